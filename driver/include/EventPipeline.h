@@ -0,0 +1,99 @@
+#ifndef EventPipeline_h
+#define EventPipeline_h
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+
+/** One unit of work (normally one event) passed along an EventPipeline. */
+class PipelineItem
+{
+public:
+	virtual ~PipelineItem() {}
+};
+
+/** Runs a reader, several workers and a writer over a stream of items, each in its own thread.
+*
+* The reader thread reads the items one after the other. Each worker thread takes the next item
+* that is waiting and processes it. Every thread has its own Worker object, so workers need not be
+* thread safe. The writer (run in the calling thread) gets the items back in the order they were
+* read, whatever order the workers finish them in, and then owns them.<br>
+* At most maxItemsInFlight items are between the reader and the writer at any time. The reader
+* waits when this is reached, so memory use does not depend on the length of the input, and a slow
+* item holds back at most maxItemsInFlight-1 items behind it.<br>
+* If any stage throws a std::exception the pipeline stops, the items not yet written are deleted
+* and run() throws a std::runtime_error with the message.
+*/
+class EventPipeline
+{
+public:
+	class Reader
+	{
+	public:
+		virtual ~Reader() {}
+		/** The next item, or 0 at the end of the input. */
+		virtual PipelineItem* read()=0;
+	};
+
+	class Worker
+	{
+	public:
+		virtual ~Worker() {}
+		virtual void process( PipelineItem* item )=0;
+	};
+
+	class Writer
+	{
+	public:
+		virtual ~Writer() {}
+		/** Called for each item in input order. The writer then owns item. */
+		virtual void write( PipelineItem* item )=0;
+	};
+
+	EventPipeline( int maxItemsInFlight );
+	~EventPipeline();
+
+	/** Runs the pipeline with one thread per worker until the reader returns 0 and every item has been written.
+	* @return the number of items written
+	*/
+	long run( Reader& reader, const std::vector<Worker*>& workers, Writer& writer );
+
+private:
+	struct WorkerArguments
+	{
+		EventPipeline* pipeline;
+		Worker* worker;
+	};
+
+	static void* readerThread( void* pipeline );
+	static void* workerThread( void* arguments );
+	void readItems();
+	void processItems( Worker* worker );
+	void writeItems();
+	void fail( const std::string& message );
+
+	int _maxItemsInFlight;
+	Reader* _reader;
+	Writer* _writer;
+
+	//Everything below is guarded by _mutex
+	pthread_mutex_t _mutex;
+	pthread_cond_t _spaceAvailable;	//signalled when an item has been written, or on failure
+	pthread_cond_t _itemsToProcess;	//signalled when an item has been read, at the end of the input, or on failure
+	pthread_cond_t _itemsProcessed;	//signalled when an item has been processed, at the end of the input, or on failure
+	long _numberRead;
+	long _numberWritten;
+	bool _endOfInput;
+	bool _failed;
+	std::string _failure;
+	std::deque<std::pair<long,PipelineItem*> > _toProcess;
+	std::map<long,PipelineItem*> _processed;
+
+	EventPipeline( const EventPipeline& ); //Declared but not defined
+	EventPipeline& operator=( const EventPipeline& ); //Declared but not defined
+};
+
+#endif //ifndef EventPipeline_h
@@ -0,0 +1,113 @@
+#ifndef FlavourTagChain_h
+#define FlavourTagChain_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <util/inc/memorymanager.h>
+
+#include "EventPipeline.h"
+#include "FlavourTagNetInputs.h"
+
+namespace vertex_lcfi
+{
+	class Event;
+	class ZVRES;
+	class TwoTrackPid;
+	class JointProb;
+	class ParameterSignificance;
+	class TrackAttach;
+	class VertexMass;
+	class SecVertexProb;
+}
+namespace nnet
+{
+	class CompiledNeuralNet;
+}
+class FlavourTagInputsExtractor;
+
+/** The result of the flavour tag for one jet. */
+struct JetTagResult
+{
+	std::vector<float> inputs;	//!< The FlavourTagInputs variables, in the order of FlavourTagChain::inputNames
+	float tags[3];			//!< The b, c and bc (b background only) tags, -1 if there is no net for the jet
+};
+
+/** One event on its way through the driver.
+*
+* All the vertex_lcfi objects of the event are registered in its own memory scope, so events in
+* different threads don't share the event memory managers. The scope is made current while the
+* event is read and while it is processed, and the objects are deleted with the event.
+*/
+class FlavourTagEvent : public PipelineItem
+{
+public:
+	FlavourTagEvent( int runNumber, int eventNumber );
+
+	int runNumber;
+	int eventNumber;
+	vertex_lcfi::EventMemoryScope memory;
+	vertex_lcfi::Event* zvresEvent;	//!< The jets with the ZVRES IP, registered in memory
+	vertex_lcfi::Event* inputsEvent;	//!< The same jets with the FlavourTagInputs IP, registered in memory (can be zvresEvent)
+	std::vector<JetTagResult> jets;	//!< In the order of the jets in the events
+};
+
+/** Runs the ZVRES, FlavourTagInputs and FlavourTag steps over the jets of an event, as
+* ZVTOPZVRESProcessor, FlavourTagInputsProcessor and FlavourTagProcessor do in Marlin.
+*
+* Each chain has its own algorithm objects, since the algorithms keep state between calls, so each
+* thread needs its own chain. The nets are only read and can be shared by all the chains.
+*/
+class FlavourTagChain
+{
+public:
+	/** parameters overrides the default algorithm parameters (those of the processors). The keys are
+	* "Algorithm.Parameter", e.g. "ZVRES.ResolverCut" or "TrackAttach.LoDCutmax", where the algorithm
+	* is one of ZVRES, TwoTrackPid, JointProb, ParameterSignificance, TrackAttach, VertexMass and
+	* SecVertexProb. ZVRES.JetWeightingEnergyScaling sets the ZVRES Kalpha per unit jet energy.<br>
+	* nets holds the nine nets by name, as used by FlavourTagNetInputs::tag, and must outlive the chain.
+	*/
+	FlavourTagChain( const std::map<std::string,double>& parameters, const std::map<std::string,const nnet::CompiledNeuralNet*>& nets );
+	~FlavourTagChain();
+
+	/** Vertexes every jet of item->zvresEvent and tags the same jet of item->inputsEvent, filling item->jets.
+	* The memory scope of item must be current.
+	*/
+	void process( FlavourTagEvent* item );
+
+	/** The names of the JetTagResult::inputs, as in the FlavourTagInputs run header. */
+	static const std::vector<std::string>& inputNames();
+
+private:
+	void _setParameter( const std::string& name, double value );
+	void _deleteAlgorithms();
+
+	const std::map<std::string,const nnet::CompiledNeuralNet*>& _Nets;
+	double _JetWeightingEnergyScaling;
+	vertex_lcfi::ZVRES* _ZVRES;
+	vertex_lcfi::TwoTrackPid* _TwoTrackPid;
+	vertex_lcfi::JointProb* _JointProb;
+	vertex_lcfi::ParameterSignificance* _ParameterSignificance;
+	vertex_lcfi::TrackAttach* _TrackAttach;
+	vertex_lcfi::VertexMass* _VertexMass;
+	vertex_lcfi::SecVertexProb* _SecVertexProb;
+	FlavourTagInputsExtractor* _InputsExtractor;
+	FlavourTagNetInputs::InputMap _InputMap;	//Positions of the net inputs in the inputs
+
+	FlavourTagChain( const FlavourTagChain& ); //Declared but not defined
+	FlavourTagChain& operator=( const FlavourTagChain& ); //Declared but not defined
+};
+
+/** An EventPipeline::Worker that runs a FlavourTagChain over FlavourTagEvent items. */
+class FlavourTagWorker : public EventPipeline::Worker
+{
+public:
+	FlavourTagWorker( const std::map<std::string,double>& parameters, const std::map<std::string,const nnet::CompiledNeuralNet*>& nets );
+	void process( PipelineItem* item );
+
+private:
+	FlavourTagChain _Chain;
+};
+
+#endif //ifndef FlavourTagChain_h
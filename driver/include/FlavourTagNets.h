@@ -0,0 +1,44 @@
+#ifndef FlavourTagNets_h
+#define FlavourTagNets_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "FlavourTagNetRegistry.h"
+
+/** The nine flavour tag nets, loaded from files as FlavourTagProcessor does, for the driver programs.
+*
+* The nets come from the FlavourTagNetRegistry, so they are shared with anything else in the process
+* that uses the same files. The nets are only read while tagging, so one FlavourTagNets can be shared by
+* any number of threads.
+*/
+class FlavourTagNets
+{
+public:
+	/** fileNames holds a file for each of the nine nets, by the names used by FlavourTagNetInputs::tag
+	* ("b_net-1vtx" ... "bc_net-3vtx"). Each file is read as XML if it starts like one and as plain
+	* text otherwise. precision is as the FlavourTag InferencePrecision parameter (0 double, 1 single,
+	* 2 int8 quantised weights) and fold as its FoldInputNormalisation parameter.
+	* Throws std::runtime_error if a net is missing or a file can't be opened.
+	*/
+	FlavourTagNets( const std::map<std::string,std::string>& fileNames, int precision, bool fold );
+	~FlavourTagNets();
+
+	/** The names of the nine nets. */
+	static const char* const* netNames();
+	enum { NumberOfNets=9 };
+
+	const std::map<std::string,const nnet::CompiledNeuralNet*>& compiledNets() const { return _CompiledNets; }
+
+private:
+	void _releaseNets();
+
+	std::vector<const FlavourTagNetRegistry::Net*> _Nets;
+	std::map<std::string,const nnet::CompiledNeuralNet*> _CompiledNets;
+
+	FlavourTagNets( const FlavourTagNets& ); //Declared but not defined
+	FlavourTagNets& operator=( const FlavourTagNets& ); //Declared but not defined
+};
+
+#endif //ifndef FlavourTagNets_h
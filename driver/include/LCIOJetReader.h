@@ -0,0 +1,66 @@
+#ifndef LCIOJetReader_h
+#define LCIOJetReader_h
+
+#include <string>
+#include <vector>
+
+#include "EventPipeline.h"
+
+namespace IO
+{
+	class LCReader;
+}
+namespace EVENT
+{
+	class LCEvent;
+}
+
+/** An EventPipeline::Reader that reads LCIO files and converts the jets of each event to a FlavourTagEvent.
+*
+* The conversion is done here, in the reader thread, because the LCIO reader reuses its event for
+* the next one, so nothing from the LCIO event is kept.<br>
+* As in Marlin, ZVRES and FlavourTagInputs each have their own IP, and so their own vertex_lcfi::Event.
+* Each IP is either set by hand or the primary vertex of a vertex collection. The defaults are those
+* of the processors: ZVTOPZVRESProcessor uses its ManualIPVertex parameters (the origin), and
+* FlavourTagInputsProcessor the primary vertex in the IPVertex collection. The jets are converted once
+* for each IP, or only once if the two IPs are the same.
+*/
+class LCIOJetReader : public EventPipeline::Reader
+{
+public:
+	/** Reads the files in order. maxEvents<0 reads all the events. */
+	LCIOJetReader( const std::vector<std::string>& fileNames, const std::string& jetCollectionName, long maxEvents=-1 );
+	~LCIOJetReader();
+
+	/** The steps that take an IP. */
+	enum Step { ZVRESStep, FlavourTagInputsStep, NumberOfSteps };
+
+	/** Sets the IP of step for every event. error is the lower symmetric error matrix (six values). */
+	void useManualIP( Step step, const std::vector<double>& position, const std::vector<double>& error );
+
+	/** Takes the IP of step for each event from the primary vertex in the named collection. */
+	void useIPVertexCollection( Step step, const std::string& collectionName );
+
+	PipelineItem* read();
+
+private:
+	struct IP
+	{
+		std::string vertexCollectionName;	//Empty to use the manual IP
+		std::vector<double> position;
+		std::vector<double> error;
+	};
+
+	void _findIP( EVENT::LCEvent* LCIOEvent, const IP& ip, std::vector<double>& position, std::vector<double>& error ) const;
+
+	IO::LCReader* _Reader;
+	std::string _JetCollectionName;
+	IP _IP[NumberOfSteps];
+	long _MaxEvents;
+	long _NumberRead;
+
+	LCIOJetReader( const LCIOJetReader& ); //Declared but not defined
+	LCIOJetReader& operator=( const LCIOJetReader& ); //Declared but not defined
+};
+
+#endif //ifndef LCIOJetReader_h
@@ -0,0 +1,174 @@
+// Runs the ZVRES vertexing, the flavour tag inputs and the flavour tag neural nets over the jets
+// of LCIO files outside Marlin, with the events shared between several threads.
+//
+// The events are read and converted in one thread, vertexed and tagged by the worker threads and
+// written in the order they were read, one line per jet, to a text file.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "nnet/inc/NeuralNetThreads.h"
+
+#include "EventPipeline.h"
+#include "FlavourTagChain.h"
+#include "FlavourTagNets.h"
+#include "LCIOJetReader.h"
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: lcfiflavourtag [options] -o output.txt input.slcio [input.slcio ...]\n"
+			<< "  -net NAME=FILE       the previously trained net NAME (b_net-1vtx, c_net-1vtx, bc_net-1vtx,\n"
+			<< "                       b_net-2vtx ... bc_net-3vtx), all nine are needed\n"
+			<< "  -jets COLLECTION     the ReconstructedParticle collection of the jets (default FTSelectedJets)\n"
+			<< "  -zvresipvertex COLLECTION\n"
+			<< "                       take the ZVRES IP from the primary vertex in COLLECTION (default the\n"
+			<< "                       origin, as ZVTOPZVRESProcessor with ManualIPVertex)\n"
+			<< "  -inputsipvertex COLLECTION\n"
+			<< "                       take the FlavourTagInputs IP from the primary vertex in COLLECTION\n"
+			<< "                       (default IPVertex, as FlavourTagInputsProcessor)\n"
+			<< "  -ipvertex COLLECTION the same as both of the above\n"
+			<< "  -set ALGO.PARAM=X    set an algorithm parameter, e.g. -set TrackAttach.LoDCutmax=2.5\n"
+			<< "  -threads N           number of worker threads (default 0, one per processor)\n"
+			<< "  -inflight N          most events read but not yet written (default 4 per thread)\n"
+			<< "  -events N            stop after N events\n"
+			<< "  -precision N         net arithmetic, 0 double (default), 1 single, 2 int8 quantised weights\n"
+			<< "  -fold                fold the net input normalisation into the first layer weights\n";
+	}
+
+	bool splitAssignment( const std::string& assignment, std::string& name, std::string& value )
+	{
+		std::string::size_type equals=assignment.find( '=' );
+		if( equals==std::string::npos || equals==0 ) return false;
+		name=assignment.substr( 0, equals );
+		value=assignment.substr( equals+1 );
+		return true;
+	}
+
+	/** Writes the tags and inputs of each jet as one line of text. */
+	class TagTableWriter : public EventPipeline::Writer
+	{
+	public:
+		TagTableWriter( std::ostream& output ) : _Output(output)
+		{
+			_Output << "Run Event Jet BTag CTag BCTag";
+			for( size_t i=0; i<FlavourTagChain::inputNames().size(); ++i ) _Output << " " << FlavourTagChain::inputNames()[i];
+			_Output << std::endl;
+		}
+
+		void write( PipelineItem* item )
+		{
+			std::auto_ptr<FlavourTagEvent> Event( static_cast<FlavourTagEvent*>( item ) );
+			for( size_t a=0; a<Event->jets.size(); ++a )
+			{
+				const JetTagResult& Jet=Event->jets[a];
+				_Output << Event->runNumber << " " << Event->eventNumber << " " << a;
+				for( int net=0; net<3; ++net ) _Output << " " << Jet.tags[net];
+				for( size_t i=0; i<Jet.inputs.size(); ++i ) _Output << " " << Jet.inputs[i];
+				_Output << "\n";
+			}
+			if( !_Output ) throw std::runtime_error( "TagTableWriter: unable to write the output" );
+		}
+
+	private:
+		std::ostream& _Output;
+	};
+}
+
+int main( int argc, char** argv )
+{
+	std::vector<std::string> inputFiles;
+	std::string outputFile;
+	std::string jetCollection( "FTSelectedJets" );
+	std::string zvresIPVertexCollection;
+	std::string inputsIPVertexCollection( "IPVertex" );
+	std::map<std::string,std::string> netFiles;
+	std::map<std::string,double> parameters;
+	int threads=0;
+	int inFlight=0;
+	long maxEvents=-1;
+	int precision=0;
+	bool fold=false;
+
+	for( int i=1; i<argc; ++i )
+	{
+		std::string arg( argv[i] );
+		bool hasValue=( i+1<argc );
+		std::string name, value;
+		if( arg=="-o" && hasValue ) outputFile=argv[++i];
+		else if( arg=="-jets" && hasValue ) jetCollection=argv[++i];
+		else if( arg=="-zvresipvertex" && hasValue ) zvresIPVertexCollection=argv[++i];
+		else if( arg=="-inputsipvertex" && hasValue ) inputsIPVertexCollection=argv[++i];
+		else if( arg=="-ipvertex" && hasValue ) zvresIPVertexCollection=inputsIPVertexCollection=argv[++i];
+		else if( arg=="-threads" && hasValue ) threads=std::atoi( argv[++i] );
+		else if( arg=="-inflight" && hasValue ) inFlight=std::atoi( argv[++i] );
+		else if( arg=="-events" && hasValue ) maxEvents=std::atol( argv[++i] );
+		else if( arg=="-precision" && hasValue ) precision=std::atoi( argv[++i] );
+		else if( arg=="-fold" ) fold=true;
+		else if( arg=="-net" && hasValue && splitAssignment( argv[++i], name, value ) ) netFiles[name]=value;
+		else if( arg=="-set" && hasValue && splitAssignment( argv[++i], name, value ) ) parameters[name]=std::atof( value.c_str() );
+		else if( !arg.empty() && arg[0]!='-' ) inputFiles.push_back( arg );
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if( inputFiles.empty() || outputFile.empty() )
+	{
+		usage();
+		return 1;
+	}
+	if( threads<=0 ) threads=nnet::NeuralNetThreads::NumberOfProcessors();
+	if( inFlight<=0 ) inFlight=4*threads;
+
+	int status=0;
+	try
+	{
+		//The nets are only read while tagging, so one copy is shared by all the workers
+		FlavourTagNets nets( netFiles, precision, fold );
+
+		std::vector<FlavourTagWorker*> workers;
+		std::vector<EventPipeline::Worker*> pipelineWorkers;
+		try
+		{
+			for( int i=0; i<threads; ++i )
+			{
+				workers.push_back( new FlavourTagWorker( parameters, nets.compiledNets() ) );
+				pipelineWorkers.push_back( workers.back() );
+			}
+
+			LCIOJetReader reader( inputFiles, jetCollection, maxEvents );
+			if( !zvresIPVertexCollection.empty() ) reader.useIPVertexCollection( LCIOJetReader::ZVRESStep, zvresIPVertexCollection );
+			reader.useIPVertexCollection( LCIOJetReader::FlavourTagInputsStep, inputsIPVertexCollection );
+
+			std::ofstream output( outputFile.c_str() );
+			if( !output ) throw std::runtime_error( "unable to open " + outputFile );
+			TagTableWriter writer( output );
+
+			EventPipeline pipeline( inFlight );
+			long numberOfEvents=pipeline.run( reader, pipelineWorkers, writer );
+			std::cout << "lcfiflavourtag: Tagged " << numberOfEvents << " events with " << threads << " threads." << std::endl;
+		}
+		catch( ... )
+		{
+			for( size_t i=0; i<workers.size(); ++i ) delete workers[i];
+			throw;
+		}
+		for( size_t i=0; i<workers.size(); ++i ) delete workers[i];
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << "lcfiflavourtag: " << e.what() << std::endl;
+		status=1;
+	}
+
+	return status;
+}
@@ -0,0 +1,98 @@
+// Adds up the partial results written by PlotProcessor or LCFIAIDAPlotProcessor (their PartialResultsFile
+// parameter) for any number of jobs, and writes the merged partial results and/or the final curves.
+//
+// The files are read one at a time and added to the running total, so memory use does not depend on
+// how many there are. With -list the file names are read from a file, one per line, for when there
+// are too many to go on the command line.
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FlavourTagPlotData.h"
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: lcfimergeplots [options] partial1 partial2 ...\n"
+			<< "  -o FILE         write the merged partial results to FILE (which can be merged again)\n"
+			<< "  -curves BASE    write the efficiency-purity and vertex charge curves to BASE-*.csv\n"
+			<< "  -list FILE      also merge the partial results files listed in FILE, one per line\n"
+			<< "At least one of -o and -curves is needed.\n";
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::string outputFile;
+	std::string curvesBase;
+	std::vector<std::string> inputFiles;
+
+	for( int i=1; i<argc; ++i )
+	{
+		std::string arg( argv[i] );
+		bool hasValue=( i+1<argc );
+		if( arg=="-o" && hasValue ) outputFile=argv[++i];
+		else if( arg=="-curves" && hasValue ) curvesBase=argv[++i];
+		else if( arg=="-list" && hasValue )
+		{
+			std::string listFile( argv[++i] );
+			std::ifstream list( listFile.c_str() );
+			if( !list.is_open() )
+			{
+				std::cerr << "lcfimergeplots: unable to open " << listFile << std::endl;
+				return 1;
+			}
+			std::string line;
+			while( std::getline( list, line ) )
+			{
+				std::string::size_type first=line.find_first_not_of( " \t\r" );
+				if( first==std::string::npos ) continue;
+				std::string::size_type last=line.find_last_not_of( " \t\r" );
+				inputFiles.push_back( line.substr( first, last-first+1 ) );
+			}
+		}
+		else if( !arg.empty() && arg[0]!='-' ) inputFiles.push_back( arg );
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if( inputFiles.empty() || ( outputFile.empty() && curvesBase.empty() ) )
+	{
+		usage();
+		return 1;
+	}
+
+	try
+	{
+		FlavourTagPlotData total;
+		FlavourTagPlotData partial;
+		for( size_t i=0; i<inputFiles.size(); ++i )
+		{
+			partial.read( inputFiles[i] );
+			try
+			{
+				total.merge( partial );
+			}
+			catch( std::runtime_error& e )
+			{
+				throw std::runtime_error( inputFiles[i] + ": " + e.what() );
+			}
+		}
+
+		if( !outputFile.empty() ) total.write( outputFile );
+		if( !curvesBase.empty() ) total.writeCurves( curvesBase );
+		std::cout << "lcfimergeplots: Merged " << inputFiles.size() << " files." << std::endl;
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << "lcfimergeplots: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,134 @@
+// Runs the flavour tag neural nets over a column file of flavour tag inputs (written by
+// FlavourTagInputsExportProcessor), without reading the LCIO events again.
+//
+// Each chunk of the file is tagged in one go: the net inputs of all its jets are gathered and
+// normalised together, and each net is evaluated once over the jets of its vertex category.
+// The output has one line per jet with the true flavour from the file.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "FlavourTagInputsColumns.h"
+#include "FlavourTagNetInputs.h"
+#include "FlavourTagNets.h"
+
+namespace
+{
+	void usage()
+	{
+		std::cerr << "Usage: lcfiretag [options] -o output.txt input.ftic\n"
+			<< "  -net NAME=FILE  the previously trained net NAME (b_net-1vtx, c_net-1vtx, bc_net-1vtx,\n"
+			<< "                  b_net-2vtx ... bc_net-3vtx), all nine are needed\n"
+			<< "  -precision N    net arithmetic, 0 double (default), 1 single, 2 int8 quantised weights\n"
+			<< "  -fold           fold the net input normalisation into the first layer weights\n";
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::string inputFile;
+	std::string outputFile;
+	std::map<std::string,std::string> netFiles;
+	int precision=0;
+	bool fold=false;
+
+	for( int i=1; i<argc; ++i )
+	{
+		std::string arg( argv[i] );
+		bool hasValue=( i+1<argc );
+		if( arg=="-o" && hasValue ) outputFile=argv[++i];
+		else if( arg=="-precision" && hasValue ) precision=std::atoi( argv[++i] );
+		else if( arg=="-fold" ) fold=true;
+		else if( arg=="-net" && hasValue )
+		{
+			std::string assignment( argv[++i] );
+			std::string::size_type equals=assignment.find( '=' );
+			if( equals==std::string::npos || equals==0 )
+			{
+				usage();
+				return 1;
+			}
+			netFiles[assignment.substr( 0, equals )]=assignment.substr( equals+1 );
+		}
+		else if( !arg.empty() && arg[0]!='-' && inputFile.empty() ) inputFile=arg;
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if( inputFile.empty() || outputFile.empty() )
+	{
+		usage();
+		return 1;
+	}
+
+	try
+	{
+		FlavourTagNets nets( netFiles, precision, fold );
+		FlavourTagInputsColumnReader reader( inputFile );
+
+		//Where each variable the nets use is in the file, for each vertex category
+		const int numberOfInputs=FlavourTagNetInputs::NumberOfInputs;
+		FlavourTagNetInputs::InputMap inputMap;
+		std::vector<std::string> missingNames=inputMap.resolve( reader.variableNames() );
+		if( !missingNames.empty() ) throw std::runtime_error( inputFile + " has no " + missingNames[0] + " column" );
+
+		std::ofstream output( outputFile.c_str() );
+		if( !output ) throw std::runtime_error( "unable to open " + outputFile );
+		output << "Run Event Jet TrueJetFlavour BTag CTag BCTag" << std::endl;
+
+		std::vector<int> vertexCategory;
+		std::vector<double> jetEnergies;
+		std::vector<double> inputs;
+		std::vector<double> tags;
+		for( int chunk=0; chunk<reader.numberOfChunks(); ++chunk )
+		{
+			const int numberOfJets=reader.readChunk( chunk );
+			if( numberOfJets==0 ) continue;
+			vertexCategory.resize( numberOfJets );
+			jetEnergies.resize( numberOfJets );
+			inputs.assign( numberOfJets*numberOfInputs, 0.0 );
+			tags.resize( numberOfJets*3 );
+
+			const float* numVertices=reader.variable( inputMap.numVerticesIndex() );
+			for( int a=0; a<numberOfJets; ++a )
+			{
+				vertexCategory[a]=FlavourTagNetInputs::vertexCategory( numVertices[a] );
+				jetEnergies[a]=( reader.jetEnergy()[a]==0 ) ? 45.5 : reader.jetEnergy()[a];
+			}
+			//Gather column by column, so each column of the chunk is read through once
+			for( int i=0; i<numberOfInputs; ++i )
+			{
+				for( int category=1; category<=3; ++category )
+				{
+					const float* column=reader.variable( inputMap.index( category, i ) );
+					for( int a=0; a<numberOfJets; ++a )
+						if( vertexCategory[a]==category ) inputs[a*numberOfInputs+i]=column[a];
+				}
+			}
+
+			FlavourTagNetInputs::normalise( numberOfJets, &vertexCategory[0], &jetEnergies[0], &inputs[0] );
+			FlavourTagNetInputs::tag( nets.compiledNets(), numberOfJets, &vertexCategory[0], &inputs[0], &tags[0] );
+
+			for( int a=0; a<numberOfJets; ++a )
+			{
+				output << reader.runNumber()[a] << " " << reader.eventNumber()[a] << " " << reader.jetIndex()[a] << " " << reader.trueJetFlavour()[a]
+					<< " " << tags[a*3] << " " << tags[a*3+1] << " " << tags[a*3+2] << "\n";
+			}
+			if( !output ) throw std::runtime_error( "unable to write " + outputFile );
+		}
+		std::cout << "lcfiretag: Tagged " << reader.numberOfJets() << " jets." << std::endl;
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << "lcfiretag: " << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,145 @@
+// Reads a column file of ZVTOP results (written by the ZVTOP_ZVRESProcessor or ZVTOP_ZVKINProcessor
+// ColumnFile parameter), checks that it is consistent and prints a summary.
+//
+// Every chunk is read, and for every jet the vertex and track rows it points to are checked to be in the
+// chunk and to point back to the jet, and the chunk index is checked to find the jet's event. With -event
+// the vertices and tracks of the jets of one event are also printed.
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include "ZVTOPResultColumns.h"
+
+namespace
+{
+	typedef ZVTOPResultColumns Z;
+
+	void usage()
+	{
+		std::cerr << "Usage: lcfizvtopcolumns [options] input.zvtc\n"
+			<< "  -event RUN EVENT  print the vertices and tracks of the jets of this event\n";
+	}
+
+	void check( bool condition, int chunk, int jetRow, const std::string& problem )
+	{
+		if( condition ) return;
+		std::ostringstream message;
+		message << "chunk " << chunk << ", jet row " << jetRow << ": " << problem;
+		throw std::runtime_error( message.str() );
+	}
+
+	void checkChunk( ZVTOPResultColumnReader& reader, int chunk )
+	{
+		const int* run=reader.jetColumn( Z::Run );
+		const int* event=reader.jetColumn( Z::Event );
+		const int* numberOfVertices=reader.jetColumn( Z::NumberOfVertices );
+		const int* firstVertex=reader.jetColumn( Z::FirstVertex );
+		const int* numberOfTrackRows=reader.jetColumn( Z::NumberOfTrackRows );
+		const int* firstTrackRow=reader.jetColumn( Z::FirstTrackRow );
+		const int* vertexJetRow=reader.vertexIntColumn( Z::VertexJetRow );
+		const int* trackJetRow=reader.trackIntColumn( Z::TrackJetRow );
+		const int* vertexRow=reader.trackIntColumn( Z::VertexRow );
+		const int vertexRows=reader.rows( Z::Vertices );
+		const int trackRows=reader.rows( Z::Tracks );
+
+		for( int jet=0; jet<reader.rows( Z::Jets ); ++jet )
+		{
+			check( reader.findChunk( run[jet], event[jet] )==chunk, chunk, jet, "the chunk index does not find the event" );
+			check( firstVertex[jet]>=0 && numberOfVertices[jet]>=0 && firstVertex[jet]+numberOfVertices[jet]<=vertexRows, chunk, jet, "vertex rows out of range" );
+			check( firstTrackRow[jet]>=0 && numberOfTrackRows[jet]>=0 && firstTrackRow[jet]+numberOfTrackRows[jet]<=trackRows, chunk, jet, "track rows out of range" );
+			for( int v=firstVertex[jet]; v<firstVertex[jet]+numberOfVertices[jet]; ++v )
+				check( vertexJetRow[v]==jet, chunk, jet, "a vertex belongs to another jet" );
+			for( int t=firstTrackRow[jet]; t<firstTrackRow[jet]+numberOfTrackRows[jet]; ++t )
+			{
+				check( trackJetRow[t]==jet, chunk, jet, "a track row belongs to another jet" );
+				check( vertexRow[t]==-1 || ( vertexRow[t]>=firstVertex[jet] && vertexRow[t]<firstVertex[jet]+numberOfVertices[jet] ), chunk, jet,
+					"a track row points to a vertex of another jet" );
+			}
+		}
+	}
+
+	void printEvent( ZVTOPResultColumnReader& reader, int runNumber, int eventNumber )
+	{
+		const int* run=reader.jetColumn( Z::Run );
+		const int* event=reader.jetColumn( Z::Event );
+		for( int jet=0; jet<reader.rows( Z::Jets ); ++jet )
+		{
+			if( run[jet]!=runNumber || event[jet]!=eventNumber ) continue;
+			std::cout << "Jet " << reader.jetColumn( Z::JetIndex )[jet] << ": " << reader.jetColumn( Z::JetNumberOfTracks )[jet] << " tracks, "
+				<< reader.jetColumn( Z::NumberOfVertices )[jet] << " vertices" << std::endl;
+			const int firstVertex=reader.jetColumn( Z::FirstVertex )[jet];
+			for( int v=firstVertex; v<firstVertex+reader.jetColumn( Z::NumberOfVertices )[jet]; ++v )
+			{
+				std::cout << "  vertex " << v-firstVertex << ( reader.vertexIntColumn( Z::IsPrimary )[v] ? " (IP)" : "" )
+					<< " at (" << reader.vertexFloatColumn( Z::X )[v] << ", " << reader.vertexFloatColumn( Z::Y )[v] << ", " << reader.vertexFloatColumn( Z::Z )[v]
+					<< ") chi2 " << reader.vertexFloatColumn( Z::VertexChi2 )[v] << " V(r) " << reader.vertexFloatColumn( Z::VertexFunctionMax )[v]
+					<< ", tracks";
+				const int firstTrackRow=reader.jetColumn( Z::FirstTrackRow )[jet];
+				for( int t=firstTrackRow; t<firstTrackRow+reader.jetColumn( Z::NumberOfTrackRows )[jet]; ++t )
+					if( reader.trackIntColumn( Z::VertexRow )[t]==v ) std::cout << " " << reader.trackIntColumn( Z::TrackIndex )[t];
+				std::cout << std::endl;
+			}
+		}
+	}
+}
+
+int main( int argc, char** argv )
+{
+	std::string inputFile;
+	bool printOneEvent=false;
+	int runNumber=0;
+	int eventNumber=0;
+
+	for( int i=1; i<argc; ++i )
+	{
+		std::string arg( argv[i] );
+		if( arg=="-event" && i+2<argc )
+		{
+			printOneEvent=true;
+			runNumber=std::atoi( argv[++i] );
+			eventNumber=std::atoi( argv[++i] );
+		}
+		else if( !arg.empty() && arg[0]!='-' && inputFile.empty() ) inputFile=arg;
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+	if( inputFile.empty() )
+	{
+		usage();
+		return 1;
+	}
+
+	try
+	{
+		ZVTOPResultColumnReader reader( inputFile );
+		long numberOfTrackRows=0;
+		for( int chunk=0; chunk<reader.numberOfChunks(); ++chunk )
+		{
+			reader.readChunk( chunk );
+			checkChunk( reader, chunk );
+			numberOfTrackRows+=reader.rows( Z::Tracks );
+		}
+		std::cout << inputFile << ": " << reader.numberOfJets() << " jets, " << reader.numberOfVertices() << " vertices, "
+			<< numberOfTrackRows << " track rows in " << reader.numberOfChunks() << " chunks" << std::endl;
+
+		if( printOneEvent )
+		{
+			int chunk=reader.findChunk( runNumber, eventNumber );
+			if( chunk<0 ) throw std::runtime_error( "the event is not in the file" );
+			reader.readChunk( chunk );
+			printEvent( reader, runNumber, eventNumber );
+		}
+	}
+	catch( std::exception& error )
+	{
+		std::cerr << "lcfizvtopcolumns: " << error.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,197 @@
+#include "../include/EventPipeline.h"
+
+#include <stdexcept>
+
+EventPipeline::EventPipeline( int maxItemsInFlight )
+	: _maxItemsInFlight( maxItemsInFlight>0 ? maxItemsInFlight : 1 ), _reader(0), _writer(0),
+	_numberRead(0), _numberWritten(0), _endOfInput(false), _failed(false)
+{
+	pthread_mutex_init( &_mutex, 0 );
+	pthread_cond_init( &_spaceAvailable, 0 );
+	pthread_cond_init( &_itemsToProcess, 0 );
+	pthread_cond_init( &_itemsProcessed, 0 );
+}
+
+EventPipeline::~EventPipeline()
+{
+	pthread_cond_destroy( &_itemsProcessed );
+	pthread_cond_destroy( &_itemsToProcess );
+	pthread_cond_destroy( &_spaceAvailable );
+	pthread_mutex_destroy( &_mutex );
+}
+
+long EventPipeline::run( Reader& reader, const std::vector<Worker*>& workers, Writer& writer )
+{
+	if( workers.empty() ) throw std::invalid_argument( "EventPipeline::run needs at least one worker" );
+
+	_reader=&reader;
+	_writer=&writer;
+	_numberRead=0;
+	_numberWritten=0;
+	_endOfInput=false;
+	_failed=false;
+	_failure.clear();
+
+	pthread_t readerThreadId;
+	bool readerStarted=( pthread_create( &readerThreadId, 0, readerThread, this )==0 );
+	if( !readerStarted ) fail( "EventPipeline: unable to start the reader thread" );
+
+	std::vector<WorkerArguments> arguments( workers.size() );
+	std::vector<pthread_t> workerThreadIds( workers.size() );
+	std::vector<bool> workerStarted( workers.size(), false );
+	for( size_t i=0; i<workers.size(); ++i )
+	{
+		arguments[i].pipeline=this;
+		arguments[i].worker=workers[i];
+		workerStarted[i]=( pthread_create( &workerThreadIds[i], 0, workerThread, &arguments[i] )==0 );
+		if( !workerStarted[i] ) fail( "EventPipeline: unable to start a worker thread" );
+	}
+
+	//The writer runs in this thread
+	writeItems();
+
+	if( readerStarted ) pthread_join( readerThreadId, 0 );
+	for( size_t i=0; i<workers.size(); ++i )
+		if( workerStarted[i] ) pthread_join( workerThreadIds[i], 0 );
+
+	//Anything left over is only there if the pipeline failed
+	for( std::deque<std::pair<long,PipelineItem*> >::iterator iItem=_toProcess.begin(); iItem!=_toProcess.end(); ++iItem ) delete iItem->second;
+	_toProcess.clear();
+	for( std::map<long,PipelineItem*>::iterator iItem=_processed.begin(); iItem!=_processed.end(); ++iItem ) delete iItem->second;
+	_processed.clear();
+
+	if( _failed ) throw std::runtime_error( _failure );
+	return _numberWritten;
+}
+
+void* EventPipeline::readerThread( void* pipeline )
+{
+	static_cast<EventPipeline*>( pipeline )->readItems();
+	return 0;
+}
+
+void* EventPipeline::workerThread( void* arguments )
+{
+	WorkerArguments* args=static_cast<WorkerArguments*>( arguments );
+	args->pipeline->processItems( args->worker );
+	return 0;
+}
+
+void EventPipeline::readItems()
+{
+	for(;;)
+	{
+		pthread_mutex_lock( &_mutex );
+		while( !_failed && _numberRead-_numberWritten>=_maxItemsInFlight ) pthread_cond_wait( &_spaceAvailable, &_mutex );
+		bool failed=_failed;
+		pthread_mutex_unlock( &_mutex );
+		if( failed ) return;
+
+		PipelineItem* item=0;
+		try
+		{
+			item=_reader->read();
+		}
+		catch( std::exception& e )
+		{
+			fail( std::string( "EventPipeline: reader failed: " )+e.what() );
+			return;
+		}
+
+		pthread_mutex_lock( &_mutex );
+		if( !item || _failed )
+		{
+			_endOfInput=true;
+			pthread_cond_broadcast( &_itemsToProcess );
+			pthread_cond_broadcast( &_itemsProcessed );
+			pthread_mutex_unlock( &_mutex );
+			delete item;
+			return;
+		}
+		_toProcess.push_back( std::make_pair( _numberRead, item ) );
+		++_numberRead;
+		pthread_cond_signal( &_itemsToProcess );
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
+void EventPipeline::processItems( Worker* worker )
+{
+	for(;;)
+	{
+		pthread_mutex_lock( &_mutex );
+		while( !_failed && _toProcess.empty() && !_endOfInput ) pthread_cond_wait( &_itemsToProcess, &_mutex );
+		if( _failed || _toProcess.empty() )
+		{
+			pthread_mutex_unlock( &_mutex );
+			return;
+		}
+		std::pair<long,PipelineItem*> item=_toProcess.front();
+		_toProcess.pop_front();
+		pthread_mutex_unlock( &_mutex );
+
+		try
+		{
+			worker->process( item.second );
+		}
+		catch( std::exception& e )
+		{
+			delete item.second;
+			fail( std::string( "EventPipeline: worker failed: " )+e.what() );
+			return;
+		}
+
+		pthread_mutex_lock( &_mutex );
+		_processed[item.first]=item.second;
+		pthread_cond_signal( &_itemsProcessed );
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
+void EventPipeline::writeItems()
+{
+	for(;;)
+	{
+		pthread_mutex_lock( &_mutex );
+		while( !_failed && _processed.find( _numberWritten )==_processed.end() && !( _endOfInput && _numberWritten==_numberRead ) )
+			pthread_cond_wait( &_itemsProcessed, &_mutex );
+		std::map<long,PipelineItem*>::iterator next=_processed.find( _numberWritten );
+		if( _failed || next==_processed.end() )
+		{
+			pthread_mutex_unlock( &_mutex );
+			return;
+		}
+		PipelineItem* item=next->second;
+		_processed.erase( next );
+		pthread_mutex_unlock( &_mutex );
+
+		try
+		{
+			_writer->write( item );
+		}
+		catch( std::exception& e )
+		{
+			fail( std::string( "EventPipeline: writer failed: " )+e.what() );
+			return;
+		}
+
+		pthread_mutex_lock( &_mutex );
+		++_numberWritten;
+		pthread_cond_signal( &_spaceAvailable );
+		pthread_mutex_unlock( &_mutex );
+	}
+}
+
+void EventPipeline::fail( const std::string& message )
+{
+	pthread_mutex_lock( &_mutex );
+	if( !_failed )
+	{
+		_failed=true;
+		_failure=message;
+	}
+	pthread_cond_broadcast( &_spaceAvailable );
+	pthread_cond_broadcast( &_itemsToProcess );
+	pthread_cond_broadcast( &_itemsProcessed );
+	pthread_mutex_unlock( &_mutex );
+}
@@ -0,0 +1,225 @@
+#include "../include/FlavourTagChain.h"
+
+#include <stdexcept>
+
+#include <inc/event.h>
+#include <inc/jet.h>
+#include <inc/decaychain.h>
+#include <inc/track.h>
+#include <inc/vertex.h>
+#include <algo/inc/zvres.h>
+#include <algo/inc/twotrackpid.h>
+#include <algo/inc/jointprob.h>
+#include <algo/inc/paramsignificance.h>
+#include <algo/inc/trackattach.h>
+#include <algo/inc/vertexmass.h>
+#include <algo/inc/secondvertexprob.h>
+
+#include "FlavourTagInputsExtractor.h"
+
+using namespace vertex_lcfi;
+
+namespace
+{
+	//The ZVRES decay chain of a jet moved onto the same jet in another event, as ZVTOPZVRESProcessor writing it to
+	//LCIO and FlavourTagInputsProcessor reading it back with decayChainFromLCIORP do: the vertices are copied into
+	//the event of MyJet without the track chi squareds, and the tracks are those of MyJet from the same
+	//ReconstructedParticles. Only the float rounding of LCIO is left out.
+	DecayChain* decayChainOfJet( DecayChain* ZVRESChain, Jet* MyJet )
+	{
+		std::map<void*,vertex_lcfi::Track*> TrackOf;
+		for( std::vector<vertex_lcfi::Track*>::const_iterator iTrack=MyJet->tracks().begin(); iTrack!=MyJet->tracks().end(); ++iTrack )
+			TrackOf[(*iTrack)->trackingNum()]=*iTrack;
+
+		DecayChain* NewChain=new DecayChain( MyJet, std::vector<vertex_lcfi::Track*>(), std::vector<vertex_lcfi::Vertex*>() );
+		MemoryManager<DecayChain>::Event()->registerObject( NewChain );
+		std::map<vertex_lcfi::Track*,vertex_lcfi::Vertex*> VertexOf;
+		for( std::vector<vertex_lcfi::Vertex*>::const_iterator iVertex=ZVRESChain->vertices().begin(); iVertex!=ZVRESChain->vertices().end(); ++iVertex )
+		{
+			vertex_lcfi::Vertex* NewVertex=new vertex_lcfi::Vertex( MyJet->event(), std::vector<vertex_lcfi::Track*>(), (*iVertex)->position(), (*iVertex)->positionError(),
+				(*iVertex)->isPrimary(), (*iVertex)->chi2(), (*iVertex)->probability() );
+			MemoryManager<vertex_lcfi::Vertex>::Event()->registerObject( NewVertex );
+			NewChain->addVertex( NewVertex );
+			for( std::vector<vertex_lcfi::Track*>::const_iterator iTrack=(*iVertex)->tracks().begin(); iTrack!=(*iVertex)->tracks().end(); ++iTrack )
+				VertexOf[*iTrack]=NewVertex;
+		}
+
+		//The tracks go in the order of allTracks, as they are written to LCIO
+		const std::vector<vertex_lcfi::Track*>& AllTracks=ZVRESChain->allTracks();
+		for( std::vector<vertex_lcfi::Track*>::const_iterator iTrack=AllTracks.begin(); iTrack!=AllTracks.end(); ++iTrack )
+		{
+			std::map<void*,vertex_lcfi::Track*>::const_iterator iNewTrack=TrackOf.find( (*iTrack)->trackingNum() );
+			if( iNewTrack==TrackOf.end() ) continue;
+			std::map<vertex_lcfi::Track*,vertex_lcfi::Vertex*>::const_iterator iNewVertex=VertexOf.find( *iTrack );
+			if( iNewVertex!=VertexOf.end() ) iNewVertex->second->addTrack( iNewTrack->second );
+			else NewChain->addTrack( iNewTrack->second );
+		}
+		return NewChain;
+	}
+}
+
+FlavourTagEvent::FlavourTagEvent( int RunNumber, int EventNumber )
+	: runNumber(RunNumber), eventNumber(EventNumber), zvresEvent(0), inputsEvent(0)
+{
+}
+
+FlavourTagChain::FlavourTagChain( const std::map<std::string,double>& parameters, const std::map<std::string,const nnet::CompiledNeuralNet*>& nets )
+	: _Nets(nets), _JetWeightingEnergyScaling(5.0/40.0)
+{
+	//The defaults are those of ZVTOPZVRESProcessor and FlavourTagInputsProcessor
+	_ZVRES=new ZVRES();
+	_ZVRES->setDoubleParameter( "Kip", 1.0 );
+	_ZVRES->setDoubleParameter( "TwoProngCut", 10.0 );
+	_ZVRES->setDoubleParameter( "TrackTrimCut", 10.0 );
+	_ZVRES->setDoubleParameter( "ResolverCut", 0.6 );
+	_ZVRES->setStringParameter( "AutoJetAxis", "TRUE" );
+	_ZVRES->setStringParameter( "UseEventIP", "TRUE" );
+
+	_TwoTrackPid=new TwoTrackPid();
+	_TwoTrackPid->setDoubleParameter( "MaxGammaMass", 0.02 );
+	_TwoTrackPid->setDoubleParameter( "MinKsMass", 0.475 );
+	_TwoTrackPid->setDoubleParameter( "MaxKsMass", 0.525 );
+	_TwoTrackPid->setDoubleParameter( "Chi2Cut", 6.63 );
+	_TwoTrackPid->setDoubleParameter( "RPhiCut", 20.0 );
+	_TwoTrackPid->setDoubleParameter( "SignificanceCut", 3.0 );
+
+	_JointProb=new JointProb();
+	_JointProb->setDoubleParameter( "MaxD0Significance", 200.0 );
+	_JointProb->setDoubleParameter( "MaxD0andZ0", 5.0 );
+
+	_ParameterSignificance=new ParameterSignificance();
+	_ParameterSignificance->setDoubleParameter( "LayersHit", 5.0 );
+	_ParameterSignificance->setDoubleParameter( "AllbutOneLayersMomentumCut", 2.0 );
+	_ParameterSignificance->setDoubleParameter( "AllLayersMomentumCut", 1.0 );
+
+	_TrackAttach=new TrackAttach();
+	_TrackAttach->setDoubleParameter( "AddAllTracksFromSecondary", 0.0 );
+	_TrackAttach->setDoubleParameter( "LoDCutmin", 0.18 );
+	_TrackAttach->setDoubleParameter( "LoDCutmax", 2.5 );
+	_TrackAttach->setDoubleParameter( "CloseapproachCut", 1.0 );
+
+	_VertexMass=new VertexMass();
+	_VertexMass->setDoubleParameter( "MaxMomentumAngle", 3.0 );
+	_VertexMass->setDoubleParameter( "MaxKinematicCorrectionSigma", 2.0 );
+	_VertexMass->setDoubleParameter( "MaxMomentumCorrection", 2.0 );
+
+	_SecVertexProb=new SecVertexProb();
+	_SecVertexProb->setDoubleParameter( "Chisquarecut", 20.0 );
+	_SecVertexProb->setDoubleParameter( "Ntrackscut", 1.0 );
+
+	_InputsExtractor=new FlavourTagInputsExtractor( _JointProb, _ParameterSignificance, _TrackAttach, _VertexMass, _SecVertexProb );
+
+	try
+	{
+		for( std::map<std::string,double>::const_iterator iParameter=parameters.begin(); iParameter!=parameters.end(); ++iParameter )
+			_setParameter( iParameter->first, iParameter->second );
+	}
+	catch( ... )
+	{
+		_deleteAlgorithms();
+		throw;
+	}
+
+	_InputMap.resolve( inputNames() );
+}
+
+FlavourTagChain::~FlavourTagChain()
+{
+	_deleteAlgorithms();
+}
+
+void FlavourTagChain::_deleteAlgorithms()
+{
+	delete _InputsExtractor;
+	delete _SecVertexProb;
+	delete _VertexMass;
+	delete _TrackAttach;
+	delete _ParameterSignificance;
+	delete _JointProb;
+	delete _TwoTrackPid;
+	delete _ZVRES;
+}
+
+void FlavourTagChain::_setParameter( const std::string& name, double value )
+{
+	std::string::size_type dot=name.find( '.' );
+	std::string algorithm=name.substr( 0, dot );
+	std::string parameter=( dot==std::string::npos ) ? std::string() : name.substr( dot+1 );
+
+	if( algorithm=="ZVRES" && parameter=="JetWeightingEnergyScaling" ) _JetWeightingEnergyScaling=value;
+	else if( algorithm=="ZVRES" ) _ZVRES->setDoubleParameter( parameter, value );
+	else if( algorithm=="TwoTrackPid" ) _TwoTrackPid->setDoubleParameter( parameter, value );
+	else if( algorithm=="JointProb" ) _JointProb->setDoubleParameter( parameter, value );
+	else if( algorithm=="ParameterSignificance" ) _ParameterSignificance->setDoubleParameter( parameter, value );
+	else if( algorithm=="TrackAttach" ) _TrackAttach->setDoubleParameter( parameter, value );
+	else if( algorithm=="VertexMass" ) _VertexMass->setDoubleParameter( parameter, value );
+	else if( algorithm=="SecVertexProb" ) _SecVertexProb->setDoubleParameter( parameter, value );
+	else throw std::invalid_argument( "FlavourTagChain: unknown algorithm parameter " + name );
+}
+
+const std::vector<std::string>& FlavourTagChain::inputNames()
+{
+	static const char* const names[]={ "JointProbRPhi", "JointProbZ", "D0Significance1", "D0Significance2",
+		"Z0Significance1", "Z0Significance2", "Momentum1", "Momentum2", "NumTracksInVertices", "DecayLength",
+		"DecayLengthSignificance", "RawMomentum", "PTCorrectedMass", "SecondaryVertexProbability", "NumVertices",
+		"DecayLength(SeedToIP)" };
+	static const std::vector<std::string> inputNames( names, names+sizeof(names)/sizeof(names[0]) );
+	return inputNames;
+}
+
+void FlavourTagChain::process( FlavourTagEvent* item )
+{
+	const std::vector<Jet*>& ZVRESJets=item->zvresEvent->jets();
+	const std::vector<Jet*>& Jets=item->inputsEvent->jets();
+	const int numberOfJets=Jets.size();
+	const int numberOfInputs=FlavourTagNetInputs::NumberOfInputs;
+	item->jets.resize( numberOfJets );
+	std::vector<int> vertexCategory( numberOfJets );
+	std::vector<double> jetEnergies( numberOfJets );
+	std::vector<double> netInputs( numberOfJets*numberOfInputs );
+
+	for( int a=0; a<numberOfJets; ++a )
+	{
+		Jet* MyJet=Jets[a];
+		_ZVRES->setDoubleParameter( "Kalpha", _JetWeightingEnergyScaling*ZVRESJets[a]->energy() );
+		DecayChain* ZVTOPResult=_ZVRES->calculateFor( ZVRESJets[a] );
+		ZVTOPResult=decayChainOfJet( ZVTOPResult, MyJet );
+
+		std::map<PidCutType,std::vector<vertex_lcfi::Track*> > PIDCutTracks=_TwoTrackPid->calculateFor( MyJet );
+		std::vector<float>& Inputs=item->jets[a].inputs;
+		Inputs.clear();
+		_InputsExtractor->calculateFor( MyJet, ZVTOPResult, PIDCutTracks, Inputs );
+
+		//As FlavourTagProcessor
+		jetEnergies[a]=( MyJet->energy()==0 ) ? 45.5 : MyJet->energy();
+		vertexCategory[a]=_InputMap.gather( &Inputs[0], &netInputs[a*numberOfInputs] );
+	}
+
+	if( numberOfJets==0 ) return;
+	FlavourTagNetInputs::normalise( numberOfJets, &vertexCategory[0], &jetEnergies[0], &netInputs[0] );
+	std::vector<double> tags( numberOfJets*3 );
+	FlavourTagNetInputs::tag( _Nets, numberOfJets, &vertexCategory[0], &netInputs[0], &tags[0] );
+	for( int a=0; a<numberOfJets; ++a )
+		for( int net=0; net<3; ++net ) item->jets[a].tags[net]=tags[a*3+net];
+}
+
+FlavourTagWorker::FlavourTagWorker( const std::map<std::string,double>& parameters, const std::map<std::string,const nnet::CompiledNeuralNet*>& nets )
+	: _Chain( parameters, nets )
+{
+}
+
+void FlavourTagWorker::process( PipelineItem* item )
+{
+	FlavourTagEvent* Event=static_cast<FlavourTagEvent*>( item );
+	Event->memory.makeCurrent();
+	try
+	{
+		_Chain.process( Event );
+	}
+	catch( ... )
+	{
+		EventMemoryScope::release();
+		throw;
+	}
+	EventMemoryScope::release();
+}
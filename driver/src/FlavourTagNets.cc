@@ -0,0 +1,63 @@
+#include "../include/FlavourTagNets.h"
+
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+	const char* const NetNames[FlavourTagNets::NumberOfNets]={ "b_net-1vtx", "c_net-1vtx", "bc_net-1vtx", "b_net-2vtx", "c_net-2vtx",
+		"bc_net-2vtx", "b_net-3vtx", "c_net-3vtx", "bc_net-3vtx" };
+}
+
+FlavourTagNets::FlavourTagNets( const std::map<std::string,std::string>& fileNames, int precision, bool fold )
+{
+	nnet::CompiledNeuralNet::Precision netPrecision=nnet::CompiledNeuralNet::DoublePrecision;
+	if( precision==1 ) netPrecision=nnet::CompiledNeuralNet::SinglePrecision;
+	else if( precision==2 ) netPrecision=nnet::CompiledNeuralNet::QuantisedInt8;
+
+	try
+	{
+		for( int i=0; i<NumberOfNets; ++i )
+		{
+			const std::string name( NetNames[i] );
+			std::map<std::string,std::string>::const_iterator iFile=fileNames.find( name );
+			if( iFile==fileNames.end() ) throw std::runtime_error( "FlavourTagNets: No file given for the " + name + " neural net" );
+
+			const FlavourTagNetRegistry::Net* pNet;
+			try
+			{
+				pNet=FlavourTagNetRegistry::instance().acquire( iFile->second, netPrecision, fold );
+			}
+			catch( std::runtime_error& error )
+			{
+				throw std::runtime_error( std::string( error.what() ) + " for the " + name + " neural net" );
+			}
+			_Nets.push_back( pNet );
+			_CompiledNets[name]=pNet->compiledNet;
+			if( fold && !pNet->folded )
+				std::cout << "FlavourTagNets: The input normalisation of the " << name << " network can't be folded into its weights, it will be done explicitly." << std::endl;
+		}
+	}
+	catch( ... )
+	{
+		_releaseNets();
+		throw;
+	}
+}
+
+FlavourTagNets::~FlavourTagNets()
+{
+	_releaseNets();
+}
+
+const char* const* FlavourTagNets::netNames()
+{
+	return NetNames;
+}
+
+void FlavourTagNets::_releaseNets()
+{
+	for( std::vector<const FlavourTagNetRegistry::Net*>::iterator iNet=_Nets.begin(); iNet!=_Nets.end(); ++iNet ) FlavourTagNetRegistry::instance().release( *iNet );
+	_Nets.clear();
+	_CompiledNets.clear();
+}
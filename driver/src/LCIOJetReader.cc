@@ -0,0 +1,126 @@
+#include "../include/LCIOJetReader.h"
+
+#include <cmath>
+#include <stdexcept>
+
+#include "lcio.h"
+#include "IO/LCReader.h"
+#include "IOIMPL/LCFactory.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/ReconstructedParticle.h"
+#include "EVENT/Vertex.h"
+
+#include <inc/lciointerface.h>
+#include <util/inc/memorymanager.h>
+#include <util/inc/vector3.h>
+#include <util/inc/matrix.h>
+
+#include "../include/FlavourTagChain.h"
+
+LCIOJetReader::LCIOJetReader( const std::vector<std::string>& fileNames, const std::string& jetCollectionName, long maxEvents )
+	: _Reader(0), _JetCollectionName(jetCollectionName), _MaxEvents(maxEvents), _NumberRead(0)
+{
+	//The default IP of ZVTOPZVRESProcessor: the origin with a 5 micron error in x and y and 20 in z
+	std::vector<double> Position( 3, 0.0 );
+	std::vector<double> Error( 6, 0.0 );
+	Error[0]=std::pow( 5.0/1000.0, 2.0 );
+	Error[2]=std::pow( 5.0/1000.0, 2.0 );
+	Error[5]=std::pow( 20.0/1000.0, 2.0 );
+	useManualIP( ZVRESStep, Position, Error );
+
+	//FlavourTagInputsProcessor always takes its IP from a vertex collection
+	useIPVertexCollection( FlavourTagInputsStep, "IPVertex" );
+
+	_Reader=lcio::LCFactory::getInstance()->createLCReader();
+	_Reader->open( fileNames );
+}
+
+LCIOJetReader::~LCIOJetReader()
+{
+	_Reader->close();
+	delete _Reader;
+}
+
+void LCIOJetReader::useManualIP( Step step, const std::vector<double>& position, const std::vector<double>& error )
+{
+	if( position.size()!=3 || error.size()!=6 ) throw std::invalid_argument( "LCIOJetReader: the IP needs 3 position and 6 error matrix values" );
+	_IP[step].position=position;
+	_IP[step].error=error;
+	_IP[step].vertexCollectionName.clear();
+}
+
+void LCIOJetReader::useIPVertexCollection( Step step, const std::string& collectionName )
+{
+	_IP[step].vertexCollectionName=collectionName;
+}
+
+void LCIOJetReader::_findIP( lcio::LCEvent* LCIOEvent, const IP& ip, std::vector<double>& position, std::vector<double>& error ) const
+{
+	position=ip.position;
+	error=ip.error;
+	if( ip.vertexCollectionName.empty() ) return;
+
+	position.assign( 3, 0.0 );
+	error.assign( 6, 0.0 );
+	lcio::LCCollection* VertexCol=LCIOEvent->getCollection( ip.vertexCollectionName );
+	for( int i=0; i<VertexCol->getNumberOfElements(); ++i )
+	{
+		lcio::Vertex* iVertex=dynamic_cast<lcio::Vertex*>( VertexCol->getElementAt(i) );
+		if( !iVertex->isPrimary() ) continue;
+		for( int j=0; j<3; ++j ) position[j]=iVertex->getPosition()[j];
+		for( int j=0; j<6; ++j ) error[j]=iVertex->getCovMatrix()[j];
+		return;
+	}
+	throw std::runtime_error( "LCIOJetReader: no primary vertex in " + ip.vertexCollectionName );
+}
+
+PipelineItem* LCIOJetReader::read()
+{
+	if( _MaxEvents>=0 && _NumberRead>=_MaxEvents ) return 0;
+	lcio::LCEvent* LCIOEvent=_Reader->readNextEvent();
+	if( !LCIOEvent ) return 0;
+	++_NumberRead;
+
+	std::vector<double> Position[NumberOfSteps];
+	std::vector<double> Error[NumberOfSteps];
+	for( int step=0; step<NumberOfSteps; ++step ) _findIP( LCIOEvent, _IP[step], Position[step], Error[step] );
+
+	FlavourTagEvent* Item=new FlavourTagEvent( LCIOEvent->getRunNumber(), LCIOEvent->getEventNumber() );
+	Item->memory.makeCurrent();
+	try
+	{
+		lcio::LCCollection* JetCollection=LCIOEvent->getCollection( _JetCollectionName );
+		vertex_lcfi::Event* EventOfStep[NumberOfSteps];
+		for( int step=0; step<NumberOfSteps; ++step )
+		{
+			//A step with the same IP as an earlier one shares its event
+			EventOfStep[step]=0;
+			for( int earlier=0; earlier<step && !EventOfStep[step]; ++earlier )
+				if( Position[earlier]==Position[step] && Error[earlier]==Error[step] ) EventOfStep[step]=EventOfStep[earlier];
+			if( EventOfStep[step] ) continue;
+
+			Vector3 IPPos( Position[step][0], Position[step][1], Position[step][2] );
+			SymMatrix3x3 IPErr;
+			IPErr(0,0)=Error[step][0];
+			IPErr(1,0)=Error[step][1];
+			IPErr(1,1)=Error[step][2];
+			IPErr(2,0)=Error[step][3];
+			IPErr(2,1)=Error[step][4];
+			IPErr(2,2)=Error[step][5];
+			EventOfStep[step]=new vertex_lcfi::Event( IPPos, IPErr );
+			MemoryManager<vertex_lcfi::Event>::Event()->registerObject( EventOfStep[step] );
+			for( int i=0; i<JetCollection->getNumberOfElements(); ++i )
+				jetFromLCIORP( EventOfStep[step], dynamic_cast<lcio::ReconstructedParticle*>( JetCollection->getElementAt(i) ) );
+		}
+		Item->zvresEvent=EventOfStep[ZVRESStep];
+		Item->inputsEvent=EventOfStep[FlavourTagInputsStep];
+	}
+	catch( ... )
+	{
+		EventMemoryScope::release();
+		delete Item;
+		throw;
+	}
+	EventMemoryScope::release();
+	return Item;
+}
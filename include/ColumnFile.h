@@ -0,0 +1,114 @@
+#ifndef ColumnFile_h
+#define ColumnFile_h
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+/** The binary container shared by the column file formats (FlavourTagInputsColumns, ZVTOPResultColumns).
+*
+* A file is, in 4 byte words in the byte order of the machine that wrote it:
+* - 8 characters naming the format, the format version, byte order mark 0x01020304
+* - the header of the format, normally its columns (see ColumnFileWriter::writeColumn)
+* - chunks, each a fixed number of header words set by the format, the chunk size in bytes after the
+*   chunk header, then blocks, each its size in bytes followed by the block padded to 4 bytes
+*
+* The formats only decide what goes in their header, in the chunk headers and in the blocks.
+*/
+class ColumnFile
+{
+public:
+	enum { MagicSize=8, ByteOrderMark=0x01020304 };
+
+	/** size rounded up to a whole number of 4 byte words. */
+	static unsigned int padded( unsigned int size ) { return ( size+3 )&~3u; }
+};
+
+/** Writes the container of a column file (see ColumnFile). */
+class ColumnFileWriter
+{
+public:
+	/** Writes the magic, version and byte order mark. owner starts the error messages. Throws
+	* std::runtime_error if the file can't be opened or ints and floats are not 4 bytes.
+	*/
+	ColumnFileWriter( const std::string& fileName, const char* magic, unsigned int version, const std::string& owner );
+
+	/** A word of the format header. */
+	void writeWord( unsigned int word );
+	/** A column of the format header: its type, the length of its name and the name. */
+	void writeColumn( unsigned int type, const std::string& name );
+	/** A chunk: the header words, the size of the rest of the chunk, then the blocks. */
+	void writeChunk( const std::vector<unsigned int>& header, const std::vector<const std::vector<char>*>& blocks );
+
+	bool isOpen() const { return _File.is_open(); }
+	/** Closes the file. Throws std::runtime_error if anything failed to be written. */
+	void close();
+
+private:
+	void _writeBlock( const char* data, unsigned int size );
+
+	std::ofstream _File;
+	std::string _Owner;
+
+	ColumnFileWriter( const ColumnFileWriter& ); //Declared but not defined
+	ColumnFileWriter& operator=( const ColumnFileWriter& ); //Declared but not defined
+};
+
+/** Reads the container of a column file (see ColumnFile).
+*
+* The file is memory mapped where possible (and otherwise read chunk by chunk), so the blocks of a
+* chunk point straight into the file. The format header is read word by word after the constructor,
+* then indexChunks finds all the chunks.
+*/
+class ColumnFileReader
+{
+public:
+	/** Checks the magic, version and byte order mark. owner starts the error messages, and description says
+	* what the file should be (e.g. "a ZVTOP result column file"). Throws std::runtime_error if they don't match.
+	*/
+	ColumnFileReader( const std::string& fileName, const char* magic, unsigned int version, const std::string& owner, const std::string& description );
+	~ColumnFileReader();
+
+	/** The next word of the format header. */
+	unsigned int readWord();
+	/** The next column of the format header, as written by ColumnFileWriter::writeColumn. */
+	void readColumn( unsigned int& type, std::string& name );
+
+	/** Finds the chunks after the format header, each with headerWords words before its size. */
+	void indexChunks( int headerWords );
+	int numberOfChunks() const { return _Chunks.size(); }
+	/** A word of the header of a chunk. */
+	unsigned int chunkWord( int chunk, int word ) const { return _Chunks[chunk].header[word]; }
+
+	/** The blocks of chunk and their sizes in bytes. The pointers are valid until the next call. */
+	void readChunk( int chunk, std::vector<const char*>& blocks, std::vector<unsigned int>& blockSizes );
+
+	/** Throws std::runtime_error saying the file has the problem, e.g. "has a corrupt chunk". */
+	void fail( const std::string& problem ) const;
+	const std::string& fileName() const { return _FileName; }
+
+private:
+	struct Chunk
+	{
+		long offset;	//Of the first block, from the start of the file
+		unsigned int size;
+		std::vector<unsigned int> header;
+	};
+
+	void _read( long offset, unsigned int size, char* destination );
+	unsigned int _readWord( long offset );
+
+	std::string _FileName;
+	std::string _Owner;
+	std::ifstream _File;	//Only used if the file could not be mapped
+	const char* _Map;
+	long _FileSize;
+	long _Offset;	//Of the next word of the format header
+	std::vector<Chunk> _Chunks;
+	std::vector<char> _ChunkBuffer;
+
+	ColumnFileReader( const ColumnFileReader& ); //Declared but not defined
+	ColumnFileReader& operator=( const ColumnFileReader& ); //Declared but not defined
+};
+
+#endif //ifndef ColumnFile_h
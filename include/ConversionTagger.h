@@ -1,46 +1,80 @@
 #ifndef ConversionTagger_h
 #define ConversionTagger_h 1
 
-#include "HistMap.h"
-
 #include "marlin/Processor.h"
 #include "lcio.h"
 #include <string>
+#include <vector>
+#include <utility>
 
 #include <EVENT/ReconstructedParticle.h>
 #include <EVENT/Track.h>
 
+#include <HelixClass.h>
+
+#ifdef MARLIN_USE_AIDA
+#include <AIDA/IHistogram1D.h>
+#endif
 
 using namespace lcio;
 using namespace marlin;
 using namespace std;
 
 
+/** Tags photon conversions and K0/Lambda decays in every track and ReconstructedParticle collection of the event.
+ *
+ * For each collection the pairs of opposite charge, single track particles whose helices meet (in r-phi
+ * within 1mm, then in z within 1mm) and whose invariant mass is close to 0, the K0 or the Lambda mass are
+ * stored as collection+"Conv", and the particles not used in any pair as "V0Veto"+collection.<br>
+ * The helix of each track is made once per collection, and the helix centres and radii are kept in
+ * a table. Pairs are only tested if their r-phi circles come within the distance cut of each other,
+ * which is found by sorting the circles of each charge by their extent in x and sweeping across them,
+ * so that only pairs whose bounding boxes overlap are looked at.
+ *
+ * @param FillHistograms Set true to fill the diagnostic histograms (needs Marlin to be compiled with AIDA).
+ */
 class ConversionTagger : public Processor {
-  
+
  public:
-  
+
   virtual Processor*  newProcessor() { return new ConversionTagger ; }
   ConversionTagger() ;
   virtual void init() ;
-  virtual void processEvent( LCEvent * evt ) ; 
+  virtual void processEvent( LCEvent * evt ) ;
   virtual void end() ;
-  
-  
+
+
  private:
 
+  /** The single track, charged particles of one collection and their helices. */
+  struct HelixTable {
+    vector<int> index; ///< position of the particle in the collection
+    vector<HelixClass> helix;
+    vector<double> xc; ///< helix centre
+    vector<double> yc;
+    vector<double> radius;
+    vector<int> positive; ///< rows of positively charged particles
+    vector<int> negative; ///< rows of negatively charged particles
+  };
+
+  /** The diagnostic histograms, filled through fillHistogram if FillHistograms is set. */
+  enum Histogram { HelixDist, DistRPhi, DistZ, Radius, ConvMass, K0Mass, LambdaMass, NumberOfHistograms };
+
   void tagger( LCEvent *evt, const string collectionName);
+  void buildHelixTable( const vector<ReconstructedParticle*>& particles, HelixTable& table );
+  void findCandidatePairs( const HelixTable& table, vector< pair<int,int> >& pairs );
   ReconstructedParticle* CreateRecoPart(Track* trk);
   double diParticleMass(float* mom1, float* mom2,
 			double mass1, double mass2);
+  void fillHistogram( Histogram histogram, double value );
 
-  HistMap* histos;
+  bool _FillHistograms;
+#ifdef MARLIN_USE_AIDA
+  AIDA::IHistogram1D* _pHistograms[NumberOfHistograms]; ///< created in init() if _FillHistograms is set
+#endif
 
   double _BField;
   double _twopi;
 } ;
 
 #endif
-
-
-
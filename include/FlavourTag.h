@@ -8,9 +8,13 @@
 
 //Neural Net includes
 #include "nnet/inc/NeuralNet.h"
+#include "nnet/inc/CompiledNeuralNet.h"
 #include "nnet/inc/NeuralNetDataSet.h"
 #include "nnet/inc/BackPropagationCGAlgorithm.h"
 
+#include "FlavourTagNetInputs.h"
+#include "FlavourTagNetRegistry.h"
+
 
 
 /** Performs a neural net based flavour tag using data calculated by the LCFI vertex package.
@@ -26,6 +30,10 @@
 * N.B. The code that loads the XML networks is currently a little shaky. <b>If the XML is not properly
 * formed then you may get a segmentation fault or runaway memory allocation leading to Marlin crashing.</b>
 * This is still being looked into.<br>
+* The nets are taken from the FlavourTagNetRegistry, so when several FlavourTag processors in one job
+* use the same files (with the same InferencePrecision and FoldInputNormalisation) each file is only loaded
+* once and all of them share the same read only nets. With LazyNetLoading set the three nets of a vertex
+* category are only loaded when the first jet in that category is tagged.<br>
 * For more information on the tagging variables used as input, have a look at the documentation for 
 * FlavourTagInputsProcessor. The flavour tag result will be in the range 0 to 1; so to
 * select tagged jets apply a cut on this value (e.g. the b-tag value to tag b-jets).  If anything goes
@@ -56,6 +64,19 @@
 * @param Filename-b_net-3plusvtx Filename for the 3 or more vertices b tag network.
 * @param Filename-c_net-3plusvtx Filename for the 3 or more vertices c tag network.
 * @param Filename-bc_net-3plusvtx Filename for the 3 or more vertices c tag (only b background) network.
+* @param InferencePrecision Arithmetic used to evaluate the nets: 0 double (default, identical to the
+* nets as trained), 1 single precision floats, 2 weights quantised to 8 bit integers with one scale per layer.
+* @param PrecisionValidationSample If not blank, a filename prefix for reference samples used to check the
+* reduced precision modes. For each net the file prefix+netname+".txt" (e.g. "ref_b_net-1vtx.txt") is read,
+* if it exists, as a NeuralNetDataSet text file of normalised inputs with target 1 for signal and 0 for
+* background.  The maximum output deviation and the efficiency at PrecisionValidationPurity for single and
+* int8 precision are printed at init.
+* @param PrecisionValidationPurity Purity at which the efficiencies are compared (default 0.8).
+* @param FoldInputNormalisation If true (default false) the input normalisation stored with each net, if it
+* is of the form scale*input+offset, is folded into the weights and biases of the net's first layer. The
+* results then differ from the unfolded evaluation by rounding only.
+* @param LazyNetLoading If true (default false) the files are only checked at init, and each net is loaded
+* the first time a jet needs it. The precision validation, if requested, is then also done at that point.
 *
 * @author Mark Grimes (mark.grimes@bristol.ac.uk)
 */
@@ -79,12 +100,23 @@ protected:
 	int _nRun;
 	int _evt;
 	std::map<std::string,std::string> _filename;//The input filenames for the nets.
-	std::map<std::string,nnet::NeuralNet*> _NeuralNet;//Pointers to the neural nets
+	std::map<std::string,const FlavourTagNetRegistry::Net*> _Net;//The nets loaded so far, shared through the registry
+	std::map<std::string,const nnet::CompiledNeuralNet*> _CompiledNet;//The same nets in the form used for evaluation
+	int _inferencePrecision;
+	std::string _precisionValidationSample;
+	float _precisionValidationPurity;
+	bool _foldInputNormalisation;
+	bool _lazyNetLoading;
+	bool _categoryLoaded[4];//Whether the nets of each vertex category have been acquired
 	//ofstream ofile;
-	//This map holds the position of the Inputs in the LCFloatVec
-	std::map<std::string,unsigned int> _IndexOf;
+	//The positions of the net inputs in the LCFloatVec
+	FlavourTagNetInputs::InputMap _InputMap;
 	
 	void _displayCollectionNames( lcio::LCEvent* pEvent );
+	void _validatePrecision( const std::string& netName );
+	void _acquireNet( const std::string& netName );
+	void _acquireNetsOfCategory( int category );
+	void _releaseNets();
 	
 };
 
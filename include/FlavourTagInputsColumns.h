@@ -0,0 +1,117 @@
+#ifndef FlavourTagInputsColumns_h
+#define FlavourTagInputsColumns_h
+
+#include <string>
+#include <vector>
+
+#include "ColumnFile.h"
+
+/** The file format shared by FlavourTagInputsColumnWriter and FlavourTagInputsColumnReader.
+*
+* The file holds one row per jet in columns of fixed width (4 byte floats or ints). The first six
+* columns are always the run and event numbers, the index of the jet in its event, the jet energy,
+* the cosine of the jet polar angle (NaN if the jet momentum is not set) and the true jet flavour
+* (0 if it is not known). The FlavourTagInputs variables follow, in the order of the run header.<br>
+* The rows are stored in chunks of whole events, each column of a chunk as one block, so a reader
+* only touches the columns it uses. Uncompressed blocks are 4 byte aligned and are used in place when the file is
+* memory mapped. Compressed blocks (only if built with zlib, USEZLIB) have the bytes of the values
+* regrouped by significance before compression, which compresses floats much better.
+*
+* The file is a ColumnFile with the magic "LCFIFTIC":
+* - the format header is the number of columns, then each column (type 'f' or 'i' and name)
+* - the chunk header is the number of rows and flags (1 if compressed), and there is one block per column
+*/
+class FlavourTagInputsColumns
+{
+public:
+	enum { NumberOfJetColumns=6 };
+	enum ColumnType { FloatColumn='f', IntColumn='i' };
+
+	/** The names of the first NumberOfJetColumns columns. */
+	static const char* const* jetColumnNames();
+	static ColumnType jetColumnType( int column );
+
+	enum { Version=1, CompressedFlag=1 };
+};
+
+/** Writes the flavour tag inputs of jets to a column file (see FlavourTagInputsColumns). */
+class FlavourTagInputsColumnWriter
+{
+public:
+	/** variableNames are the names of the FlavourTagInputs variables, in the order they are passed to addJet.
+	* compress is ignored (with a warning) if the package was built without zlib. A chunk is ended at the
+	* first event that starts after rowsPerChunk jets.
+	*/
+	FlavourTagInputsColumnWriter( const std::string& fileName, const std::vector<std::string>& variableNames, bool compress=false, int rowsPerChunk=65536 );
+	/** Writes out any jets not yet written. */
+	~FlavourTagInputsColumnWriter();
+
+	/** Adds a jet. The jets of an event must be added together, starting with jetIndex 0. */
+	void addJet( int runNumber, int eventNumber, int jetIndex, double jetEnergy, double jetCosTheta, int trueJetFlavour,
+		const std::vector<float>& variables );
+
+	/** Writes out any jets not yet written and closes the file. */
+	void close();
+
+	const std::vector<std::string>& variableNames() const { return _VariableNames; }
+	long numberOfJets() const { return _NumberOfJets; }
+
+private:
+	void _writeChunk();
+
+	ColumnFileWriter _File;
+	std::vector<std::string> _VariableNames;
+	bool _Compress;
+	int _RowsPerChunk;
+	int _RowsInChunk;
+	long _NumberOfJets;
+	std::vector<std::vector<char> > _Columns;	//The values of the current chunk, 4 bytes each
+
+	FlavourTagInputsColumnWriter( const FlavourTagInputsColumnWriter& ); //Declared but not defined
+	FlavourTagInputsColumnWriter& operator=( const FlavourTagInputsColumnWriter& ); //Declared but not defined
+};
+
+/** Reads a column file written by FlavourTagInputsColumnWriter, one chunk at a time.
+*
+* The file is memory mapped where possible (see ColumnFileReader), so the column pointers of an
+* uncompressed chunk point straight into the file. The pointers are valid until the next call to readChunk.
+*/
+class FlavourTagInputsColumnReader
+{
+public:
+	FlavourTagInputsColumnReader( const std::string& fileName );
+	~FlavourTagInputsColumnReader();
+
+	const std::vector<std::string>& variableNames() const { return _VariableNames; }
+	/** The position of the variable in variableNames, or -1 if it is not in the file. */
+	int variableIndex( const std::string& name ) const;
+
+	long numberOfJets() const { return _NumberOfJets; }
+	int numberOfChunks() const { return _File.numberOfChunks(); }
+
+	/** Makes chunk the current chunk. @return the number of jets in it */
+	int readChunk( int chunk );
+
+	//The columns of the current chunk
+	const int* runNumber() const { return static_cast<const int*>( _Column[0] ); }
+	const int* eventNumber() const { return static_cast<const int*>( _Column[1] ); }
+	const int* jetIndex() const { return static_cast<const int*>( _Column[2] ); }
+	const float* jetEnergy() const { return static_cast<const float*>( _Column[3] ); }
+	const float* jetCosTheta() const { return static_cast<const float*>( _Column[4] ); }
+	const int* trueJetFlavour() const { return static_cast<const int*>( _Column[5] ); }
+	const float* variable( int index ) const { return static_cast<const float*>( _Column[FlavourTagInputsColumns::NumberOfJetColumns+index] ); }
+
+private:
+	ColumnFileReader _File;
+	std::vector<std::string> _VariableNames;
+	long _NumberOfJets;
+	std::vector<const char*> _Blocks;
+	std::vector<unsigned int> _BlockSizes;
+	std::vector<std::vector<char> > _Decoded;
+	std::vector<const void*> _Column;
+
+	FlavourTagInputsColumnReader( const FlavourTagInputsColumnReader& ); //Declared but not defined
+	FlavourTagInputsColumnReader& operator=( const FlavourTagInputsColumnReader& ); //Declared but not defined
+};
+
+#endif //ifndef FlavourTagInputsColumns_h
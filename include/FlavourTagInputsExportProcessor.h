@@ -0,0 +1,60 @@
+#ifndef FlavourTagInputsExportProcessor_h
+#define FlavourTagInputsExportProcessor_h
+
+#include <string>
+#include <vector>
+
+#include "marlin/Processor.h"
+#include "lcio.h"
+
+class FlavourTagInputsColumnWriter;
+
+/** Writes the flavour tag inputs of every jet to a compact column file.
+ *
+ * The file (see FlavourTagInputsColumns) holds, for each jet, the run and event number, the jet energy
+ * and polar angle, the true jet flavour and all the variables calculated by FlavourTagInputsProcessor,
+ * with the names from the run header. NeuralNetTrainerProcessor (InputsColumnFile parameter) and the
+ * lcfiretag program can then read just these columns instead of the full LCIO events, which is much
+ * faster when retraining or retagging the same sample several times.
+ *
+ * <H4>Input</H4>
+ * - A collection of ReconstructedParticles that represents the jets in the event.
+ * - A LCFloatVec collection that holds the flavour tag inputs (put in by FlavourTagInputsProcessor).
+ * - Optionally a LCIntVec collection that holds the true jet flavours (put in by
+ * TrueAngularJetFlavourProcessor). If the event doesn't have it the flavours are written as 0.
+ *
+ * <H4>Output</H4>
+ * The column file. The LCIO file is not modified at all.
+ *
+ * @param JetCollectionName Name of the ReconstructedParticle collection that represents jets.
+ * @param FlavourTagInputsCollection Name of the LCFloatVec collection that holds the flavour tag inputs.
+ * @param TrueJetFlavourCollection Name of the LCIntVec Collection that contains the true jet flavours.
+ * @param OutputFile Name of the column file to write.
+ * @param Compress If true each column of each chunk is compressed (needs the package to be built with zlib).
+ * @param JetsPerChunk Number of jets in each chunk of the file.
+ */
+class FlavourTagInputsExportProcessor : public marlin::Processor
+{
+public:
+	//The usual Marlin processor methods
+	virtual Processor* newProcessor() { return new FlavourTagInputsExportProcessor; }
+	FlavourTagInputsExportProcessor();
+	virtual ~FlavourTagInputsExportProcessor();
+	virtual void init();
+	virtual void processRunHeader( LCRunHeader* pRun );
+	virtual void processEvent( LCEvent* pEvent );
+	virtual void end();
+protected:
+	std::string _JetCollectionName;
+	std::string _FlavourTagInputsCollectionName;
+	std::string _TrueJetFlavourCollectionName;
+	std::string _outputFileName;
+	bool _compress;
+	int _jetsPerChunk;
+
+	FlavourTagInputsColumnWriter* _writer; ///< @internal Made at the first run header, when the variable names are known
+	int _nRun;
+	int _nEvent;
+};
+
+#endif //ifndef FlavourTagInputsExportProcessor_h
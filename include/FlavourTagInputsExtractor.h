@@ -0,0 +1,55 @@
+#ifndef FlavourTagInputsExtractor_h
+#define FlavourTagInputsExtractor_h
+
+#include <map>
+#include <vector>
+
+#include <inc/algo.h>
+#include <algo/inc/twotrackpid.h>
+
+namespace vertex_lcfi
+{
+	class Jet;
+	class DecayChain;
+	class JointProb;
+	class ParameterSignificance;
+}
+
+/** Calculates all the FlavourTagInputsProcessor variables of a jet together.
+*
+* Separately the algorithms each loop over the tracks or vertices of the jet again, and get the
+* significances, momenta and vertex lists they need for themselves. Here the track variables
+* (the RPhi and Z joint probabilities and the two most significant tracks) come from one loop over
+* the tracks, and the vertex variables (track multiplicity, decay length and significance, number
+* of vertices and seed distance) from one loop over the vertices. The 3D joint probability, which
+* is not an input, is not calculated. The track attachment, vertex mass and secondary vertex
+* probability still come from their algorithms.<br>
+* The parameters are taken from the algorithm objects the processor sets up, so the values are
+* the same as those of the separate algorithms (the processor can check this, see its
+* ValidateFusedInputs parameter).
+*/
+class FlavourTagInputsExtractor
+{
+public:
+	FlavourTagInputsExtractor( const vertex_lcfi::JointProb* JointProbAlgo, const vertex_lcfi::ParameterSignificance* ParameterSignificanceAlgo,
+		vertex_lcfi::Algo<vertex_lcfi::DecayChain*,vertex_lcfi::DecayChain*>* TrackAttachAlgo,
+		vertex_lcfi::Algo<vertex_lcfi::DecayChain*,double>* VertexMassAlgo, vertex_lcfi::Algo<vertex_lcfi::DecayChain*,double>* SecVertexProbAlgo );
+
+	/** Appends the inputs of MyJet, in the order of the FlavourTagInputs run header, to Inputs.
+	* MyDecayChain is the vertexing result for the jet and PIDCutTracks the result of
+	* vertex_lcfi::TwoTrackPid for it.
+	*/
+	void calculateFor( vertex_lcfi::Jet* MyJet, vertex_lcfi::DecayChain* MyDecayChain,
+		const std::map<vertex_lcfi::PidCutType,std::vector<vertex_lcfi::Track*> >& PIDCutTracks, std::vector<float>& Inputs );
+
+private:
+	const vertex_lcfi::JointProb* _JointProb;
+	const vertex_lcfi::ParameterSignificance* _ParameterSignificance;
+	vertex_lcfi::Algo<vertex_lcfi::DecayChain*,vertex_lcfi::DecayChain*>* _TrackAttach;
+	vertex_lcfi::Algo<vertex_lcfi::DecayChain*,double>* _VertexMass;
+	vertex_lcfi::Algo<vertex_lcfi::DecayChain*,double>* _SecVertexProb;
+
+	std::vector<vertex_lcfi::Track*> _ExcludedTracks; //Gamma and Ks tracks of the current jet, sorted
+};
+
+#endif //ifndef FlavourTagInputsExtractor_h
@@ -13,6 +13,8 @@
 #include "algo/inc/paramsignificance.h"
 #include "algo/inc/twotrackpid.h"
 #include "algo/inc/decaysignificance.h"
+#include "algo/inc/jointprob.h"
+#include "FlavourTagInputsExtractor.h"
 
 using namespace lcio ;
 using namespace marlin ;
@@ -88,6 +90,10 @@ using vertex_lcfi::DecaySignificanceType;
  *  @param VertexMassMaxMomentumAngleCut Upper cut on angle between momentum of vertex and the vertex axis, used by  vertex_lcfi::VertexMass
  *  @param VertexMassMaxMomentumCorrection Maximum factor, by which vertex mass can be corrected, used by  vertex_lcfi::VertexMass
  *
+ *  The variables are calculated together by FlavourTagInputsExtractor, which loops over the tracks and vertices of each jet
+ *  once rather than once per algorithm. The separate algorithms remain as the reference:
+ *  @param ValidateFusedInputs Also calculate every variable with the separate algorithms and report any that differ (slow, for checking only)
+ *
  *  As a final remark one should notice that two additional values are stored in the Output LC Collection. 
  *  These are: 
  *  <br> NumVertices - number of vertices in the jet; used to determine what variables to use in the following flavour tag processor. Calculated in the processor.
@@ -123,9 +129,12 @@ class FlavourTagInputsProcessor : public Processor {
   vertex_lcfi::Algo<DecayChain*,DecayChain* >* _BAttach;
   vertex_lcfi::Algo<DecayChain*,DecayChain* >* _CAttach;
   vertex_lcfi::Algo<DecayChain*,double >* _SecVertexProb;
-  vertex_lcfi::Algo<Jet*,std::map<SignificanceType, double> >* _ParameterSignificance;
-  vertex_lcfi::Algo<Jet*,std::map<Projection, double> >* _JointProb;
-  vertex_lcfi::Algo<Jet*,std::map<PidCutType,std::vector< vertex_lcfi::Track* > > >* _TwoTrackPID; 
+  vertex_lcfi::ParameterSignificance* _ParameterSignificance;
+  vertex_lcfi::JointProb* _JointProb;
+  vertex_lcfi::TwoTrackPid* _TwoTrackPID; 
+  FlavourTagInputsExtractor* _InputsExtractor;
+  bool _ValidateFusedInputs;
+  int _nValidationDifferences;
   double _VertexMassMaxMomentumAngle;					     
   double _VertexMassMaxKinematicCorrectionSigma;			     
   double _VertexMassMaxMomentumCorrection;			    
@@ -150,6 +159,8 @@ class FlavourTagInputsProcessor : public Processor {
   FloatVec _JProbResolutionParameterZ;
   int _nRun ;
   int _nEvt ;
+
+  void _referenceInputs( Jet* MyJet, DecayChain* MyDecayChain, std::map<PidCutType, std::vector<vertex_lcfi::Track*> >* PIDCutTracks, std::vector<float>& Inputs );
 } ;
 
 #endif
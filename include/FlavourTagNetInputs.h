@@ -0,0 +1,92 @@
+#ifndef FlavourTagNetInputs_h
+#define FlavourTagNetInputs_h
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace nnet
+{
+	class CompiledNeuralNet;
+}
+
+/** Turns the flavour tag variables of a block of jets into the inputs of the tagging neural nets.
+*
+* All nine nets have eight inputs. The 1 vertex nets use one set of variables, the 2 vertex and 3 or
+* more vertex nets another. Most of the variables are compressed with tanh(value/norm), where the
+* norm can depend on the jet energy; the probabilities are used as they are.<br>
+* The normalisation is done as one stage over all the jets of an event, once per jet whichever of
+* the three nets of its vertex category are evaluated afterwards. Any further (affine) normalisation
+* stored with the nets can then be folded into their first layer (see
+* nnet::CompiledNeuralNet::setFoldedNormalisation), so nothing else is done per net.
+*/
+class FlavourTagNetInputs
+{
+public:
+	enum { NumberOfInputs=8 };
+
+	/** Where the net inputs are in the FlavourTagInputs variables of a jet.
+	*
+	* The positions are looked up by name once (per run header or input file), giving a fixed table
+	* of NumberOfInputs positions for each vertex category. Filling the inputs of a jet is then a plain
+	* gather, with no string lookups, and the trainer and the tagger both use the same table.
+	*/
+	class InputMap
+	{
+	public:
+		InputMap();
+
+		/** Looks up the positions of the variables the nets need in variableNames, which is in the order of
+		* the FlavourTagInputs run header. Returns the names of any that are missing; their positions are left
+		* at 0 so the map can still be used, but the inputs will be wrong.
+		*/
+		std::vector<std::string> resolve( const std::vector<std::string>& variableNames );
+
+		/** The position of the NumVertices variable. */
+		int numVerticesIndex() const { return _numVerticesIndex; }
+
+		/** The position of input i of the nets of the given vertex category (0 to 3). */
+		int index( int vertexCategory, int i ) const { return _index[vertexCategory][i]; }
+
+		/** Works out the vertex category of a jet from its FlavourTagInputs variables, and copies the
+		* NumberOfInputs raw values the nets of that category use to inputs. Returns the vertex category.
+		*/
+		int gather( const float* variables, double* inputs ) const
+		{
+			const int category=vertexCategory( variables[_numVerticesIndex] );
+			const int* index=_index[category];
+			for( int i=0; i<NumberOfInputs; ++i ) inputs[i]=variables[index[i]];
+			return category;
+		}
+
+	private:
+		int _numVerticesIndex;
+		int _index[4][NumberOfInputs];
+	};
+
+	/** The names of the variables (as given in the FlavourTagInputs run header) that make up the
+	* net inputs, in input order, for jets with the given number of vertices (or vertex category).
+	*/
+	static const char* const* variableNames( int numberOfVertices );
+
+	/** Normalises the raw variables of numberOfJets jets in place. values holds NumberOfInputs
+	* values per jet, in the order given by variableNames for that jet's number of vertices.
+	*/
+	static void normalise( int numberOfJets, const int* numberOfVertices, const double* jetEnergy, double* values );
+
+	/** The vertex category of a jet from its NumVertices variable: 1, 2 or 3 (for 3 or more vertices),
+	* or 0 if there is no net for it.
+	*/
+	static int vertexCategory( double numberOfVertices );
+
+	/** Runs the b, c and bc nets of each jet's vertex category over the normalised inputs of numberOfJets
+	* jets, writing three tag values per jet to tags (-1 for jets in category 0). Each net is evaluated
+	* once over all the jets of its category. nets holds the nets by name, e.g. "b_net-1vtx",
+	* "c_net-2vtx" and "bc_net-3vtx"; only those of the categories the jets are in are needed, and
+	* std::runtime_error is thrown if one of those is missing.
+	*/
+	static void tag( const std::map<std::string,const nnet::CompiledNeuralNet*>& nets, int numberOfJets, const int* vertexCategory,
+		const double* values, double* tags );
+};
+
+#endif //ifndef FlavourTagNetInputs_h
@@ -0,0 +1,96 @@
+#ifndef FlavourTagNetRegistry_h
+#define FlavourTagNetRegistry_h
+
+#include <map>
+#include <string>
+
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#include "nnet/inc/CompiledNeuralNet.h"
+
+namespace nnet
+{
+	class NeuralNet;
+}
+
+/** The neural nets loaded from files, shared by everything in the process that tags with them.
+*
+* Several FlavourTag processors in one steering file (one per jet finding, say) normally use the same
+* nine net files. Each file is read and parsed once, and every processor gets a pointer to the same
+* read only copy. A net is identified by its file (the canonical path, so "./a.xml" and "a.xml" are the
+* same) and a hash of the file contents, so a file that has been rewritten in between is loaded again,
+* and by the evaluation precision and folding the compiled net was made with.<br>
+* The nets are never changed once they are in the registry, and CompiledNeuralNet::batchOutput is const,
+* so any number of threads can evaluate them at once. acquire and release can also be called from any
+* thread. A file is parsed without holding the registry lock, so different nets can be loaded at the same
+* time; if two threads load the same net at once the second copy is thrown away. The file is read again
+* after it is parsed, and parsed again if it changed, so a net is never filed under contents it wasn't
+* parsed from.<br>
+* Nets are reference counted, and deleted when the last user releases them.
+*/
+class FlavourTagNetRegistry
+{
+public:
+	/** A net as read from its file and the compiled form used to evaluate it. */
+	struct Net
+	{
+		std::string fileName;	///< canonical path of the file
+		const nnet::NeuralNet* neuralNet;
+		const nnet::CompiledNeuralNet* compiledNet;
+		bool folded;	///< whether the input normalisation is folded into the weights (it can't always be)
+	};
+
+	/** The registry of the process. */
+	static FlavourTagNetRegistry& instance();
+
+	/** The net in fileName, compiled with precision and, if fold is set, the input normalisation folded in
+	* where possible. The file is read as XML if it starts like one and as plain text otherwise. Each call must
+	* be matched by a call to release. Throws std::runtime_error if the file can't be opened, or if it is still
+	* changing after MaximumLoadAttempts parses.
+	*/
+	const Net* acquire( const std::string& fileName, nnet::CompiledNeuralNet::Precision precision, bool fold );
+
+	/** Gives back a net from acquire. It is deleted if nothing else is using it. */
+	void release( const Net* pNet );
+
+	/** The number of different nets currently loaded. */
+	int numberOfNets() const;
+
+	~FlavourTagNetRegistry();
+
+private:
+	enum { MaximumLoadAttempts=3 };
+
+	struct Key
+	{
+		std::string fileName;
+		unsigned int contentHash;
+		unsigned long contentSize;
+		int precision;
+		bool fold;
+		bool operator<( const Key& other ) const;
+	};
+	struct Entry
+	{
+		Net* pNet;
+		int users;
+	};
+
+	FlavourTagNetRegistry();
+	static Net* _load( const std::string& fileName, const std::string& firstWord, nnet::CompiledNeuralNet::Precision precision, bool fold );
+	static void _delete( Net* pNet );
+	void _lock() const;
+	void _unlock() const;
+
+	std::map<Key,Entry> _Nets;
+#ifndef _WIN32
+	mutable pthread_mutex_t _Mutex;
+#endif
+
+	FlavourTagNetRegistry( const FlavourTagNetRegistry& ); //Declared but not defined
+	FlavourTagNetRegistry& operator=( const FlavourTagNetRegistry& ); //Declared but not defined
+};
+
+#endif //ifndef FlavourTagNetRegistry_h
@@ -0,0 +1,103 @@
+#ifndef FlavourTagPlotData_h
+#define FlavourTagPlotData_h
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "../vertex_lcfi/util/inc/util.h"
+
+/** The additive state behind the flavour tag performance plots, so that the results of many jobs can be combined.
+*
+* For each tag collection, vertex category (0 if not known, 1, 2, or 3 for 3 or more vertices), jet angle
+* bin (in |cos(theta)|) and true flavour (b, c or light) it holds the b, c and bc tag values binned between
+* 0 and 1, with tag values outside that range (for example the -1 of untagged jets) in the underflow and
+* overflow. For each jet angle bin it also holds the vertex charge counts of tagged b and c jets, by true
+* hadron charge and by the sign of the vertex charge.<br>
+* Everything is a count, so adding up (see merge) the partial results of any number of jobs gives exactly
+* what one job over all their events would have given. PlotProcessor and LCFIAIDAPlotProcessor write
+* their partial results with write (see their PartialResultsFile parameters), and lcfimergeplots adds up
+* any number of these files and writes the final curves (see writeCurves).
+*/
+class FlavourTagPlotData
+{
+public:
+	enum Flavour { BJet, CJet, LightJet, NumberOfFlavours };
+	enum Tag { BTag, CTag, BCTag, NumberOfTags };
+	enum ChargeSign { NegativeCharge, NeutralCharge, PositiveCharge, NumberOfChargeSigns };
+	enum { NumberOfVertexCategories=4 };
+	enum { MinimumTrueCharge=-2, MaximumTrueCharge=2, NumberOfTrueCharges=5 };
+
+	/** An empty set of results, to be read or merged into. */
+	FlavourTagPlotData();
+
+	/** Empty results for the given tag collections, with numberOfTagBins bins for the tag values and
+	* numberOfAngleBins bins in |cos(theta)| of the jet.
+	*/
+	FlavourTagPlotData( const std::vector<std::string>& tagCollectionNames, int numberOfTagBins=100, int numberOfAngleBins=10 );
+
+	const std::vector<std::string>& tagCollectionNames() const { return _TagCollectionNames; }
+	int numberOfTagBins() const { return _NumberOfTagBins; }
+	int numberOfAngleBins() const { return _NumberOfAngleBins; }
+
+	/** The jet angle bin for cos(theta) of the jet. |cos(theta)|>=1 goes in the last bin. */
+	int angleBin( double cosTheta ) const;
+
+	/** Adds the tag values of one jet from tag collection number tagCollection. */
+	void addJet( int tagCollection, int vertexCategory, double cosTheta, Flavour flavour, double bTag, double cTag, double bcTag );
+
+	/** Adds the vertex charge of a tagged b or c jet (flavour BJet or CJet) with the given true hadron charge.
+	* Jets with true charges outside -2 to +2 are ignored.
+	*/
+	void addVertexCharge( Flavour flavour, double cosTheta, int trueCharge, int vertexCharge );
+
+	/** Adds other to these results. Throws std::runtime_error if they have different tag collections or binning. */
+	void merge( const FlavourTagPlotData& other );
+
+	/** Writes the results as text. */
+	void write( std::ostream& output ) const;
+
+	/** Writes the results to a file, first to fileName.tmp and then renamed. Throws std::runtime_error on failure. */
+	void write( const std::string& fileName ) const;
+
+	/** Reads results written by write, replacing these. Returns false if the input is not in the right format. */
+	bool read( std::istream& input );
+
+	/** Reads results from a file. Throws std::runtime_error if it can't be opened or read. */
+	void read( const std::string& fileName );
+
+	/** The tag values for the given collection and flavour, summed over all vertex categories if vertexCategory
+	* is -1 and over all jet angle bins if angleBin is -1.
+	*/
+	vertex_lcfi::util::binned_histogram_data<double> tagValues( int tagCollection, int vertexCategory, int angleBin, Flavour flavour, Tag tag ) const;
+
+	/** The number of tagged jets of the flavour (BJet or CJet) in the angle bin with the true hadron charge and
+	* vertex charge sign.
+	*/
+	double vertexChargeCount( Flavour flavour, int angleBin, int trueCharge, ChargeSign sign ) const;
+
+	/** The fraction of tagged jets of the flavour (BJet or CJet) with a charged true hadron in the angle bin
+	* whose vertex charge does not have the right sign, and its binomial error. Both are 0 if there are no such jets.
+	*/
+	double vertexChargeLeakage( Flavour flavour, int angleBin, double& error ) const;
+
+	/** Writes the final curves as comma separated values. For each tag collection and for the vertex categories
+	* "AnyNumberOfVertices", "OneVertex", "TwoVertices" and "ThreeOrMoreVertices" there is one file,
+	* fileNameBase-collection-category.csv, giving for each cut on the tag values (the low edges of the tag
+	* bins) the efficiency, purity and leakage rates of each tag. The vertex charge leakage rate for each jet
+	* angle bin goes to fileNameBase-VertexCharge.csv. Throws std::runtime_error if a file can't be written.
+	*/
+	void writeCurves( const std::string& fileNameBase ) const;
+
+private:
+	size_t _index( int tagCollection, int vertexCategory, int angleBin, int flavour, int tag ) const;
+	size_t _chargeIndex( int flavour, int angleBin, int trueCharge, int sign ) const;
+
+	std::vector<std::string> _TagCollectionNames;
+	int _NumberOfTagBins;
+	int _NumberOfAngleBins;
+	std::vector<vertex_lcfi::util::binned_histogram_data<double> > _TagValues;
+	std::vector<double> _VertexChargeCounts; //Only for b and c jets
+};
+
+#endif //ifndef FlavourTagPlotData_h
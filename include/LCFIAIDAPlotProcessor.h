@@ -64,10 +64,13 @@
  *    Only used if PrintNeuralNetOutput parameter is true.  If left blank, output will be directed to standard out
  * @param PrintNeuralNetOutput  Bool set true if you want to make a text file of the neural net values (useful for some scripts).
  * @param UseFlavourTagCollectionForVertexCharge For vertex charge plots we demand the cTag>CTagNNCut and bTag>BTagNNCut.  This integer is used if there is more than one tag collection, to determine which of the collections should be used to apply this cut.
+ * @param PartialResultsFile  String representing name of a file to write the binned tag values and vertex charge counts to (see FlavourTagPlotData),
+ *    so that the results of many jobs can be added up with lcfimergeplots.  If left blank, nothing is written.
  * 
  * <H4>Output</H4>
  * - An aida (or root??) file containing the histograms, plots and tuples.
  * - (Optionally) a text file containing some of the neural net tagging output
+ * - (Optionally) a file of partial results that can be merged with those of other jobs
  *  
  * @author Victoria Martin (victoria.martin@ed.ac.uk)
 */
@@ -84,6 +87,8 @@
 #include <iostream>
 #include <fstream>
 
+#include "FlavourTagPlotData.h"
+
 //AIDA includes...
 #include <AIDA/IHistogram1D.h>
 #include <AIDA/IDataPointSet.h>
@@ -144,6 +149,10 @@ protected:
 	int _iVertexChargeTagCollection;
 	unsigned int _myVertexChargeTagCollection;
 
+	//!optional file for the mergeable partial results, and the results themselves
+	std::string _PartialResultsFile;
+	FlavourTagPlotData _PartialResults;
+
 	std::vector<std::string> _VertexCatNames;
 	std::vector<std::string>  _NumVertexCatDir;
 	std::vector<std::string> _ZoomedVarNames;
@@ -10,6 +10,9 @@
 #include "nnet/inc/NeuralNet.h"
 #include "nnet/inc/NeuralNetDataSet.h"
 #include "nnet/inc/BackPropagationCGAlgorithm.h"
+#include "nnet/inc/NeuralNetThreads.h"
+
+#include "FlavourTagNetInputs.h"
 
 /** Trains neural networks to be used for jet flavour tagging.
  *
@@ -64,6 +67,18 @@
  * @param Filename-b_net-3plusvtx Output filename for the trained 3 or more vertices b-tag net.
  * @param Filename-c_net-3plusvtx Output filename for the trained 3 or more vertices c-tag net.
  * @param Filename-bc_net-3plusvtx Output filename for the trained  3 or more vertices c-tag (with only b background) net.
+ * @param NumberOfTrainingThreads Number of threads the conjugate gradient training uses to evaluate the error function
+ * and its gradient over the data set (default 1, 0 means one per processor). With more than one thread the results
+ * are reproducible for any number of threads, but differ in rounding from the single threaded training.
+ * @param NumberOfConcurrentNets Number of nets trained at the same time at the end of the job, each in its own thread
+ * (default 1, 0 means one per processor). The nets are independent, so this gives the same nets as training them one
+ * after the other. Each net still uses NumberOfTrainingThreads threads of its own.
+ * @param RandomSeed Seed for the random initial weights of the nets (default 0, which takes the seed from the time).
+ * Each net is seeded with the seed plus its position in the list of the nine nets, so a trained net only depends on its
+ * own data set and the seed, and no two nets start from the same weights.
+ * @param InputsColumnFile If set, the jets are read at the end of the run from this column file (written by
+ * FlavourTagInputsExportProcessor) instead of from the LCIO events, which are then not used at all. The same cuts are
+ * applied. Reading the few columns needed is much faster than reading the LCIO events again when retraining.
  *
  * @author Mark Grimes (mark.grimes@bristol.ac.uk)
 */
@@ -87,6 +102,10 @@ protected:
 	std::string _FlavourTagInputsCollectionName;
 	std::string _TrueJetFlavourCollectionName;
 	int _serialiseAsXML;
+	int _numberOfTrainingThreads;
+	int _numberOfConcurrentNets;
+	int _randomSeed;
+	std::string _inputsColumnFile;
 	nnet::NeuralNet::SerialisationMode _outputFormat;
 
 	//These maps all use the same string keys to distinguish between the different nets.
@@ -104,9 +123,7 @@ protected:
 	std::vector<std::string> _listOfSelectedNetNames; /**< @internal A list of the nets that have been selected for training, in the form of the strings
 								used in the map keys above.*/
 
-	//This map holds the position of the Inputs in the LCFloatVec
-	std::map<std::string,unsigned int> _IndexOf; /**< @internal Holds the positions of the inputs, so that, for example, you can get the position of
-							D0Significance1 in the inputs LCFloatVec just with _IndexOf["D0Significance1"]*/
+	FlavourTagNetInputs::InputMap _InputMap; /**< @internal The positions of the net inputs in the inputs LCFloatVec, worked out once per run.*/
 	
 	int _nRun; /**< @internal The run number.*/
 	int _nEvent;/**< @internal The event number.*/
@@ -116,10 +133,32 @@ protected:
 	static const int C_JET=4; /**< @internal Just a useful constant for testing true jet flavour.*/
 	static const int B_JET=5; /**< @internal Ditto.*/
 
+	/** @internal Trains and saves a list of nets, the nets given to each thread one after the other (see nnet::NeuralNetThreads::ParallelFor).*/
+	class TrainingTask : public nnet::NeuralNetParallelTask
+	{
+	public:
+		struct Net
+		{
+			std::string name;
+			nnet::NeuralNet* neuralNet;
+			nnet::NeuralNetDataSet* dataSet;
+			std::string filename;
+			std::string temporaryFilename; ///< The net is written here first and then renamed to filename
+			bool succeeded; ///< Set once the net has been trained and saved
+		};
+		TrainingTask( NeuralNetTrainerProcessor& trainer, std::vector<Net>& nets );
+		void process( const int thread, const int begin, const int end );
+	private:
+		NeuralNetTrainerProcessor& _trainer;
+		std::vector<Net>& _nets;
+	};
+
 	//The following functions are just code that has been split off so that the code doesn't look quite so cluttered.
 	void _displayCollectionNames( lcio::LCEvent* pEvent );/**< @internal Displays all of the available collections in the file.*/
 	void _trainNet( nnet::BackPropagationCGAlgorithm& pBackPropCGAlgo, nnet::NeuralNetDataSet& dataSet );/**< @internal The training code, split off to make the code a bit more manageable*/
 	bool _passesCuts( lcio::LCEvent* pEvent );///< @internal All the code for the cuts should be put in here; returns false if the event fails any of the cuts.
+	void _addJet( const std::vector<float>& Inputs, double jetEnergy, int jetType );///< @internal Normalises the inputs of a jet and adds it to the data sets of the nets it trains.
+	void _addJetsFromColumnFile();///< @internal Adds the jets that pass the cuts from the InputsColumnFile.
 };
 
 #endif //ifndef NeuralNetTrainer_h
@@ -5,14 +5,15 @@
 #include <algorithm>
 
 #include "../vertex_lcfi/util/inc/util.h"
+#include "FlavourTagPlotData.h"
 
 //Marlin and LCIO includes
 #include "marlin/Processor.h"
 #include "lcio.h"
 #include "EVENT/ReconstructedParticle.h"
 
-using vertex_lcfi::util::efficiency_purity;
-using vertex_lcfi::util::histogram_data;
+using vertex_lcfi::util::binned_efficiency_purity;
+using vertex_lcfi::util::binned_histogram_data;
 
 /** Creates some sample plots from the data calculated by the LCFI vertex package.
  *
@@ -52,11 +53,18 @@ using vertex_lcfi::util::histogram_data;
  * Otherwise, the efficiency-purity values will be output as comma separated values to the file
  * <filename>+".csv", and the jet energies to <filename>+"-JetEnergies.csv".
  *
+ * <H5>Combining many jobs</H5>
+ * If PartialResultsFile is set the binned tag values (see FlavourTagPlotData) are also written to that file.
+ * These are just counts, so the files from any number of jobs can be added up with the lcfimergeplots
+ * program, which also writes the final efficiency-purity curves. The vertex category isn't known here so all
+ * jets go in category 0, and jets that are neither b nor c count as light.
+ *
  * @param JetCollectionName Name of the ReconstructedParticle collection that represents jets.
  * @param FlavourTagCollections Names of the LCFloatVec collections holding the Flavour tags, all tags
  * in this list will be produced in one file for comparison
  * @param TrueJetFlavourCollection LCIntVec that contains the MC Jet flavour (from TrueJetFlavourProcessor)
  * @param OutputFilename The name of the file that will hold the output.
+ * @param PartialResultsFile If not empty, the file to write the mergeable partial results to.
 */
 class PlotProcessor : public marlin::Processor
 {
@@ -76,14 +84,22 @@ protected:
 	std::vector<std::string> _FlavourTagCollectionNames;	/**< @internal The names of the collection of LCFloatVec that are the flavour tags (a set of purity effiency plots will be made for each tag) (comes from the steering file).*/
 	std::string _TrueJetFlavourColName; /**< @internal The name of the collection of LCIntVec that is the true jet flavour (comes from the steering file).*/
 	std::string _OutputFilename; /**< @internal The filename of the output root file if using root, otherwise the directory and the first part of the filename of the comma seperated value files.*/
-	std::vector<std::map<std::string,unsigned int> > _IndexOfForEachTag;
+	std::string _PartialResultsFile; /**< @internal The file to write the mergeable partial results to, or empty to not write them (comes from the steering file).*/
+	FlavourTagPlotData _PartialResults; /**< @internal The binned tag values that are written to _PartialResultsFile.*/
+	struct TagIndices
+	{
+		unsigned int bTag;
+		unsigned int cTag;
+		unsigned int bcTag;
+	};
+	std::vector<TagIndices> _TagIndicesForEachTag; /**< @internal The positions of BTag, CTag and BCTag in each of the flavour tag collections.*/
 	int _nRun; /**< @internal The current run number.*/
 
-	histogram_data<double> _jetEnergy; /**< @internal Custom storage class that holds all of the jet energies.*/
+	binned_histogram_data<double> _jetEnergy; /**< @internal Custom storage class that holds the jet energies, binned in 0.1GeV bins up to 120GeV.*/
 
-	std::vector<efficiency_purity<double> > _BTagEfficiencyPurity;/**< @internal Custom storage class that holds all the efficiency/purity data for the b tag calculated by the FlavourTagProcessor.*/
-	std::vector<efficiency_purity<double> > _CTagEfficiencyPurity;/**< @internal Custom storage class that holds all the efficiency/purity data for the b tag calculated by the FlavourTagProcessor.*/
-	std::vector<efficiency_purity<double> > _BCTagEfficiencyPurity;/**< @internal Custom storage class that holds all the efficiency/purity data for the b tag (only b background) calculated by the FlavourTagProcessor.*/
+	std::vector<binned_efficiency_purity<double> > _BTagEfficiencyPurity;/**< @internal Custom storage class that holds the binned efficiency/purity data for the b tag calculated by the FlavourTagProcessor.*/
+	std::vector<binned_efficiency_purity<double> > _CTagEfficiencyPurity;/**< @internal Custom storage class that holds the binned efficiency/purity data for the b tag calculated by the FlavourTagProcessor.*/
+	std::vector<binned_efficiency_purity<double> > _BCTagEfficiencyPurity;/**< @internal Custom storage class that holds the binned efficiency/purity data for the b tag (only b background) calculated by the FlavourTagProcessor.*/
 
 	//useful constants
 	static const int C_JET=4;/**< @internal Useful constant for the jet flavour*/
@@ -92,8 +108,9 @@ protected:
 	void _displayCollectionNames( lcio::LCEvent* pEvent );/**< @internal Just prints out the available collections in the LCIO file to standard output.*/
 	bool _passesEventCuts( lcio::LCEvent* pEvent );	///< @internal A function that contains all the event cuts - returns true if the event passes all of the cuts, false otherwise.
 	bool _passesJetCuts( lcio::ReconstructedParticle* pJet ); ///< @internal A function that contains all the jet cuts - returns true if the event passes all of the cuts, false otherwise.
+	double _cosTheta( lcio::ReconstructedParticle* pJet ); ///< @internal Cosine of the polar angle of the jet axis.
 
-	void _fillPlots( LCEvent* pEvent, unsigned int jet);/**< @internal Internal function that is just code split off from processEvent() to simplify it - fills the container classes with the data from the file.*/
+	void _fillPlots( LCEvent* pEvent, unsigned int jet, double cosTheta );/**< @internal Internal function that is just code split off from processEvent() to simplify it - fills the container classes with the data from the file.*/
 	void _outputDataToFile( std::string filename );/**< @internal Internal function that is just code split off from end() to simplify it - writes the required data from the container classes to the output file.*/
 
 	double _jetEMax;/**< @internal Keeps a record of the highest jet energy - gets printed to standard output at the end as a sanity check.*/
@@ -15,6 +15,8 @@
 #include "marlin/Processor.h"
 #include "lcio.h"
 #include <string>
+#include <vector>
+#include <map>
 using namespace lcio ;
 using namespace marlin ;
 
@@ -70,6 +72,14 @@ If enabled by "i1_BadParametersEnable" this cut removes tracks with nan covarian
 <br>
 <h4>MC Vertex cut</h4>
 Experimental MC Cut - most likely removed in next release
+<h4>Compiled cuts</h4>
+If "k1_CompiledCuts" is true the RPs of an event (all the particles of all the jets if SubParticleLists = true)
+are first unpacked into one array per cut variable. Each enabled cut is then run over a whole array at a time,
+in the same order as above, marking the RPs that fail it. Only RPs that haven't failed an earlier cut are tested
+by the cuts that need the MC data, so the result is the same as with the cuts applied one RP at a time. The number of
+RPs rejected by each cut is printed at the end of the job.
+<br>If "k2_SubsetOutput" is also true, OutputRCPCollection is made a subset collection of the RPs that pass (the
+particles of the jets if SubParticleLists = true). The input RPs are neither copied nor changed, whatever WriteNewCollection is.
 \author Ben Jeffery (b.jeffery1@physics.ox.ac.uk)
 */
 class RPCutProcessor : public Processor {
@@ -91,11 +101,37 @@ class RPCutProcessor : public Processor {
   bool  _Z0Fail(ReconstructedParticle* RPTrack);
   bool  _Z0ErrFail(ReconstructedParticle* RPTrack);
   bool  _PTFail(ReconstructedParticle* RPTrack);
-  bool  _DetectorHitsFail(ReconstructedParticle* RPTrack,std::map<std::string,int> SubdetectorIndex);
+  bool  _DetectorHitsFail(ReconstructedParticle* RPTrack);
   bool  _MCPIDFail( lcio::ReconstructedParticle* RPTrack, UTIL::LCRelationNavigator* pMCRelationNavigator );
   bool  _BadParametersFail(lcio::ReconstructedParticle* RPTrack);
   bool  _MCVertexFail(lcio::ReconstructedParticle* RPTrack, UTIL::LCRelationNavigator* pMCRelationNavigator );
   
+  //! The cuts in the order they are applied, for the statistics of the compiled cuts. 0 means passed.
+  enum CutId { Passed, NoTrack, D0Cut, D0ErrCut, Z0Cut, Z0ErrCut, PTCut, Chi2OverDOFCut, DetectorHitsCut, MCPIDCut, BadParametersCut, MCVertexCut, NumberOfCutIds };
+  
+  //! The cut variables of the RPs of one event, one entry per RP. Kept between events so the arrays aren't reallocated.
+  struct CutColumns
+  {
+    std::vector<ReconstructedParticle*> RP;
+    std::vector<float> AbsD0;
+    std::vector<float> D0Err;
+    std::vector<float> AbsZ0;
+    std::vector<float> Z0Err;
+    std::vector<double> PT;
+    std::vector<float> Chi2OverDOF;
+    std::vector<unsigned char> BadParameters;
+    std::vector<unsigned char> RejectedBy; ///< the first CutId the RP failed, Passed if none
+  };
+  
+  void _addToColumns(ReconstructedParticle* RP);
+  void _applyCompiledCuts(UTIL::LCRelationNavigator* pMCRelationNavigator);
+  void _compiledCutEvent(LCCollection* InCol, LCCollection* OutRPCollection, UTIL::LCRelationNavigator* pMCRelationNavigator);
+  
+  bool _CompiledCuts;
+  bool _SubsetOutput;
+  CutColumns _Columns;
+  std::vector<long> _NumberRejectedBy; ///< indexed by CutId, Passed counts the RPs that passed
+  
   std::string _InRCPColName ;
   std::string _TrackColName;
   std::string _OutRCPColName ;
@@ -140,6 +176,10 @@ class RPCutProcessor : public Processor {
   std::vector<std::string> _DetectorHitsRegion2DetectorNames;
   std::vector<int> _DetectorHitsRegion2Cuts;
   std::vector<std::string> _DetectorNames;
+  std::vector<int> _DetectorHitsBoundaryIndices; ///< positions in getSubdetectorHitNumbers() of the detectors named above, found in init()
+  std::vector<int> _DetectorHitsRegion1Indices;
+  std::vector<int> _DetectorHitsRegion2Indices;
+  std::vector<int> _SortedMonteCarloPIDsToCut;
   
   bool _MCVertexEnable;
   const gear::VXDParameters* _VxdPar;
@@ -24,6 +24,8 @@ using EVENT::MCParticle;
  *  The association is done by  matching heavy flavour hadrons to the jet that is closest in agle. 
  *  More than one heavy particle can therefore be associated with the same jet. If this happens the jet flavour is 
  *  the flavour of the first particle in the parent-daughter chain associated with the jet.
+ *  Whether a PDG code is a heavy hadron, and its parton charge, is looked up in a table made in init(), and the
+ *  jet directions are worked out once per event, so that large MC records can be gone through quickly.
  *  The pdg code of particle is subsequently used to determine the hadronic charge of the jet and the partonic charge of the heavy particle.  
  *  
  *  <h4>Input - Prerequisites</h4>
@@ -71,6 +73,9 @@ class TrueAngularJetFlavourProcessor : public Processor {
   std::string _TrueHChargeColName;
   std::string _TruePChargeColName;
   double _MaximumAngle;
+  static const int MaximumReducedCode=10000; ///< PDG codes are reduced below this (modulo 1000 from 10000 up) before being looked up
+  std::vector<int> _HeavyFlavourOfCode; ///< 4 or 5 for charm or beauty hadrons, 0 otherwise, indexed by the reduced abs(PDG code)
+  std::vector<int> _PartonChargeSignOfCode; ///< the parton charge is this times the sign of the PDG code
   int _nRun ;
   int _nEvt ;
 } ;
@@ -0,0 +1,80 @@
+#ifndef TypedCollection_h
+#define TypedCollection_h
+
+#include <string>
+#include <vector>
+
+#include "lcio.h"
+#include "EVENT/LCEvent.h"
+#include "EVENT/LCCollection.h"
+#include "EVENT/LCFloatVec.h"
+#include "EVENT/LCIntVec.h"
+#include "EVENT/MCParticle.h"
+#include "EVENT/ReconstructedParticle.h"
+#include "EVENT/Track.h"
+#include "EVENT/Vertex.h"
+
+/** The LCIO type name of the collections that hold objects of type T. */
+template<class T> struct LCIOTypeName;
+template<> struct LCIOTypeName<lcio::ReconstructedParticle> { static const char* name() { return lcio::LCIO::RECONSTRUCTEDPARTICLE; } };
+template<> struct LCIOTypeName<lcio::Vertex> { static const char* name() { return lcio::LCIO::VERTEX; } };
+template<> struct LCIOTypeName<lcio::Track> { static const char* name() { return lcio::LCIO::TRACK; } };
+template<> struct LCIOTypeName<lcio::MCParticle> { static const char* name() { return lcio::LCIO::MCPARTICLE; } };
+template<> struct LCIOTypeName<lcio::LCFloatVec> { static const char* name() { return lcio::LCIO::LCFLOATVEC; } };
+template<> struct LCIOTypeName<lcio::LCIntVec> { static const char* name() { return lcio::LCIO::LCINTVEC; } };
+
+/** The elements of an LCIO collection as an array of T*.
+*
+* The type name of the collection is checked once when the view is made, and an lcio::EventException
+* is thrown if it is not the one for T (see LCIOTypeName). After that each element is only a static_cast
+* away, so they are all converted up front instead of being dynamic_cast on every access the way
+* LCCollection::getElementAt has to be used. begin() and end() are plain pointers into one array, so the
+* view can be looped over like a std::vector or passed to the standard algorithms.<br>
+* The view holds pointers to the objects in the collection, which still owns them, so it must not
+* outlive the collection (normally the event).
+*/
+template<class T>
+class TypedCollection
+{
+public:
+	typedef T* const* const_iterator;
+
+	/** A view of pCollection. Throws lcio::EventException if it does not hold objects of type T. */
+	TypedCollection( lcio::LCCollection* pCollection )
+	{
+		_fill( pCollection, "" );
+	}
+
+	/** A view of the named collection in the event. Throws lcio::DataNotAvailableException if there is no such
+	* collection, and lcio::EventException if it does not hold objects of type T.
+	*/
+	TypedCollection( lcio::LCEvent* pEvent, const std::string& collectionName )
+	{
+		_fill( pEvent->getCollection( collectionName ), collectionName );
+	}
+
+	int size() const { return _elements.size(); }
+	bool empty() const { return _elements.empty(); }
+	T* operator[]( int element ) const { return _elements[element]; }
+	const_iterator begin() const { return _elements.empty() ? 0 : &_elements[0]; }
+	const_iterator end() const { return begin()+_elements.size(); }
+
+private:
+	void _fill( lcio::LCCollection* pCollection, const std::string& collectionName )
+	{
+		if( pCollection->getTypeName()!=LCIOTypeName<T>::name() )
+		{
+			std::string name=collectionName.empty() ? std::string("") : "\""+collectionName+"\" ";
+			throw lcio::EventException( "The collection "+name+"is of type "+pCollection->getTypeName()
+				+" not "+LCIOTypeName<T>::name() );
+		}
+
+		int numberOfElements=pCollection->getNumberOfElements();
+		_elements.resize( numberOfElements );
+		for( int i=0; i<numberOfElements; ++i ) _elements[i]=static_cast<T*>( pCollection->getElementAt( i ) );
+	}
+
+	std::vector<T*> _elements;
+};
+
+#endif //ifndef TypedCollection_h
@@ -69,7 +69,8 @@ public:
 		//TODO Modify the last error message to say way these are returning 0
 		if( element<0 || element>=_pCollection->getNumberOfElements() ) return 0;
 
-		return dynamic_cast<T*>( _pCollection->getElementAt( element ) );
+		//The type of the collection was checked in the constructor, so a static_cast is enough
+		return static_cast<T*>( _pCollection->getElementAt( element ) );
 	}
 private:
 	lcio::LCCollection* _pCollection;
@@ -0,0 +1,133 @@
+#ifndef ZVTOPResultColumns_h
+#define ZVTOPResultColumns_h
+
+#include <string>
+#include <vector>
+
+#include "ColumnFile.h"
+
+namespace vertex_lcfi
+{
+	class DecayChain;
+}
+
+/** The file format shared by ZVTOPResultColumnWriter and ZVTOPResultColumnReader.
+*
+* The file holds the ZVTOP result of each jet as three tables of fixed width (4 byte floats or ints) columns:
+* - Jets, one row per jet: Run, Event, JetIndex, NumberOfTracks (in the jet), NumberOfVertices, FirstVertex,
+*   NumberOfTrackRows, FirstTrackRow. The First columns are rows of the other tables in the same chunk.
+* - Vertices, one row per vertex of a jet in ZVTOP order (the IP first): JetRow, IsPrimary, NumberOfTracks,
+*   X, Y, Z, the error matrix XX, YX, YY, ZX, ZY, ZZ, Chi2, Probability and VertexFunctionMax (V(r) at the maximum
+*   nearest the vertex, 0 if not known).
+* - Tracks, one row for each vertex a track of the jet is in, and one row for each track that is in no
+*   vertex: JetRow, TrackIndex (position in the jet), VertexRow (-1 if in no vertex) and Chi2 (the chi squared
+*   contribution of the track to the vertex, -1 if not known).
+*
+* The rows are stored in chunks of whole events. Each chunk header holds the first and last run and event
+* numbers in it, so a reader can go straight to the chunk of an event. Each column of a chunk is one 4 byte aligned
+* block, used in place when the file is memory mapped.
+*
+* The file is a ColumnFile with the magic "LCFIZVTC":
+* - the format header is, per table, the number of columns then each column (type 'f' or 'i' and name)
+* - the chunk header is the first run, first event, last run, last event and the number of rows of each
+*   table, and there is one block per column of each table in turn
+*/
+class ZVTOPResultColumns
+{
+public:
+	enum Table { Jets, Vertices, Tracks, NumberOfTables };
+	enum ColumnType { FloatColumn='f', IntColumn='i' };
+
+	enum JetColumn { Run, Event, JetIndex, JetNumberOfTracks, NumberOfVertices, FirstVertex, NumberOfTrackRows, FirstTrackRow, NumberOfJetColumns };
+	enum VertexColumn { VertexJetRow, IsPrimary, VertexNumberOfTracks, X, Y, Z, ErrorXX, ErrorYX, ErrorYY, ErrorZX, ErrorZY, ErrorZZ,
+		VertexChi2, Probability, VertexFunctionMax, NumberOfVertexColumns };
+	enum TrackColumn { TrackJetRow, TrackIndex, VertexRow, TrackChi2, NumberOfTrackColumns };
+
+	static int numberOfColumns( Table table );
+	static const char* columnName( Table table, int column );
+	static ColumnType columnType( Table table, int column );
+
+	enum { Version=1 };
+};
+
+/** Writes the ZVTOP results of jets to a column file (see ZVTOPResultColumns). */
+class ZVTOPResultColumnWriter
+{
+public:
+	/** A chunk is ended at the first event that starts after jetsPerChunk jets. */
+	ZVTOPResultColumnWriter( const std::string& fileName, int jetsPerChunk=16384 );
+	/** Writes out any jets not yet written. */
+	~ZVTOPResultColumnWriter();
+
+	/** Adds the result for a jet. The jets of an event must be added together, starting with jetIndex 0. */
+	void addJet( int runNumber, int eventNumber, int jetIndex, const vertex_lcfi::DecayChain* pDecayChain );
+
+	/** Writes out any jets not yet written and closes the file. */
+	void close();
+
+	long numberOfJets() const { return _NumberOfJets; }
+	long numberOfVertices() const { return _NumberOfVertices; }
+
+private:
+	void _writeChunk();
+
+	ColumnFileWriter _File;
+	int _JetsPerChunk;
+	int _Rows[ZVTOPResultColumns::NumberOfTables];	//In the current chunk
+	int _FirstRun, _FirstEvent, _LastRun, _LastEvent;
+	long _NumberOfJets;
+	long _NumberOfVertices;
+	std::vector<std::vector<char> > _Columns[ZVTOPResultColumns::NumberOfTables];	//The values of the current chunk, 4 bytes each
+
+	ZVTOPResultColumnWriter( const ZVTOPResultColumnWriter& ); //Declared but not defined
+	ZVTOPResultColumnWriter& operator=( const ZVTOPResultColumnWriter& ); //Declared but not defined
+};
+
+/** Reads a column file written by ZVTOPResultColumnWriter, one chunk at a time.
+*
+* The lcfizvtopcolumns program (driver/main) uses it to check a file and print the results of an event.
+*
+* The file is memory mapped where possible (see ColumnFileReader), so the column pointers point
+* straight into the file. The pointers are valid until the next call to readChunk.
+*/
+class ZVTOPResultColumnReader
+{
+public:
+	ZVTOPResultColumnReader( const std::string& fileName );
+	~ZVTOPResultColumnReader();
+
+	long numberOfJets() const { return _NumberOfRows[ZVTOPResultColumns::Jets]; }
+	long numberOfVertices() const { return _NumberOfRows[ZVTOPResultColumns::Vertices]; }
+	int numberOfChunks() const { return _File.numberOfChunks(); }
+
+	/** The chunk holding the event, or -1 if it is not in the file. */
+	int findChunk( int runNumber, int eventNumber ) const;
+
+	/** Makes chunk the current chunk. @return the number of jets in it */
+	int readChunk( int chunk );
+
+	/** The number of rows of a table in the current chunk. */
+	int rows( ZVTOPResultColumns::Table table ) const { return _Rows[table]; }
+
+	//The columns of the current chunk
+	const int* intColumn( ZVTOPResultColumns::Table table, int column ) const { return static_cast<const int*>( _Column[table][column] ); }
+	const float* floatColumn( ZVTOPResultColumns::Table table, int column ) const { return static_cast<const float*>( _Column[table][column] ); }
+	const int* jetColumn( ZVTOPResultColumns::JetColumn column ) const { return intColumn( ZVTOPResultColumns::Jets, column ); }
+	const int* vertexIntColumn( ZVTOPResultColumns::VertexColumn column ) const { return intColumn( ZVTOPResultColumns::Vertices, column ); }
+	const float* vertexFloatColumn( ZVTOPResultColumns::VertexColumn column ) const { return floatColumn( ZVTOPResultColumns::Vertices, column ); }
+	const int* trackIntColumn( ZVTOPResultColumns::TrackColumn column ) const { return intColumn( ZVTOPResultColumns::Tracks, column ); }
+	const float* trackFloatColumn( ZVTOPResultColumns::TrackColumn column ) const { return floatColumn( ZVTOPResultColumns::Tracks, column ); }
+
+private:
+	ColumnFileReader _File;
+	long _NumberOfRows[ZVTOPResultColumns::NumberOfTables];
+	int _Rows[ZVTOPResultColumns::NumberOfTables];
+	std::vector<const char*> _Blocks;
+	std::vector<unsigned int> _BlockSizes;
+	std::vector<const void*> _Column[ZVTOPResultColumns::NumberOfTables];
+
+	ZVTOPResultColumnReader( const ZVTOPResultColumnReader& ); //Declared but not defined
+	ZVTOPResultColumnReader& operator=( const ZVTOPResultColumnReader& ); //Declared but not defined
+};
+
+#endif //ifndef ZVTOPResultColumns_h
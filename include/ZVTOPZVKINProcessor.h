@@ -15,6 +15,8 @@ using namespace marlin ;
 using vertex_lcfi::DecayChain;
 using vertex_lcfi::Jet;
 
+class ZVTOPResultColumnWriter;
+
 //!Find vertices in a jet using kinematic ZVTOP-ZVKIN algorithm
 /*!
 <h4>Input</h4>
@@ -59,6 +61,7 @@ For more details on algorihmic parameters see the ZVKIN paper "zvkin.ps" in the
 \param InitialGhostWidth  Width in cm of the ghost inital ghosttrack also the smallest width it is allowed to have  
 \param MaxChi2Allowed  The ghost track is widened until all forward jet tracks have a chi squared lower than this value  
 \param OutputTrackChi2  If true the chi squared contributions of tracks to vertices is written to LCIO  
+\param ColumnFile If set, the vertices and tracks of the decay chain of every jet are also written to this column file (see ZVTOPResultColumns), which is read back at the end of the job as a check; lcfizvtopcolumns checks and prints such files
 */
 class ZVTOPZVKINProcessor : public Processor {
   
@@ -87,6 +90,8 @@ class ZVTOPZVKINProcessor : public Processor {
   double _InitialGhostWidth;
   double _MaxChi2Allowed;
   bool _OutputTrackChi2;
+  std::string _ColumnFileName;
+  ZVTOPResultColumnWriter* _ColumnWriter;
   int _nRun ;
   int _nEvt ;
 } ;
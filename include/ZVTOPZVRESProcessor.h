@@ -15,6 +15,8 @@ using namespace marlin ;
 using vertex_lcfi::DecayChain;
 using vertex_lcfi::Jet;
 
+class ZVTOPResultColumnWriter;
+
 //!Find vertices in a jet using topological ZVTOP-ZVRES algorithm
 /*!
 <h4>Input</h4>
@@ -60,6 +62,7 @@ For more details on algorihmic parameters see the ZVTOP paper.
 \param TrackTrimCut Chi Squared cut for final trimming of tracks from vertices
 \param ResolverCut Cut to determine if two vertices are resolved
 \param OutputTrackChi2 If true the chi squared contributions of tracks to vertices is written to LCIO
+\param ColumnFile If set, the vertices and tracks of the decay chain of every jet are also written to this column file (see ZVTOPResultColumns), which is read back at the end of the job as a check; lcfizvtopcolumns checks and prints such files
 */
 class ZVTOPZVRESProcessor : public Processor {
   
@@ -92,6 +95,8 @@ class ZVTOPZVRESProcessor : public Processor {
   double _TrackTrimCut;
   double _ResolverCut;
   bool _OutputTrackChi2;
+  std::string _ColumnFileName;
+  ZVTOPResultColumnWriter* _ColumnWriter;
   int _nRun ;
   int _nEvt ;
 } ;
@@ -0,0 +1,196 @@
+#include "../include/ColumnFile.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+ColumnFileWriter::ColumnFileWriter( const std::string& fileName, const char* magic, unsigned int version, const std::string& owner )
+	: _File( fileName.c_str(), std::ios::out|std::ios::binary ), _Owner(owner)
+{
+	if( sizeof(int)!=4 || sizeof(float)!=4 ) throw std::runtime_error( _Owner + ": needs 4 byte ints and floats" );
+	if( !_File.is_open() ) throw std::runtime_error( _Owner + ": unable to open " + fileName );
+
+	_File.write( magic, ColumnFile::MagicSize );
+	writeWord( version );
+	writeWord( ColumnFile::ByteOrderMark );
+}
+
+void ColumnFileWriter::writeWord( unsigned int word )
+{
+	_File.write( reinterpret_cast<const char*>( &word ), 4 );
+}
+
+void ColumnFileWriter::writeColumn( unsigned int type, const std::string& name )
+{
+	writeWord( type );
+	writeWord( name.size() );
+	_writeBlock( name.data(), name.size() );
+}
+
+void ColumnFileWriter::writeChunk( const std::vector<unsigned int>& header, const std::vector<const std::vector<char>*>& blocks )
+{
+	unsigned int chunkSize=0;
+	for( size_t i=0; i<blocks.size(); ++i ) chunkSize+=4+ColumnFile::padded( blocks[i]->size() );
+	for( size_t i=0; i<header.size(); ++i ) writeWord( header[i] );
+	writeWord( chunkSize );
+	for( size_t i=0; i<blocks.size(); ++i )
+	{
+		const std::vector<char>& block=*blocks[i];
+		writeWord( block.size() );
+		_writeBlock( block.empty() ? 0 : &block[0], block.size() );
+	}
+}
+
+void ColumnFileWriter::close()
+{
+	if( !_File.is_open() ) return;
+	_File.close();
+	if( _File.fail() ) throw std::runtime_error( _Owner + ": error writing the file" );
+}
+
+void ColumnFileWriter::_writeBlock( const char* data, unsigned int size )
+{
+	static const char padding[4]={ 0, 0, 0, 0 };
+	if( size ) _File.write( data, size );
+	_File.write( padding, ColumnFile::padded( size )-size );
+}
+
+ColumnFileReader::ColumnFileReader( const std::string& fileName, const char* magic, unsigned int version, const std::string& owner, const std::string& description )
+	: _FileName(fileName), _Owner(owner), _Map(0), _FileSize(0), _Offset(0)
+{
+#ifndef _WIN32
+	int descriptor=open( fileName.c_str(), O_RDONLY );
+	if( descriptor>=0 )
+	{
+		struct stat status;
+		if( fstat( descriptor, &status )==0 && status.st_size>0 )
+		{
+			void* map=mmap( 0, status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0 );
+			if( map!=MAP_FAILED )
+			{
+				_Map=static_cast<const char*>( map );
+				_FileSize=status.st_size;
+			}
+		}
+		::close( descriptor );
+	}
+#endif
+	if( !_Map )
+	{
+		_File.open( fileName.c_str(), std::ios::in|std::ios::binary );
+		if( !_File.is_open() ) throw std::runtime_error( _Owner + ": unable to open " + fileName );
+		_File.seekg( 0, std::ios::end );
+		_FileSize=_File.tellg();
+	}
+
+	char fileMagic[ColumnFile::MagicSize];
+	_read( 0, ColumnFile::MagicSize, fileMagic );
+	if( std::memcmp( fileMagic, magic, ColumnFile::MagicSize )!=0 ) fail( "is not " + description );
+	_Offset=ColumnFile::MagicSize;
+	unsigned int fileVersion=readWord();
+	unsigned int byteOrder=readWord();
+	if( byteOrder!=ColumnFile::ByteOrderMark ) fail( "was written on a machine with a different byte order" );
+	if( fileVersion!=version ) fail( "has an unknown format version" );
+}
+
+ColumnFileReader::~ColumnFileReader()
+{
+#ifndef _WIN32
+	if( _Map ) munmap( const_cast<char*>( _Map ), _FileSize );
+#endif
+}
+
+unsigned int ColumnFileReader::readWord()
+{
+	unsigned int word=_readWord( _Offset );
+	_Offset+=4;
+	return word;
+}
+
+void ColumnFileReader::readColumn( unsigned int& type, std::string& name )
+{
+	type=readWord();
+	unsigned int length=readWord();
+	if( length>_FileSize-_Offset ) fail( "is truncated" );
+	name.assign( length, ' ' );
+	if( length ) _read( _Offset, length, &name[0] );
+	_Offset+=ColumnFile::padded( length );
+}
+
+void ColumnFileReader::indexChunks( int headerWords )
+{
+	//Index the chunks, so any of them can be read directly
+	_Chunks.clear();
+	long offset=_Offset;
+	while( offset+4*( headerWords+1 )<=_FileSize )
+	{
+		Chunk chunk;
+		for( int i=0; i<headerWords; ++i ) chunk.header.push_back( _readWord( offset+4*i ) );
+		chunk.size=_readWord( offset+4*headerWords );
+		chunk.offset=offset+4*( headerWords+1 );
+		if( chunk.size>_FileSize-chunk.offset ) fail( "is truncated" );
+		_Chunks.push_back( chunk );
+		offset=chunk.offset+chunk.size;
+	}
+}
+
+void ColumnFileReader::readChunk( int chunk, std::vector<const char*>& blocks, std::vector<unsigned int>& blockSizes )
+{
+	const Chunk& thisChunk=_Chunks.at( chunk );
+	const char* data;
+	if( _Map ) data=_Map+thisChunk.offset;
+	else
+	{
+		_ChunkBuffer.resize( thisChunk.size+1 );
+		_read( thisChunk.offset, thisChunk.size, &_ChunkBuffer[0] );
+		data=&_ChunkBuffer[0];
+	}
+
+	blocks.clear();
+	blockSizes.clear();
+	unsigned int position=0;
+	while( position<thisChunk.size )
+	{
+		if( thisChunk.size-position<4 ) fail( "has a corrupt chunk" );
+		unsigned int blockSize;
+		std::memcpy( &blockSize, data+position, 4 );
+		position+=4;
+		//Written so nothing can wrap around, or a corrupt size could stop position moving on
+		if( blockSize>thisChunk.size-position || ColumnFile::padded( blockSize )<blockSize ) fail( "has a corrupt chunk" );
+		blocks.push_back( data+position );
+		blockSizes.push_back( blockSize );
+		position+=ColumnFile::padded( blockSize );
+	}
+}
+
+void ColumnFileReader::fail( const std::string& problem ) const
+{
+	throw std::runtime_error( _Owner + ": " + _FileName + " " + problem );
+}
+
+void ColumnFileReader::_read( long offset, unsigned int size, char* destination )
+{
+	if( offset>_FileSize || size>_FileSize-offset ) fail( "is truncated" );
+	if( _Map )
+	{
+		std::memcpy( destination, _Map+offset, size );
+		return;
+	}
+	_File.clear();
+	_File.seekg( offset );
+	_File.read( destination, size );
+	if( !_File ) throw std::runtime_error( _Owner + ": error reading " + _FileName );
+}
+
+unsigned int ColumnFileReader::_readWord( long offset )
+{
+	unsigned int word;
+	_read( offset, 4, reinterpret_cast<char*>( &word ) );
+	return word;
+}
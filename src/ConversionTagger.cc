@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <algorithm>
 
 #include <UTIL/LCTOOLS.h>
 #include <EVENT/LCCollection.h>
@@ -18,6 +19,11 @@
 
 #include <gear/BField.h>
 
+#ifdef MARLIN_USE_AIDA
+#include <marlin/AIDAProcessor.h>
+#include <AIDA/IHistogramFactory.h>
+#endif
+
 using namespace lcio;
 using namespace marlin;
 using namespace std;
@@ -25,6 +31,12 @@ using namespace std;
 
 ConversionTagger aConversionTagger ;
 
+namespace {
+  // maximum distance between the two helices in rphi and in z for a vertex candidate
+  const double MaxDistRPhi=1;
+  const double MaxDistZ=1;
+}
+
 
 ConversionTagger::ConversionTagger() : Processor("ConversionTagger") {
   
@@ -32,6 +44,11 @@ ConversionTagger::ConversionTagger() : Processor("ConversionTagger") {
   _description = "ConversionTagger processor does conversion and V0 tagging" ;
   
   _twopi=2*acos(-1.0);
+
+  registerOptionalParameter( "FillHistograms",
+			     "Set true to fill the diagnostic histograms (needs Marlin to be compiled with AIDA)",
+			     _FillHistograms,
+			     bool(0) );
 }
 
 
@@ -41,7 +58,23 @@ void ConversionTagger::init() {
 
   _BField = Global::GEAR->getBField().at(gear::Vector3D(0.,0.,0.)).z();
 
-  histos = new HistMap(this);
+#ifdef MARLIN_USE_AIDA
+  if (_FillHistograms) {
+    AIDA::IHistogramFactory* pHistogramFactory=AIDAProcessor::histogramFactory(this);
+    _pHistograms[HelixDist]=pHistogramFactory->createHistogram1D("helixdist","fractional distance between helix centres",100,0,2);
+    _pHistograms[DistRPhi]=pHistogramFactory->createHistogram1D("dist_rphi","helix distance in rphi",100,0,10);
+    _pHistograms[DistZ]=pHistogramFactory->createHistogram1D("dist_z","helix distance in z",100,0,10);
+    _pHistograms[Radius]=pHistogramFactory->createHistogram1D("radius","radius of closest approach in z",100,0,2000);
+    _pHistograms[ConvMass]=pHistogramFactory->createHistogram1D("conv_mass","conv_mass",100,0,1);
+    _pHistograms[K0Mass]=pHistogramFactory->createHistogram1D("K0_mass","K0_mass",100,0,1);
+    _pHistograms[LambdaMass]=pHistogramFactory->createHistogram1D("Lambda_mass","Lambda_mass",100,1,2);
+  }
+#else
+  if (_FillHistograms) {
+    streamlog_out(WARNING) << "Marlin was compiled without AIDA, so no histograms will be filled" << endl;
+    _FillHistograms=false;
+  }
+#endif
 }
 
 
@@ -89,192 +122,185 @@ void ConversionTagger::tagger( LCEvent *evt,
   vector<bool> tagged;
   for (int i=0; i<coll->getNumberOfElements(); i++) tagged.push_back(false);
 
-  for (int irp1=0; irp1<coll->getNumberOfElements(); irp1++) {
-    ReconstructedParticle *rp1=dynamic_cast<ReconstructedParticle*>
-      (coll->getElementAt(irp1));
-
-    for (int irp2=irp1+1; irp2<coll->getNumberOfElements(); irp2++) {
-      ReconstructedParticle *rp2=dynamic_cast<ReconstructedParticle*>
-	(coll->getElementAt(irp2));
-
-      // require opposite charges
-      if (rp1->getCharge()*rp2->getCharge()>=0) continue;
-
-      // require exactly one track each
-      if (rp1->getTracks().size()!=1) continue;
-      if (rp2->getTracks().size()!=1) continue;
-
-
-      // very simple vertexing algorithm:
-
-      // get all information required for finding potential vertex
-      Track* trk1=rp1->getTracks()[0];
-      Track* trk2=rp2->getTracks()[0];
-      HelixClass helix1,helix2;
-      helix1.Initialize_Canonical(trk1->getPhi(),trk1->getD0(),
-				  trk1->getZ0(),trk1->getOmega(),
-				  trk1->getTanLambda(),_BField);
-      helix2.Initialize_Canonical(trk2->getPhi(),trk2->getD0(),
-				  trk2->getZ0(),trk2->getOmega(),
-				  trk2->getTanLambda(),_BField);
-
-      // find intersection of helices in rphi projection
-      // calculations a la Paul Bourke, University of Western Australia
-      //
-      // distance between centres
-      double r1=helix1.getRadius();
-      double r2=helix2.getRadius();
-      double x1=helix1.getXC();
-      double y1=helix1.getYC();
-      double x2=helix2.getXC();
-      double y2=helix2.getYC();
-      double d=sqrt((x1-x2)*(x1-x2)+(y1-y2)*(y1-y2));
-      histos->fill("helixdist",d/(r1+r2),1,
-		   "fractional distance between helix centres",100,0,2);
-      // centre point
-      double a=(r1*r1-r2*r2+d*d)/2/d;
-      double xa=x1+a/d*(x2-x1);
-      double ya=y1+a/d*(y2-y1);
-      // do these helices intersect at all?
-      double vertex_radius, vertex_z;
-      double dist_rphi, dist_z;
-      float vertex1[3],vertex2[3];
-      float ref1[3]={helix1.getReferencePoint()[0],
-		     helix1.getReferencePoint()[1],
-		     helix1.getReferencePoint()[2]};
-      float ref2[3]={helix2.getReferencePoint()[0],
-		     helix2.getReferencePoint()[1],
-		     helix2.getReferencePoint()[2]};
-      if (d<r1+r2) {
-	// we have two possible vertices here.
-	double h=sqrt(r1*r1-a*a);
-	double xc1=xa+h*(y2-y1)/d;
-	double yc1=ya-h*(x2-x1)/d;
-	double rc1=sqrt(xc1*xc1+yc1*yc1);
-	double xc2=xa-h*(y2-y1)/d;
-	double yc2=ya+h*(x2-x1)/d;
-	double rc2=sqrt(xc2*xc2+yc2*yc2);
-	// check z coordinates to see at which candidate vertex radius
-	// the agreement is better
-	float vtx1rc1[6],vtx2rc1[6],vtx1rc2[6],vtx2rc2[6];
-	helix1.getPointOnCircle(rc1,ref1,vtx1rc1);
-	helix2.getPointOnCircle(rc1,ref2,vtx2rc1);
-	helix1.getPointOnCircle(rc2,ref1,vtx1rc2);
-	helix2.getPointOnCircle(rc2,ref2,vtx2rc2);
-	if (fabs(vtx1rc1[2]-vtx2rc1[2])<fabs(vtx1rc2[2]-vtx2rc2[2])) {
-	  vertex_radius=rc1;
-	  dist_rphi=0;
-	  vertex_z=(vtx1rc1[2]+vtx2rc1[2])/2;
-	  dist_z=fabs(vtx1rc1[2]-vtx2rc1[2]);
-	  vertex1[0]=vtx1rc1[0];
-	  vertex1[1]=vtx1rc1[1];
-	  vertex1[2]=vtx1rc1[2];
-	  vertex2[0]=vtx2rc1[0];
-	  vertex2[1]=vtx2rc1[1];
-	  vertex2[2]=vtx2rc1[2];
-	} else {
-	  vertex_radius=rc2;
-	  dist_rphi=0;
-	  vertex_z=(vtx1rc2[2]+vtx2rc2[2])/2;
-	  dist_z=fabs(vtx1rc2[2]-vtx2rc2[2]);
-	  vertex1[0]=vtx1rc2[0];
-	  vertex1[1]=vtx1rc2[1];
-	  vertex1[2]=vtx1rc2[2];
-	  vertex2[0]=vtx2rc2[0];
-	  vertex2[1]=vtx2rc2[1];
-	  vertex2[2]=vtx2rc2[2];
-	}
+  vector<ReconstructedParticle*> particles;
+  for (int i=0; i<coll->getNumberOfElements(); i++)
+    particles.push_back(dynamic_cast<ReconstructedParticle*>(coll->getElementAt(i)));
+
+  // make the helices once, and only look at the pairs whose circles are
+  // close enough in rphi
+  HelixTable table;
+  buildHelixTable(particles,table);
+  vector< pair<int,int> > candidates;
+  findCandidatePairs(table,candidates);
+
+  for (size_t icand=0; icand<candidates.size(); icand++) {
+    int row1=candidates[icand].first;
+    int row2=candidates[icand].second;
+    int irp1=table.index[row1];
+    int irp2=table.index[row2];
+    ReconstructedParticle *rp1=particles[irp1];
+    ReconstructedParticle *rp2=particles[irp2];
+    HelixClass& helix1=table.helix[row1];
+    HelixClass& helix2=table.helix[row2];
+
+    // find intersection of helices in rphi projection
+    // calculations a la Paul Bourke, University of Western Australia
+    //
+    // distance between centres
+    double r1=table.radius[row1];
+    double r2=table.radius[row2];
+    double x1=table.xc[row1];
+    double y1=table.yc[row1];
+    double x2=table.xc[row2];
+    double y2=table.yc[row2];
+    double d=sqrt((x1-x2)*(x1-x2)+(y1-y2)*(y1-y2));
+    if (_FillHistograms) fillHistogram(HelixDist,d/(r1+r2));
+    // centre point
+    double a=(r1*r1-r2*r2+d*d)/2/d;
+    double xa=x1+a/d*(x2-x1);
+    double ya=y1+a/d*(y2-y1);
+    // do these helices intersect at all?
+    double vertex_radius, vertex_z;
+    double dist_rphi, dist_z;
+    float vertex1[3],vertex2[3];
+    float ref1[3]={helix1.getReferencePoint()[0],
+		   helix1.getReferencePoint()[1],
+		   helix1.getReferencePoint()[2]};
+    float ref2[3]={helix2.getReferencePoint()[0],
+		   helix2.getReferencePoint()[1],
+		   helix2.getReferencePoint()[2]};
+    if (d<r1+r2) {
+      // we have two possible vertices here.
+      double h=sqrt(r1*r1-a*a);
+      double xc1=xa+h*(y2-y1)/d;
+      double yc1=ya-h*(x2-x1)/d;
+      double rc1=sqrt(xc1*xc1+yc1*yc1);
+      double xc2=xa-h*(y2-y1)/d;
+      double yc2=ya+h*(x2-x1)/d;
+      double rc2=sqrt(xc2*xc2+yc2*yc2);
+      // check z coordinates to see at which candidate vertex radius
+      // the agreement is better
+      float vtx1rc1[6],vtx2rc1[6],vtx1rc2[6],vtx2rc2[6];
+      helix1.getPointOnCircle(rc1,ref1,vtx1rc1);
+      helix2.getPointOnCircle(rc1,ref2,vtx2rc1);
+      helix1.getPointOnCircle(rc2,ref1,vtx1rc2);
+      helix2.getPointOnCircle(rc2,ref2,vtx2rc2);
+      if (fabs(vtx1rc1[2]-vtx2rc1[2])<fabs(vtx1rc2[2]-vtx2rc2[2])) {
+	vertex_radius=rc1;
+	dist_rphi=0;
+	vertex_z=(vtx1rc1[2]+vtx2rc1[2])/2;
+	dist_z=fabs(vtx1rc1[2]-vtx2rc1[2]);
+	vertex1[0]=vtx1rc1[0];
+	vertex1[1]=vtx1rc1[1];
+	vertex1[2]=vtx1rc1[2];
+	vertex2[0]=vtx2rc1[0];
+	vertex2[1]=vtx2rc1[1];
+	vertex2[2]=vtx2rc1[2];
       } else {
-	// take the centre point
-	vertex_radius = sqrt(xa*xa+ya*ya);
-	float vtx1rc[6],vtx2rc[6];
-	double r1x=x1+r1/d*(x2-x1);
-	double r1y=y1+r1/d*(y2-y1);
-	helix1.getPointOnCircle(sqrt(r1x*r1x+r1y*r1y),ref1,vtx1rc);
-	double r2x=x2-r2/d*(x2-x1);
-	double r2y=y2-r2/d*(y2-y1);
-	helix2.getPointOnCircle(sqrt(r2x*r2x+r2y*r2y),ref2,vtx2rc);
-	vertex_z = (vtx1rc[2]+vtx2rc[2])/2;
-	dist_z = fabs(vtx1rc[2]-vtx2rc[2]);
-	dist_rphi = d-r1-r2;
-	vertex1[0]=vtx1rc[0];
-	vertex1[1]=vtx1rc[1];
-	vertex1[2]=vtx1rc[2];
-	vertex2[0]=vtx2rc[0];
-	vertex2[1]=vtx2rc[1];
-	vertex2[2]=vtx2rc[2];
+	vertex_radius=rc2;
+	dist_rphi=0;
+	vertex_z=(vtx1rc2[2]+vtx2rc2[2])/2;
+	dist_z=fabs(vtx1rc2[2]-vtx2rc2[2]);
+	vertex1[0]=vtx1rc2[0];
+	vertex1[1]=vtx1rc2[1];
+	vertex1[2]=vtx1rc2[2];
+	vertex2[0]=vtx2rc2[0];
+	vertex2[1]=vtx2rc2[1];
+	vertex2[2]=vtx2rc2[2];
       }
+    } else {
+      // take the centre point
+      vertex_radius = sqrt(xa*xa+ya*ya);
+      float vtx1rc[6],vtx2rc[6];
+      double r1x=x1+r1/d*(x2-x1);
+      double r1y=y1+r1/d*(y2-y1);
+      helix1.getPointOnCircle(sqrt(r1x*r1x+r1y*r1y),ref1,vtx1rc);
+      double r2x=x2-r2/d*(x2-x1);
+      double r2y=y2-r2/d*(y2-y1);
+      helix2.getPointOnCircle(sqrt(r2x*r2x+r2y*r2y),ref2,vtx2rc);
+      vertex_z = (vtx1rc[2]+vtx2rc[2])/2;
+      dist_z = fabs(vtx1rc[2]-vtx2rc[2]);
+      dist_rphi = d-r1-r2;
+      vertex1[0]=vtx1rc[0];
+      vertex1[1]=vtx1rc[1];
+      vertex1[2]=vtx1rc[2];
+      vertex2[0]=vtx2rc[0];
+      vertex2[1]=vtx2rc[1];
+      vertex2[2]=vtx2rc[2];
+    }
 
-      cout << "vertex candidate: radius=" << vertex_radius << ", z=" << vertex_z
-	   << "; distance rphi=" << dist_rphi << ", distance z=" << dist_z
-	   << endl;
-
-      // cut on distance
-      histos->fill("dist_rphi",dist_rphi,1,"helix distance in rphi",100,0,10);
-      histos->fill("dist_z",dist_z,1,"helix distance in z",100,0,10);
-      if (dist_rphi>1) continue;
-      if (dist_z>1) continue;
-
-      histos->fill("radius",vertex_radius,1,
-		   "radius of closest approach in z",100,0,2000);
-
-      // get particle momenta at vertex
-      float mom1[3],mom2[3];
-      helix1.getExtrapolatedMomentum(vertex1,mom1);
-      helix2.getExtrapolatedMomentum(vertex2,mom2);
-
-      // for some reason the extrapolation sometimes ends up with NaN momentum
-      if ( ( !(mom1[0]<0) && !(mom1[0]>=0) ) ||
-	   ( !(mom1[1]<0) && !(mom1[1]>=0) ) ||
-	   ( !(mom2[0]<0) && !(mom2[0]>=0) ) ||
-	   ( !(mom2[1]<0) && !(mom2[1]>=0) ) ) {
-	streamlog_out(ERROR) << "extrapolated momenta are NaN" << endl;
-	continue;
-      }
+    streamlog_out(DEBUG) << "vertex candidate: radius=" << vertex_radius << ", z=" << vertex_z
+			 << "; distance rphi=" << dist_rphi << ", distance z=" << dist_z
+			 << endl;
+
+    // cut on distance
+    if (_FillHistograms) {
+      fillHistogram(DistRPhi,dist_rphi);
+      fillHistogram(DistZ,dist_z);
+    }
+    if (dist_rphi>MaxDistRPhi) continue;
+    if (dist_z>MaxDistZ) continue;
+
+    if (_FillHistograms) fillHistogram(Radius,vertex_radius);
+
+    // get particle momenta at vertex
+    float mom1[3],mom2[3];
+    helix1.getExtrapolatedMomentum(vertex1,mom1);
+    helix2.getExtrapolatedMomentum(vertex2,mom2);
+
+    // for some reason the extrapolation sometimes ends up with NaN momentum
+    if ( ( !(mom1[0]<0) && !(mom1[0]>=0) ) ||
+	 ( !(mom1[1]<0) && !(mom1[1]>=0) ) ||
+	 ( !(mom2[0]<0) && !(mom2[0]>=0) ) ||
+	 ( !(mom2[1]<0) && !(mom2[1]>=0) ) ) {
+      streamlog_out(ERROR) << "extrapolated momenta are NaN" << endl;
+      continue;
+    }
 
 
-      // invariant mass of the combination: either around 0 or K0 mass?
-      double conv_mass = diParticleMass(mom1,mom2,0.000511,0.000511);
-      double K0_mass = diParticleMass(mom1,mom2,0.13957,0.13957);
-      double Lambda_mass1 = diParticleMass(mom1,mom2,0.13957,0.938);
-      double Lambda_mass2 = diParticleMass(mom2,mom1,0.13957,0.938);
-      histos->fill("conv_mass",conv_mass,1,"conv_mass",100,0,1);
-      histos->fill("K0_mass",K0_mass,1,"K0_mass",100,0,1);
-      histos->fill("Lambda_mass",Lambda_mass1,1,"Lambda_mass",100,1,2);
-      histos->fill("Lambda_mass",Lambda_mass2);
+    // invariant mass of the combination: either around 0 or K0 mass?
+    double conv_mass = diParticleMass(mom1,mom2,0.000511,0.000511);
+    double K0_mass = diParticleMass(mom1,mom2,0.13957,0.13957);
+    double Lambda_mass1 = diParticleMass(mom1,mom2,0.13957,0.938);
+    double Lambda_mass2 = diParticleMass(mom2,mom1,0.13957,0.938);
+    if (_FillHistograms) {
+      fillHistogram(ConvMass,conv_mass);
+      fillHistogram(K0Mass,K0_mass);
+      fillHistogram(LambdaMass,Lambda_mass1);
+      fillHistogram(LambdaMass,Lambda_mass2);
+    }
 
-      // check whether our candidate is either close to photon mass
-      // or K0 mass
-      if (conv_mass>0.01 && fabs(K0_mass-0.498)>0.02
-	  && fabs(Lambda_mass1-1.116)>0.02
-	  && fabs(Lambda_mass2-1.116)>0.02) continue;
+    // check whether our candidate is either close to photon mass
+    // or K0 mass
+    if (conv_mass>0.01 && fabs(K0_mass-0.498)>0.02
+	&& fabs(Lambda_mass1-1.116)>0.02
+	&& fabs(Lambda_mass2-1.116)>0.02) continue;
 
 
-      // vertex probability (cut on distance of closest approach first?)
+    // vertex probability (cut on distance of closest approach first?)
 
-      // can we improve mass resolution by track refit with vertex constraint?
+    // can we improve mass resolution by track refit with vertex constraint?
 
-      // see Erik's vertex_lcfi/algo/ twotrackpid class!
+    // see Erik's vertex_lcfi/algo/ twotrackpid class!
 
-      // we should make sure that no track is used in more than one
-      // candidate. reason: at least one of the partners will be a false
-      // conversion tag then!
+    // we should make sure that no track is used in more than one
+    // candidate. reason: at least one of the partners will be a false
+    // conversion tag then!
 
-      // whatever is left here will be stored as conversion candidate
-      ReconstructedParticleImpl* recopart = new ReconstructedParticleImpl();
-      if (conv_mass<=0.01) {
-	recopart->setType(22);
-      } else if (fabs(K0_mass-0.498)<=0.02) {
-	recopart->setType(130);
-      } else {
-	recopart->setType(3122);
-      }
-      recopart->addTrack(rp1->getTracks()[0]);
-      recopart->addTrack(rp2->getTracks()[0]);
-      recocoll->addElement(recopart);
-      tagged[irp1]=true;
-      tagged[irp2]=true;
+    // whatever is left here will be stored as conversion candidate
+    ReconstructedParticleImpl* recopart = new ReconstructedParticleImpl();
+    if (conv_mass<=0.01) {
+      recopart->setType(22);
+    } else if (fabs(K0_mass-0.498)<=0.02) {
+      recopart->setType(130);
+    } else {
+      recopart->setType(3122);
     }
+    recopart->addTrack(rp1->getTracks()[0]);
+    recopart->addTrack(rp2->getTracks()[0]);
+    recocoll->addElement(recopart);
+    tagged[irp1]=true;
+    tagged[irp2]=true;
   }
 
 
@@ -313,6 +339,95 @@ void ConversionTagger::end(){
 }
 
 
+void ConversionTagger::buildHelixTable( const vector<ReconstructedParticle*>& particles,
+					HelixTable& table ) {
+
+  // only particles with exactly one track and a charge can be used
+  for (size_t i=0; i<particles.size(); i++) {
+    ReconstructedParticle* rp=particles[i];
+    if (rp->getTracks().size()!=1) continue;
+    if (rp->getCharge()==0) continue;
+
+    Track* trk=rp->getTracks()[0];
+    HelixClass helix;
+    helix.Initialize_Canonical(trk->getPhi(),trk->getD0(),
+			       trk->getZ0(),trk->getOmega(),
+			       trk->getTanLambda(),_BField);
+
+    int row=table.index.size();
+    table.index.push_back(i);
+    table.helix.push_back(helix);
+    table.xc.push_back(helix.getXC());
+    table.yc.push_back(helix.getYC());
+    table.radius.push_back(helix.getRadius());
+    if (rp->getCharge()>0) table.positive.push_back(row);
+    else table.negative.push_back(row);
+  }
+}
+
+
+void ConversionTagger::findCandidatePairs( const HelixTable& table,
+					   vector< pair<int,int> >& pairs ) {
+
+  // Two circles can only come within MaxDistRPhi of each other if their
+  // bounding boxes, widened by MaxDistRPhi, overlap. Sort the circles of
+  // both charges by the low x edge of their boxes and sweep across them,
+  // keeping for each charge the boxes that reach the current x. Only
+  // opposite charge pairs with overlapping boxes get the exact test.
+  vector< pair<double,int> > lowEdges;
+  for (size_t i=0; i<table.positive.size(); i++) {
+    int row=table.positive[i];
+    lowEdges.push_back(make_pair(table.xc[row]-table.radius[row]-MaxDistRPhi,row));
+  }
+  for (size_t i=0; i<table.negative.size(); i++) {
+    int row=table.negative[i];
+    lowEdges.push_back(make_pair(table.xc[row]-table.radius[row]-MaxDistRPhi,row));
+  }
+  sort(lowEdges.begin(),lowEdges.end());
+
+  vector<bool> isPositive(table.index.size(),false);
+  for (size_t i=0; i<table.positive.size(); i++) isPositive[table.positive[i]]=true;
+
+  vector<int> active[2]; // rows whose boxes may still overlap, negative then positive
+  for (size_t i=0; i<lowEdges.size(); i++) {
+    double xlow=lowEdges[i].first;
+    int row=lowEdges[i].second;
+    double r=table.radius[row];
+    vector<int>& others=active[isPositive[row] ? 0 : 1];
+
+    size_t kept=0;
+    for (size_t j=0; j<others.size(); j++) {
+      int other=others[j];
+      // drop the boxes that end before this one starts
+      if (table.xc[other]+table.radius[other]+MaxDistRPhi<xlow) continue;
+      others[kept++]=other;
+
+      double dy=table.yc[row]-table.yc[other];
+      if (fabs(dy)>r+table.radius[other]+2*MaxDistRPhi) continue;
+      double dx=table.xc[row]-table.xc[other];
+      double d=sqrt(dx*dx+dy*dy);
+      if (d-r-table.radius[other]>MaxDistRPhi) continue;
+
+      // the particle that comes first in the collection is the first of the pair
+      if (table.index[row]<table.index[other]) pairs.push_back(make_pair(row,other));
+      else pairs.push_back(make_pair(other,row));
+    }
+    others.resize(kept);
+    active[isPositive[row] ? 1 : 0].push_back(row);
+  }
+
+  // test the pairs in the same order as looping over the collection would
+  sort(pairs.begin(),pairs.end());
+}
+
+
+void ConversionTagger::fillHistogram( Histogram histogram, double value ) {
+#ifdef MARLIN_USE_AIDA
+  _pHistograms[histogram]->fill(value);
+#endif
+}
+
+
 ReconstructedParticle* ConversionTagger::CreateRecoPart(Track* trk){
 
   double d0 = trk->getD0();
@@ -363,8 +478,8 @@ double ConversionTagger::diParticleMass(float* mom1,
   double e2=sqrt(mass2*mass2+mom2[0]*mom2[0]+mom2[1]*mom2[1]+mom2[2]*mom2[2]);
   double sqmass=(e1+e2)*(e1+e2);
   for (int i=0; i<3; i++) sqmass-=(mom1[i]+mom2[i])*(mom1[i]+mom2[i]);
-  cout << "diParticleMass: part1=" << mom1[0] << ", " << mom1[1] << ", " << mom1[2] << "; energy " << e1 << endl;
-  cout << "                part2=" << mom2[0] << ", " << mom2[1] << ", " << mom2[2] << "; energy " << e2 << endl;
-  cout << "                mass=" << sqrt(sqmass) << endl;
+  streamlog_out(DEBUG) << "diParticleMass: part1=" << mom1[0] << ", " << mom1[1] << ", " << mom1[2] << "; energy " << e1 << endl;
+  streamlog_out(DEBUG) << "                part2=" << mom2[0] << ", " << mom2[1] << ", " << mom2[2] << "; energy " << e2 << endl;
+  streamlog_out(DEBUG) << "                mass=" << sqrt(sqmass) << endl;
   return sqrt(sqmass);
 }
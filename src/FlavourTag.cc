@@ -5,7 +5,7 @@
 #include <sstream>
 #include <vector>
 #include <cmath>
-#include <set>
+#include <stdexcept>
 
 #include "EVENT/LCCollection.h"
 #include "IMPL/ReconstructedParticleImpl.h"
@@ -15,10 +15,14 @@
 #include "EVENT/LCFloatVec.h"
 #include "util/inc/memorymanager.h"
 #include "util/inc/vector3.h"
+#include "inc/lciointerface.h"
 
 #include "nnet/inc/NeuralNet.h"
+#include "nnet/inc/CompiledNeuralNet.h"
+#include "nnet/inc/NeuralNetPrecisionValidator.h"
+#include "../include/FlavourTagNetInputs.h"
+#include "../include/TypedCollection.h"
 
-using std::set;
 using std::string;
 
 FlavourTagProcessor aFlavourTagProcessor;
@@ -81,6 +85,26 @@ FlavourTagProcessor::FlavourTagProcessor() : marlin::Processor("FlavourTag")
 				"Filename of the previously trained 3 (or more) vertex c-tag (b background only) net"  ,
 				_filename["bc_net-3vtx"],
 				std::string("") ) ;
+	registerProcessorParameter( "InferencePrecision" , 
+				"Arithmetic used to evaluate the nets: 0 double (default), 1 single precision, 2 int8 quantised weights"  ,
+				_inferencePrecision,
+				0 ) ;
+	registerProcessorParameter( "PrecisionValidationSample" , 
+				"If set, the reference sample for each net is read from this prefix + net name + \".txt\" and used to report the effect of reduced precision"  ,
+				_precisionValidationSample,
+				std::string("") ) ;
+	registerProcessorParameter( "PrecisionValidationPurity" , 
+				"Purity at which the efficiencies of the reduced precision nets are compared"  ,
+				_precisionValidationPurity,
+				float(0.8) ) ;
+	registerProcessorParameter( "FoldInputNormalisation" , 
+				"If true the (affine) input normalisation stored with each net is folded into the weights of its first layer"  ,
+				_foldInputNormalisation,
+				bool(0) ) ;
+	registerProcessorParameter( "LazyNetLoading" , 
+				"If true the networks are only loaded when the first jet that needs them is tagged"  ,
+				_lazyNetLoading,
+				bool(0) ) ;
 }
 
 FlavourTagProcessor::~FlavourTagProcessor()
@@ -99,36 +123,13 @@ void FlavourTagProcessor::init()
 		
 	_nRun=0;
 	_evt=0;
-	//Run through the filenames given, try and open them and also see if they appear to be XML or plain text,
-	//because the neural net code causes a segmentation fault if you try and open one type as another.
+	//Check all the files are there before anything is loaded, so that a mistake in the steering file shows
+	//up at init even if the nets are only loaded later.
 	//Remember "(*i).second" is the filename and "(*i).first" is the string key that identifies the net.
 	for( std::map<std::string,std::string>::iterator iPair=_filename.begin(); iPair!=_filename.end(); ++iPair )
 	{
 		std::ifstream inputFile( (*iPair).second.c_str() );
-		if( inputFile.is_open() )
-		{
-			nnet::NeuralNet::SerialisationMode fileFormat;//whether the file is XML or PlainText
-			
-			//read the first line
-			std::string firstLine;//the first line (up until the first space) read from the file
-			inputFile >> firstLine;//check to see if this is how we expect an XML file to start
-
-			if ( firstLine=="<?xml" ) fileFormat=nnet::NeuralNet::XML;
-			else fileFormat=nnet::NeuralNet::PlainText;
-
-			inputFile.close();
-
-			//Print what we're trying to do so the user knows what's happened if this goes wrong
-			std::cout << "FlavourTag: Attempting to load the " << (*iPair).first << " network as ";
-			if( fileFormat==nnet::NeuralNet::XML ) std::cout << "XML";
-			else std::cout << "plain text";
-			std::cout << " from file " << (*iPair).second << " ..." << std::endl;
-
-			//N.B. If fileFormat is wrong could get a segmentation fault!
-			_NeuralNet[ (*iPair).first ]=new nnet::NeuralNet( (*iPair).second, fileFormat );
-			vertex_lcfi::MemoryManager<nnet::NeuralNet>::Run()->registerObject( _NeuralNet[ (*iPair).first ] );
-		}
-		else
+		if( !inputFile.is_open() )
 		{
 			std::stringstream message;
 			message << std::endl
@@ -140,6 +141,14 @@ void FlavourTagProcessor::init()
 		}
 	}
 
+	for( int category=0; category<4; ++category ) _categoryLoaded[category]=false;
+	if( _lazyNetLoading )
+	{
+		std::cout << "FlavourTag: All network files found, each network will be loaded when it is first needed." << std::endl;
+		return;
+	}
+	for( int category=1; category<=3; ++category ) _acquireNetsOfCategory( category );
+
 	// If control gets to here then all the files loaded okay. Tell the user in case something goes wrong later and this gets blamed.
 	std::cout << "FlavourTag: All networks loaded okay." << std::endl;
 }
@@ -151,32 +160,9 @@ void FlavourTagProcessor::processRunHeader( LCRunHeader* pRun )
 	std::vector<std::string> VarNames;
 	(pRun->parameters()).getStringVals(_FlavourTagInputsCollectionName,VarNames);
 	
-	set<string> AvailableNames;
-	//Fill the map realting names and indexes
-	for (size_t i = 0;i < VarNames.size();++i)
-	{
-		AvailableNames.insert(VarNames[i]);
-		_IndexOf[VarNames[i]] = i;
-	}
-	
-	//Check the required information is in the LCFloatVec
-	set<string> RequiredNames;
-	RequiredNames.insert( "D0Significance1");
-	RequiredNames.insert( "D0Significance2");
-	RequiredNames.insert( "Z0Significance1" );
-	RequiredNames.insert( "Z0Significance2" );
-	RequiredNames.insert( "JointProbRPhi");
-	RequiredNames.insert( "JointProbZ");
-	RequiredNames.insert( "Momentum1");
-	RequiredNames.insert( "Momentum2");	
-	RequiredNames.insert( "DecayLengthSignificance");
-	RequiredNames.insert( "DecayLength");
-	RequiredNames.insert( "PTCorrectedMass");
-	RequiredNames.insert( "RawMomentum");
-	RequiredNames.insert( "NumTracksInVertices" );
-	RequiredNames.insert( "SecondaryVertexProbability");
-	
-	if (!includes(AvailableNames.begin(),AvailableNames.end(),RequiredNames.begin(),RequiredNames.end()))
+	//Work out where the net inputs are, and check they are all there
+	std::vector<std::string> MissingNames=_InputMap.resolve( VarNames );
+	if( !MissingNames.empty() )
 		std::cerr << _FlavourTagInputsCollectionName << " does not contain information required by FlavourTagProcessor";
 	
 	VarNames.clear();
@@ -190,6 +176,9 @@ void FlavourTagProcessor::processRunHeader( LCRunHeader* pRun )
 
 void FlavourTagProcessor::processEvent( lcio::LCEvent* pEvent )
 {
+	//Deletes what was made for the last event, what the other processors made for this one is kept
+	LCIOConversionCache::forEvent( pEvent );
+	
 	//Get the collection of jets. Can't do anything if the collection isn't there
 	//so don't bother catching the exception and terminate.
 	lcio::LCCollection* pJetCollection=pEvent->getCollection( _JetCollectionName );
@@ -210,36 +199,24 @@ void FlavourTagProcessor::processEvent( lcio::LCEvent* pEvent )
 	LCCollectionVec* OutCollection = new LCCollectionVec("LCFloatVec");
 	pEvent->addCollection(OutCollection,_FlavourTagCollectionName);
 	
-	//loop over the jets
-	for( int a=0; a<pJetCollection->getNumberOfElements(); ++a )
-	{
-		lcio::ReconstructedParticle* pJet;
-		//Dynamic casts are not the best programming practice in the world, but I can't see another way of doing this
-		//in the LCIO framework.  This cast should be safe though because we've already tested the type.
-		pJet=dynamic_cast<lcio::ReconstructedParticle*>( pJetCollection->getElementAt(a) );
-		
-		// Find out the jet energy to work out the correct normalisation constants
-		double jetEnergy=pJet->getEnergy();
-		if( 0==jetEnergy )
-		{
-			jetEnergy=45.5;
-			if( isFirstEvent() ) std::cerr << "*** FlavourTag - Warning: Jet energy undefined, assuming 45.5GeV ***" << std::cout;
-		}
-	
-		// Variables for the normalisation of the inputs
-		double Norm_D0Significance		= 100.0;
-		double Norm_Z0Significance		= 100.0;
-		double Norm_Momentum			= jetEnergy/3.0;
-		double Norm_DecayLengthSignificance	= 6.0*jetEnergy;
-		double Norm_DecayLength			= 1.0;
-		double Norm_PTMassCorrection		= 5.0;
-		double Norm_RawMomentum			= jetEnergy;
-		double Norm_NumTracksInVertices		= 10.0;
+	//
+	// Gather the inputs of all the jets first, so that the normalisation is done in one go and
+	// each net is evaluated over all the jets it applies to at once.
+	//
+	TypedCollection<lcio::ReconstructedParticle> Jets( pJetCollection );
+	const int numberOfJets=Jets.size();
+	const int numberOfInputs=FlavourTagNetInputs::NumberOfInputs;
+	std::vector<double> NumVertices( numberOfJets );
+	std::vector<int> vertexCategory( numberOfJets );//1, 2 or 3 (3 or more vertices), 0 if there is no net for the jet
+	std::vector<double> jetEnergies( numberOfJets );
+	std::vector<double> inputs( numberOfJets*numberOfInputs );
 	
-		//
-		// See if we can get the required info from the file
-		//
-		
+	//
+	// See if we can get the required info from the file. The inputs collection is only needed if there are jets.
+	//
+	std::vector<lcio::LCFloatVec*> FTInputsOfJet;
+	if( numberOfJets>0 )
+	{
 		lcio::LCCollection* pInputs=pEvent->getCollection( _FlavourTagInputsCollectionName );
 		
 		//make sure the collection is of the right type
@@ -254,105 +231,65 @@ void FlavourTagProcessor::processEvent( lcio::LCEvent* pEvent )
 			throw lcio::EventException( message.str() );
 		}
 		
-		LCFloatVec* FTInputs = dynamic_cast<lcio::LCFloatVec*>( pInputs->getElementAt(a) );
-		double NumVertices = (*FTInputs)[_IndexOf["NumVertices"]];
+		TypedCollection<lcio::LCFloatVec> Inputs( pInputs );
+		FTInputsOfJet.assign( Inputs.begin(), Inputs.end() );
+	}
+	
+	for( int a=0; a<numberOfJets; ++a )
+	{
+		lcio::ReconstructedParticle* pJet=Jets[a];
 		
-		std::vector<double> inputs;
-		if( NumVertices==1 )
-		{
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["D0Significance1"]]/Norm_D0Significance) );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["D0Significance2"]]/Norm_D0Significance) );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["Z0Significance1"]]/Norm_Z0Significance) );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["Z0Significance2"]]/Norm_Z0Significance) );
-			inputs.push_back( (*FTInputs)[_IndexOf["JointProbRPhi"]] );
-			inputs.push_back( (*FTInputs)[_IndexOf["JointProbZ"]] );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["Momentum1"]]/Norm_Momentum) );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["Momentum2"]]/Norm_Momentum) );
-			
-		}
-		else
+		// Find out the jet energy to work out the correct normalisation constants
+		double jetEnergy=pJet->getEnergy();
+		if( 0==jetEnergy )
 		{
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["DecayLengthSignificance"]]/Norm_DecayLengthSignificance) );
-			inputs.push_back( std::tanh(((*FTInputs)[_IndexOf["DecayLength"]]/10.0)/Norm_DecayLength));
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["PTCorrectedMass"]]/Norm_PTMassCorrection) );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["RawMomentum"]]/Norm_RawMomentum) );
-			inputs.push_back( (*FTInputs)[_IndexOf["JointProbRPhi"]] );
-			inputs.push_back( (*FTInputs)[_IndexOf["JointProbZ"]] );
-			inputs.push_back( std::tanh((*FTInputs)[_IndexOf["NumTracksInVertices"]]/Norm_NumTracksInVertices) );
-			inputs.push_back( (*FTInputs)[_IndexOf["SecondaryVertexProbability"]] );
+			jetEnergy=45.5;
+			if( isFirstEvent() ) std::cerr << "*** FlavourTag - Warning: Jet energy undefined, assuming 45.5GeV ***" << std::cout;
 		}
-			
-	 	// Perform the tag.
+		jetEnergies[a]=jetEnergy;
 		
-		std::vector<double> bTagOutput;
-		std::vector<double> cTagOutput;
-		std::vector<double> cTagbBackgroundOutput;
+		LCFloatVec* FTInputs = FTInputsOfJet[a];
+		NumVertices[a] = (*FTInputs)[_InputMap.numVerticesIndex()];
+		vertexCategory[a]=_InputMap.gather( &(*FTInputs)[0], &inputs[a*numberOfInputs] );
+	}
 	
-		if( NumVertices==1 )
-		{
-			bTagOutput=_NeuralNet["b_net-1vtx"]->output( inputs );
-			cTagOutput=_NeuralNet["c_net-1vtx"]->output( inputs );
-			cTagbBackgroundOutput=_NeuralNet["bc_net-1vtx"]->output( inputs );
-		}
-		else if( NumVertices==2 )
-		{
-			bTagOutput=_NeuralNet["b_net-2vtx"]->output( inputs );
-			cTagOutput=_NeuralNet["c_net-2vtx"]->output( inputs );
-			cTagbBackgroundOutput=_NeuralNet["bc_net-2vtx"]->output( inputs );
-		}
-		else if( NumVertices>=3 )
-		{
-			bTagOutput=_NeuralNet["b_net-3vtx"]->output( inputs );
-			cTagOutput=_NeuralNet["c_net-3vtx"]->output( inputs );
-			cTagbBackgroundOutput=_NeuralNet["bc_net-3vtx"]->output( inputs );
-		}
-		else
-		{
-			//Don't know why this happens, I had thought ZVTop always returned at least the IP...
-			
-			std::cerr << "FlavourTagProcessor - Warning: Unexpected multiplicity of " << NumVertices << "!" << std::endl;
-			
-			// The output vector sizes will be zero, so the next few lines will add in the invalid
-			// output value to keep the particle ID parameters the same size as expected from the
-			// names in the run header.
-		}
+	if( _lazyNetLoading )
+		for( int a=0; a<numberOfJets; ++a ) _acquireNetsOfCategory( vertexCategory[a] );
+	
+	if( numberOfJets>0 ) FlavourTagNetInputs::normalise( numberOfJets, &vertexCategory[0], &jetEnergies[0], &inputs[0] );
+	
+	// Perform the tag. Each of the three nets of a category is run over the inputs of all the jets in that category.
+	std::vector<double> tagOutput( numberOfJets*3, -1 );
+	if( numberOfJets>0 ) FlavourTagNetInputs::tag( _CompiledNet, numberOfJets, &vertexCategory[0], &inputs[0], &tagOutput[0] );
 	
-		//
-		// Now store the data in the file
-		//
+	//
+	// Now store the data in the file
+	//
+	for( int a=0; a<numberOfJets; ++a )
+	{
 		LCFloatVec* OutVec = new LCFloatVec();
 		
-		if( bTagOutput.size()==1 ) // If NumVertices is 0, as sometimes happens, then this will be empty.
+		if( vertexCategory[a]!=0 )
 		{
-			OutVec->push_back(bTagOutput.back());
+			OutVec->push_back(tagOutput[a*3]);
+			OutVec->push_back(tagOutput[a*3+1]);
+			OutVec->push_back(tagOutput[a*3+2]);
 		}
 		else
 		{
+			//Don't know why this happens, I had thought ZVTop always returned at least the IP...
+			
+			std::cerr << "FlavourTagProcessor - Warning: Unexpected multiplicity of " << NumVertices[a] << "!" << std::endl;
+			
 			// Something has gone wrong, but some data needs to be in the file otherwise it could
 			// screw up the other parameters by putting them in a different order than expected.
-			std::cerr << "FlavourTagProcessor - Warning: b tag output has size " << bTagOutput.size()
+			std::cerr << "FlavourTagProcessor - Warning: b tag output has size 0"
 					<< ". Putting invalid output value of -1 in the LCIO file."<< std::endl;
 			OutVec->push_back(-1);
-		}
-		
-		if( cTagOutput.size()==1 )
-		{
-			OutVec->push_back(cTagOutput.back());
-		}
-		else
-		{
-			std::cerr << "FlavourTagProcessor - Warning: c tag output has size " << cTagOutput.size()
+			std::cerr << "FlavourTagProcessor - Warning: c tag output has size 0"
 					<< ". Putting invalid output value of -1 in the LCIO file."<< std::endl;
 			OutVec->push_back(-1);
-		}
-	
-		if( cTagbBackgroundOutput.size()==1 )
-		{
-			OutVec->push_back(cTagbBackgroundOutput.back());
-		}
-		else
-		{
-			std::cerr << "FlavourTagProcessor - Warning: c tag (b background only) output has size " << cTagbBackgroundOutput.size()
+			std::cerr << "FlavourTagProcessor - Warning: c tag (b background only) output has size 0"
 					<< ". Putting invalid output value of -1 in the LCIO file."<< std::endl;
 			OutVec->push_back(-1);
 		}
@@ -361,17 +298,88 @@ void FlavourTagProcessor::processEvent( lcio::LCEvent* pEvent )
 	//ofile << (*OutVec)[0] << "\t" << (*OutVec)[1] << "\t" << (*OutVec)[2] << std::endl;
 	//ofile << "----------------------" << std::endl;
 	}
-	//Clear anything that may have been allocated during this event
-	vertex_lcfi::MetaMemoryManager::Event()->delAllObjects();
 }
 
 void FlavourTagProcessor::end()
 {
 	//ofile.close();
 	//free up stuff
+	_releaseNets();
+	LCIOConversionCache::clear();
 	vertex_lcfi::MetaMemoryManager::Run()->delAllObjects();
 }
 
+void FlavourTagProcessor::_acquireNetsOfCategory( int category )
+{
+	if( category==0 || _categoryLoaded[category] ) return;
+	
+	const char* netNames[]={ "b_net", "c_net", "bc_net" };
+	const char* categoryNames[]={ "", "-1vtx", "-2vtx", "-3vtx" };
+	for( int net=0; net<3; ++net ) _acquireNet( std::string(netNames[net])+categoryNames[category] );
+	_categoryLoaded[category]=true;
+}
+
+void FlavourTagProcessor::_acquireNet( const std::string& netName )
+{
+	nnet::CompiledNeuralNet::Precision precision=nnet::CompiledNeuralNet::DoublePrecision;
+	if( _inferencePrecision==1 ) precision=nnet::CompiledNeuralNet::SinglePrecision;
+	else if( _inferencePrecision==2 ) precision=nnet::CompiledNeuralNet::QuantisedInt8;
+	
+	const std::string& fileName=_filename[netName];
+	const FlavourTagNetRegistry::Net* pNet;
+	try
+	{
+		pNet=FlavourTagNetRegistry::instance().acquire( fileName, precision, _foldInputNormalisation );
+	}
+	catch( std::runtime_error& error )
+	{
+		std::stringstream message;
+		message << std::endl
+			<< "########################################################################################\n"
+			<< "# FlavourTagProcessor -                                                                #\n"
+			<< "#   Unable to load file " << fileName << " for the " << netName << " neural net.    #\n"
+			<< "#   " << error.what() << "\n"
+			<< "########################################################################################" << std::endl;
+		throw lcio::Exception( message.str() );
+	}
+	_Net[netName]=pNet;
+	_CompiledNet[netName]=pNet->compiledNet;
+	std::cout << "FlavourTag: Using the " << netName << " network from " << pNet->fileName << std::endl;
+	
+	if( !_precisionValidationSample.empty() ) _validatePrecision( netName );
+	if( _foldInputNormalisation && !pNet->folded )
+		std::cout << "FlavourTag: The input normalisation of the " << netName << " network can't be folded into its weights, it will be done explicitly." << std::endl;
+}
+
+void FlavourTagProcessor::_releaseNets()
+{
+	for( std::map<std::string,const FlavourTagNetRegistry::Net*>::iterator iNet=_Net.begin(); iNet!=_Net.end(); ++iNet )
+		FlavourTagNetRegistry::instance().release( iNet->second );
+	_Net.clear();
+	_CompiledNet.clear();
+	for( int category=0; category<4; ++category ) _categoryLoaded[category]=false;
+}
+
+void FlavourTagProcessor::_validatePrecision( const std::string& netName )
+{
+	std::string sampleName=_precisionValidationSample+netName+".txt";
+	std::ifstream sampleFile( sampleName.c_str() );
+	if( !sampleFile.is_open() )
+	{
+		std::cout << "FlavourTag: No precision validation sample " << sampleName << " for the " << netName << " network." << std::endl;
+		return;
+	}
+	sampleFile.close();
+
+	nnet::NeuralNetDataSet referenceSample( sampleName );
+	nnet::NeuralNetPrecisionValidator validator( *_Net[netName]->neuralNet, referenceSample );
+	std::cout << "FlavourTag: Precision validation of the " << netName << " network on " << sampleName << std::endl;
+	validator.validate( nnet::CompiledNeuralNet::SinglePrecision, _precisionValidationPurity );
+	validator.print( std::cout );
+	validator.validate( nnet::CompiledNeuralNet::QuantisedInt8, _precisionValidationPurity );
+	validator.print( std::cout );
+}
+
 void FlavourTagProcessor::_displayCollectionNames( lcio::LCEvent* pEvent )
 {
 	const std::vector<std::string>* pCollectionNames=pEvent->getCollectionNames();
@@ -0,0 +1,226 @@
+#include "../include/FlavourTagInputsColumns.h"
+
+#include <iostream>
+#include <stdexcept>
+
+#ifdef USEZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+	const char* const JetColumnNames[FlavourTagInputsColumns::NumberOfJetColumns]={ "Run", "Event", "JetIndex", "JetEnergy", "JetCosTheta", "TrueJetFlavour" };
+	const FlavourTagInputsColumns::ColumnType JetColumnTypes[FlavourTagInputsColumns::NumberOfJetColumns]={ FlavourTagInputsColumns::IntColumn,
+		FlavourTagInputsColumns::IntColumn, FlavourTagInputsColumns::IntColumn, FlavourTagInputsColumns::FloatColumn,
+		FlavourTagInputsColumns::FloatColumn, FlavourTagInputsColumns::IntColumn };
+	const char Magic[ColumnFile::MagicSize]={ 'L', 'C', 'F', 'I', 'F', 'T', 'I', 'C' };
+	//Words in a chunk header: number of rows and flags
+	const int ChunkHeaderWords=2;
+
+	void appendValue( std::vector<char>& column, const void* value )
+	{
+		const char* bytes=static_cast<const char*>( value );
+		column.insert( column.end(), bytes, bytes+4 );
+	}
+
+#ifdef USEZLIB
+	//Puts the first byte of every value first, then the second bytes and so on. The high bytes of floats vary
+	//much less than the low ones, so grouping them compresses better.
+	void shuffle( const char* values, unsigned int size, char* shuffled )
+	{
+		unsigned int n=size/4;
+		for( unsigned int i=0; i<n; ++i )
+			for( unsigned int b=0; b<4; ++b ) shuffled[b*n+i]=values[i*4+b];
+	}
+
+	void unshuffle( const char* shuffled, unsigned int size, char* values )
+	{
+		unsigned int n=size/4;
+		for( unsigned int i=0; i<n; ++i )
+			for( unsigned int b=0; b<4; ++b ) values[i*4+b]=shuffled[b*n+i];
+	}
+#endif
+}
+
+const char* const* FlavourTagInputsColumns::jetColumnNames()
+{
+	return JetColumnNames;
+}
+
+FlavourTagInputsColumns::ColumnType FlavourTagInputsColumns::jetColumnType( int column )
+{
+	return JetColumnTypes[column];
+}
+
+FlavourTagInputsColumnWriter::FlavourTagInputsColumnWriter( const std::string& fileName, const std::vector<std::string>& variableNames, bool compress, int rowsPerChunk )
+	: _File( fileName, Magic, FlavourTagInputsColumns::Version, "FlavourTagInputsColumnWriter" ), _VariableNames(variableNames), _Compress(compress),
+	_RowsPerChunk( rowsPerChunk>0 ? rowsPerChunk : 65536 ), _RowsInChunk(0), _NumberOfJets(0),
+	_Columns( FlavourTagInputsColumns::NumberOfJetColumns+variableNames.size() )
+{
+#ifndef USEZLIB
+	if( _Compress )
+	{
+		std::cerr << "FlavourTagInputsColumnWriter: Built without zlib, " << fileName << " will not be compressed." << std::endl;
+		_Compress=false;
+	}
+#endif
+
+	_File.writeWord( _Columns.size() );
+	for( size_t i=0; i<_Columns.size(); ++i )
+	{
+		bool jetColumn=( i<FlavourTagInputsColumns::NumberOfJetColumns );
+		const std::string name=jetColumn ? JetColumnNames[i] : _VariableNames[i-FlavourTagInputsColumns::NumberOfJetColumns];
+		_File.writeColumn( jetColumn ? JetColumnTypes[i] : FlavourTagInputsColumns::FloatColumn, name );
+	}
+	for( size_t i=0; i<_Columns.size(); ++i ) _Columns[i].reserve( 4*_RowsPerChunk );
+}
+
+FlavourTagInputsColumnWriter::~FlavourTagInputsColumnWriter()
+{
+	try
+	{
+		close();
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << e.what() << std::endl;
+	}
+}
+
+void FlavourTagInputsColumnWriter::addJet( int runNumber, int eventNumber, int jetIndex, double jetEnergy, double jetCosTheta, int trueJetFlavour,
+	const std::vector<float>& variables )
+{
+	if( variables.size()!=_VariableNames.size() ) throw std::invalid_argument( "FlavourTagInputsColumnWriter: wrong number of variables" );
+
+	//Chunks end between events, so the jets of an event are always in the same chunk
+	if( _RowsInChunk>=_RowsPerChunk && jetIndex==0 ) _writeChunk();
+
+	float energy=jetEnergy;
+	float cosTheta=jetCosTheta;
+	appendValue( _Columns[0], &runNumber );
+	appendValue( _Columns[1], &eventNumber );
+	appendValue( _Columns[2], &jetIndex );
+	appendValue( _Columns[3], &energy );
+	appendValue( _Columns[4], &cosTheta );
+	appendValue( _Columns[5], &trueJetFlavour );
+	for( size_t i=0; i<variables.size(); ++i ) appendValue( _Columns[FlavourTagInputsColumns::NumberOfJetColumns+i], &variables[i] );
+
+	++_NumberOfJets;
+	++_RowsInChunk;
+}
+
+void FlavourTagInputsColumnWriter::close()
+{
+	if( !_File.isOpen() ) return;
+	_writeChunk();
+	_File.close();
+}
+
+void FlavourTagInputsColumnWriter::_writeChunk()
+{
+	if( _RowsInChunk==0 ) return;
+
+	//Encode every block first, as the chunk header has the size of the chunk
+	std::vector<std::vector<char> > encoded;
+	if( _Compress )
+	{
+#ifdef USEZLIB
+		encoded.resize( _Columns.size() );
+		std::vector<char> shuffled;
+		for( size_t i=0; i<_Columns.size(); ++i )
+		{
+			shuffled.resize( _Columns[i].size() );
+			shuffle( &_Columns[i][0], _Columns[i].size(), &shuffled[0] );
+			uLongf compressedSize=compressBound( shuffled.size() );
+			encoded[i].resize( compressedSize );
+			if( compress2( reinterpret_cast<Bytef*>( &encoded[i][0] ), &compressedSize, reinterpret_cast<const Bytef*>( &shuffled[0] ), shuffled.size(), Z_DEFAULT_COMPRESSION )!=Z_OK )
+				throw std::runtime_error( "FlavourTagInputsColumnWriter: compression failed" );
+			encoded[i].resize( compressedSize );
+		}
+#endif
+	}
+	const std::vector<std::vector<char> >& blocks=_Compress ? encoded : _Columns;
+
+	std::vector<unsigned int> header( ChunkHeaderWords );
+	header[0]=_RowsInChunk;
+	header[1]=_Compress ? FlavourTagInputsColumns::CompressedFlag : 0;
+	std::vector<const std::vector<char>*> blockPointers;
+	for( size_t i=0; i<blocks.size(); ++i ) blockPointers.push_back( &blocks[i] );
+	_File.writeChunk( header, blockPointers );
+
+	for( size_t i=0; i<_Columns.size(); ++i ) _Columns[i].clear();
+	_RowsInChunk=0;
+}
+
+FlavourTagInputsColumnReader::FlavourTagInputsColumnReader( const std::string& fileName )
+	: _File( fileName, Magic, FlavourTagInputsColumns::Version, "FlavourTagInputsColumnReader", "a flavour tag inputs column file" ), _NumberOfJets(0)
+{
+	unsigned int numberOfColumns=_File.readWord();
+	if( numberOfColumns<FlavourTagInputsColumns::NumberOfJetColumns ) _File.fail( "has too few columns" );
+
+	for( unsigned int i=0; i<numberOfColumns; ++i )
+	{
+		unsigned int type;
+		std::string name;
+		_File.readColumn( type, name );
+
+		if( i<FlavourTagInputsColumns::NumberOfJetColumns )
+		{
+			if( name!=JetColumnNames[i] || type!=static_cast<unsigned int>( JetColumnTypes[i] ) )
+				_File.fail( "does not have the jet columns expected" );
+		}
+		else if( type!=static_cast<unsigned int>( FlavourTagInputsColumns::FloatColumn ) )
+			_File.fail( "has a variable column that is not float" );
+		else _VariableNames.push_back( name );
+	}
+
+	_File.indexChunks( ChunkHeaderWords );
+	for( int chunk=0; chunk<_File.numberOfChunks(); ++chunk ) _NumberOfJets+=_File.chunkWord( chunk, 0 );
+
+	_Decoded.resize( numberOfColumns );
+	_Column.assign( numberOfColumns, static_cast<const void*>( 0 ) );
+}
+
+FlavourTagInputsColumnReader::~FlavourTagInputsColumnReader()
+{
+}
+
+int FlavourTagInputsColumnReader::variableIndex( const std::string& name ) const
+{
+	for( size_t i=0; i<_VariableNames.size(); ++i )
+		if( _VariableNames[i]==name ) return i;
+	return -1;
+}
+
+int FlavourTagInputsColumnReader::readChunk( int chunk )
+{
+	_File.readChunk( chunk, _Blocks, _BlockSizes );
+	if( _Blocks.size()!=_Column.size() ) _File.fail( "has a corrupt chunk" );
+	const unsigned int numberOfRows=_File.chunkWord( chunk, 0 );
+	const unsigned int flags=_File.chunkWord( chunk, 1 );
+
+	const unsigned int valuesSize=4*numberOfRows;
+	for( size_t i=0; i<_Column.size(); ++i )
+	{
+		const char* block=_Blocks[i];
+		const unsigned int blockSize=_BlockSizes[i];
+		if( !( flags&FlavourTagInputsColumns::CompressedFlag ) )
+		{
+			if( blockSize!=valuesSize ) _File.fail( "has a corrupt chunk" );
+			_Column[i]=block;
+			continue;
+		}
+#ifdef USEZLIB
+		std::vector<char> shuffled( valuesSize+1 );
+		uLongf size=valuesSize;
+		if( uncompress( reinterpret_cast<Bytef*>( &shuffled[0] ), &size, reinterpret_cast<const Bytef*>( block ), blockSize )!=Z_OK || size!=valuesSize )
+			_File.fail( "has a corrupt chunk" );
+		_Decoded[i].resize( valuesSize+1 );
+		unshuffle( &shuffled[0], valuesSize, &_Decoded[i][0] );
+		_Column[i]=&_Decoded[i][0];
+#else
+		_File.fail( "is compressed, but the package was built without zlib" );
+#endif
+	}
+	return numberOfRows;
+}
@@ -0,0 +1,125 @@
+#include "../include/FlavourTagInputsExportProcessor.h"
+#include <iostream>
+#include <sstream>
+#include <cmath>
+#include <limits>
+
+#include "EVENT/LCCollection.h"
+#include "EVENT/ReconstructedParticle.h"
+#include "EVENT/LCFloatVec.h"
+#include "EVENT/LCIntVec.h"
+#include "EVENT/LCParameters.h"
+
+#include "../include/FlavourTagInputsColumns.h"
+#include "../include/TypedCollection.h"
+
+FlavourTagInputsExportProcessor aFlavourTagInputsExportProcessor;
+
+FlavourTagInputsExportProcessor::FlavourTagInputsExportProcessor() : marlin::Processor("FlavourTagInputsExport")
+{
+	_description = "Writes the flavour tag inputs, jet energy and true flavour of every jet to a column file" ;
+
+	registerInputCollection( lcio::LCIO::RECONSTRUCTEDPARTICLE,
+				"JetCollectionName" , 
+				"Name of the collection of ReconstructedParticles that is the jet"  ,
+				_JetCollectionName ,
+				std::string("FTSelectedJets") ) ;
+	registerInputCollection( lcio::LCIO::LCFLOATVEC,
+				"FlavourTagInputsCollection" , 
+				"Name of the LCFloatVec Collection that contains the flavour tag inputs (in same order as jet collection)"  ,
+				_FlavourTagInputsCollectionName,
+				"FlavourTagInputs" ) ;
+	registerInputCollection( lcio::LCIO::LCINTVEC,
+				"TrueJetFlavourCollection" , 
+				"Name of the LCIntVec Collection that contains the true jet flavours (written as 0 if the event doesn't have it)"  ,
+				_TrueJetFlavourCollectionName,
+				"TrueJetFlavour" ) ;
+	registerProcessorParameter( "OutputFile" , 
+				"Name of the column file to write"  ,
+				_outputFileName,
+				std::string("FlavourTagInputs.ftic") ) ;
+	registerProcessorParameter( "Compress" , 
+				"If true the columns are compressed (needs the package to be built with zlib)"  ,
+				_compress,
+				bool(0) ) ;
+	registerProcessorParameter( "JetsPerChunk" , 
+				"Number of jets in each chunk of the file"  ,
+				_jetsPerChunk,
+				int(65536) ) ;
+}
+
+FlavourTagInputsExportProcessor::~FlavourTagInputsExportProcessor()
+{
+}
+
+void FlavourTagInputsExportProcessor::init()
+{
+	printParameters();
+	_writer=0;
+	_nRun=0;
+	_nEvent=0;
+}
+
+void FlavourTagInputsExportProcessor::processRunHeader( LCRunHeader* pRun )
+{
+	_nRun++;
+
+	std::vector<std::string> VarNames;
+	(pRun->parameters()).getStringVals(_FlavourTagInputsCollectionName,VarNames);
+
+	if( !_writer )
+	{
+		_writer=new FlavourTagInputsColumnWriter( _outputFileName, VarNames, _compress, _jetsPerChunk );
+	}
+	else if( VarNames!=_writer->variableNames() )
+	{
+		std::stringstream message;
+		message << "FlavourTagInputsExportProcessor: The variables in " << _FlavourTagInputsCollectionName
+			<< " are not the same in every run, so they can't all go in one column file.";
+		throw lcio::Exception( message.str() );
+	}
+}
+
+void FlavourTagInputsExportProcessor::processEvent( lcio::LCEvent* pEvent )
+{
+	if( !_writer ) throw lcio::Exception( "FlavourTagInputsExportProcessor: No run header before the first event" );
+
+	TypedCollection<lcio::ReconstructedParticle> Jets( pEvent, _JetCollectionName );
+	TypedCollection<lcio::LCFloatVec> Inputs( pEvent, _FlavourTagInputsCollectionName );
+	std::vector<lcio::LCIntVec*> TrueJets;
+	try
+	{
+		TypedCollection<lcio::LCIntVec> TrueJetCollection( pEvent, _TrueJetFlavourCollectionName );
+		TrueJets.assign( TrueJetCollection.begin(), TrueJetCollection.end() );
+	}
+	catch( lcio::DataNotAvailableException& )
+	{
+		//Not simulated data, or no flavours worked out; the flavour is left as 0
+	}
+
+	int numJets=Jets.size();
+	for( int a=0; a<numJets; ++a )
+	{
+		lcio::ReconstructedParticle* pJet=Jets[a];
+		const double* mom=pJet->getMomentum();
+		double momentum=std::sqrt( mom[0]*mom[0]+mom[1]*mom[1]+mom[2]*mom[2] );
+		double cosTheta=( momentum>0 ) ? mom[2]/momentum : std::numeric_limits<double>::quiet_NaN();
+
+		int jetType=0;
+		if( !TrueJets.empty() ) jetType=*TrueJets[a]->begin();
+
+		_writer->addJet( pEvent->getRunNumber(), pEvent->getEventNumber(), a, pJet->getEnergy(), cosTheta, jetType, *Inputs[a] );
+	}
+	++_nEvent;
+}
+
+void FlavourTagInputsExportProcessor::end()
+{
+	if( _writer )
+	{
+		std::cout << "FlavourTagInputsExport: Wrote " << _writer->numberOfJets() << " jets from " << _nEvent << " events to " << _outputFileName << std::endl;
+		_writer->close();
+		delete _writer;
+		_writer=0;
+	}
+}
@@ -0,0 +1,141 @@
+#include "../include/FlavourTagInputsExtractor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <inc/jet.h>
+#include <inc/track.h>
+#include <inc/event.h>
+#include <inc/vertex.h>
+#include <inc/decaychain.h>
+#include <algo/inc/jointprob.h>
+#include <algo/inc/paramsignificance.h>
+#include <util/inc/vector3.h>
+#include <util/inc/projection.h>
+
+using namespace vertex_lcfi;
+
+FlavourTagInputsExtractor::FlavourTagInputsExtractor( const JointProb* JointProbAlgo, const ParameterSignificance* ParameterSignificanceAlgo,
+	Algo<DecayChain*,DecayChain*>* TrackAttachAlgo, Algo<DecayChain*,double>* VertexMassAlgo, Algo<DecayChain*,double>* SecVertexProbAlgo )
+	: _JointProb(JointProbAlgo), _ParameterSignificance(ParameterSignificanceAlgo), _TrackAttach(TrackAttachAlgo), _VertexMass(VertexMassAlgo), _SecVertexProb(SecVertexProbAlgo)
+{
+}
+
+void FlavourTagInputsExtractor::calculateFor( Jet* MyJet, DecayChain* MyDecayChain,
+	const std::map<PidCutType,std::vector<vertex_lcfi::Track*> >& PIDCutTracks, std::vector<float>& Inputs )
+{
+	const std::vector<vertex_lcfi::Track*>& Tracks=MyJet->tracks();
+
+	_ExcludedTracks.clear();
+	std::map<PidCutType,std::vector<vertex_lcfi::Track*> >::const_iterator iPID;
+	for( iPID=PIDCutTracks.begin(); iPID!=PIDCutTracks.end(); ++iPID )
+		_ExcludedTracks.insert( _ExcludedTracks.end(), iPID->second.begin(), iPID->second.end() );
+	std::sort( _ExcludedTracks.begin(), _ExcludedTracks.end() );
+
+	//The track loop: joint probability (as JointProb) and the two most significant tracks (as ParameterSignificance)
+	const Projection JointProbProjection[2]={ RPhi, Z };
+	const double maxdz=_JointProb->maxD0andZ0();
+	const double maxd0sig=_JointProb->maxD0Significance();
+	double totallog[2]={ 0, 0 };
+	int ntraks[2]={ 0, 0 };
+
+	const double layershit=_ParameterSignificance->layersHit();
+	const double mommin4=_ParameterSignificance->allButOneLayersMomentumCut();
+	const double mommin5=_ParameterSignificance->allLayersMomentumCut();
+	double maxsig=-100, maxsig2=-100;
+	double maxmom=0, maxmom2=0;
+	double maxz0=-100, maxz02=-100;
+
+	for( std::vector<vertex_lcfi::Track*>::const_iterator iTrack=Tracks.begin(); iTrack!=Tracks.end(); ++iTrack )
+	{
+		vertex_lcfi::Track* ThisTrack=*iTrack;
+
+		if( std::fabs( ThisTrack->helixRep().d0() )<maxdz && std::fabs( ThisTrack->helixRep().z0() )<maxdz )
+		{
+			for( int j=0; j<2; ++j )
+			{
+				double significance=std::fabs( ThisTrack->significance( JointProbProjection[j] ) );
+				if( significance<maxd0sig )
+				{
+					totallog[j]+=_JointProb->logTrackProbability( significance, JointProbProjection[j] );
+					ntraks[j]++;
+				}
+			}
+		}
+
+		double momentum=ThisTrack->momentum().mag();
+		int layers=ThisTrack->hitsInSubDetector( 0 );
+		if( ( momentum>mommin4 && layers==( layershit-1 ) ) || ( momentum>mommin5 && layers>=layershit ) )
+		{
+			if( !std::binary_search( _ExcludedTracks.begin(), _ExcludedTracks.end(), ThisTrack ) )
+			{
+				double d0significance=ThisTrack->signedSignificance( RPhi, MyJet );
+				double z0significance=ThisTrack->signedSignificance( Z, MyJet );
+				if( d0significance>maxsig )
+				{
+					maxsig2=maxsig;
+					maxmom2=maxmom;
+					maxz02=maxz0;
+					maxsig=d0significance;
+					maxmom=momentum;
+					maxz0=z0significance;
+				}
+				else if( d0significance>maxsig2 )
+				{
+					maxsig2=d0significance;
+					maxmom2=momentum;
+					maxz02=z0significance;
+				}
+			}
+		}
+	}
+
+	Inputs.push_back( JointProb::combinedProbability( totallog[0], ntraks[0] ) );
+	Inputs.push_back( JointProb::combinedProbability( totallog[1], ntraks[1] ) );
+	Inputs.push_back( maxsig );
+	Inputs.push_back( maxsig2 );
+	Inputs.push_back( maxz0 );
+	Inputs.push_back( maxz02 );
+	Inputs.push_back( maxmom );
+	Inputs.push_back( maxmom2 );
+
+	//The vertex loop: track multiplicity (as VertexMultiplicity) and decay length significance (as VertexDecaySignificance)
+	const std::vector<vertex_lcfi::Vertex*>& Vertices=MyDecayChain->vertices();
+	int totaltracks=0;
+	double maxdecaysig=0;
+	double maxdistance=0;
+	if( Vertices.size()>1 ) //If we have more than just the IP
+	{
+		for( std::vector<vertex_lcfi::Vertex*>::const_iterator iVertex=Vertices.begin()+1; iVertex<Vertices.end(); ++iVertex )
+		{
+			totaltracks+=( *iVertex )->tracks().size();
+
+			//The first secondary is measured from the event IP, not the vertex result IP
+			vertex_lcfi::Vertex* previousVertex=( iVertex==Vertices.begin()+1 ) ? MyDecayChain->jet()->event()->ipVertex() : *( iVertex-1 );
+			double distance=( *iVertex )->distanceToVertex( previousVertex, ThreeD );
+			double error=( *iVertex )->distanceToVertexError( previousVertex, ThreeD );
+			double significance=distance/error;
+			if( significance>maxdecaysig )
+			{
+				maxdecaysig=significance;
+				maxdistance=distance;
+			}
+		}
+	}
+	Inputs.push_back( totaltracks );
+	Inputs.push_back( maxdistance );
+	Inputs.push_back( maxdecaysig );
+
+	//The decay chain with the attached tracks: momentum (as VertexMomentum), mass and probability
+	DecayChain* AttachedTracksChain=_TrackAttach->calculateFor( MyDecayChain );
+	const std::vector<vertex_lcfi::Track*>& AttachedTracks=AttachedTracksChain->allTracks();
+	Vector3 totalmom( 0, 0, 0 );
+	for( std::vector<vertex_lcfi::Track*>::const_iterator iTrack=AttachedTracks.begin(); iTrack!=AttachedTracks.end(); ++iTrack )
+		totalmom=totalmom.add( ( *iTrack )->momentum() );
+	Inputs.push_back( totalmom.mag() );
+	Inputs.push_back( _VertexMass->calculateFor( AttachedTracksChain ) );
+	Inputs.push_back( _SecVertexProb->calculateFor( AttachedTracksChain ) );
+
+	Inputs.push_back( Vertices.size() );
+	Inputs.push_back( Vertices.back()->position().mag() );
+}
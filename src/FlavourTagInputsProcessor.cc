@@ -11,6 +11,7 @@
 #include <UTIL/LCRelationNavigator.h>
 #include <IMPL/ParticleIDImpl.h>
 #include <EVENT/LCFloatVec.h>
+#include "TypedCollection.h"
 
 #include <inc/event.h>
 #include <util/inc/memorymanager.h>
@@ -184,6 +185,11 @@ FlavourTagInputsProcessor::FlavourTagInputsProcessor() : Processor("FlavourTagIn
 			      _JProbResolutionParameterZ,
 			      temp,
 			      temp.size());
+
+   registerOptionalParameter( "ValidateFusedInputs",
+			      "Also calculate the inputs with the separate algorithms and report any differences (slow)",
+			      _ValidateFusedInputs,
+			      bool(0));
 }
 
 void FlavourTagInputsProcessor::init() 
@@ -256,6 +262,10 @@ void FlavourTagInputsProcessor::init()
 	_TwoTrackPID->setDoubleParameter("RPhiCut",_PIDRPhiCut);
 	_TwoTrackPID->setDoubleParameter("SignificanceCut",_PIDSignificanceCut);
 
+	_InputsExtractor = new FlavourTagInputsExtractor(_JointProb, _ParameterSignificance, _TrackAttach, _VertexMass, _SecVertexProb);
+	MemoryManager<FlavourTagInputsExtractor>::Run()->registerObject(_InputsExtractor);
+	_nValidationDifferences = 0;
+
 }
 
 void FlavourTagInputsProcessor::processRunHeader( LCRunHeader* run) { 
@@ -296,21 +306,20 @@ if( isFirstEvent() )
 	for (unsigned int i = 0 ; i<names->size() ; ++i) std::cout << (*names)[i] << std::endl;
 }
 
-	LCCollection* JetRPCol = evt->getCollection( _JetRPColName );
-	LCCollection* DecayChainRPCol = evt->getCollection( _DecayChainRPColName );
+	TypedCollection<ReconstructedParticle> JetRPCol( evt, _JetRPColName );
+	TypedCollection<ReconstructedParticle> DecayChainRPCol( evt, _DecayChainRPColName );
 	
 	//Find the primary vertex in the event
-	LCCollection* VertexCol;
-	VertexCol = evt->getCollection( _IPVertexCollectionName );
+	TypedCollection<lcio::Vertex> VertexCol( evt, _IPVertexCollectionName );
 	
 	//Search throught the vertices in this colection to find the primary
 	Vector3 IPPos;
 	Matrix3x3 IPErr;
-	int nVerts = VertexCol->getNumberOfElements()  ;
+	int nVerts = VertexCol.size()  ;
 	bool done = 0;
 	for(int i=0; i< nVerts ; i++)
 	{
-		lcio::Vertex* iVertex = dynamic_cast<lcio::Vertex*>(VertexCol->getElementAt(i));
+		lcio::Vertex* iVertex = VertexCol[i];
 		if (iVertex->isPrimary())
 		{
 			IPPos.x() = iVertex->getPosition()[0];
@@ -328,25 +337,26 @@ if( isFirstEvent() )
 	}
 	if (!done) done = 1;//TODO Throw something
 		
-	Event* MyEvent = new Event(IPPos,IPErr);
-	MemoryManager<Event>::Event()->registerObject(MyEvent);
+	//Get the event, jets and decay chains from the conversion cache, they are shared with the other processors
+	LCIOConversionCache* Cache = LCIOConversionCache::forEvent(evt);
+	Event* MyEvent = Cache->event(_JetRPColName,IPPos,IPErr);
 	
 	std::map<Jet*,DecayChain*> DecayChainOf;
 	std::map<Jet*,ReconstructedParticle*> LCIORPOf;
 	//LCRelationNavigator RelNav(evt->getCollection(_RelationColName));
 	//std::cout << evt->getCollection(_RelationColName)->getNumberOfElements() << std::endl;
 	//Jet Loop, for each jet add it to the event and its corresponding decay chain to the map 
-	int nRCP = JetRPCol->getNumberOfElements()  ;
+	int nRCP = JetRPCol.size()  ;
 	
 	if(nRCP ==0 ) std::cerr<<"Warning: FlavourTagInputsProcessor.cc:336 : NO jets present "<<std::endl; 
 	
 	for(int i=0; i< nRCP ; i++)
 	{
-		ReconstructedParticle* JetRP = dynamic_cast<ReconstructedParticle*>(JetRPCol->getElementAt(i)); 
-		Jet* ThisJet = jetFromLCIORP(MyEvent,JetRP);
+		ReconstructedParticle* JetRP = JetRPCol[i]; 
+		Jet* ThisJet = Cache->jet(MyEvent,JetRP);
 		LCIORPOf[ThisJet] = JetRP;
 		//Assume Jets and DecayChains in same order in LCIO
-		DecayChainOf[ThisJet] = decayChainFromLCIORP(ThisJet,dynamic_cast<ReconstructedParticle*>(DecayChainRPCol->getElementAt(i)));
+		DecayChainOf[ThisJet] = Cache->decayChain(ThisJet,DecayChainRPCol[i]);
 		//Commented Out as we rely on the order of decay chains and jets being the same
 		/*//Find the Decay chain RP associated with this jet
 		std::cout << JetRPCol->getElementAt(i) <<std::endl;
@@ -371,72 +381,91 @@ if( isFirstEvent() )
 	//Loop over the jets
 	for (vector<Jet*>::const_iterator iJet=MyEvent->jets().begin();iJet != MyEvent->jets().end();++iJet)
 	{
-		LCFloatVec FlavourTagInputs;
-		
-		//Probability that all tracks consistant with IP
-		std::map<Projection,double> JointProb;
+		LCFloatVec* OutVec = new LCFloatVec();
 		
-		JointProb  = _JointProb->calculateFor(*iJet);
-		FlavourTagInputs.push_back(JointProb[RPhi]);
-		FlavourTagInputs.push_back(JointProb[Z]);
-		//FlavourTagInputs.push_back(JointProb[ThreeD]);
-		
-		//D0, Z0 significances and momentum of the two most D0 significant tracks
-		//First make a cut based on particle pid for this input
-		//TODO - Clean up
+		//First make a cut based on particle pid, used by the D0, Z0 significances and momenta of the two most D0 significant tracks
 		std::map<PidCutType, vector<vertex_lcfi::Track*> >* PIDCutTracks = new std::map<PidCutType	, vector<vertex_lcfi::Track*> >();
 		MemoryManager<std::map<PidCutType, vector<vertex_lcfi::Track*> > > ::Event()->registerObject(PIDCutTracks);
 		*PIDCutTracks = _TwoTrackPID->calculateFor(*iJet);
-		std::map<SignificanceType,double> ParSignificance;
-		_ParameterSignificance->setPointerParameter( "TwoTrackPidCut", PIDCutTracks);
-		ParSignificance  = _ParameterSignificance->calculateFor(*iJet);
-		FlavourTagInputs.push_back(ParSignificance[D0SigTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[D0SigTrack2]);
-		FlavourTagInputs.push_back(ParSignificance[Z0SigTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[Z0SigTrack2]);
-		FlavourTagInputs.push_back(ParSignificance[MomentumTrack1]);
-		FlavourTagInputs.push_back(ParSignificance[MomentumTrack2]);
 		
-		//Num Tracks in secondary and upwards vertices
-		FlavourTagInputs.push_back(_VerticesTrackMultiplicity->calculateFor(DecayChainOf[*iJet]))  ;
+		_InputsExtractor->calculateFor(*iJet, DecayChainOf[*iJet], *PIDCutTracks, *OutVec);
 		
-		//Decay Length and Significance of most significant vertex
-		std::map<DecaySignificanceType,double> DecaySignificance;
-		DecaySignificance  = _VertexDecaySignificance->calculateFor(DecayChainOf[*iJet]);
-		FlavourTagInputs.push_back(DecaySignificance[Distance]);
-		FlavourTagInputs.push_back(DecaySignificance[Significance]);
-		//Using cuts attach tracks that were not associated to the decay by vertexing
-	
-
-		DecayChain* AttachedTracksChain = _TrackAttach->calculateFor(DecayChainOf[*iJet]);
-		
-		        //Sum momentum of all tracks in decay chain (vertexed and attached)
-			FlavourTagInputs.push_back(_VertexMomentum->calculateFor(AttachedTracksChain));
-			//Vertex momentum corrected mass
-			FlavourTagInputs.push_back(_VertexMass->calculateFor(AttachedTracksChain));
-			//Probability of all tracks in decay chain belonging to one vertex
-			FlavourTagInputs.push_back(_SecVertexProb->calculateFor(AttachedTracksChain));
-			
-		//Num Vertices in the vertexing result 
-		FlavourTagInputs.push_back(DecayChainOf[*iJet]->vertices().size());
-		//std::cout << DecayChainOf[*iJet]->vertices().size();
-		//Extra Decay length from seed vertex (last vertex) to IP (IP at Origin for now)
-		//TODO De-obfuscate and upgrade to moveable IP
-		FlavourTagInputs.push_back((*(--(DecayChainOf[*iJet]->vertices().end())))->position().mag());
+		if (_ValidateFusedInputs)
+		{
+			std::vector<float> Reference;
+			_referenceInputs(*iJet, DecayChainOf[*iJet], PIDCutTracks, Reference);
+			for (unsigned int i=0; i<Reference.size() && i<_JetVariableNames.size(); ++i)
+			{
+				//Both NaN counts as the same
+				if (!((*OutVec)[i] == Reference[i]) && !((*OutVec)[i] != (*OutVec)[i] && Reference[i] != Reference[i]))
+				{
+					std::cerr << "FlavourTagInputsProcessor: " << _JetVariableNames[i] << " in event " << evt->getEventNumber()
+						  << " differs: fused " << (*OutVec)[i] << ", reference " << Reference[i] << std::endl;
+					++_nValidationDifferences;
+				}
+			}
+		}
 		
-		LCFloatVec* OutVec = new LCFloatVec(FlavourTagInputs);
 		OutCollection->addElement(OutVec);
 		
 	}//End iJet Loop
 	
 	//std::cout << ",";std::cout.flush();
-	//Clear all objects created for this event
-	MetaMemoryManager::Event()->delAllObjects();
+	//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
 	_nEvt ++ ;
 }
 
 
 
+void FlavourTagInputsProcessor::_referenceInputs( Jet* MyJet, DecayChain* MyDecayChain, std::map<PidCutType, std::vector<vertex_lcfi::Track*> >* PIDCutTracks, std::vector<float>& Inputs )
+{
+	//The inputs calculated by each algorithm separately, as FlavourTagInputsExtractor should reproduce them
+	
+	//Probability that all tracks consistant with IP
+	std::map<Projection,double> JointProb;
+	
+	JointProb  = _JointProb->calculateFor(MyJet);
+	Inputs.push_back(JointProb[RPhi]);
+	Inputs.push_back(JointProb[Z]);
+	//Inputs.push_back(JointProb[ThreeD]);
+	
+	//D0, Z0 significances and momentum of the two most D0 significant tracks
+	std::map<SignificanceType,double> ParSignificance;
+	_ParameterSignificance->setPointerParameter( "TwoTrackPidCut", PIDCutTracks);
+	ParSignificance  = _ParameterSignificance->calculateFor(MyJet);
+	Inputs.push_back(ParSignificance[D0SigTrack1]);
+	Inputs.push_back(ParSignificance[D0SigTrack2]);
+	Inputs.push_back(ParSignificance[Z0SigTrack1]);
+	Inputs.push_back(ParSignificance[Z0SigTrack2]);
+	Inputs.push_back(ParSignificance[MomentumTrack1]);
+	Inputs.push_back(ParSignificance[MomentumTrack2]);
+	
+	//Num Tracks in secondary and upwards vertices
+	Inputs.push_back(_VerticesTrackMultiplicity->calculateFor(MyDecayChain))  ;
+	
+	//Decay Length and Significance of most significant vertex
+	std::map<DecaySignificanceType,double> DecaySignificance;
+	DecaySignificance  = _VertexDecaySignificance->calculateFor(MyDecayChain);
+	Inputs.push_back(DecaySignificance[Distance]);
+	Inputs.push_back(DecaySignificance[Significance]);
+	
+	//Using cuts attach tracks that were not associated to the decay by vertexing
+	DecayChain* AttachedTracksChain = _TrackAttach->calculateFor(MyDecayChain);
+	
+	//Sum momentum of all tracks in decay chain (vertexed and attached)
+	Inputs.push_back(_VertexMomentum->calculateFor(AttachedTracksChain));
+	//Vertex momentum corrected mass
+	Inputs.push_back(_VertexMass->calculateFor(AttachedTracksChain));
+	//Probability of all tracks in decay chain belonging to one vertex
+	Inputs.push_back(_SecVertexProb->calculateFor(AttachedTracksChain));
+	
+	//Num Vertices in the vertexing result 
+	Inputs.push_back(MyDecayChain->vertices().size());
+	//Extra Decay length from seed vertex (last vertex) to IP (IP at Origin for now)
+	//TODO De-obfuscate and upgrade to moveable IP
+	Inputs.push_back((*(--(MyDecayChain->vertices().end())))->position().mag());
+}
+
 void FlavourTagInputsProcessor::check( LCEvent * evt ) { 
   // nothing to check here - could be used to fill checkplots in reconstruction processor
 }
@@ -444,6 +473,10 @@ void FlavourTagInputsProcessor::check( LCEvent * evt ) {
 
 void FlavourTagInputsProcessor::end(){ 
 	
+	_TwoTrackPID->printPairCounters(std::cout);
+	if (_ValidateFusedInputs)
+		std::cout << "FlavourTagInputsProcessor: " << _nValidationDifferences << " differences between the fused and separate calculation of the inputs" << std::endl;
+	LCIOConversionCache::clear();
 	MetaMemoryManager::Run()->delAllObjects();
    	std::cout << "FlavourTagInputsProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
@@ -0,0 +1,150 @@
+#include "../include/FlavourTagNetInputs.h"
+#include <cmath>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "nnet/inc/CompiledNeuralNet.h"
+
+namespace
+{
+	const char* const OneVertexVariables[FlavourTagNetInputs::NumberOfInputs]={ "D0Significance1", "D0Significance2",
+		"Z0Significance1", "Z0Significance2", "JointProbRPhi", "JointProbZ", "Momentum1", "Momentum2" };
+	const char* const MultiVertexVariables[FlavourTagNetInputs::NumberOfInputs]={ "DecayLengthSignificance", "DecayLength",
+		"PTCorrectedMass", "RawMomentum", "JointProbRPhi", "JointProbZ", "NumTracksInVertices", "SecondaryVertexProbability" };
+
+	//If any of these variables or normalisation constants are changed, update the documentation in the
+	//main class description in NeuralNetTrainer.h, and retrain the nets.
+
+	//How each variable is normalised: NotNormalised leaves it as it is, the others give tanh(value/x) where x is
+	//the norm (Fixed), jet energy/norm (JetEnergyFraction) or norm*jet energy (JetEnergyMultiple).
+	enum NormalisationType { NotNormalised, Fixed, JetEnergyFraction, JetEnergyMultiple };
+	struct InputNormalisation
+	{
+		NormalisationType type;
+		double norm;
+	};
+
+	const InputNormalisation OneVertexNormalisation[FlavourTagNetInputs::NumberOfInputs]={
+		{ Fixed, 100.0 },		//D0Significance1
+		{ Fixed, 100.0 },		//D0Significance2
+		{ Fixed, 100.0 },		//Z0Significance1
+		{ Fixed, 100.0 },		//Z0Significance2
+		{ NotNormalised, 0.0 },		//JointProbRPhi
+		{ NotNormalised, 0.0 },		//JointProbZ
+		{ JetEnergyFraction, 3.0 },	//Momentum1
+		{ JetEnergyFraction, 3.0 } };	//Momentum2
+	const InputNormalisation MultiVertexNormalisation[FlavourTagNetInputs::NumberOfInputs]={
+		{ JetEnergyMultiple, 6.0 },	//DecayLengthSignificance
+		{ Fixed, 10.0 },		//DecayLength (divided by 10, as in the training)
+		{ Fixed, 5.0 },			//PTCorrectedMass
+		{ JetEnergyFraction, 1.0 },	//RawMomentum
+		{ NotNormalised, 0.0 },		//JointProbRPhi
+		{ NotNormalised, 0.0 },		//JointProbZ
+		{ Fixed, 10.0 },		//NumTracksInVertices
+		{ NotNormalised, 0.0 } };	//SecondaryVertexProbability
+}
+
+const char* const* FlavourTagNetInputs::variableNames( int numberOfVertices )
+{
+	if( numberOfVertices==1 ) return OneVertexVariables;
+	else return MultiVertexVariables;
+}
+
+FlavourTagNetInputs::InputMap::InputMap() : _numVerticesIndex(0)
+{
+	for( int category=0; category<4; ++category )
+		for( int i=0; i<NumberOfInputs; ++i ) _index[category][i]=0;
+}
+
+std::vector<std::string> FlavourTagNetInputs::InputMap::resolve( const std::vector<std::string>& variableNames )
+{
+	std::map<std::string,int> indexOf;
+	for( size_t i=0; i<variableNames.size(); ++i ) indexOf[variableNames[i]]=i;
+
+	std::set<std::string> missing;
+	std::map<std::string,int>::const_iterator iVariable=indexOf.find( "NumVertices" );
+	if( iVariable!=indexOf.end() ) _numVerticesIndex=iVariable->second;
+	else
+	{
+		_numVerticesIndex=0;
+		missing.insert( "NumVertices" );
+	}
+
+	for( int category=0; category<4; ++category )
+	{
+		const char* const* names=FlavourTagNetInputs::variableNames( category );
+		for( int i=0; i<NumberOfInputs; ++i )
+		{
+			iVariable=indexOf.find( names[i] );
+			if( iVariable!=indexOf.end() ) _index[category][i]=iVariable->second;
+			else
+			{
+				_index[category][i]=0;
+				missing.insert( names[i] );
+			}
+		}
+	}
+	return std::vector<std::string>( missing.begin(), missing.end() );
+}
+
+void FlavourTagNetInputs::normalise( int numberOfJets, const int* numberOfVertices, const double* jetEnergy, double* values )
+{
+	double divisor[NumberOfInputs];
+	bool compress[NumberOfInputs];
+	for( int jet=0; jet<numberOfJets; ++jet )
+	{
+		const InputNormalisation* normalisation=( numberOfVertices[jet]==1 ) ? OneVertexNormalisation : MultiVertexNormalisation;
+
+		//Work out the divisors for this jet first so that the loop doing the work has no branches on the type
+		for( int i=0; i<NumberOfInputs; ++i )
+		{
+			compress[i]=( normalisation[i].type!=NotNormalised );
+			if( normalisation[i].type==JetEnergyFraction ) divisor[i]=jetEnergy[jet]/normalisation[i].norm;
+			else if( normalisation[i].type==JetEnergyMultiple ) divisor[i]=normalisation[i].norm*jetEnergy[jet];
+			else divisor[i]=normalisation[i].norm;
+		}
+
+		double* x=values+jet*NumberOfInputs;
+		for( int i=0; i<NumberOfInputs; ++i )
+			if( compress[i] ) x[i]=std::tanh( x[i]/divisor[i] );
+	}
+}
+
+int FlavourTagNetInputs::vertexCategory( double numberOfVertices )
+{
+	if( numberOfVertices==1 ) return 1;
+	else if( numberOfVertices==2 ) return 2;
+	else if( numberOfVertices>=3 ) return 3;
+	else return 0;
+}
+
+void FlavourTagNetInputs::tag( const std::map<std::string,const nnet::CompiledNeuralNet*>& nets, int numberOfJets, const int* vertexCategory,
+	const double* values, double* tags )
+{
+	const char* netNames[]={ "b_net", "c_net", "bc_net" };
+	const char* categoryNames[]={ "", "-1vtx", "-2vtx", "-3vtx" };
+	for( int i=0; i<numberOfJets*3; ++i ) tags[i]=-1;
+	for( int category=1; category<=3; ++category )
+	{
+		std::vector<int> jets;
+		std::vector<double> categoryInputs;
+		for( int a=0; a<numberOfJets; ++a )
+		{
+			if( vertexCategory[a]!=category ) continue;
+			jets.push_back( a );
+			categoryInputs.insert( categoryInputs.end(), values+a*NumberOfInputs, values+(a+1)*NumberOfInputs );
+		}
+		if( jets.empty() ) continue;
+
+		std::vector<double> netOutput( jets.size() );
+		for( int net=0; net<3; ++net )
+		{
+			const std::string netName=std::string(netNames[net])+categoryNames[category];
+			std::map<std::string,const nnet::CompiledNeuralNet*>::const_iterator iNet=nets.find( netName );
+			if( iNet==nets.end() ) throw std::runtime_error( "FlavourTagNetInputs::tag: there is no " + netName + " net for the jets with that vertex category" );
+			iNet->second->batchOutput( &categoryInputs[0], jets.size(), &netOutput[0] );
+			for( size_t j=0; j<jets.size(); ++j ) tags[jets[j]*3+net]=netOutput[j];
+		}
+	}
+}
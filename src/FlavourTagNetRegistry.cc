@@ -0,0 +1,216 @@
+#include "../include/FlavourTagNetRegistry.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include "nnet/inc/NeuralNet.h"
+
+namespace
+{
+	//32 bit FNV-1a hash of the file contents
+	unsigned int contentHash( const std::string& contents )
+	{
+		unsigned int hash=2166136261u;
+		for( std::string::const_iterator i=contents.begin(); i!=contents.end(); ++i )
+		{
+			hash^=static_cast<unsigned char>( *i );
+			hash*=16777619u;
+		}
+		return hash;
+	}
+
+	//The whole of the file, read as bytes
+	std::string fileContents( const std::string& fileName )
+	{
+		std::ifstream inputFile( fileName.c_str(), std::ios::in|std::ios::binary );
+		if( !inputFile.is_open() ) throw std::runtime_error( "FlavourTagNetRegistry: Unable to open file " + fileName );
+		std::ostringstream contents;
+		contents << inputFile.rdbuf();
+		return contents.str();
+	}
+
+	//The canonical path of the file, or the name as given if that can't be found
+	std::string canonicalFileName( const std::string& fileName )
+	{
+#ifndef _WIN32
+		char* pPath=realpath( fileName.c_str(), 0 );
+		if( pPath )
+		{
+			std::string path( pPath );
+			std::free( pPath );
+			return path;
+		}
+#endif
+		return fileName;
+	}
+}
+
+FlavourTagNetRegistry& FlavourTagNetRegistry::instance()
+{
+	static FlavourTagNetRegistry registry;
+	return registry;
+}
+
+FlavourTagNetRegistry::FlavourTagNetRegistry()
+{
+#ifndef _WIN32
+	pthread_mutex_init( &_Mutex, 0 );
+#endif
+}
+
+FlavourTagNetRegistry::~FlavourTagNetRegistry()
+{
+	for( std::map<Key,Entry>::iterator iEntry=_Nets.begin(); iEntry!=_Nets.end(); ++iEntry ) _delete( iEntry->second.pNet );
+#ifndef _WIN32
+	pthread_mutex_destroy( &_Mutex );
+#endif
+}
+
+bool FlavourTagNetRegistry::Key::operator<( const Key& other ) const
+{
+	if( contentHash!=other.contentHash ) return contentHash<other.contentHash;
+	if( contentSize!=other.contentSize ) return contentSize<other.contentSize;
+	if( precision!=other.precision ) return precision<other.precision;
+	if( fold!=other.fold ) return fold<other.fold;
+	return fileName<other.fileName;
+}
+
+const FlavourTagNetRegistry::Net* FlavourTagNetRegistry::acquire( const std::string& fileName, nnet::CompiledNeuralNet::Precision precision, bool fold )
+{
+	//Reading the file to hash it is cheap next to parsing it, so it is done every time
+	std::string contents=fileContents( fileName );
+
+	Key key;
+	key.fileName=canonicalFileName( fileName );
+	key.precision=precision;
+	key.fold=fold;
+
+	for( int attempt=1; ; ++attempt )
+	{
+		key.contentHash=contentHash( contents );
+		key.contentSize=contents.size();
+
+		_lock();
+		std::map<Key,Entry>::iterator iEntry=_Nets.find( key );
+		if( iEntry!=_Nets.end() )
+		{
+			++iEntry->second.users;
+			_unlock();
+			return iEntry->second.pNet;
+		}
+		_unlock();
+
+		//The neural net code crashes if a file is opened as the wrong type, so check which it is first
+		std::string firstWord;
+		std::istringstream firstLine( contents );
+		firstLine >> firstWord;
+		Net* pNet=_load( key.fileName, firstWord, precision, fold );
+
+		//The net code can only parse a file by name, so it may have read something other than the contents
+		//the key was made from if the file was rewritten in between. Check, and load it again if so.
+		std::string loadedContents=fileContents( fileName );
+		if( loadedContents!=contents )
+		{
+			_delete( pNet );
+			if( attempt==MaximumLoadAttempts ) throw std::runtime_error( "FlavourTagNetRegistry: " + fileName + " keeps changing while it is being loaded" );
+			contents.swap( loadedContents );
+			continue;
+		}
+
+		_lock();
+		iEntry=_Nets.find( key );
+		if( iEntry==_Nets.end() )
+		{
+			Entry entry;
+			entry.pNet=pNet;
+			entry.users=0;
+			iEntry=_Nets.insert( std::make_pair( key, entry ) ).first;
+			pNet=0;
+		}
+		++iEntry->second.users;
+		const Net* pResult=iEntry->second.pNet;
+		_unlock();
+
+		//Another thread loaded the same net in the meantime
+		if( pNet ) _delete( pNet );
+		return pResult;
+	}
+}
+
+void FlavourTagNetRegistry::release( const Net* pNet )
+{
+	Net* pUnused=0;
+	_lock();
+	for( std::map<Key,Entry>::iterator iEntry=_Nets.begin(); iEntry!=_Nets.end(); ++iEntry )
+	{
+		if( iEntry->second.pNet!=pNet ) continue;
+		if( --iEntry->second.users==0 )
+		{
+			pUnused=iEntry->second.pNet;
+			_Nets.erase( iEntry );
+		}
+		break;
+	}
+	_unlock();
+	if( pUnused ) _delete( pUnused );
+}
+
+int FlavourTagNetRegistry::numberOfNets() const
+{
+	_lock();
+	int number=_Nets.size();
+	_unlock();
+	return number;
+}
+
+FlavourTagNetRegistry::Net* FlavourTagNetRegistry::_load( const std::string& fileName, const std::string& firstWord, nnet::CompiledNeuralNet::Precision precision, bool fold )
+{
+	nnet::NeuralNet::SerialisationMode fileFormat=( firstWord=="<?xml" ) ? nnet::NeuralNet::XML : nnet::NeuralNet::PlainText;
+
+	//Print what we're trying to do so the user knows what's happened if this goes wrong
+	std::cout << "FlavourTagNetRegistry: Loading " << fileName << " as " << ( fileFormat==nnet::NeuralNet::XML ? "XML" : "plain text" ) << " ..." << std::endl;
+
+	//N.B. If fileFormat is wrong could get a segmentation fault!
+	nnet::NeuralNet* pNeuralNet=new nnet::NeuralNet( fileName, fileFormat );
+	nnet::CompiledNeuralNet* pCompiledNet=0;
+	try
+	{
+		pCompiledNet=new nnet::CompiledNeuralNet( *pNeuralNet, precision );
+	}
+	catch( ... )
+	{
+		delete pNeuralNet;
+		throw;
+	}
+
+	Net* pNet=new Net;
+	pNet->fileName=fileName;
+	pNet->folded=fold && pCompiledNet->setFoldedNormalisation( true );
+	pNet->neuralNet=pNeuralNet;
+	pNet->compiledNet=pCompiledNet;
+	return pNet;
+}
+
+void FlavourTagNetRegistry::_delete( Net* pNet )
+{
+	delete pNet->compiledNet;
+	delete pNet->neuralNet;
+	delete pNet;
+}
+
+void FlavourTagNetRegistry::_lock() const
+{
+#ifndef _WIN32
+	pthread_mutex_lock( &_Mutex );
+#endif
+}
+
+void FlavourTagNetRegistry::_unlock() const
+{
+#ifndef _WIN32
+	pthread_mutex_unlock( &_Mutex );
+#endif
+}
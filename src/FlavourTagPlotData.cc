@@ -0,0 +1,242 @@
+#include "../include/FlavourTagPlotData.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+	const char* const FileHeader="FlavourTagPlotData";
+	const int FileVersion=1;
+
+	const char* const VertexCategoryNames[FlavourTagPlotData::NumberOfVertexCategories]={ "AnyNumberOfVertices", "OneVertex", "TwoVertices",
+		"ThreeOrMoreVertices" };
+	const char* const TagNames[FlavourTagPlotData::NumberOfTags]={ "BTag", "CTag", "BCTag" };
+	const char* const FlavourNames[FlavourTagPlotData::NumberOfFlavours]={ "B", "C", "Light" };
+
+	//The signal of each tag, and which flavours are background to it (the bc tag only has b background)
+	const FlavourTagPlotData::Flavour SignalFlavour[FlavourTagPlotData::NumberOfTags]={ FlavourTagPlotData::BJet, FlavourTagPlotData::CJet,
+		FlavourTagPlotData::CJet };
+	const bool IsBackground[FlavourTagPlotData::NumberOfTags][FlavourTagPlotData::NumberOfFlavours]={ { false, true, true },
+		{ true, false, true }, { true, false, false } };
+
+	//The number of entries of a tag value histogram at or above cut
+	double numberPassing( vertex_lcfi::util::binned_histogram_data<double>& values, double cut )
+	{
+		return values.number_of_entries()-values.number_below( cut );
+	}
+}
+
+FlavourTagPlotData::FlavourTagPlotData() : _NumberOfTagBins(0), _NumberOfAngleBins(0)
+{
+}
+
+FlavourTagPlotData::FlavourTagPlotData( const std::vector<std::string>& tagCollectionNames, int numberOfTagBins, int numberOfAngleBins )
+	: _TagCollectionNames(tagCollectionNames), _NumberOfTagBins(numberOfTagBins), _NumberOfAngleBins(numberOfAngleBins),
+	_TagValues( tagCollectionNames.size()*NumberOfVertexCategories*numberOfAngleBins*NumberOfFlavours*NumberOfTags,
+		vertex_lcfi::util::binned_histogram_data<double>( numberOfTagBins, 0, 1 ) ),
+	_VertexChargeCounts( 2*numberOfAngleBins*NumberOfTrueCharges*NumberOfChargeSigns, 0 )
+{
+}
+
+size_t FlavourTagPlotData::_index( int tagCollection, int vertexCategory, int angleBin, int flavour, int tag ) const
+{
+	return (((size_t(tagCollection)*NumberOfVertexCategories+vertexCategory)*_NumberOfAngleBins+angleBin)*NumberOfFlavours+flavour)*NumberOfTags+tag;
+}
+
+size_t FlavourTagPlotData::_chargeIndex( int flavour, int angleBin, int trueCharge, int sign ) const
+{
+	return ((size_t(flavour)*_NumberOfAngleBins+angleBin)*NumberOfTrueCharges+(trueCharge-MinimumTrueCharge))*NumberOfChargeSigns+sign;
+}
+
+int FlavourTagPlotData::angleBin( double cosTheta ) const
+{
+	int bin=int( std::fabs( cosTheta )*_NumberOfAngleBins );
+	if( bin>=_NumberOfAngleBins || bin<0 ) bin=_NumberOfAngleBins-1; //also catches NaN
+	return bin;
+}
+
+void FlavourTagPlotData::addJet( int tagCollection, int vertexCategory, double cosTheta, Flavour flavour, double bTag, double cTag, double bcTag )
+{
+	if( vertexCategory<0 || vertexCategory>=NumberOfVertexCategories ) vertexCategory=NumberOfVertexCategories-1;
+	const size_t index=_index( tagCollection, vertexCategory, angleBin( cosTheta ), flavour, 0 );
+	_TagValues[index+BTag].add( bTag );
+	_TagValues[index+CTag].add( cTag );
+	_TagValues[index+BCTag].add( bcTag );
+}
+
+void FlavourTagPlotData::addVertexCharge( Flavour flavour, double cosTheta, int trueCharge, int vertexCharge )
+{
+	if( flavour==LightJet || trueCharge<MinimumTrueCharge || trueCharge>MaximumTrueCharge ) return;
+	ChargeSign sign=( vertexCharge>0 ) ? PositiveCharge : ( vertexCharge<0 ) ? NegativeCharge : NeutralCharge;
+	++_VertexChargeCounts[_chargeIndex( flavour, angleBin( cosTheta ), trueCharge, sign )];
+}
+
+void FlavourTagPlotData::merge( const FlavourTagPlotData& other )
+{
+	if( other._NumberOfTagBins==0 ) return;
+	if( _NumberOfTagBins==0 )
+	{
+		*this=other;
+		return;
+	}
+	if( other._TagCollectionNames!=_TagCollectionNames || other._NumberOfTagBins!=_NumberOfTagBins || other._NumberOfAngleBins!=_NumberOfAngleBins )
+		throw std::runtime_error( "FlavourTagPlotData: can't merge results with different tag collections or binning" );
+
+	for( size_t i=0; i<_TagValues.size(); ++i ) _TagValues[i].merge( other._TagValues[i] );
+	for( size_t i=0; i<_VertexChargeCounts.size(); ++i ) _VertexChargeCounts[i]+=other._VertexChargeCounts[i];
+}
+
+void FlavourTagPlotData::write( std::ostream& output ) const
+{
+	output << FileHeader << " " << FileVersion << "\n"
+		<< _TagCollectionNames.size() << " " << _NumberOfTagBins << " " << _NumberOfAngleBins << "\n";
+	for( size_t i=0; i<_TagCollectionNames.size(); ++i ) output << _TagCollectionNames[i] << "\n";
+	for( size_t i=0; i<_TagValues.size(); ++i ) _TagValues[i].write( output );
+
+	std::streamsize oldPrecision=output.precision( 17 );
+	for( size_t i=0; i<_VertexChargeCounts.size(); ++i ) output << _VertexChargeCounts[i] << ( ( i+1==_VertexChargeCounts.size() ) ? "\n" : " " );
+	output.precision( oldPrecision );
+}
+
+void FlavourTagPlotData::write( const std::string& fileName ) const
+{
+	const std::string temporaryFileName=fileName+".tmp";
+	std::ofstream output( temporaryFileName.c_str() );
+	if( !output.is_open() ) throw std::runtime_error( "FlavourTagPlotData: unable to open " + temporaryFileName );
+	write( output );
+	output.close();
+	if( output.fail() || std::rename( temporaryFileName.c_str(), fileName.c_str() )!=0 )
+		throw std::runtime_error( "FlavourTagPlotData: unable to write " + fileName );
+}
+
+bool FlavourTagPlotData::read( std::istream& input )
+{
+	std::string header;
+	int version;
+	size_t numberOfCollections;
+	int numberOfTagBins;
+	int numberOfAngleBins;
+	input >> header >> version >> numberOfCollections >> numberOfTagBins >> numberOfAngleBins;
+	if( !input || header!=FileHeader || version!=FileVersion || numberOfTagBins<=0 || numberOfAngleBins<=0 ) return false;
+
+	std::vector<std::string> names( numberOfCollections );
+	for( size_t i=0; i<numberOfCollections; ++i ) input >> names[i];
+	*this=FlavourTagPlotData( names, numberOfTagBins, numberOfAngleBins );
+
+	for( size_t i=0; i<_TagValues.size(); ++i )
+		if( !_TagValues[i].read( input ) ) return false;
+	for( size_t i=0; i<_VertexChargeCounts.size(); ++i ) input >> _VertexChargeCounts[i];
+	return !input.fail();
+}
+
+void FlavourTagPlotData::read( const std::string& fileName )
+{
+	std::ifstream input( fileName.c_str() );
+	if( !input.is_open() ) throw std::runtime_error( "FlavourTagPlotData: unable to open " + fileName );
+	if( !read( input ) ) throw std::runtime_error( "FlavourTagPlotData: " + fileName + " is not a partial results file or is incomplete" );
+}
+
+vertex_lcfi::util::binned_histogram_data<double> FlavourTagPlotData::tagValues( int tagCollection, int vertexCategory, int angleBin, Flavour flavour, Tag tag ) const
+{
+	vertex_lcfi::util::binned_histogram_data<double> sum( _NumberOfTagBins, 0, 1 );
+	for( int category=0; category<NumberOfVertexCategories; ++category )
+	{
+		if( vertexCategory>=0 && category!=vertexCategory ) continue;
+		for( int bin=0; bin<_NumberOfAngleBins; ++bin )
+			if( angleBin<0 || bin==angleBin ) sum.merge( _TagValues[_index( tagCollection, category, bin, flavour, tag )] );
+	}
+	return sum;
+}
+
+double FlavourTagPlotData::vertexChargeCount( Flavour flavour, int angleBin, int trueCharge, ChargeSign sign ) const
+{
+	if( flavour==LightJet || trueCharge<MinimumTrueCharge || trueCharge>MaximumTrueCharge ) return 0;
+	return _VertexChargeCounts[_chargeIndex( flavour, angleBin, trueCharge, sign )];
+}
+
+double FlavourTagPlotData::vertexChargeLeakage( Flavour flavour, int angleBin, double& error ) const
+{
+	double rightSign=0;
+	double total=0;
+	for( int trueCharge=MinimumTrueCharge; trueCharge<=MaximumTrueCharge; ++trueCharge )
+	{
+		if( trueCharge==0 ) continue;
+		for( int sign=0; sign<NumberOfChargeSigns; ++sign ) total+=vertexChargeCount( flavour, angleBin, trueCharge, ChargeSign(sign) );
+		rightSign+=vertexChargeCount( flavour, angleBin, trueCharge, ( trueCharge>0 ) ? PositiveCharge : NegativeCharge );
+	}
+
+	error=0;
+	if( total==0 ) return 0;
+	double leakage=1.0-rightSign/total;
+	error=std::sqrt( leakage*(1.0-leakage)/total );
+	return leakage;
+}
+
+void FlavourTagPlotData::writeCurves( const std::string& fileNameBase ) const
+{
+	for( size_t iCollection=0; iCollection<_TagCollectionNames.size(); ++iCollection )
+	{
+		//Category 0 of the curves is all the jets, whether the vertex category is known or not
+		for( int category=0; category<NumberOfVertexCategories; ++category )
+		{
+			const std::string fileName=fileNameBase + "-" + _TagCollectionNames[iCollection] + "-" + VertexCategoryNames[category] + ".csv";
+			std::ofstream output( fileName.c_str() );
+			if( !output.is_open() ) throw std::runtime_error( "FlavourTagPlotData: unable to open " + fileName );
+
+			std::vector<vertex_lcfi::util::binned_histogram_data<double> > values;
+			output << "Cut";
+			for( int tag=0; tag<NumberOfTags; ++tag )
+			{
+				output << "," << TagNames[tag] << " efficiency," << TagNames[tag] << " purity";
+				for( int flavour=0; flavour<NumberOfFlavours; ++flavour )
+				{
+					values.push_back( tagValues( iCollection, ( category==0 ) ? -1 : category, -1, Flavour(flavour), Tag(tag) ) );
+					if( IsBackground[tag][flavour] ) output << "," << FlavourNames[flavour] << " leakage into " << TagNames[tag];
+				}
+			}
+			output << "\n";
+
+			//The cuts go from the highest to the lowest, as in LCFIAIDAPlotProcessor
+			for( int bin=_NumberOfTagBins-1; bin>=0; --bin )
+			{
+				const double cut=double(bin)/_NumberOfTagBins;
+				output << cut;
+				for( int tag=0; tag<NumberOfTags; ++tag )
+				{
+					vertex_lcfi::util::binned_histogram_data<double>* flavourValues=&values[tag*NumberOfFlavours];
+					const double signal=numberPassing( flavourValues[SignalFlavour[tag]], cut );
+					const double totalSignal=numberPassing( flavourValues[SignalFlavour[tag]], 0 );
+					double background=0;
+					for( int flavour=0; flavour<NumberOfFlavours; ++flavour )
+						if( IsBackground[tag][flavour] ) background+=numberPassing( flavourValues[flavour], cut );
+
+					output << "," << ( ( totalSignal>0 ) ? signal/totalSignal : 0 ) << "," << ( ( signal+background>0 ) ? signal/(signal+background) : 0 );
+					for( int flavour=0; flavour<NumberOfFlavours; ++flavour )
+					{
+						if( !IsBackground[tag][flavour] ) continue;
+						const double total=numberPassing( flavourValues[flavour], 0 );
+						output << "," << ( ( total>0 ) ? numberPassing( flavourValues[flavour], cut )/total : 0 );
+					}
+				}
+				output << "\n";
+			}
+			if( output.fail() ) throw std::runtime_error( "FlavourTagPlotData: unable to write " + fileName );
+		}
+	}
+
+	const std::string fileName=fileNameBase + "-VertexCharge.csv";
+	std::ofstream output( fileName.c_str() );
+	if( !output.is_open() ) throw std::runtime_error( "FlavourTagPlotData: unable to open " + fileName );
+	output << "|cos(theta)| low,|cos(theta)| high,B jet leakage,B jet leakage error,C jet leakage,C jet leakage error\n";
+	for( int bin=0; bin<_NumberOfAngleBins; ++bin )
+	{
+		double bError, cError;
+		double bLeakage=vertexChargeLeakage( BJet, bin, bError );
+		double cLeakage=vertexChargeLeakage( CJet, bin, cError );
+		output << double(bin)/_NumberOfAngleBins << "," << double(bin+1)/_NumberOfAngleBins << "," << bLeakage << "," << bError << ","
+			<< cLeakage << "," << cError << "\n";
+	}
+	if( output.fail() ) throw std::runtime_error( "FlavourTagPlotData: unable to write " + fileName );
+}
@@ -171,6 +171,11 @@ LCFIAIDAPlotProcessor::LCFIAIDAPlotProcessor() : marlin::Processor( "LCFIAIDAPlo
 			     _iVertexChargeTagCollection,
 			     int(0));
 
+  registerOptionalParameter( "PartialResultsFile" , 
+			     "Filename to write the binned tag values and vertex charge counts to, so that the results of many jobs can be combined with lcfimergeplots.  If left blank, nothing is written.",
+			     _PartialResultsFile,
+			     std::string("") ) ;
+
 } 
 
 LCFIAIDAPlotProcessor::~LCFIAIDAPlotProcessor() 
@@ -209,6 +214,7 @@ void LCFIAIDAPlotProcessor::init()
 
   _numberOfPoints=100;
 
+  _PartialResults = FlavourTagPlotData( _FlavourTagCollectionNames, _numberOfPoints, N_JETANGLE_BINS );
   
   _pBJetBTag.resize( _FlavourTagCollectionNames.size() );
   _pBJetCTag.resize( _FlavourTagCollectionNames.size() );
@@ -697,6 +703,18 @@ void LCFIAIDAPlotProcessor::check( LCEvent* pEvent )
 
 void LCFIAIDAPlotProcessor::end() 
 {
+  if( !_PartialResultsFile.empty() )
+    {
+      try
+	{
+	  _PartialResults.write( _PartialResultsFile );
+	}
+      catch( std::exception& error )
+	{
+	  std::cerr << " In " << __FILE__ << "(" << __LINE__ << "): " << error.what() << std::endl;
+	}
+    }
+  
   
   AIDA::IHistogramFactory* pHistogramFactory=marlin::AIDAProcessor::histogramFactory( this );
   AIDA::IDataPointSetFactory* pDataPointSetFactory=marlin::AIDAProcessor::dataPointSetFactory(this);
@@ -1057,6 +1075,11 @@ void LCFIAIDAPlotProcessor::FillTagPlots( LCEvent* pEvent, unsigned int jetNumbe
 	      int trueJetCharge = int(FindJetHadronCharge(pEvent,jetNumber));
 	      
 	      std::string nvname = _VertexCatNames[ (NumVertices>=N_VERTEX_CATEGORIES) ? (N_VERTEX_CATEGORIES) : (NumVertices)];
+
+	      FlavourTagPlotData::Flavour flavour = FlavourTagPlotData::LightJet;
+	      if( jetType==B_JET ) flavour = FlavourTagPlotData::BJet;
+	      else if( jetType==C_JET ) flavour = FlavourTagPlotData::CJet;
+	      _PartialResults.addJet( iTagCollection, (NumVertices>=3) ? 3 : NumVertices, cosTheta, flavour, bTag, cTag, cTagBBack );
 	      
 	      if( jetType==B_JET )  {
 
@@ -1149,6 +1172,7 @@ void LCFIAIDAPlotProcessor::FillTagPlots( LCEvent* pEvent, unsigned int jetNumbe
 		if( jetType==C_JET && cTag > _CTagNNCut) {
 		  
 		  int bin = _pCJetLeakageRate->coordToIndex(fabs(cosTheta));
+		  _PartialResults.addVertexCharge( FlavourTagPlotData::CJet, cosTheta, trueJetCharge, CQVtx );
 		  
 		  if (trueJetCharge==+2)   _cJet_truePlus2++;
 		  if (trueJetCharge==+1)   _cJet_truePlus++;
@@ -1220,6 +1244,7 @@ void LCFIAIDAPlotProcessor::FillTagPlots( LCEvent* pEvent, unsigned int jetNumbe
 		} else if ( jetType==B_JET && bTag > _BTagNNCut) {
 		  
 		  int bin = _pBJetLeakageRate->coordToIndex(fabs(cosTheta));
+		  _PartialResults.addVertexCharge( FlavourTagPlotData::BJet, cosTheta, trueJetCharge, BQVtx );
 		  
 		  if (trueJetCharge==+2)   _bJet_truePlus2++;
 		  if (trueJetCharge==+1)   _bJet_truePlus++;
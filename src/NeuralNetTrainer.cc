@@ -5,7 +5,8 @@
 #include <sstream>
 #include <vector>
 #include <cmath>
-#include <set>
+#include <cstdio>
+#include <iterator>
 
 
 #include "EVENT/LCCollection.h"
@@ -16,11 +17,17 @@
 
 #include "util/inc/memorymanager.h"
 #include "util/inc/vector3.h"
+#include "inc/lciointerface.h"
 
 #include "nnet/inc/NeuralNet.h"
 #include "nnet/inc/NeuralNetDataSet.h"
 #include "nnet/inc/SigmoidNeuronBuilder.h"
 #include "nnet/inc/BackPropagationCGAlgorithm.h"
+#include "nnet/inc/RandomNumberUtils.h"
+
+#include "../include/FlavourTagInputsColumns.h"
+#include "../include/FlavourTagNetInputs.h"
+#include "../include/TypedCollection.h"
 
 //Needs to be instantiated for Marlin to know about it (I think)
 NeuralNetTrainerProcessor aNeuralNetTrainerProcessor;
@@ -91,6 +98,22 @@ NeuralNetTrainerProcessor::NeuralNetTrainerProcessor() : marlin::Processor("Neur
 				"Output filename for the trained net. If it is blank (default) then this net is not trained"  ,
 				_filename["bc_net-3vtx"],
 				std::string("") ) ;
+	registerProcessorParameter( "NumberOfTrainingThreads" , 
+				"Number of threads used to evaluate the error function of each net during training, 0 for one per processor (default 1)"  ,
+				_numberOfTrainingThreads,
+				int(1) ) ;
+	registerProcessorParameter( "NumberOfConcurrentNets" , 
+				"Number of nets trained at the same time, each in its own thread, 0 for one per processor (default 1)"  ,
+				_numberOfConcurrentNets,
+				int(1) ) ;
+	registerProcessorParameter( "RandomSeed" , 
+				"Seed for the initial weights of the nets. Each net gets its own seed from this one. If 0 (default) the seed is taken from the time"  ,
+				_randomSeed,
+				int(0) ) ;
+	registerProcessorParameter( "InputsColumnFile" , 
+				"If set, the jets are read from this column file (written by FlavourTagInputsExportProcessor) at the end instead of from the LCIO events"  ,
+				_inputsColumnFile,
+				std::string("") ) ;
 }
 
 NeuralNetTrainerProcessor::~NeuralNetTrainerProcessor()
@@ -163,37 +186,21 @@ void NeuralNetTrainerProcessor::processRunHeader( LCRunHeader* pRun )
 	std::vector<std::string> VarNames;
 	(pRun->parameters()).getStringVals(_FlavourTagInputsCollectionName,VarNames);
 	
-	std::set<std::string> AvailableNames;
-	for (size_t i = 0;i < VarNames.size();++i)
-	{
-		AvailableNames.insert(VarNames[i]);
-		_IndexOf[VarNames[i]] = i;
-	}
-	
-	//Check the required information is in the LCFloatVec
-	std::set<std::string> RequiredNames;
-	RequiredNames.insert( "D0Significance1");
-	RequiredNames.insert( "D0Significance2");
-	RequiredNames.insert( "Z0Significance1" );
-	RequiredNames.insert( "D0Significance2" );
-	RequiredNames.insert( "JointProbRPhi");
-	RequiredNames.insert( "JointProbZ");
-	RequiredNames.insert( "Momentum1");
-	RequiredNames.insert( "Momentum2");	
-	RequiredNames.insert( "DecayLengthSignificance");
-	RequiredNames.insert( "DecayLength");
-	RequiredNames.insert( "PTCorrectedMass");
-	RequiredNames.insert( "RawMomentum");
-	RequiredNames.insert( "NumTracksInVertices" );
-	RequiredNames.insert( "SecondaryVertexProbability");
-	
-	if (!includes(AvailableNames.begin(),AvailableNames.end(),RequiredNames.begin(),RequiredNames.end()))
+	//Work out where the net inputs are, and check they are all there
+	std::vector<std::string> MissingNames=_InputMap.resolve( VarNames );
+	if( !MissingNames.empty() )
 		std::cerr << _FlavourTagInputsCollectionName << " does not contain information required by NeuralNetTrainerProcessor";
 	
 }
 
 void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 {
+	//Deletes what was made for the last event, what the other processors made for this one is kept
+	LCIOConversionCache::forEvent( pEvent );
+	
+	//The jets all come from the column file
+	if( !_inputsColumnFile.empty() ) return;
+
 	//Output the collection names for debugging
 	if( isFirstEvent() ) _displayCollectionNames( pEvent );
 
@@ -213,8 +220,8 @@ void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 		throw lcio::EventException( message.str() );
 	}
 
-	lcio::ReconstructedParticle* pJet;
-	int numJets=pJetCollection->getNumberOfElements();
+	TypedCollection<lcio::ReconstructedParticle> Jets( pJetCollection );
+	int numJets=Jets.size();
 	
 	//apply any cuts on the event here
 	if( _passesCuts(pEvent) )
@@ -222,9 +229,7 @@ void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 		//loop over the jets
 		for( int a=0; a<numJets; ++a )
 		{
-			//Dynamic casts are not the best programming practice in the world, but I can't see another way of doing this
-			//in the LCIO framework.  This cast should be safe though because we've already tested the type.
-			pJet=dynamic_cast<lcio::ReconstructedParticle*>( pJetCollection->getElementAt(a) );
+			lcio::ReconstructedParticle* pJet=Jets[a];
 
 			// Find out the jet energy to work out the correct normalisation constants
 			double jetEnergy=pJet->getEnergy();
@@ -234,23 +239,6 @@ void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 				if( isFirstEvent() ) std::cout << "*** NeuralNetTrainer - Warning: Jet energy undefined, assuming 45.5GeV ***" << std::cout;
 			}
 
-/*
-	-----------------------------------
-	-------------IMPORTANT-------------
-	-----------------------------------
-	If any of these normalisation constants are changed, update in the documentation by modifying
-	the main class description in NeuralNetTrainer.h (at around line 20). 
-*/
-			// Variables for the normalisation of the inputs
-			double Norm_D0Significance		= 100.0;
-			double Norm_Z0Significance		= 100.0;
-			double Norm_Momentum			= jetEnergy/3.0;
-			double Norm_DecayLengthSignificance	= 6.0*jetEnergy;
-			double Norm_DecayLength			= 1.0;
-			double Norm_PTMassCorrection		= 5.0;
-			double Norm_RawMomentum			= jetEnergy;
-			double Norm_NumTracksInVertices		= 10.0;
-		
 			//Get the MC Jet type
 			lcio::LCCollection* pTrueJet=pEvent->getCollection( _TrueJetFlavourCollectionName );
 			//make sure the collection is of the right type
@@ -264,7 +252,8 @@ void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 					<< "########################################################################################" << std::endl;
 				throw lcio::EventException( message.str() );
 			}
-			int jetType = *((dynamic_cast<lcio::LCIntVec*>( pTrueJet->getElementAt(a))->begin()));
+			//The type has just been tested, so a static_cast is safe
+			int jetType = *((static_cast<lcio::LCIntVec*>( pTrueJet->getElementAt(a))->begin()));
 			
 			//
 			// See if we can get the required info from the file
@@ -282,89 +271,116 @@ void NeuralNetTrainerProcessor::processEvent( lcio::LCEvent* pEvent )
 					<< "########################################################################################" << std::endl;
 				throw lcio::EventException( message.str() );
 			}
-			LCFloatVec Inputs = *(dynamic_cast<lcio::LCFloatVec*>( pInputs->getElementAt(a) ));
-			
-			std::vector<double> inputs;
-			std::vector<double> target;
+			const LCFloatVec& Inputs = *(static_cast<lcio::LCFloatVec*>( pInputs->getElementAt(a) ));
 			
-			double NumVertices = Inputs[_IndexOf["NumVertices"]];
-			//TODO Check that the inputs exist in the index
-			if( NumVertices==1 )
-			{
-				inputs.push_back( std::tanh(Inputs[_IndexOf["D0Significance1"]]/Norm_D0Significance) );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["D0Significance2"]]/Norm_D0Significance) );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["Z0Significance1"]]/Norm_Z0Significance) );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["D0Significance2"]]/Norm_Z0Significance) );
-				inputs.push_back( Inputs[_IndexOf["JointProbRPhi"]] );
-				inputs.push_back( Inputs[_IndexOf["JointProbZ"]] );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["Momentum1"]]/Norm_Momentum) );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["Momentum2"]]/Norm_Momentum) );
-			}
-			else
-			{
-				inputs.push_back( std::tanh(Inputs[_IndexOf["DecayLengthSignificance"]]/Norm_DecayLengthSignificance) );
-				inputs.push_back( std::tanh((Inputs[_IndexOf["DecayLength"]]/10.0)/Norm_DecayLength));
-				inputs.push_back( std::tanh(Inputs[_IndexOf["PTCorrectedMass"]]/Norm_PTMassCorrection) );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["RawMomentum"]]/Norm_RawMomentum) );
-				inputs.push_back( Inputs[_IndexOf["JointProbRPhi"]] );
-				inputs.push_back( Inputs[_IndexOf["JointProbZ"]] );
-				inputs.push_back( std::tanh(Inputs[_IndexOf["NumTracksInVertices"]]/Norm_NumTracksInVertices) );
-				inputs.push_back( Inputs[_IndexOf["SecondaryVertexProbability"]] );
-			}
-		
-			if( jetType==B_JET )
-			{
-				target.clear();
-				target.push_back( 1.0 );
-				if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numSignal["b_net-1vtx"]+=1;}
-				if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numSignal["b_net-2vtx"]+=1;}
-				if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numSignal["b_net-3vtx"]+=1;}
-				target.clear();
-				target.push_back( 0.0 );
-				if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numBackground["c_net-1vtx"]+=1;}
-				if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numBackground["c_net-2vtx"]+=1;}
-				if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numBackground["c_net-3vtx"]+=1;}
-				if( _trainThisNet["bc_net-1vtx"] && NumVertices==1 ){ _dataSet["bc_net-1vtx"]->addDataItem( inputs, target );_numBackground["bc_net-1vtx"]+=1;}
-				if( _trainThisNet["bc_net-2vtx"] && NumVertices==2 ){ _dataSet["bc_net-2vtx"]->addDataItem( inputs, target );_numBackground["bc_net-2vtx"]+=1;}
-				if( _trainThisNet["bc_net-3vtx"] && NumVertices>=3 ){ _dataSet["bc_net-3vtx"]->addDataItem( inputs, target );_numBackground["bc_net-3vtx"]+=1;}
-			}
-			else if( jetType==C_JET )
-			{
-				target.clear();
-				target.push_back( 0.0 );
-				if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numBackground["b_net-1vtx"]+=1;}
-				if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numBackground["b_net-2vtx"]+=1;}
-				if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numBackground["b_net-3vtx"]+=1;}
-				target.clear();
-				target.push_back( 1.0 );
-				if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numSignal["c_net-1vtx"]+=1;}
-				if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numSignal["c_net-2vtx"]+=1;}
-				if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numSignal["c_net-3vtx"]+=1;}
-				if( _trainThisNet["bc_net-1vtx"] && NumVertices==1 ){ _dataSet["bc_net-1vtx"]->addDataItem( inputs, target );_numSignal["bc_net-1vtx"]+=1;}
-				if( _trainThisNet["bc_net-2vtx"] && NumVertices==2 ){ _dataSet["bc_net-2vtx"]->addDataItem( inputs, target );_numSignal["bc_net-2vtx"]+=1;}
-				if( _trainThisNet["bc_net-3vtx"] && NumVertices>=3 ){ _dataSet["bc_net-3vtx"]->addDataItem( inputs, target );_numSignal["bc_net-3vtx"]+=1;}
-			}
-			else
-			{
-				target.clear();
-				target.push_back( 0.0 );
-				if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numBackground["b_net-1vtx"]+=1;}
-				if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numBackground["b_net-2vtx"]+=1;}
-				if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numBackground["b_net-3vtx"]+=1;}
-				if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numBackground["c_net-1vtx"]+=1;}
-				if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numBackground["c_net-2vtx"]+=1;}
-				if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numBackground["c_net-3vtx"]+=1;}
-				//don't fill anything for the bc net because this isn't a b or a c jet
-			}
-
+			_addJet( Inputs, jetEnergy, jetType );
 		}
 
 		++_nAcceptedEvents;
 	}
 	++_nEvent;
+}
+
+void NeuralNetTrainerProcessor::_addJet( const std::vector<float>& Inputs, double jetEnergy, int jetType )
+{
+	//The inputs are gathered and normalised in the same way as in FlavourTagProcessor, see FlavourTagNetInputs
+	double netInputs[FlavourTagNetInputs::NumberOfInputs];
+	int vertexCategory=_InputMap.gather( &Inputs[0], netInputs );
+	FlavourTagNetInputs::normalise( 1, &vertexCategory, &jetEnergy, netInputs );
+
+	std::vector<double> inputs( netInputs, netInputs+FlavourTagNetInputs::NumberOfInputs );
+	std::vector<double> target;
+	
+	double NumVertices = Inputs[_InputMap.numVerticesIndex()];
 
-	//Clear anything that may have been allocated during this event
-	vertex_lcfi::MetaMemoryManager::Event()->delAllObjects();
+	if( jetType==B_JET )
+	{
+		target.clear();
+		target.push_back( 1.0 );
+		if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numSignal["b_net-1vtx"]+=1;}
+		if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numSignal["b_net-2vtx"]+=1;}
+		if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numSignal["b_net-3vtx"]+=1;}
+		target.clear();
+		target.push_back( 0.0 );
+		if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numBackground["c_net-1vtx"]+=1;}
+		if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numBackground["c_net-2vtx"]+=1;}
+		if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numBackground["c_net-3vtx"]+=1;}
+		if( _trainThisNet["bc_net-1vtx"] && NumVertices==1 ){ _dataSet["bc_net-1vtx"]->addDataItem( inputs, target );_numBackground["bc_net-1vtx"]+=1;}
+		if( _trainThisNet["bc_net-2vtx"] && NumVertices==2 ){ _dataSet["bc_net-2vtx"]->addDataItem( inputs, target );_numBackground["bc_net-2vtx"]+=1;}
+		if( _trainThisNet["bc_net-3vtx"] && NumVertices>=3 ){ _dataSet["bc_net-3vtx"]->addDataItem( inputs, target );_numBackground["bc_net-3vtx"]+=1;}
+	}
+	else if( jetType==C_JET )
+	{
+		target.clear();
+		target.push_back( 0.0 );
+		if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numBackground["b_net-1vtx"]+=1;}
+		if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numBackground["b_net-2vtx"]+=1;}
+		if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numBackground["b_net-3vtx"]+=1;}
+		target.clear();
+		target.push_back( 1.0 );
+		if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numSignal["c_net-1vtx"]+=1;}
+		if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numSignal["c_net-2vtx"]+=1;}
+		if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numSignal["c_net-3vtx"]+=1;}
+		if( _trainThisNet["bc_net-1vtx"] && NumVertices==1 ){ _dataSet["bc_net-1vtx"]->addDataItem( inputs, target );_numSignal["bc_net-1vtx"]+=1;}
+		if( _trainThisNet["bc_net-2vtx"] && NumVertices==2 ){ _dataSet["bc_net-2vtx"]->addDataItem( inputs, target );_numSignal["bc_net-2vtx"]+=1;}
+		if( _trainThisNet["bc_net-3vtx"] && NumVertices>=3 ){ _dataSet["bc_net-3vtx"]->addDataItem( inputs, target );_numSignal["bc_net-3vtx"]+=1;}
+	}
+	else
+	{
+		target.clear();
+		target.push_back( 0.0 );
+		if( _trainThisNet["b_net-1vtx"] && NumVertices==1 ){ _dataSet["b_net-1vtx"]->addDataItem( inputs, target );_numBackground["b_net-1vtx"]+=1;}
+		if( _trainThisNet["b_net-2vtx"] && NumVertices==2 ){ _dataSet["b_net-2vtx"]->addDataItem( inputs, target );_numBackground["b_net-2vtx"]+=1;}
+		if( _trainThisNet["b_net-3vtx"] && NumVertices>=3 ){ _dataSet["b_net-3vtx"]->addDataItem( inputs, target );_numBackground["b_net-3vtx"]+=1;}
+		if( _trainThisNet["c_net-1vtx"] && NumVertices==1 ){ _dataSet["c_net-1vtx"]->addDataItem( inputs, target );_numBackground["c_net-1vtx"]+=1;}
+		if( _trainThisNet["c_net-2vtx"] && NumVertices==2 ){ _dataSet["c_net-2vtx"]->addDataItem( inputs, target );_numBackground["c_net-2vtx"]+=1;}
+		if( _trainThisNet["c_net-3vtx"] && NumVertices>=3 ){ _dataSet["c_net-3vtx"]->addDataItem( inputs, target );_numBackground["c_net-3vtx"]+=1;}
+		//don't fill anything for the bc net because this isn't a b or a c jet
+	}
+}
+
+void NeuralNetTrainerProcessor::_addJetsFromColumnFile()
+{
+	FlavourTagInputsColumnReader reader( _inputsColumnFile );
+	std::cout << "NeuralNetTrainer: Reading " << reader.numberOfJets() << " jets from " << _inputsColumnFile << std::endl;
+
+	std::vector<std::string> MissingNames=_InputMap.resolve( reader.variableNames() );
+	if( !MissingNames.empty() ) throw lcio::Exception( _inputsColumnFile + " has no " + MissingNames[0] + " column" );
+
+	std::vector<float> Inputs( reader.variableNames().size() );
+	for( int chunk=0; chunk<reader.numberOfChunks(); ++chunk )
+	{
+		const int numJets=reader.readChunk( chunk );
+		const float* cosTheta=reader.jetCosTheta();
+		const int* jetIndex=reader.jetIndex();
+
+		//The jets of an event are consecutive, starting from jet index 0
+		int eventEnd;
+		for( int eventBegin=0; eventBegin<numJets; eventBegin=eventEnd )
+		{
+			for( eventEnd=eventBegin+1; eventEnd<numJets && jetIndex[eventEnd]!=0; ++eventEnd ) {}
+			++_nEvent;
+
+			//The same cut as _passesCuts: no cut if any jet momentum is missing (NaN), otherwise all jets must have |cos(theta)|<=0.866
+			bool momentumMissing=false;
+			bool passes=true;
+			for( int a=eventBegin; a<eventEnd; ++a )
+			{
+				if( cosTheta[a]!=cosTheta[a] ) momentumMissing=true;
+				else if( cosTheta[a]>0.866 || cosTheta[a]<-0.866 ) passes=false;
+			}
+			if( !passes && !momentumMissing ) continue;
+
+			for( int a=eventBegin; a<eventEnd; ++a )
+			{
+				double jetEnergy=reader.jetEnergy()[a];
+				if( 0==jetEnergy ) jetEnergy=45.5;
+				for( size_t i=0; i<Inputs.size(); ++i ) Inputs[i]=reader.variable( i )[a];
+				_addJet( Inputs, jetEnergy, reader.trueJetFlavour()[a] );
+			}
+			++_nAcceptedEvents;
+		}
+	}
 }
 
 /*
@@ -387,10 +403,10 @@ bool NeuralNetTrainerProcessor::_passesCuts( lcio::LCEvent* pEvent )
 
 	try
 	{
-		lcio::LCCollection* pJetCollection=pEvent->getCollection( _JetCollectionName );
-		for( int i=0; i<pJetCollection->getNumberOfElements(); ++i )
+		TypedCollection<lcio::ReconstructedParticle> Jets( pEvent, _JetCollectionName );
+		for( int i=0; i<Jets.size(); ++i )
 		{
-			const double* mom=(dynamic_cast<lcio::ReconstructedParticle*>( pJetCollection->getElementAt(i) ))->getMomentum();
+			const double* mom=Jets[i]->getMomentum();
 			if( mom[0]==0 && mom[1]==0 && mom[2]==0 ) throw lcio::Exception( "Jet momentum not defined" );
 
 			jetMomentums.push_back( vertex_lcfi::util::Vector3( mom[0], mom[1], mom[2] ) );
@@ -444,6 +460,8 @@ void NeuralNetTrainerProcessor::end()
 	//The data sets should all be filled, so train the nets
 	//
 
+	if( !_inputsColumnFile.empty() ) _addJetsFromColumnFile();
+
 	//Just make one neuron builder and reuse it
 	nnet::SigmoidNeuronBuilder neuronBuilder;
 
@@ -456,41 +474,83 @@ void NeuralNetTrainerProcessor::end()
 	//print out info on how many events passed the cuts
 	std::cout << "NeuralNetTrainer: " << _nAcceptedEvents << " of " << _nEvent << " events passed the cuts. See the documentation of NeuralNetTrainerProcessor::_passesCuts() for details of the cuts applied." << std::endl;
 
-	//Train and save any nets that have been selected for training
+	//Create the nets here, one after the other, because the initial weights come from rand(). Each net gets a seed
+	//from its position in the list of all nine nets, so its initial weights do not depend on which other nets are
+	//trained or on the order they are trained in. Without a RandomSeed the base seed is taken from the time once,
+	//since seeding every net from the time would give them all the same weights when they are made in the same second.
+	const unsigned int baseSeed=( _randomSeed!=0 ) ? _randomSeed : nnet::NeuralNetRandom::GetNewRandomSeed();
+	std::vector<TrainingTask::Net> nets;
 	for( std::vector<std::string>::iterator iName=_listOfSelectedNetNames.begin(); iName<_listOfSelectedNetNames.end(); ++iName )
 	{
-		//Not going to need these once the net is trained and saved so have them local to this 'for' loop
-		nnet::NeuralNet thisNeuralNet( nInputs, nodes, &neuronBuilder, 1 );
-		nnet::BackPropagationCGAlgorithm myAlgorithm( thisNeuralNet );
+		TrainingTask::Net thisNet;
+		thisNet.name=*iName;
+		thisNet.dataSet=_dataSet[*iName];
+		thisNet.filename=_filename[*iName];
+		thisNet.succeeded=false;
+
+		// Make sure we can open the file before training.  Nothing worse than waiting ages to train and then losing the result!
+		// The net is written to a temporary file which then replaces the output file, so an existing net is never left half written.
+		thisNet.temporaryFilename=thisNet.filename+".tmp";
+		std::ofstream outputFile( thisNet.temporaryFilename.c_str() );
+		if( !outputFile.is_open() )
+		{
+			std::cerr << "Unable to open file " << thisNet.temporaryFilename << "! Skipping training for this net." << std::endl;
+			continue;
+		}
+		outputFile.close();
+
+		unsigned int seed=baseSeed+std::distance( _filename.begin(), _filename.find( *iName ) );
+		nnet::NeuralNetRandom::SetRandomSeed( seed );
+		thisNet.neuralNet=new nnet::NeuralNet( nInputs, nodes, &neuronBuilder, false );
+		nets.push_back( thisNet );
 
 		std::cout << std::endl << "Training neural net " << *iName << " with " << _dataSet[*iName]->numberOfDataItems()
 				<< " jets " << "(" << _numBackground[*iName] << " background, " << _numSignal[*iName] << " signal)..." << std::endl;
+	}
 
-		// Make sure we can open the file before training.  Nothing worse than waiting ages to train and then losing the result!
-		std::ofstream outputFile( _filename[*iName].c_str() );
-		if( outputFile.is_open() )
-		{
-			//do the training
-			_trainNet( myAlgorithm, *_dataSet[*iName] );
+	//Train and save the nets, NumberOfConcurrentNets at a time
+	TrainingTask task( *this, nets );
+	nnet::NeuralNetThreads::ParallelFor( task, nets.size(), _numberOfConcurrentNets );
 
-			//Set the output format to the one requested in the steering file
-			thisNeuralNet.setSerialisationMode( _outputFormat );
-			thisNeuralNet.serialise( outputFile );
-			outputFile.close();
-		}
-		else
-		{
-			std::cerr << "Unable to open file " << _filename[*iName] << "! Skipping training for this net." << std::endl;
-		}
+	for( std::vector<TrainingTask::Net>::iterator iNet=nets.begin(); iNet<nets.end(); ++iNet )
+	{
+		if( iNet->succeeded ) std::cout << "Saved neural net " << iNet->name << " to " << iNet->filename << std::endl;
+		else std::cerr << "Unable to save neural net " << iNet->name << " to " << iNet->filename << "!" << std::endl;
+		delete iNet->neuralNet;
 	}
-	
 
 	std::cout << "Finished training all selected nets" << std::endl;
 	
 	//free up stuff
+	LCIOConversionCache::clear();
 	vertex_lcfi::MetaMemoryManager::Run()->delAllObjects();
 }
 
+NeuralNetTrainerProcessor::TrainingTask::TrainingTask( NeuralNetTrainerProcessor& trainer, std::vector<Net>& nets )
+	: _trainer(trainer), _nets(nets)
+{
+}
+
+void NeuralNetTrainerProcessor::TrainingTask::process( const int thread, const int begin, const int end )
+{
+	for( int i=begin; i<end; ++i )
+	{
+		Net& thisNet=_nets[i];
+		nnet::BackPropagationCGAlgorithm myAlgorithm( *thisNet.neuralNet );
+		myAlgorithm.setNumberOfThreads( _trainer._numberOfTrainingThreads );
+
+		//do the training
+		_trainer._trainNet( myAlgorithm, *thisNet.dataSet );
+
+		//Set the output format to the one requested in the steering file, and only replace the output file once the net is completely written
+		thisNet.neuralNet->setSerialisationMode( _trainer._outputFormat );
+		std::ofstream outputFile( thisNet.temporaryFilename.c_str() );
+		thisNet.neuralNet->serialise( outputFile );
+		outputFile.close();
+		thisNet.succeeded=( !outputFile.fail() && std::rename( thisNet.temporaryFilename.c_str(), thisNet.filename.c_str() )==0 );
+	}
+}
+
 void NeuralNetTrainerProcessor::_trainNet( nnet::BackPropagationCGAlgorithm& backPropCGAlgo, nnet::NeuralNetDataSet& dataSet )
 {
 	//This function pretty much just calls backPropCGAlgo.train(...) at the moment, although code can easily be added
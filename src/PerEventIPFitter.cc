@@ -9,6 +9,7 @@
 #include <IMPL/LCRelationImpl.h>
 
 #include <inc/lciointerface.h>
+#include "TypedCollection.h"
 #include <algo/inc/pereventipfitter.h>
 #include <util/inc/memorymanager.h>
 
@@ -88,8 +89,7 @@ void PerEventIPFitterProcessor::processRunHeader( LCRunHeader* run) {
 
 void PerEventIPFitterProcessor::processEvent( LCEvent * evt ) { 
 	
-	LCCollection* RPCollection;
-	RPCollection = evt->getCollection( _InputRPCollectionName );
+	TypedCollection<ReconstructedParticle> RPCollection( evt, _InputRPCollectionName );
 	
 	//Create an Event with an IP with default parameters
 	Vector3 IPPos;
@@ -106,16 +106,17 @@ void PerEventIPFitterProcessor::processEvent( LCEvent * evt ) {
 	IPErr(2,1) = _DefaultIPErr[4];
 	IPErr(2,2) = _DefaultIPErr[5];
 	
-	//Create an event with this IP
-	vertex_lcfi::Event* MyEvent = new vertex_lcfi::Event(IPPos,IPErr);
-	MemoryManager<Event>::Event()->registerObject(MyEvent);
+	//Get the event with this IP from the conversion cache
+	LCIOConversionCache* Cache = LCIOConversionCache::forEvent(evt);
+	vertex_lcfi::Event* MyEvent = Cache->event(_InputRPCollectionName,IPPos,IPErr);
 		
 	//Create jets from LCIO and add them to the event
-	int nRCP = RPCollection->getNumberOfElements()  ;
+	int nRCP = RPCollection.size()  ;
 	//std::cout << nRCP << std::endl;
 	for(int i=0; i< nRCP ; i++)
 	{
-		MyEvent->addTrack(trackFromLCIORP(MyEvent,dynamic_cast<ReconstructedParticle*>(RPCollection->getElementAt(i))) );
+		//The cache adds the track to the event
+		Cache->track(MyEvent,RPCollection[i]);
 	}
 	
 	//Run IP Fitter
@@ -133,8 +134,7 @@ void PerEventIPFitterProcessor::processEvent( LCEvent * evt ) {
 	}
 	evt->getCollection(_VertexCollectionName)->addElement(LCIOIPResult);
 
-	//Clear all objects created for this event
-	MetaMemoryManager::Event()->delAllObjects();
+	//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
 	_nEvt ++ ;
 }
 
@@ -147,6 +147,7 @@ void PerEventIPFitterProcessor::check( LCEvent * evt ) {
 
 void PerEventIPFitterProcessor::end(){ 
   
+	LCIOConversionCache::clear();
 	MetaMemoryManager::Run()->delAllObjects();
    	std::cout << "PerEventIPFitterProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
@@ -25,6 +25,7 @@
 
 #include "util/inc/vector3.h"
 #include "util/inc/util.h"
+#include "TypedCollection.h"
 
 using std::includes;
 using std::map;
@@ -43,7 +44,7 @@ using namespace lcio;
 //Needs to be instantiated for Marlin to know about it (I think)
 PlotProcessor aPlotProcessor;
 
-PlotProcessor::PlotProcessor() : marlin::Processor("Plot")
+PlotProcessor::PlotProcessor() : marlin::Processor("Plot"), _jetEnergy( 1200, 0, 120 )
 {
 	_description = "Plots various outputs from the flavour tag" ;
 
@@ -70,6 +71,10 @@ PlotProcessor::PlotProcessor() : marlin::Processor("Plot")
 				"Filename for the output"  ,
 				_OutputFilename ,
 				string("PlotProcessorOutput") ) ;
+	registerOptionalParameter( "PartialResultsFile" ,
+				"If set, the binned tag values are also written to this file so that the results of many jobs can be combined with lcfimergeplots"  ,
+				_PartialResultsFile ,
+				string("") ) ;
 }
 
 PlotProcessor::~PlotProcessor()
@@ -88,10 +93,11 @@ void PlotProcessor::init()
 	//Make as many binning containers as we need
 	for (unsigned int iTag=0; iTag < _FlavourTagCollectionNames.size(); ++iTag)
 	{
-		_BTagEfficiencyPurity.push_back(efficiency_purity<double>());
-		_CTagEfficiencyPurity.push_back(efficiency_purity<double>());
-		_BCTagEfficiencyPurity.push_back(efficiency_purity<double>());
+		_BTagEfficiencyPurity.push_back(binned_efficiency_purity<double>());
+		_CTagEfficiencyPurity.push_back(binned_efficiency_purity<double>());
+		_BCTagEfficiencyPurity.push_back(binned_efficiency_purity<double>());
 	}
+	_PartialResults=FlavourTagPlotData( _FlavourTagCollectionNames );
 }
 
 void PlotProcessor::processRunHeader( LCRunHeader* pRun )
@@ -112,8 +118,12 @@ void PlotProcessor::processRunHeader( LCRunHeader* pRun )
 			IndexOf[VarNames[i]] = i;
 		}
 		
-		//Add the index to the list
-		_IndexOfForEachTag.push_back(IndexOf);
+		//Add the positions of the tags to the list, so that no names need to be looked up for each jet
+		TagIndices Indices;
+		Indices.bTag=IndexOf["BTag"];
+		Indices.cTag=IndexOf["CTag"];
+		Indices.bcTag=IndexOf["BCTag"];
+		_TagIndicesForEachTag.push_back(Indices);
 		
 		//Check the required information is in the LCFloatVec
 		set<string> RequiredNames;
@@ -147,17 +157,15 @@ void PlotProcessor::processEvent( LCEvent* pEvent )
 	//apply any cuts on the event here
 	if( _passesEventCuts(pEvent) )
 	{
-		ReconstructedParticle* pJet;
+		TypedCollection<ReconstructedParticle> Jets( pJetCollection );
 		//loop over the jets
-		for( int a=0; a<pJetCollection->getNumberOfElements(); ++a )
+		for( int a=0; a<Jets.size(); ++a )
 		{
-			//Dynamic casts are not the best programming practice in the world, but I can't see another way of doing this
-			//in the LCIO framework.  This cast should be safe though because we've already tested the type.
-			pJet=dynamic_cast<ReconstructedParticle*>( pJetCollection->getElementAt(a) );
+			ReconstructedParticle* pJet=Jets[a];
 			
 			if( _passesJetCuts(pJet) )
 			{
-				_fillPlots(pEvent, a );
+				_fillPlots(pEvent, a, _cosTheta(pJet) );
 				_jetEnergy.add(pJet->getEnergy());
 				if (pJet->getEnergy() > _jetEMax) _jetEMax = pJet->getEnergy();
 			}
@@ -170,6 +178,18 @@ void PlotProcessor::end()
 {
 	_outputDataToFile( _OutputFilename );
 
+	if( !_PartialResultsFile.empty() )
+	{
+		try
+		{
+			_PartialResults.write( _PartialResultsFile );
+		}
+		catch( std::exception& error )
+		{
+			cerr << "PlotProcessor - " << error.what() << endl;
+		}
+	}
+
 	cout << "The largest jet energy was " << _jetEMax << endl;
 }
 
@@ -202,21 +222,26 @@ bool PlotProcessor::_passesJetCuts( ReconstructedParticle* pJet )
 	double CThJ_lower=0;	//lower cut on cos(theta) of the jet axis
 	double CThJ_upper=0.95;	//upper cut (Sho Ryu Ken!)
 
+	double cosTheta=_cosTheta( pJet );
+	if( fabs(cosTheta)<=CThJ_lower || fabs(cosTheta)>=CThJ_upper ) return false;
+
+
+	// If control gets to this point then the jet has passed
+	return true;
+}
+
+double PlotProcessor::_cosTheta( ReconstructedParticle* pJet )
+{
 	vertex_lcfi::util::Vector3 zAxis( 0, 0, 1 ); //work out theta from dot product with jet axis
 
 	const double* mom=pJet->getMomentum();
 	vertex_lcfi::util::Vector3 jetMomentum( mom[0], mom[1], mom[2] );
 
 	jetMomentum.makeUnit();
-	double cosTheta=jetMomentum.dot( zAxis );
-	if( fabs(cosTheta)<=CThJ_lower || fabs(cosTheta)>=CThJ_upper ) return false;
-
-
-	// If control gets to this point then the jet has passed
-	return true;
+	return jetMomentum.dot( zAxis );
 }
 
-void PlotProcessor::_fillPlots( LCEvent* pEvent, unsigned int jet)
+void PlotProcessor::_fillPlots( LCEvent* pEvent, unsigned int jet, double cosTheta )
 {
 	LCCollection* pTrueCollection=pEvent->getCollection( _TrueJetFlavourColName );
 	int jetType = dynamic_cast<LCIntVec*>(pTrueCollection->getElementAt(jet))->back();
@@ -225,9 +250,15 @@ void PlotProcessor::_fillPlots( LCEvent* pEvent, unsigned int jet)
 	for (unsigned int iTag=0; iTag < _FlavourTagCollectionNames.size(); ++iTag)
 	{
 		LCCollection* pTagCollection=pEvent->getCollection( _FlavourTagCollectionNames[iTag] );
-		double bTag= (*dynamic_cast<LCFloatVec*>(pTagCollection->getElementAt(jet)))[_IndexOfForEachTag[iTag]["BTag"]];
-		double cTag= (*dynamic_cast<LCFloatVec*>(pTagCollection->getElementAt(jet)))[_IndexOfForEachTag[iTag]["CTag"]];
-		double cTagBBack= (*dynamic_cast<LCFloatVec*>(pTagCollection->getElementAt(jet)))[_IndexOfForEachTag[iTag]["BCTag"]];
+		const LCFloatVec& Tags=*dynamic_cast<LCFloatVec*>(pTagCollection->getElementAt(jet));
+		double bTag= Tags[_TagIndicesForEachTag[iTag].bTag];
+		double cTag= Tags[_TagIndicesForEachTag[iTag].cTag];
+		double cTagBBack= Tags[_TagIndicesForEachTag[iTag].bcTag];
+
+		FlavourTagPlotData::Flavour flavour=FlavourTagPlotData::LightJet;
+		if( jetType==B_JET ) flavour=FlavourTagPlotData::BJet;
+		else if( jetType==C_JET ) flavour=FlavourTagPlotData::CJet;
+		_PartialResults.addJet( iTag, 0, cosTheta, flavour, bTag, cTag, cTagBBack );
 	
 		if( jetType==B_JET )
 		{
@@ -316,8 +347,13 @@ void PlotProcessor::_outputDataToFile( string filename )
 	}
 	// now add in the jet energies
 	TH1F jetEnergyHistogram( "jetEnergyHistogram", "Jet energies", 200, 0, 120 );
-	const vector<double> jetEnergyData=_jetEnergy.sorted_data();
-	for( vector<double>::const_iterator i=jetEnergyData.begin(); i<jetEnergyData.end(); ++i ) jetEnergyHistogram.Fill( (*i) );
+	vector< vertex_lcfi::util::bin<double> > jetEnergyBins=_jetEnergy.binned_data( 200, 0, 120 );
+	for( size_t i=0; i<jetEnergyBins.size(); ++i ) jetEnergyHistogram.SetBinContent( i+1, jetEnergyBins[i].contents() );
+	//The first bin also holds anything below 0, so move that to the underflow bin
+	jetEnergyHistogram.SetBinContent( 0, _jetEnergy.number_below( 0 ) );
+	jetEnergyHistogram.SetBinContent( 1, jetEnergyBins[0].contents()-_jetEnergy.number_below( 0 ) );
+	jetEnergyHistogram.SetBinContent( 201, _jetEnergy.number_of_entries()-_jetEnergy.number_below( 120 ) );
+	jetEnergyHistogram.SetEntries( _jetEnergy.number_of_entries() );
 	
 	rootFile.Write();
 	rootFile.Close();
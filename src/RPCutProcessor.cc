@@ -18,12 +18,48 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <cmath>
 
 using namespace marlin ;
 using namespace lcio;
 
 RPCutProcessor aRPCutProcessor ;
 
+namespace
+{
+	//Marks the entries not already rejected whose value is on the wrong side of the cut. Written without branches
+	//on the data so the compiler can vectorise it.
+	template<class T>
+	void applyCut( const std::vector<T>& Values, bool CutLowerThan, float CutValue, unsigned char Id, std::vector<unsigned char>& RejectedBy )
+	{
+		const int n=Values.size();
+		if (CutLowerThan)
+			for (int i=0;i<n;++i) RejectedBy[i] = ( RejectedBy[i]==0 && Values[i]<CutValue ) ? Id : RejectedBy[i];
+		else
+			for (int i=0;i<n;++i) RejectedBy[i] = ( RejectedBy[i]==0 && Values[i]>CutValue ) ? Id : RejectedBy[i];
+	}
+	
+	const char* CutNames[] = { "Passed", "No track", "D0", "D0Err", "Z0", "Z0Err", "PT", "Chi2OverDOF", "DetectorHits", "MCPID", "BadParameters", "MCVertex" };
+	
+	//The position of each name in DetectorNames, 0 for names not in it (as std::map::operator[] gave before)
+	std::vector<int> detectorIndices( const std::map<std::string,int>& SubdetectorIndex, const std::vector<std::string>& Names )
+	{
+		std::vector<int> Indices;
+		for (std::vector<std::string>::const_iterator iName = Names.begin(); iName != Names.end(); ++iName)
+		{
+			std::map<std::string,int>::const_iterator iIndex = SubdetectorIndex.find(*iName);
+			if (iIndex == SubdetectorIndex.end())
+			{
+				std::cerr << "RPCutProcessor - Warning: Sub detector " << *iName << " is not in g2_SubDetectorNames, the first detector will be used" << std::endl;
+				Indices.push_back(0);
+			}
+			else Indices.push_back(iIndex->second);
+		}
+		return Indices;
+	}
+}
+
 RPCutProcessor::RPCutProcessor() : Processor("RPCutProcessor") {
   
   // modify processor description
@@ -209,6 +245,14 @@ RPCutProcessor::RPCutProcessor() : Processor("RPCutProcessor") {
 			      "Enable a cut on tracks with MC Production Vertices in material"  ,
 			      _MCVertexEnable,
 			      bool(0) ) ;
+  registerOptionalParameter( "k1_CompiledCuts" , 
+			      "If true the cut variables of all the RPs of an event are unpacked first and each cut is applied to all of them in turn, the number rejected by each cut is printed at the end"  ,
+			      _CompiledCuts,
+			      bool(0) ) ;
+  registerOptionalParameter( "k2_SubsetOutput" , 
+			      "With k1_CompiledCuts, write the RPs that pass (the particles of the jets if SubParticleLists) to OutputRCPCollection as a subset collection instead of copying or changing the input"  ,
+			      _SubsetOutput,
+			      bool(0) ) ;
   			      
 }
 
@@ -221,6 +265,23 @@ void RPCutProcessor::init() {
   _nRun = 0 ;
   _nEvt = 0 ;
 
+  //Find where each detector named in the hit cuts is in the hit numbers, once for the whole job
+  if (_DetectorHitsEnable)
+  {
+    if (_DetectorNames.empty())
+    {
+      std::cerr << "Subdetector Names not set" << std::endl;
+    }
+    std::map<std::string,int> SubdetectorIndex;
+    for (unsigned int i=0; i<_DetectorNames.size(); ++i) SubdetectorIndex[_DetectorNames[i]] = i;
+    _DetectorHitsBoundaryIndices = detectorIndices(SubdetectorIndex,_DetectorHitsBoundaryDetectorNames);
+    _DetectorHitsRegion1Indices = detectorIndices(SubdetectorIndex,_DetectorHitsRegion1DetectorNames);
+    _DetectorHitsRegion2Indices = detectorIndices(SubdetectorIndex,_DetectorHitsRegion2DetectorNames);
+  }
+  _SortedMonteCarloPIDsToCut = _MonteCarloPIDsToCut;
+  std::sort(_SortedMonteCarloPIDsToCut.begin(),_SortedMonteCarloPIDsToCut.end());
+  _NumberRejectedBy.assign(NumberOfCutIds,0);
+
   if (_MCVertexEnable) {
     _VxdPar = &(Global::GEAR->getVXDParameters());
     const gear::GearParameters& BeamPipePar
@@ -266,6 +327,9 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
   // this gets called for every event 
   // usually the working horse ...
 
+	//Deletes what was made for the last event, what the other processors made for this one is kept
+	LCIOConversionCache::forEvent(evt);
+	
 	LCCollection* InCol = evt->getCollection( _InRCPColName );
 
 	//Get the collection of associated Monte Carlo particles if the cut on MC PDG code is enabled.
@@ -296,8 +360,10 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
 		}
 	}
 	
+	//The subset output is always a new collection
+	bool SubsetOutput = _CompiledCuts && _SubsetOutput;
 	LCCollection* OutRPCollection;
-	if (_WriteNewCollection)
+	if (_WriteNewCollection || SubsetOutput)
 	{
 		std::vector<std::string>::const_iterator it = find(evt->getCollectionNames()->begin(),evt->getCollectionNames()->end(),_OutRCPColName);
 		if (it == evt->getCollectionNames()->end())
@@ -309,28 +375,19 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
 		
 	}
 	OutRPCollection = evt->getCollection(_OutRCPColName);
-	if (_WriteNewCollection && !_SubParticleLists)
+	if ((_WriteNewCollection && !_SubParticleLists) || SubsetOutput)
 	{
 		dynamic_cast<LCCollectionVec*>(OutRPCollection)->setSubset(true);
 	}
 	
-	
-	//TODO Only do this if cut enables and check for data existance
-	//Retrive the list of detector names and create a map so that we know at what index to find them 
-	std::map<std::string,int> SubdetectorIndex;
-	if (_DetectorHitsEnable)
+	if (_CompiledCuts)
 	{
-		if (_DetectorNames.empty())
-		{
-			std::cerr << "Subdetector Names not set" << std::endl;
-		}
-		int i=0;
-		for (StringVec::iterator iDetector = _DetectorNames.begin(); iDetector != _DetectorNames.end();++iDetector)
-		{
-			SubdetectorIndex[*iDetector] = i;
-			++i;
-		}
+		_compiledCutEvent(InCol,OutRPCollection,pMCRelationNavigator);
+		//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
+		_nEvt ++ ;
+		return;
 	}
+	
 	//RP Loop
 	int nRCP = InCol->getNumberOfElements()  ;
 	for(int i=0; i< nRCP ; i++)
@@ -366,7 +423,7 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
 				       (_Z0ErrEnable && _Z0ErrFail(*iRPTrack)) ||
 				       (_PTEnable && _PTFail(*iRPTrack)) ||
 				       (_Chi2OverDOFEnable && _Chi2OverDOFFail(*iRPTrack)) ||
-				       (_DetectorHitsEnable && _DetectorHitsFail(*iRPTrack,SubdetectorIndex)) ||
+				       (_DetectorHitsEnable && _DetectorHitsFail(*iRPTrack)) ||
 				       (_MonteCarloPIDEnable && _MCPIDFail(*iRPTrack,pMCRelationNavigator)) ||
 				       (_BadParametersEnable && _BadParametersFail(*iRPTrack)) ||
 				       (_MCVertexEnable &&_MCVertexFail((*iRPTrack),pMCRelationNavigator)) ))
@@ -394,7 +451,7 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
 			       (_Z0ErrEnable && _Z0ErrFail(InputRP)) ||
 			       (_PTEnable && _PTFail(InputRP)) ||
 			       (_Chi2OverDOFEnable && _Chi2OverDOFFail(InputRP)) ||
-			       (_DetectorHitsEnable && _DetectorHitsFail(InputRP,SubdetectorIndex)) ||
+			       (_DetectorHitsEnable && _DetectorHitsFail(InputRP)) ||
 			       (_MonteCarloPIDEnable && _MCPIDFail(InputRP,pMCRelationNavigator)) ||
 			       (_BadParametersEnable && _BadParametersFail(InputRP)) ||
 			       (_MCVertexEnable &&_MCVertexFail(InputRP,pMCRelationNavigator)) ))
@@ -421,8 +478,7 @@ void RPCutProcessor::processEvent( LCEvent * evt ) {
 			}
 		}				     
 	}
-	//Clear all objects created
-	vertex_lcfi::MetaMemoryManager::Event()->delAllObjects();
+	//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
 	_nEvt ++ ;
 }
 
@@ -435,6 +491,8 @@ void RPCutProcessor::check( LCEvent * evt ) {
 
 void RPCutProcessor::end(){ 
 
+	LCIOConversionCache::clear();
+
 #ifdef MCFAIL_DIAGNOSTICS
   if (_MCVertexEnable) {
         TFile dumpfile((name()+std::string(".root")).c_str(),"RECREATE");
@@ -454,6 +512,17 @@ void RPCutProcessor::end(){
 	std::cout << "RPCutProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
  	    << std::endl ;
+	if (_CompiledCuts)
+	{
+		long NumberTested = 0;
+		for (int Id = Passed; Id < NumberOfCutIds; ++Id) NumberTested += _NumberRejectedBy[Id];
+		std::cout << "RPCutProcessor::end()  " << name() << " " << _NumberRejectedBy[Passed] << " of " << NumberTested
+			<< " RPs passed. Rejected by (first cut failed):" << std::endl;
+		for (int Id = NoTrack; Id < NumberOfCutIds; ++Id)
+		{
+			if (_NumberRejectedBy[Id] > 0) std::cout << "   " << CutNames[Id] << ": " << _NumberRejectedBy[Id] << std::endl;
+		}
+	}
 
 }
 
@@ -506,44 +575,28 @@ bool  RPCutProcessor::_PTFail(ReconstructedParticle* RPTrack)
 	else
 		return (pt > _PTCutValue);
 }
-bool  RPCutProcessor::_DetectorHitsFail(ReconstructedParticle* RPTrack, std::map<std::string,int> SubdetectorIndex)
+bool  RPCutProcessor::_DetectorHitsFail(ReconstructedParticle* RPTrack)
 {
+	//TODO Check for exisance of data
+	const std::vector<int>& HitNumbers = RPTrack->getTracks()[0]->getSubdetectorHitNumbers();
 	//First find out if this track is in region 1 or 2
 	bool Region2 = 0;
-	std::vector<int>::const_iterator iCut = _DetectorHitsBoundaryCuts.begin();
-	for (StringVec::iterator iDetector = _DetectorHitsBoundaryDetectorNames.begin(); iDetector != _DetectorHitsBoundaryDetectorNames.end();++iDetector)
+	for (unsigned int i = 0; i < _DetectorHitsBoundaryIndices.size(); ++i)
 	{
-		//TODO Check for exisance of data
-		if (RPTrack->getTracks()[0]->getSubdetectorHitNumbers()[SubdetectorIndex[*iDetector]] >= (*iCut))
+		if (HitNumbers[_DetectorHitsBoundaryIndices[i]] >= _DetectorHitsBoundaryCuts[i])
 		{
 			Region2 = 1;
 			break;
 		}
-		++iCut;
 	}
 	//Cut accordingly  1 = fail
-	if (Region2)
+	const std::vector<int>& Indices = Region2 ? _DetectorHitsRegion2Indices : _DetectorHitsRegion1Indices;
+	const std::vector<int>& Cuts = Region2 ? _DetectorHitsRegion2Cuts : _DetectorHitsRegion1Cuts;
+	for (unsigned int i = 0; i < Indices.size(); ++i)
 	{
-		iCut = _DetectorHitsRegion2Cuts.begin();
-		for (StringVec::iterator iDetector = _DetectorHitsRegion2DetectorNames.begin(); iDetector != _DetectorHitsRegion2DetectorNames.end();++iDetector)
+		if (HitNumbers[Indices[i]] < Cuts[i])
 		{
-			if (RPTrack->getTracks()[0]->getSubdetectorHitNumbers()[SubdetectorIndex[*iDetector]] < (*iCut))
-			{
-				return 1;
-			}
-			++iCut;
-		}
-	}
-	else
-	{
-		iCut = _DetectorHitsRegion1Cuts.begin();
-		for (StringVec::iterator iDetector = _DetectorHitsRegion1DetectorNames.begin(); iDetector != _DetectorHitsRegion1DetectorNames.end();++iDetector)
-		{
-			if (RPTrack->getTracks()[0]->getSubdetectorHitNumbers()[SubdetectorIndex[*iDetector]] < (*iCut))
-			{
-				return 1;
-			}
-			++iCut;
+			return 1;
 		}
 	}
 	return 0;
@@ -576,14 +629,8 @@ bool RPCutProcessor::_MCPIDFail( lcio::ReconstructedParticle* RPTrack, UTIL::LCR
 		else
 		{
 			int truePDGCode=Parents[0]->getPDG();
-			//search for this code in the integer vector of codes to cut on
-			std::vector<int>::iterator iSearchResult=std::find( _MonteCarloPIDsToCut.begin(), _MonteCarloPIDsToCut.end(), truePDGCode );
-			if( iSearchResult==_MonteCarloPIDsToCut.end() ) 
-				return false; // the PDG code was not found in the vector
-			else 
-			{
-				return true; // the PDG code was found
-			}
+			//search for this code in the (sorted) codes to cut on
+			return std::binary_search( _SortedMonteCarloPIDsToCut.begin(), _SortedMonteCarloPIDsToCut.end(), truePDGCode );
 		}
 	}
 }
@@ -661,3 +708,145 @@ bool  RPCutProcessor::_MCVertexFail(lcio::ReconstructedParticle* RPTrack, UTIL::
 	return false;	
 }
 
+void RPCutProcessor::_addToColumns(ReconstructedParticle* RP)
+{
+	_Columns.RP.push_back(RP);
+	if (RP->getTracks().empty())
+	{
+		//Cut whatever the values are
+		_Columns.AbsD0.push_back(0);
+		_Columns.D0Err.push_back(0);
+		_Columns.AbsZ0.push_back(0);
+		_Columns.Z0Err.push_back(0);
+		_Columns.PT.push_back(0);
+		_Columns.Chi2OverDOF.push_back(0);
+		_Columns.BadParameters.push_back(0);
+		_Columns.RejectedBy.push_back(NoTrack);
+		return;
+	}
+	
+	lcio::Track* Track = RP->getTracks()[0];
+	const std::vector<float>& Cov = Track->getCovMatrix();
+	const double* p = RP->getMomentum();
+	_Columns.AbsD0.push_back(fabs(Track->getD0()));
+	_Columns.D0Err.push_back(Cov[0]);
+	_Columns.AbsZ0.push_back(fabs(Track->getZ0()));
+	_Columns.Z0Err.push_back(Cov[9]);
+	_Columns.PT.push_back(sqrt(p[0]*p[0] + p[1]*p[1]));
+	_Columns.Chi2OverDOF.push_back(Track->getChi2()/(float)Track->getNdf());
+	_Columns.BadParameters.push_back(_BadParametersEnable && _BadParametersFail(RP));
+	_Columns.RejectedBy.push_back(Passed);
+}
+
+void RPCutProcessor::_applyCompiledCuts(UTIL::LCRelationNavigator* pMCRelationNavigator)
+{
+	//Same order as the one RP at a time cuts, so each RP is marked with the first cut it fails and the cuts
+	//that need the MC data only look at the RPs still left
+	std::vector<unsigned char>& RejectedBy = _Columns.RejectedBy;
+	const int n = RejectedBy.size();
+	if (_D0Enable) applyCut(_Columns.AbsD0,_D0CutLowerThan,_D0CutValue,D0Cut,RejectedBy);
+	if (_D0ErrEnable) applyCut(_Columns.D0Err,_D0ErrCutLowerThan,_D0ErrCutValue,D0ErrCut,RejectedBy);
+	if (_Z0Enable) applyCut(_Columns.AbsZ0,_Z0CutLowerThan,_Z0CutValue,Z0Cut,RejectedBy);
+	if (_Z0ErrEnable) applyCut(_Columns.Z0Err,_Z0ErrCutLowerThan,_Z0ErrCutValue,Z0ErrCut,RejectedBy);
+	if (_PTEnable) applyCut(_Columns.PT,_PTCutLowerThan,_PTCutValue,PTCut,RejectedBy);
+	if (_Chi2OverDOFEnable) applyCut(_Columns.Chi2OverDOF,_Chi2OverDOFCutLowerThan,_Chi2OverDOFCutValue,Chi2OverDOFCut,RejectedBy);
+	if (_DetectorHitsEnable)
+	{
+		for (int i=0;i<n;++i)
+			if (RejectedBy[i]==Passed && _DetectorHitsFail(_Columns.RP[i])) RejectedBy[i] = DetectorHitsCut;
+	}
+	if (_MonteCarloPIDEnable)
+	{
+		for (int i=0;i<n;++i)
+			if (RejectedBy[i]==Passed && _MCPIDFail(_Columns.RP[i],pMCRelationNavigator)) RejectedBy[i] = MCPIDCut;
+	}
+	if (_BadParametersEnable)
+	{
+		for (int i=0;i<n;++i) RejectedBy[i] = ( RejectedBy[i]==Passed && _Columns.BadParameters[i] ) ? (unsigned char)BadParametersCut : RejectedBy[i];
+	}
+	if (_MCVertexEnable)
+	{
+		for (int i=0;i<n;++i)
+			if (RejectedBy[i]==Passed && _MCVertexFail(_Columns.RP[i],pMCRelationNavigator)) RejectedBy[i] = MCVertexCut;
+	}
+	
+	for (int i=0;i<n;++i) ++_NumberRejectedBy[RejectedBy[i]];
+}
+
+void RPCutProcessor::_compiledCutEvent(LCCollection* InCol, LCCollection* OutRPCollection, UTIL::LCRelationNavigator* pMCRelationNavigator)
+{
+	//Unpack the cut variables of every RP to be cut. For the particle lists the particles of jet i are
+	//the entries from FirstOfJet[i] to FirstOfJet[i+1]
+	_Columns.RP.clear();
+	_Columns.AbsD0.clear();
+	_Columns.D0Err.clear();
+	_Columns.AbsZ0.clear();
+	_Columns.Z0Err.clear();
+	_Columns.PT.clear();
+	_Columns.Chi2OverDOF.clear();
+	_Columns.BadParameters.clear();
+	_Columns.RejectedBy.clear();
+	
+	int nRCP = InCol->getNumberOfElements()  ;
+	std::vector<ReconstructedParticle*> InputRPs(nRCP);
+	std::vector<int> FirstOfJet(1,0);
+	for(int i=0; i< nRCP ; i++)
+	{
+		InputRPs[i] = dynamic_cast<ReconstructedParticle*>( InCol->getElementAt( i ) );
+		if (_SubParticleLists)
+		{
+			const ReconstructedParticleVec& RPTracks = InputRPs[i]->getParticles();
+			for (ReconstructedParticleVec::const_iterator iRPTrack = RPTracks.begin();iRPTrack != RPTracks.end();++iRPTrack) _addToColumns(*iRPTrack);
+			FirstOfJet.push_back(_Columns.RP.size());
+		}
+		else _addToColumns(InputRPs[i]);
+	}
+	
+	_applyCompiledCuts(pMCRelationNavigator);
+	const std::vector<unsigned char>& RejectedBy = _Columns.RejectedBy;
+	
+	if (_SubsetOutput)
+	{
+		//Just list the RPs that passed
+		for (unsigned int i=0; i<RejectedBy.size(); ++i)
+			if (RejectedBy[i]==Passed) OutRPCollection->addElement(_Columns.RP[i]);
+	}
+	else if (_SubParticleLists)
+	{
+		for(int i=0; i< nRCP ; i++)
+		{
+			ReconstructedParticle* OutputRP;
+			if (_WriteNewCollection)
+			{
+				//Get a copy of the input to cut RPs from
+				OutputRP = new ReconstructedParticleImpl(*dynamic_cast<ReconstructedParticleImpl*>(InputRPs[i]));
+				//To do a proper copy we need to copy the PID objects seperatly and remove the read only
+				//TODO Get around nasty cast
+				((ReconstructedParticleLCFI*)OutputRP)->makeWritable();
+				((ReconstructedParticleLCFI*)OutputRP)->wipePIDs();
+				((ReconstructedParticleLCFI*)OutputRP)->copyPIDsFrom(InputRPs[i]);
+				OutRPCollection->addElement(OutputRP);
+			}
+			else
+			{
+				OutputRP = InputRPs[i];
+			}
+			for (int j=FirstOfJet[i]; j<FirstOfJet[i+1]; ++j)
+			{
+				//TODO Remove nasty cast
+				if (RejectedBy[j]!=Passed) ((ReconstructedParticleLCFI*)OutputRP)->removeParticle(_Columns.RP[j]);
+			}
+		}
+	}
+	else if (_WriteNewCollection)
+	{
+		for(int i=0; i< nRCP ; i++)
+			if (RejectedBy[i]==Passed) OutRPCollection->addElement(InputRPs[i]);
+	}
+	else
+	{
+		//Remove from the back so the positions of the ones still to go don't change
+		for(int i=nRCP-1; i>=0 ; i--)
+			if (RejectedBy[i]!=Passed) InCol->removeElementAt(i);
+	}
+}
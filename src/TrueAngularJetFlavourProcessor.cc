@@ -20,6 +20,8 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <set>
+#include <cstdlib>
 
 using namespace marlin ;
 using namespace lcio;
@@ -81,6 +83,37 @@ void TrueAngularJetFlavourProcessor::init()
 	
 	_nRun = 0 ;
 	_nEvt = 0 ;
+
+	// Work out which PDG codes are heavy hadrons once, instead of for every MC particle.
+	// note this relies on 551/100 = 5 in integer cast!!! (which is true here)
+	_HeavyFlavourOfCode.assign( MaximumReducedCode, 0 );
+	_PartonChargeSignOfCode.assign( MaximumReducedCode, 0 );
+	for( int code=0; code<MaximumReducedCode; code++ )
+	  {
+	    if( code > 1000 )
+	      {
+		// baryons: the parton charge has the sign of the PDG code
+		if( code/1000 == 4 || code/1000 == 5 )
+		  {
+		    _HeavyFlavourOfCode[code] = code/1000;
+		    _PartonChargeSignOfCode[code] = 1;
+		  }
+	      }
+	    else if( code > 100 )
+	      {
+		// mesons: hidden charm or beauty has no parton charge, a B meson has the opposite sign to its PDG code
+		if( code/100 == 4 )
+		  {
+		    _HeavyFlavourOfCode[code] = 4;
+		    _PartonChargeSignOfCode[code] = ( (code/10) %11 == 0 ) ? 0 : 1;
+		  }
+		if( code/100 == 5 )
+		  {
+		    _HeavyFlavourOfCode[code] = 5;
+		    _PartonChargeSignOfCode[code] = ( code %11 == 0 ) ? 0 : -1;
+		  }
+	      }
+	  }
 }
 
 void TrueAngularJetFlavourProcessor::processRunHeader( LCRunHeader* run) { 
@@ -126,258 +159,112 @@ void TrueAngularJetFlavourProcessor::processEvent( LCEvent * evt ) {
 	vector<float> hadronchargedata(MyJets.size(),-100);
 	vector<float> partonchargedata(MyJets.size(),-100);
 
-	std::vector<std::vector<int> > Ntrkjet;
-	bool originalhadron = 0;
-	int code = 0;
-
-	float charge =-100;
-	float pcharge =-100;
-
-	std::vector<MCParticle*> HeavyMCs;
-	std::vector<MCParticle*> JetMCs;
-	std::vector<double>  TrueFlavour;
-	
-	std::vector<int> typepart;
-	std::vector<MCParticle*> daughtercharge;
-
-
 	if( MCParticleCol->getNumberOfElements() == 0 ) std::cerr<<"Warning: TrueAngularFetFlavourProcessor.cc:107 : NO MC data presentjets present "<<std::endl; 
 
-
+	// Find the heavy hadrons, with their flavour from the table made in init()
+	std::vector<MCParticle*> HeavyMCs;
 	for(int nMCpart = 0; nMCpart< MCParticleCol->getNumberOfElements();nMCpart++ )
 	  {
-
-	    pcharge = -100;
 	    MCParticle* MCused = dynamic_cast<MCParticle*> (MCParticleCol->getElementAt(nMCpart));
-	    
-	    //note this whole process relies on 551/100 = 5 in integer cast!!! (which is true here)
-	      
-	    code = abs( MCused->getPDG() );
-	    charge = MCused->getCharge();
-	    
-	    //NOTE: this works only with mokka-06-04-p02 or above. 
-	    // In case you are looking at older versions of mokka please remove the if statement. 
-	    if(charge == -1000  && code >100)
-	      {
-		charge = chargefromPDG(MCused->getPDG());
-	      }
-						
-	    //this little addition will take care of wierder mesons 
-	    if( code  > 10000   )
+	    int pdg = MCused->getPDG();
+	    int code = abs( pdg );
+
+	    //this little addition will take care of wierder mesons, and keeps the code inside the tables
+	    if( code >= MaximumReducedCode )
 	      {
 		code  = code%1000;
 	      }
-	    
-	    if( code  > 1000   )
-	      {
-		
-		if( code/ 1000 == 4   )
-		  {
-		    HeavyMCs.push_back(MCused);   
-		    MCflavour.push_back(4);
-		    MCCharge.push_back(charge);
-		    MCCode.push_back(MCused->getPDG());
-		    if( MCused->getPDG() > 0  )
-		      { pcharge = 1; }
-		    else
-		      { pcharge = -1;}
-		    MCPCharge.push_back(pcharge);
-		  }
-		
-		if( code/ 1000 == 5   )
-		  {
-		    HeavyMCs.push_back(MCused);   
-		    MCflavour.push_back(5);
-		    MCCharge.push_back(charge);
-		    MCCode.push_back(MCused->getPDG());
-		    if( MCused->getPDG() > 0 )
-		      {pcharge = 1; }
-		    else
-		      {pcharge = -1;}
-		    MCPCharge.push_back(pcharge);
-		  }		
-	      }
-	    
-	    if( code  > 100   )
+	    if( _HeavyFlavourOfCode[code] == 0 ) continue;
+
+	    float charge = MCused->getCharge();
+	    //NOTE: this works only with mokka-06-04-p02 or above. 
+	    // In case you are looking at older versions of mokka please remove the if statement. 
+	    if( charge == -1000 )
 	      {
-		if( code / 100  == 4   )
-		  {
-		    HeavyMCs.push_back(MCused);   
-		    MCflavour.push_back(4);
-		    MCCharge.push_back(charge);
-		    MCCode.push_back(MCused->getPDG());
-		  
-		    if ( (code/10) %11 == 0)
-		      {
-			pcharge = 0;
-		      }
-		    else
-		      {
-			if( MCused->getPDG() > 0  )
-			  { pcharge = 1; }
-			else
-			  { pcharge = -1;}
-		      }
-		    MCPCharge.push_back(pcharge);
-		  }    
-		
-		if( code/100 == 5   )
-		  {
-		    HeavyMCs.push_back(MCused);   
-		    MCflavour.push_back(5);
-		    MCCharge.push_back(charge);
-		    MCCode.push_back(MCused->getPDG());
-		    
-		    if ( code %11 == 0)
-		      {
-			pcharge = 0;
-		      }
-		    else
-		      {
-			if( MCused->getPDG() < 0  )
-			  { pcharge = 1; }
-			else
-			  { pcharge = -1;}
-		      }
-		    MCPCharge.push_back(pcharge);
-		  }
-		
+		charge = chargefromPDG( pdg );
 	      }
-	    //std::cout<< "hadron,  "<<MCused->getPDG() << ",    "<< pcharge<<std::endl;
-	  }
 
+	    HeavyMCs.push_back(MCused);
+	    MCflavour.push_back( _HeavyFlavourOfCode[code] );
+	    MCCharge.push_back(charge);
+	    MCCode.push_back(pdg);
+	    MCPCharge.push_back( _PartonChargeSignOfCode[code] * ( pdg > 0 ? 1 : -1 ) );
+	  }
 
+	// Go up the decay chain of each heavy hadron to the first hadron in it. These are what get
+	// matched to the jets; a B and the D it decays to only give one.
+	std::vector<MCParticle*> JetMCs;
+	std::set<MCParticle*> JetMCsFound;
 	for (std::vector<MCParticle*>::const_iterator iParticle = HeavyMCs.begin(); iParticle != HeavyMCs.end() ;++iParticle)	
 	  {
-	    originalhadron =0;
 	    MCParticle* MCused = *iParticle;
-	    while(!originalhadron)
+	    // at hadron level particles can have only 1 parent only at parton level 
+	    // there might be more than 1 parent. if we are at parton level we are too far anyway.
+	    // refer to LCIO manual for details.
+	    while( MCused->getParents().size() == 1 )
 	      {
-		// at hadron level particles can have only 1 parent only at parton level 
-		// there might be more than 1 parent. if we are at parton level we are too far anyway.
-		// refer to LCIO manual for details.
-		if( MCused->getParents().size() == 1) 
-		  {
-		    //		    std::cout<<" ParentalPDG    "<<MCused->getParents()[0]->getPDG()<<std::endl;
-		    if (abs( MCused->getParents()[0]->getPDG()) >100  || (abs(MCused->getParents()[0]->getPDG())>10 && abs(MCused->getParents()[0]->getPDG())<81))
-		      {
-			MCused = MCused->getParents()[0];
-		      }
-		    else
-		      {
-
-			//check if already in the vector
-
-			std::vector<MCParticle*>::const_iterator Doubles = find( JetMCs.begin() ,JetMCs.end() , MCused);
-			if(Doubles == JetMCs.end()|| JetMCs.size() ==0 )
-			  {
-			    //	    std::cout<< MCused->getPDG() <<std::endl;
-			    JetMCs.push_back(MCused);
-			  }  
-			originalhadron = 1;
-		      }
-		  }
-		else
-		  {
-		    //check if already in the vector
-			//unique does not work
-		    std::vector<MCParticle*>::const_iterator Doubles = find(JetMCs.begin(),JetMCs.end(), MCused);
-		    if(Doubles == JetMCs.end()|| JetMCs.size() ==0)
-		      {
-			//			std::cout<<"NUMBER    "<<MCused->getPDG()<<std::endl;
-			JetMCs.push_back(MCused);
-		      }
-			originalhadron = 1;
-		  }
+		int parentCode = abs( MCused->getParents()[0]->getPDG() );
+		if( parentCode > 100 || ( parentCode > 10 && parentCode < 81 ) ) MCused = MCused->getParents()[0];
+		else break;
 	      }
+	    if( JetMCsFound.insert( MCused ).second ) JetMCs.push_back( MCused );
 	  }
 
-	//	std::cout<<JetMCs.size()<<std::endl;
-
-	if(MyJets.size()>0)
+	// The jet directions, worked out once for all the hadrons
+	std::vector<double> jetAxes( 3*MyJets.size() );
+	for( unsigned int JetCounter=0; JetCounter<MyJets.size(); JetCounter++ )
 	  {
+	    const double* Momentum = MyJets[JetCounter]->getMomentum();
+	    double length = sqrt(Momentum[0]*Momentum[0]+Momentum[1]*Momentum[1]+Momentum[2]*Momentum[2]);
+	    for( int k=0; k<3; k++ ) jetAxes[3*JetCounter+k] = Momentum[k]/length;
+	  }
 
-
-		int  MCcounter =0;	    
-	    for(std::vector<MCParticle*>::const_iterator iParticle3 = JetMCs.begin(); iParticle3 != JetMCs.end() ;++iParticle3)
+	for( unsigned int MCcounter=0; MCcounter<JetMCs.size(); MCcounter++ )
+	  {
+	    const double* MomentumMC = JetMCs[MCcounter]->getMomentum();
+	    double length = sqrt(MomentumMC[0]*MomentumMC[0]+MomentumMC[1]*MomentumMC[1]+MomentumMC[2]*MomentumMC[2]);
+	    double normMomMC[3] = { MomentumMC[0]/length, MomentumMC[1]/length, MomentumMC[2]/length };
+
+	    // the closest jet that is within MaximumAngle
+	    double dist = -999999999; 
+	    int JetValue =-1;
+	    double anglestored = 100000;
+	    bool outsideAngle = false;
+	    for( unsigned int JetCounter=0; JetCounter<MyJets.size(); JetCounter++ )
 	      {
-		double dist = -999999999; 
-		int  JetCounter =0;
-		int JetValue =-1;
-		double angle = 0;
-		double anglestored = 100000;
-		vector<double> normMomMC;
-		const double* MomentumMC = (*iParticle3)->getMomentum();
-		double length = sqrt(MomentumMC[0]*MomentumMC[0]+MomentumMC[1]*MomentumMC[1]+MomentumMC[2]*MomentumMC[2]);
-		normMomMC.push_back(MomentumMC[0]/length);
-		normMomMC.push_back(MomentumMC[1]/length);
-		normMomMC.push_back(MomentumMC[2]/length);
-		
-		//		std::cout<<"numberUSED    "<< (*iParticle3)->getPDG() <<std::endl;
-
-		for(std::vector<ReconstructedParticle*>::const_iterator iParticle2 = MyJets.begin(); iParticle2 != MyJets.end() ;++iParticle2)
+		const double* normMom = &jetAxes[3*JetCounter];
+		double disttemp= sqrt(((normMomMC[0]-normMom[0])*(normMomMC[0]-normMom[0]))+
+				      ((normMomMC[1]-normMom[1])*(normMomMC[1]-normMom[1]))+
+				      ((normMomMC[2]-normMom[2])*(normMomMC[2]-normMom[2])));
+		if (disttemp < fabs(dist))
 		  {
-		    vector<double> normMom;
-		    const double* Momentum = (*iParticle2)->getMomentum();
-		    double length = sqrt(Momentum[0]*Momentum[0]+Momentum[1]*Momentum[1]+Momentum[2]*Momentum[2]);
-		    normMom.push_back(Momentum[0]/length);
-		    normMom.push_back(Momentum[1]/length);
-		    normMom.push_back(Momentum[2]/length);
-		    
-		    double disttemp= sqrt(((normMomMC[0]-normMom[0])*(normMomMC[0]-normMom[0]))+
-					  ((normMomMC[1]-normMom[1])*(normMomMC[1]-normMom[1]))+
-					  ((normMomMC[2]-normMom[2])*(normMomMC[2]-normMom[2])));
-
-		    //		    std::cout<<"Disttemp    "<<JetCounter<< "      "<<disttemp<<std::endl;
-
-		   
-
-		    if (disttemp < fabs(dist))
+		    double angle = 180*asin( disttemp/2 )*2/3.14159265;
+		    if(angle<_MaximumAngle)
 		      {
-			 angle = 180*asin( disttemp/2 )*2/3.14159265;
-	
-			if(angle<_MaximumAngle)
-			  {
-			    dist = disttemp;
-			    JetValue = JetCounter;
-			    anglestored = angle;
-			    //			    std::cout<<"Inside    "<<(*iParticle3)->getPDG()<<"           "<<JetValue<<"     "<<anglestored<<std::endl;
-			  }
-			else
-			  {
-      			    std::cout<< "Heavy MC Particle not assigned due to angle cut   "<<std::endl;
-			  }
+			dist = disttemp;
+			JetValue = JetCounter;
+			anglestored = angle;
 		      }
-		    
-		    JetCounter++;
+		    else outsideAngle = true;
 		  }
+	      }
+	    if( outsideAngle && JetValue < 0 ) std::cout<< "Heavy MC Particle not assigned due to angle cut   "<<std::endl;
 
-		if(dist>0 && JetValue >=0)
+	    if(dist>0 && JetValue >=0)
+	      {
+		if(jetflavourdata[JetValue]>3)
 		  {
-		    if(jetflavourdata[JetValue]>3)
+		    if( jetflavourdata[JetValue] == MCflavour[MCcounter] )
 		      {
-			if( jetflavourdata[JetValue] == MCflavour[MCcounter] )
-			  {
-			    if(fabs(jetangledata[JetValue]) > fabs(anglestored))
-			      {			    
-
-				hadronchargedata[JetValue] =  MCCharge[MCcounter];
-				partonchargedata[JetValue] =  MCPCharge[MCcounter];
-				jetcodedata[JetValue] =  int(MCCode[MCcounter]);
-				jetangledata[JetValue] = anglestored;
-
-			      }
-			  }
-			if( jetflavourdata[JetValue] < MCflavour[MCcounter])
-			  {
-			    jetflavourdata[JetValue] =  MCflavour[MCcounter];
+			if(fabs(jetangledata[JetValue]) > fabs(anglestored))
+			  {			    
 			    hadronchargedata[JetValue] =  MCCharge[MCcounter];
 			    partonchargedata[JetValue] =  MCPCharge[MCcounter];
 			    jetcodedata[JetValue] =  int(MCCode[MCcounter]);
 			    jetangledata[JetValue] = anglestored;
 			  }
 		      }
-		    else
+		    if( jetflavourdata[JetValue] < MCflavour[MCcounter])
 		      {
 			jetflavourdata[JetValue] =  MCflavour[MCcounter];
 			hadronchargedata[JetValue] =  MCCharge[MCcounter];
@@ -386,9 +273,14 @@ void TrueAngularJetFlavourProcessor::processEvent( LCEvent * evt ) {
 			jetangledata[JetValue] = anglestored;
 		      }
 		  }
-
-		MCcounter++;
-
+		else
+		  {
+		    jetflavourdata[JetValue] =  MCflavour[MCcounter];
+		    hadronchargedata[JetValue] =  MCCharge[MCcounter];
+		    partonchargedata[JetValue] =  MCPCharge[MCcounter];
+		    jetcodedata[JetValue] =  int(MCCode[MCcounter]);
+		    jetangledata[JetValue] = anglestored;
+		  }
 	      }
 	  }
 	
@@ -1,4 +1,5 @@
 #include "VertexChargeProcessor.h"
+#include "TypedCollection.h"
 #include <iostream>
 #include <sstream>
 
@@ -125,21 +126,20 @@ if( isFirstEvent() )
 	for (unsigned int i = 0 ; i<names->size() ; ++i) std::cout << (*names)[i] << std::endl;
 }
 
-	LCCollection* JetRPCol = evt->getCollection( _JetRPColName );
-	LCCollection* DecayChainRPCol = evt->getCollection( _DecayChainRPColName );
+	TypedCollection<ReconstructedParticle> JetRPCol( evt, _JetRPColName );
+	TypedCollection<ReconstructedParticle> DecayChainRPCol( evt, _DecayChainRPColName );
 	
 	//Find the primary vertex in the event
-	LCCollection* VertexCol;
-	VertexCol = evt->getCollection( _IPVertexCollectionName );
+	TypedCollection<lcio::Vertex> VertexCol( evt, _IPVertexCollectionName );
 	
 	//Search throught the vertices in this colection to find the primary
 	Vector3 IPPos;
 	Matrix3x3 IPErr;
-	int nVerts = VertexCol->getNumberOfElements()  ;
+	int nVerts = VertexCol.size()  ;
 	bool done = 0;
 	for(int i=0; i< nVerts ; i++)
 	{
-		lcio::Vertex* iVertex = dynamic_cast<lcio::Vertex*>(VertexCol->getElementAt(i));
+		lcio::Vertex* iVertex = VertexCol[i];
 		if (iVertex->isPrimary())
 		{
 			IPPos.x() = iVertex->getPosition()[0];
@@ -157,26 +157,27 @@ if( isFirstEvent() )
 	}
 	if (!done) done = 1;//TODO Throw something
 		
-	Event* MyEvent = new Event(IPPos,IPErr);
-	MemoryManager<Event>::Event()->registerObject(MyEvent);
+	//Get the event, jets and decay chains from the conversion cache, they are shared with the other processors
+	LCIOConversionCache* Cache = LCIOConversionCache::forEvent(evt);
+	Event* MyEvent = Cache->event(_JetRPColName,IPPos,IPErr);
 	
 	std::map<Jet*,DecayChain*> DecayChainOf;
 	std::map<Jet*,ReconstructedParticle*> LCIORPOf;
 	//LCRelationNavigator RelNav(evt->getCollection(_RelationColName));
 	//std::cout << evt->getCollection(_RelationColName)->getNumberOfElements() << std::endl;
 	//Jet Loop, for each jet add it to the event and its corresponding decay chain to the map 
-	int nRCP = JetRPCol->getNumberOfElements()  ;
+	int nRCP = JetRPCol.size()  ;
 	
 	if(nRCP ==0 ) std::cerr<<"Warning: VertexChargeProcessor.cc:336 : NO jets present "<<std::endl; 
 	
 
 	for(int i=0; i< nRCP ; i++)
 	{
-		ReconstructedParticle* JetRP = dynamic_cast<ReconstructedParticle*>(JetRPCol->getElementAt(i)); 
-		Jet* ThisJet = jetFromLCIORP(MyEvent,JetRP);
+		ReconstructedParticle* JetRP = JetRPCol[i]; 
+		Jet* ThisJet = Cache->jet(MyEvent,JetRP);
 		LCIORPOf[ThisJet] = JetRP;
 		//Assume Jets and DecayChains in same order in LCIO
-		DecayChainOf[ThisJet] = decayChainFromLCIORP(ThisJet,dynamic_cast<ReconstructedParticle*>(DecayChainRPCol->getElementAt(i)));
+		DecayChainOf[ThisJet] = Cache->decayChain(ThisJet,DecayChainRPCol[i]);
 		//Commented Out as we rely on the order of decay chains and jets being the same
 		/*//Find the Decay chain RP associated with this jet
 		std::cout << JetRPCol->getElementAt(i) <<std::endl;
@@ -213,8 +214,7 @@ if( isFirstEvent() )
 	}//End iJet Loop
 	
 	//std::cout << ",";std::cout.flush();
-	//Clear all objects created for this event
-	MetaMemoryManager::Event()->delAllObjects();
+	//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
 	_nEvt ++ ;
 }
 
@@ -227,6 +227,7 @@ void VertexChargeProcessor::check( LCEvent * evt ) {
 
 void VertexChargeProcessor::end(){ 
 	
+	LCIOConversionCache::clear();
 	MetaMemoryManager::Run()->delAllObjects();
    	std::cout << "VertexChargeProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
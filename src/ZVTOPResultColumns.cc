@@ -0,0 +1,273 @@
+#include "../include/ZVTOPResultColumns.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+#include <inc/decaychain.h>
+#include <inc/jet.h>
+#include <inc/vertex.h>
+
+namespace
+{
+	typedef ZVTOPResultColumns Z;
+
+	const char* const JetColumnNames[Z::NumberOfJetColumns]={ "Run", "Event", "JetIndex", "NumberOfTracks", "NumberOfVertices",
+		"FirstVertex", "NumberOfTrackRows", "FirstTrackRow" };
+	const char* const VertexColumnNames[Z::NumberOfVertexColumns]={ "JetRow", "IsPrimary", "NumberOfTracks", "X", "Y", "Z",
+		"ErrorXX", "ErrorYX", "ErrorYY", "ErrorZX", "ErrorZY", "ErrorZZ", "Chi2", "Probability", "VertexFunctionMax" };
+	const char* const TrackColumnNames[Z::NumberOfTrackColumns]={ "JetRow", "TrackIndex", "VertexRow", "Chi2" };
+	const char* const* const ColumnNames[Z::NumberOfTables]={ JetColumnNames, VertexColumnNames, TrackColumnNames };
+	const int NumberOfColumns[Z::NumberOfTables]={ Z::NumberOfJetColumns, Z::NumberOfVertexColumns, Z::NumberOfTrackColumns };
+	//The columns before this one in each table are ints, the rest floats
+	const int FirstFloatColumn[Z::NumberOfTables]={ Z::NumberOfJetColumns, Z::X, Z::TrackChi2 };
+	const char Magic[ColumnFile::MagicSize]={ 'L', 'C', 'F', 'I', 'Z', 'V', 'T', 'C' };
+	//Words in a chunk header: first run, first event, last run, last event, rows of each table
+	const int ChunkHeaderWords=4+Z::NumberOfTables;
+
+	void appendInt( std::vector<char>& column, int value )
+	{
+		const char* bytes=reinterpret_cast<const char*>( &value );
+		column.insert( column.end(), bytes, bytes+4 );
+	}
+
+	void appendFloat( std::vector<char>& column, double value )
+	{
+		float floatValue=value;
+		const char* bytes=reinterpret_cast<const char*>( &floatValue );
+		column.insert( column.end(), bytes, bytes+4 );
+	}
+
+	//Lexicographic order of (run, event)
+	bool before( int run1, int event1, int run2, int event2 )
+	{
+		return run1<run2 || ( run1==run2 && event1<event2 );
+	}
+}
+
+int ZVTOPResultColumns::numberOfColumns( Table table )
+{
+	return NumberOfColumns[table];
+}
+
+const char* ZVTOPResultColumns::columnName( Table table, int column )
+{
+	return ColumnNames[table][column];
+}
+
+ZVTOPResultColumns::ColumnType ZVTOPResultColumns::columnType( Table table, int column )
+{
+	return column<FirstFloatColumn[table] ? IntColumn : FloatColumn;
+}
+
+ZVTOPResultColumnWriter::ZVTOPResultColumnWriter( const std::string& fileName, int jetsPerChunk )
+	: _File( fileName, Magic, ZVTOPResultColumns::Version, "ZVTOPResultColumnWriter" ), _JetsPerChunk( jetsPerChunk>0 ? jetsPerChunk : 16384 ),
+	_FirstRun(0), _FirstEvent(0), _LastRun(0), _LastEvent(0), _NumberOfJets(0), _NumberOfVertices(0)
+{
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table )
+	{
+		ZVTOPResultColumns::Table thisTable=static_cast<ZVTOPResultColumns::Table>( table );
+		_File.writeWord( NumberOfColumns[table] );
+		for( int column=0; column<NumberOfColumns[table]; ++column )
+			_File.writeColumn( ZVTOPResultColumns::columnType( thisTable, column ), ColumnNames[table][column] );
+		_Columns[table].resize( NumberOfColumns[table] );
+		_Rows[table]=0;
+	}
+}
+
+ZVTOPResultColumnWriter::~ZVTOPResultColumnWriter()
+{
+	try
+	{
+		close();
+	}
+	catch( std::exception& e )
+	{
+		std::cerr << e.what() << std::endl;
+	}
+}
+
+void ZVTOPResultColumnWriter::addJet( int runNumber, int eventNumber, int jetIndex, const vertex_lcfi::DecayChain* pDecayChain )
+{
+	using vertex_lcfi::Track;
+	using vertex_lcfi::Vertex;
+
+	//Chunks end between events, so the jets of an event are always in the same chunk
+	if( _Rows[ZVTOPResultColumns::Jets]>=_JetsPerChunk && jetIndex==0 ) _writeChunk();
+	if( _Rows[ZVTOPResultColumns::Jets]==0 )
+	{
+		_FirstRun=runNumber;
+		_FirstEvent=eventNumber;
+	}
+	_LastRun=runNumber;
+	_LastEvent=eventNumber;
+
+	std::vector<std::vector<char> >& jetColumns=_Columns[ZVTOPResultColumns::Jets];
+	std::vector<std::vector<char> >& vertexColumns=_Columns[ZVTOPResultColumns::Vertices];
+	std::vector<std::vector<char> >& trackColumns=_Columns[ZVTOPResultColumns::Tracks];
+	const int jetRow=_Rows[ZVTOPResultColumns::Jets];
+	const int firstVertex=_Rows[ZVTOPResultColumns::Vertices];
+	const int firstTrackRow=_Rows[ZVTOPResultColumns::Tracks];
+
+	//The position of each track in the jet, sorted by track so it can be searched
+	const std::vector<Track*>& jetTracks=pDecayChain->jet()->tracks();
+	std::vector<std::pair<Track*,int> > indexOfTrack;
+	for( size_t i=0; i<jetTracks.size(); ++i ) indexOfTrack.push_back( std::make_pair( jetTracks[i], int(i) ) );
+	std::sort( indexOfTrack.begin(), indexOfTrack.end() );
+	std::vector<char> inVertex( jetTracks.size(), 0 );
+
+	const std::vector<Vertex*>& vertices=pDecayChain->vertices();
+	for( std::vector<Vertex*>::const_iterator iVertex=vertices.begin(); iVertex!=vertices.end(); ++iVertex )
+	{
+		const Vertex& vertex=**iVertex;
+		const int vertexRow=_Rows[ZVTOPResultColumns::Vertices]++;
+		++_NumberOfVertices;
+		appendInt( vertexColumns[ZVTOPResultColumns::VertexJetRow], jetRow );
+		appendInt( vertexColumns[ZVTOPResultColumns::IsPrimary], vertex.isPrimary() );
+		appendInt( vertexColumns[ZVTOPResultColumns::VertexNumberOfTracks], vertex.tracks().size() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::X], vertex.position().x() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::Y], vertex.position().y() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::Z], vertex.position().z() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorXX], vertex.positionError()(0,0) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorYX], vertex.positionError()(1,0) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorYY], vertex.positionError()(1,1) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorZX], vertex.positionError()(2,0) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorZY], vertex.positionError()(2,1) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::ErrorZZ], vertex.positionError()(2,2) );
+		appendFloat( vertexColumns[ZVTOPResultColumns::VertexChi2], vertex.chi2() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::Probability], vertex.probability() );
+		appendFloat( vertexColumns[ZVTOPResultColumns::VertexFunctionMax], vertex.vertexFuncMaxValue() );
+
+		const std::map<Track*,double>& chi2OfTracks=vertex.chi2OfTracks();
+		for( std::vector<Track*>::const_iterator iTrack=vertex.tracks().begin(); iTrack!=vertex.tracks().end(); ++iTrack )
+		{
+			int trackIndex=-1;
+			std::vector<std::pair<Track*,int> >::const_iterator iIndex=std::lower_bound( indexOfTrack.begin(), indexOfTrack.end(), std::make_pair( *iTrack, -1 ) );
+			if( iIndex!=indexOfTrack.end() && iIndex->first==*iTrack )
+			{
+				trackIndex=iIndex->second;
+				inVertex[trackIndex]=1;
+			}
+			std::map<Track*,double>::const_iterator iChi2=chi2OfTracks.find( *iTrack );
+
+			appendInt( trackColumns[ZVTOPResultColumns::TrackJetRow], jetRow );
+			appendInt( trackColumns[ZVTOPResultColumns::TrackIndex], trackIndex );
+			appendInt( trackColumns[ZVTOPResultColumns::VertexRow], vertexRow );
+			appendFloat( trackColumns[ZVTOPResultColumns::TrackChi2], iChi2==chi2OfTracks.end() ? -1 : iChi2->second );
+			++_Rows[ZVTOPResultColumns::Tracks];
+		}
+	}
+
+	//The tracks of the jet that are in no vertex
+	for( size_t i=0; i<jetTracks.size(); ++i )
+	{
+		if( inVertex[i] ) continue;
+		appendInt( trackColumns[ZVTOPResultColumns::TrackJetRow], jetRow );
+		appendInt( trackColumns[ZVTOPResultColumns::TrackIndex], i );
+		appendInt( trackColumns[ZVTOPResultColumns::VertexRow], -1 );
+		appendFloat( trackColumns[ZVTOPResultColumns::TrackChi2], -1 );
+		++_Rows[ZVTOPResultColumns::Tracks];
+	}
+
+	appendInt( jetColumns[ZVTOPResultColumns::Run], runNumber );
+	appendInt( jetColumns[ZVTOPResultColumns::Event], eventNumber );
+	appendInt( jetColumns[ZVTOPResultColumns::JetIndex], jetIndex );
+	appendInt( jetColumns[ZVTOPResultColumns::JetNumberOfTracks], jetTracks.size() );
+	appendInt( jetColumns[ZVTOPResultColumns::NumberOfVertices], vertices.size() );
+	appendInt( jetColumns[ZVTOPResultColumns::FirstVertex], firstVertex );
+	appendInt( jetColumns[ZVTOPResultColumns::NumberOfTrackRows], _Rows[ZVTOPResultColumns::Tracks]-firstTrackRow );
+	appendInt( jetColumns[ZVTOPResultColumns::FirstTrackRow], firstTrackRow );
+	++_Rows[ZVTOPResultColumns::Jets];
+	++_NumberOfJets;
+}
+
+void ZVTOPResultColumnWriter::close()
+{
+	if( !_File.isOpen() ) return;
+	_writeChunk();
+	_File.close();
+}
+
+void ZVTOPResultColumnWriter::_writeChunk()
+{
+	if( _Rows[ZVTOPResultColumns::Jets]==0 ) return;
+
+	std::vector<unsigned int> header;
+	header.push_back( _FirstRun );
+	header.push_back( _FirstEvent );
+	header.push_back( _LastRun );
+	header.push_back( _LastEvent );
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table ) header.push_back( _Rows[table] );
+	std::vector<const std::vector<char>*> blocks;
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table )
+		for( size_t i=0; i<_Columns[table].size(); ++i ) blocks.push_back( &_Columns[table][i] );
+	_File.writeChunk( header, blocks );
+
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table )
+	{
+		for( size_t i=0; i<_Columns[table].size(); ++i ) _Columns[table][i].clear();
+		_Rows[table]=0;
+	}
+}
+
+ZVTOPResultColumnReader::ZVTOPResultColumnReader( const std::string& fileName )
+	: _File( fileName, Magic, ZVTOPResultColumns::Version, "ZVTOPResultColumnReader", "a ZVTOP result column file" )
+{
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table )
+	{
+		ZVTOPResultColumns::Table thisTable=static_cast<ZVTOPResultColumns::Table>( table );
+		unsigned int numberOfColumns=_File.readWord();
+		if( numberOfColumns!=static_cast<unsigned int>( NumberOfColumns[table] ) ) _File.fail( "does not have the columns expected" );
+		for( unsigned int column=0; column<numberOfColumns; ++column )
+		{
+			unsigned int type;
+			std::string name;
+			_File.readColumn( type, name );
+			if( name!=ColumnNames[table][column] || type!=static_cast<unsigned int>( ZVTOPResultColumns::columnType( thisTable, column ) ) )
+				_File.fail( "does not have the columns expected" );
+		}
+		_NumberOfRows[table]=0;
+		_Rows[table]=0;
+		_Column[table].assign( numberOfColumns, static_cast<const void*>( 0 ) );
+	}
+
+	_File.indexChunks( ChunkHeaderWords );
+	for( int chunk=0; chunk<_File.numberOfChunks(); ++chunk )
+		for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table ) _NumberOfRows[table]+=_File.chunkWord( chunk, 4+table );
+}
+
+ZVTOPResultColumnReader::~ZVTOPResultColumnReader()
+{
+}
+
+int ZVTOPResultColumnReader::findChunk( int runNumber, int eventNumber ) const
+{
+	for( int chunk=0; chunk<_File.numberOfChunks(); ++chunk )
+	{
+		int firstRun=_File.chunkWord( chunk, 0 ), firstEvent=_File.chunkWord( chunk, 1 );
+		int lastRun=_File.chunkWord( chunk, 2 ), lastEvent=_File.chunkWord( chunk, 3 );
+		if( !before( runNumber, eventNumber, firstRun, firstEvent ) && !before( lastRun, lastEvent, runNumber, eventNumber ) )
+			return chunk;
+	}
+	return -1;
+}
+
+int ZVTOPResultColumnReader::readChunk( int chunk )
+{
+	_File.readChunk( chunk, _Blocks, _BlockSizes );
+	size_t block=0;
+	for( int table=0; table<ZVTOPResultColumns::NumberOfTables; ++table )
+	{
+		_Rows[table]=_File.chunkWord( chunk, 4+table );
+		const unsigned int valuesSize=4*_Rows[table];
+		for( size_t i=0; i<_Column[table].size(); ++i, ++block )
+		{
+			if( block>=_Blocks.size() || _BlockSizes[block]!=valuesSize ) _File.fail( "has a corrupt chunk" );
+			_Column[table][i]=_Blocks[block];
+		}
+	}
+	if( block!=_Blocks.size() ) _File.fail( "has a corrupt chunk" );
+	return _Rows[ZVTOPResultColumns::Jets];
+}
@@ -12,9 +12,12 @@
 #include <algo/inc/zvkin.h>
 #include <util/inc/matrix.h>
 #include <inc/lciointerface.h>
+#include "TypedCollection.h"
+#include "ZVTOPResultColumns.h"
 
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 using namespace marlin ;
 using namespace lcio;
@@ -101,6 +104,10 @@ ZVTOPZVKINProcessor::ZVTOPZVKINProcessor() : Processor("ZVTOP_ZVKINProcessor") {
 			      "If true the chi squared contributions of tracks to vertices is written to LCIO"  ,
 			      _OutputTrackChi2,
 			      false) ;
+  registerOptionalParameter( "ColumnFile" , 
+			      "If set, the vertices and tracks of the decay chain of every jet are also written to this column file"  ,
+			      _ColumnFileName,
+			      std::string("")) ;
 }
 
 
@@ -112,6 +119,9 @@ void ZVTOPZVKINProcessor::init() {
   _nRun = 0 ;
   _nEvt = 0 ;
   
+  _ColumnWriter = 0;
+  if (!_ColumnFileName.empty()) _ColumnWriter = new ZVTOPResultColumnWriter(_ColumnFileName);
+  
   //Make the ZVKIN algorithm object and set its parameters
   _ZVKIN = new ZVKIN();
   MemoryManager<Algo<Jet*,DecayChain*> >::Run()->registerObject(_ZVKIN);
@@ -130,8 +140,7 @@ void ZVTOPZVKINProcessor::processRunHeader( LCRunHeader* run) {
 
 void ZVTOPZVKINProcessor::processEvent( LCEvent * evt ) { 
 	//Make Event from 
-	LCCollection* JetCollection;
-	JetCollection = evt->getCollection( _JetRPCollectionName );
+	TypedCollection<ReconstructedParticle> JetCollection( evt, _JetRPCollectionName );
 	
 	//Create an Event with an IP determined by the parameters or a vertex
 	Vector3 IPPos;
@@ -153,15 +162,14 @@ void ZVTOPZVKINProcessor::processEvent( LCEvent * evt ) {
 	else
 	{
 		//Find the primary vertex in the event
-		LCCollection* VertexCol;
-		VertexCol = evt->getCollection( _IPVertexCollectionName );
+		TypedCollection<lcio::Vertex> VertexCol( evt, _IPVertexCollectionName );
 		
 		//Search throught the vertices in this colection to find the primary
-		int nVerts = VertexCol->getNumberOfElements()  ;
+		int nVerts = VertexCol.size()  ;
 		bool done = 0;
 		for(int i=0; i< nVerts ; i++)
 		{
-			lcio::Vertex* iVertex = dynamic_cast<lcio::Vertex*>(VertexCol->getElementAt(i));
+			lcio::Vertex* iVertex = VertexCol[i];
 			if (iVertex->isPrimary())
 			{
 				IPPos.x() = iVertex->getPosition()[0];
@@ -179,8 +187,9 @@ void ZVTOPZVKINProcessor::processEvent( LCEvent * evt ) {
 		}
 		if (!done) done = 1;//TODO Throw something
 	}
-	//Create an event with this IP
-	vertex_lcfi::Event* MyEvent = new vertex_lcfi::Event(IPPos,IPErr);
+	//Get the event with this IP from the conversion cache, so the jets are shared with later processors
+	LCIOConversionCache* Cache = LCIOConversionCache::forEvent(evt);
+	vertex_lcfi::Event* MyEvent = Cache->event(_JetRPCollectionName,IPPos,IPErr);
 	
 	//Create jets from LCIO and add them to the event
 	std::vector<std::string>::const_iterator it = find(evt->getCollectionNames()->begin(),evt->getCollectionNames()->end(),_DecayChainCollectionName);
@@ -190,25 +199,37 @@ void ZVTOPZVKINProcessor::processEvent( LCEvent * evt ) {
 			LCCollection* MyCollection = new LCCollectionVec("ReconstructedParticle");
 			evt->addCollection(MyCollection,_DecayChainCollectionName);
 		}
-	int nRCP = JetCollection->getNumberOfElements()  ;
+	LCCollection* DecayChainCollection = evt->getCollection(_DecayChainCollectionName);
+	int nRCP = JetCollection.size()  ;
+	std::vector<DecayChain*> ZVTOPResults;
+	ZVTOPResults.reserve(nRCP);
 	for(int i=0; i< nRCP ; i++)
 	{
-		Jet* MyJet = jetFromLCIORP(MyEvent,dynamic_cast<ReconstructedParticle*>(JetCollection->getElementAt(i)));
+		Jet* MyJet = Cache->jet(MyEvent,JetCollection[i]);
 	
 		//Set any jet depandant parameters
 		
 		//Run ZVTOP-ZVKIN
 		DecayChain* ZVTOPResult = _ZVKIN->calculateFor(MyJet);
+		ZVTOPResults.push_back(ZVTOPResult);
 		
-		//Store resulting decay chain in the LCIO file
-		ReconstructedParticle* LCIOZVTOPResult = addDecayChainToLCIOEvent(evt, ZVTOPResult,_VertexCollectionName, _DecayChainRPTracksCollectionName, _OutputTrackChi2);
+		if (_ColumnWriter) _ColumnWriter->addJet(evt->getRunNumber(), evt->getEventNumber(), i, ZVTOPResult);
+	}
+	
+	//Store the resulting decay chains in the LCIO file. The output collections are looked up, and
+	//made big enough, once for all the jets
+	LCIODecayChainWriter Writer(evt,_VertexCollectionName, _DecayChainRPTracksCollectionName, _OutputTrackChi2);
+	Writer.reserve(ZVTOPResults);
+	for(int i=0; i< nRCP ; i++)
+	{
+		ReconstructedParticle* LCIOZVTOPResult = Writer.add(ZVTOPResults[i]);
 		
 		//Store the RP that holds all the vertexed tracks in LCIO
-		evt->getCollection(_DecayChainCollectionName)->addElement(LCIOZVTOPResult);
+		DecayChainCollection->addElement(LCIOZVTOPResult);
 		
 		//Commented out as we just rely on order
 		/*//LC Relate DecayChain and Jet
-		LCRelation* NewRelation = new LCRelationImpl(LCIOZVTOPResult,JetCollection->getElementAt(i));
+		LCRelation* NewRelation = new LCRelationImpl(LCIOZVTOPResult,JetCollection[i]);
 		it = find(evt->getCollectionNames()->begin(),evt->getCollectionNames()->end(),_RelationCollectionName);
 		if (it == evt->getCollectionNames()->end())
 		{
@@ -219,8 +240,7 @@ void ZVTOPZVKINProcessor::processEvent( LCEvent * evt ) {
 		evt->getCollection(_RelationCollectionName)->addElement(NewRelation);
 		*/
 	}
-	//Clear all objects created for this event
-	MetaMemoryManager::Event()->delAllObjects();
+	//Objects created for this event are deleted by the LCIOConversionCache when the next event starts
 	_nEvt ++ ;
 }
 
@@ -233,6 +253,28 @@ void ZVTOPZVKINProcessor::check( LCEvent * evt ) {
 
 void ZVTOPZVKINProcessor::end(){ 
   
+	if (_ColumnWriter)
+	{
+		_ColumnWriter->close();
+		long NumberOfJets = _ColumnWriter->numberOfJets();
+		long NumberOfVertices = _ColumnWriter->numberOfVertices();
+		delete _ColumnWriter;
+		_ColumnWriter = 0;
+		std::cout << name() << " wrote " << NumberOfJets << " jets to " << _ColumnFileName << std::endl;
+		
+		//Read the file back, so a file that can't be used is found now rather than when it is analysed
+		try
+		{
+			ZVTOPResultColumnReader Check(_ColumnFileName);
+			if (Check.numberOfJets() != NumberOfJets || Check.numberOfVertices() != NumberOfVertices)
+				throw std::runtime_error(_ColumnFileName + " does not read back the jets and vertices written to it");
+		}
+		catch (std::runtime_error& Error)
+		{
+			throw lcio::Exception(std::string("ZVTOPZVKINProcessor: ") + Error.what());
+		}
+	}
+	LCIOConversionCache::clear();
 	MetaMemoryManager::Run()->delAllObjects();
    	std::cout << "ZVTOPZVKINProcessor::end()  " << name() 
  	    << " processed " << _nEvt << " events in " << _nRun << " runs "
@@ -91,6 +91,32 @@ namespace vertex_lcfi
 		\return Map containing the following keys: RPhi, Z and ThreeD
 		*/
 	       std::map<Projection, double> calculateFor(Jet* MyJet) const;
+
+		//! Log Track Probability
+		/*!
+		Logarithm of the probability for a track of the given significance, normalised to that of a track
+		with zero significance, as it enters the product over the tracks of the jet
+		\param Significance absolute significance of the track, less than MaxD0Significance
+		\param Proj RPhi, Z or ThreeD
+		\return logarithm of the normalised probability
+		*/
+		double logTrackProbability(double Significance, Projection Proj) const;
+
+		//! Combined Probability
+		/*!
+		Joint probability of a jet from the product of the normalised probabilities of its tracks.
+		The product is passed as its logarithm, so that it can't underflow for jets with many tracks.
+		\param LogTotalProduct sum of the logarithms of the track probabilities
+		\param NumTracks number of tracks in the product
+		\return joint probability, -1 if there are no tracks
+		*/
+		static double combinedProbability(double LogTotalProduct, int NumTracks);
+
+		//! Maximum |d0| and |z0| of the tracks used
+		double maxD0andZ0() const {return _MaxD0andZ0;}
+
+		//! Maximum significance of the tracks used
+		double maxD0Significance() const {return _MaxD0Significance;}
 		
 	private:
 		std::string _Name;
@@ -105,7 +131,22 @@ namespace vertex_lcfi
 		std::vector<double> temp2;
 		double _MaxD0Significance;
 		double _MaxD0andZ0;
-		double probparam(double, int, double  ) const;
+		
+		//The resolution function of one coordinate with everything that doesn't depend on the
+		//significance worked out beforehand, updated whenever the parameters change
+		struct ResolutionFunction
+		{
+			double Sigma;
+			double GaussianScale;
+			double GaussianAtMaximum;
+			double TailFraction[2];
+			double TailSlope[2];
+			double TailAtMaximum[2];
+			double LogNormalisation; //log of the function at zero significance
+		};
+		ResolutionFunction _Resolution[3]; //(d0,z0,3-d)
+		void updateResolutionFunctions();
+		double probparam(double, int ) const;
 	  };
 
 	}
@@ -96,6 +96,15 @@ namespace vertex_lcfi
 		"Z0SigTrack2","MomentumTrack1","MomentumTrack2".
 		*/
 	       std::map<SignificanceType, double> calculateFor(Jet* MyJet) const;
+
+		//! Number of vertex detector layers a track needs to have hit to pass the lower momentum cut
+		double layersHit() const {return _LayersHit;}
+
+		//! Momentum cut for tracks that hit one layer less than LayersHit
+		double allButOneLayersMomentumCut() const {return _AllbutOneLayersMomentumCut;}
+
+		//! Momentum cut for tracks that hit LayersHit layers or more
+		double allLayersMomentumCut() const {return _AllLayersMomentumCut;}
 		
 	private:		
 	       double _LayersHit;
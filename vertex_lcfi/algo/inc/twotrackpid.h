@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <iostream>
 #include <inc/jet.h>
 #include <inc/algo.h>
 #include <util/inc/string.h>
@@ -32,6 +33,10 @@ namespace vertex_lcfi
 	  \param RPhiCut cut on the maximum RPhi of the vertex that the tracks form.
 	  \param SignificanceCut cut on the minimum rphi significance of the tracks with respect to the IP.
 
+	  The cuts are applied to each pair cheapest first: significance, charge, mass and only then the
+	  vertex fit (RPhiCut and Chi2Cut). How many pairs each stage rejects is counted over all the jets
+	  the algorithm has been run on, see pairCounters().
+
 	  \author Erik Devetak (e.devetak1@physics.ox.ac.uk)
 	*/
 	class TwoTrackPid:
@@ -95,12 +100,41 @@ namespace vertex_lcfi
 		satisfy these criteria. 
 		*/
 		std::map<PidCutType, std::vector<Track*> > calculateFor(Jet* MyJet) const;
+
+		//! Number of track pairs rejected at each stage of the selection
+		struct PairCounters
+		{
+			unsigned int Pairs;
+			unsigned int FailedSignificance;
+			unsigned int FailedCharge;
+			unsigned int FailedMass;
+			unsigned int FailedVertex;
+			unsigned int Gamma;
+			unsigned int KShort;
+		};
+
+		//! Pair Counters
+		/*!
+		Counts of the track pairs looked at and rejected at each stage since construction or the last reset
+		\return the counters
+		*/
+		const PairCounters & pairCounters() const {return _PairCounters;}
+
+		//! Reset Pair Counters
+		void resetPairCounters();
+
+		//! Print Pair Counters
+		/*!
+		\param os stream to print the counters to
+		*/
+		void printPairCounters(std::ostream & os) const;
 		
 		private:
 		double _MaxGammaMass,_MinKsMass,_MaxKsMass,_Chi2Cut, _RPhiCut, _SignificanceCut;
 		std::string _Name;
 		std::vector<std::string> _ParameterNames;
 		mutable std::vector<std::string> _ParameterValues;
+		mutable PairCounters _PairCounters;
 	};
 }
 #endif //LCFITWOTRACKPID_H
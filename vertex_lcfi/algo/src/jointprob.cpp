@@ -7,6 +7,8 @@
 #include <string>
 #include <map>
 #include <iostream> 
+#include <limits>
+#include <cmath>
 #include <util/inc/string.h>
 
 namespace vertex_lcfi
@@ -43,6 +45,7 @@ namespace vertex_lcfi
     temp2.push_back(0.0237413906);
 
     _ResolutionParameter3D = temp2;
+    updateResolutionFunctions();
 
     _ParameterNames.push_back("MaxD0Significance");
     _ParameterNames.push_back("MaxD0andZ0");
@@ -88,6 +91,7 @@ namespace vertex_lcfi
     if (Parameter == "MaxD0Significance")
        {
 	 _MaxD0Significance = Value;
+	 updateResolutionFunctions();
 	 return;
        }
     if (Parameter == "MaxD0andZ0")
@@ -103,16 +107,19 @@ namespace vertex_lcfi
      if (Parameter == "ResolutionParameterRphi")
        {
 	 _ResolutionParameterRphi = *(std::vector<double>*) Value;
+	 updateResolutionFunctions();
 	 return;
        }
    if (Parameter == "ResolutionParameterZ")
       {
 	_ResolutionParameterZ = *(std::vector<double>*) Value;
+	updateResolutionFunctions();
 	return;
       }
    if (Parameter == "ResolutionParameter3D")
       {
 	_ResolutionParameter3D = *(std::vector<double>*) Value;
+	updateResolutionFunctions();
 	return;
       }
     else this->badParameter(Parameter);
@@ -124,16 +131,14 @@ namespace vertex_lcfi
     std::map<Projection,double> ResultMap;
         
     
-    double totalprod[3] = {1,1,1};
+    // the products are accumulated as sums of logarithms, which don't underflow for jets with many tracks
+    double totallog[3] = {0,0,0};
     double jprob[3] = {0,0,0};
     int ntraks[3] = {0,0,0};
     int j= 0;  
-    int k= 0;
     double maxdz = _MaxD0andZ0; // maximum cuts for d0 and z0 implemented below
     double maxd0sig = _MaxD0Significance; // maximum cuts for d0 significance implemented below
-    double significancecompare = 0;
-    float sigma = 0 ; 
-    float fact =0;
+    double significance[3] = {0,0,0};
     
 
      
@@ -145,35 +150,16 @@ namespace vertex_lcfi
 	  {
 	    
 	    //(d0,z0,3-d)
+	    significance[0] = fabs((*iTrack)->significance(RPhi));
+	    significance[1] = fabs((*iTrack)->significance(Z));
+	    significance[2] = fabs((*iTrack)->significance(ThreeD));
+	    
 	    for(j = 0; j<3; j++ )
 	      {
-		switch (j)
-		{
-		case 0:
-		  {
-		    significancecompare =  fabs((*iTrack)->significance(RPhi));
-		    break;
-		  }
-		case 1:
-		  {
-		    significancecompare =  fabs((*iTrack)->significance( Z/*,MyJet->momentum()*/  ));
-
-		    break;
-		  }
-		case 2:
+		if( significance[j] < maxd0sig )
 		  {
-		   significancecompare = fabs((*iTrack)->significance(ThreeD));
-		   break;
-		  }
-		} 
-			  
-		if( significancecompare < maxd0sig )
-		  {
-		    
-		    //calculate vertex parameter probability and multiply them, notice the normalization function
-		    totalprod[j] *=  probparam( significancecompare  ,j , maxd0sig )/ probparam( 0  , j, maxd0sig  );
-		    
-
+		    //calculate vertex parameter probability and add up the logarithms, notice the normalization function
+		    totallog[j] += log( probparam( significance[j], j ) ) - _Resolution[j].LogNormalisation;
 		    ntraks[j]++;
 		  }
 	      }
@@ -184,28 +170,7 @@ namespace vertex_lcfi
     
     for( j = 0; j<3; j++ )
       {
-	
-	if( ntraks[j]>0 )
-	  {
-	    fact =1;
-	    sigma = 0;
-	    
-	    for( k =0; k <  ntraks[j]; k++ ) 
-	      {
-		
-		if( k > 0 ) fact *= k;
-		else	  fact = 1 ;
-		
-		//the summation over the tracks
-		
-		sigma += pow( ( -log( totalprod[j] ) ), k ) / fact;
-		
-	      }
-	    //and here we combine everything in the final probability
-	    jprob[j] = totalprod[j] * sigma;
-	  }
-	
-	else jprob [j] = -1; //default no chance value
+	jprob[j] = combinedProbability( totallog[j], ntraks[j] );
       }
 
     ResultMap[RPhi] = jprob[0];
@@ -215,53 +180,101 @@ namespace vertex_lcfi
     return ResultMap;
   }
   
-  double JointProb::probparam(double parameter, int thecoord, double maxd0sig   ) const
+  double JointProb::combinedProbability(double LogTotalProduct, int NumTracks)
   {
+    if( NumTracks<=0 ) return -1; //default no chance value
     
-    double prob = 0;
-    double resolutionparameters[3][5];
+    // The joint probability is P * sum_k (-ln P)^k / k! for k < NumTracks. Each term is
+    // worked out as a logarithm, so P can be far smaller than the smallest double.
+    double x = -LogTotalProduct;
+    if( x <= 0 ) return 1; // every track had zero significance
+    if( x > std::numeric_limits<double>::max() ) return 0; // a track at the edge of the resolution function
+    
+    double logx = log( x );
+    double logterm = -x; // the k = 0 term is P itself
+    double sigma = exp( logterm );
+    
+    for( int k = 1; k < NumTracks; k++ ) 
+      {
+	logterm += logx - log( double(k) );
+	sigma += exp( logterm );
+      }
+    
+    return sigma;
+  }
+
+  double JointProb::logTrackProbability(double Significance, Projection Proj) const
+  {
+    //probparam numbers the coordinates (d0,z0,3-d)
+    int coord = (Proj == RPhi) ? 0 : ((Proj == Z) ? 1 : 2);
+    return log( probparam( Significance, coord ) ) - _Resolution[coord].LogNormalisation;
+  }
+
+  void JointProb::updateResolutionFunctions()
+  {
+    const std::vector<double>* parameters[3] = {&_ResolutionParameterRphi, &_ResolutionParameterZ, &_ResolutionParameter3D};
     if (_ResolutionParameterRphi.size() != 5 || _ResolutionParameterZ.size() != 5 || _ResolutionParameter3D.size() != 5) 
-    std::cerr << "Warning jointprob.cpp:229 Parameters of wrong length" << std::endl;
-    for( int iii=0; iii<5; iii++)
-    {
-	resolutionparameters[0][iii] = _ResolutionParameterRphi[iii];
-	resolutionparameters[1][iii] = _ResolutionParameterZ[iii];
-	resolutionparameters[2][iii] = _ResolutionParameter3D[iii];
-    }
+    std::cerr << "Warning jointprob.cpp: Resolution parameters of wrong length" << std::endl;
+    
+    for( int coord = 0; coord < 3; coord++ )
+      {
+	// missing parameters are taken as zero
+	double p[5] = {0,0,0,0,0};
+	for( unsigned int iii = 0; iii < 5 && iii < parameters[coord]->size(); iii++ ) p[iii] = (*parameters[coord])[iii];
+	
+	ResolutionFunction& f = _Resolution[coord];
+	f.Sigma = p[0];
+	f.TailFraction[0] = p[1];
+	f.TailSlope[0] = p[2];
+	f.TailFraction[1] = p[3];
+	f.TailSlope[1] = p[4];
+	
+	// the terms at the maximum significance, subtracted so that the function is zero there
+	if( coord < 2 )
+	  {
+	    f.GaussianScale = 1.0 / ( sqrt( double(2) ) * p[0] );
+	    f.GaussianAtMaximum = erfc( _MaxD0Significance / ( sqrt( double(2) ) * p[0] ) );
+	  }
+	else
+	  {
+	    f.GaussianScale = 1.0 / ( p[0] * p[0] * double ( 2 ) );
+	    f.GaussianAtMaximum = exp(- ( _MaxD0Significance * _MaxD0Significance ) / ( p[0] * p[0] * double ( 2 ) ) );
+	  }
+	for( int t = 0; t < 2; t++ )
+	  {
+	    f.TailAtMaximum[t] = exp(- f.TailSlope[t] * _MaxD0Significance );
+	    if( coord == 2 ) f.TailAtMaximum[t] *= ( 1 + f.TailSlope[t] * _MaxD0Significance );
+	  }
+	
+	f.LogNormalisation = log( probparam( 0, coord ) );
+      }
+  }
+
+  double JointProb::probparam(double parameter, int thecoord) const
+  {
+    
+    const ResolutionFunction& f = _Resolution[thecoord];
+    double prob = 0;
     
     // The if statement takes into account a different parametrization for different coordinates. 
     if ( thecoord < 2 )
       {
 	// part one is the gaussian part
 	// to understand this part better one should look at the meaning of the complementary error function
-	prob = erfc( parameter / (sqrt( double(2) ) * resolutionparameters[thecoord][0] ))
-	  -erfc( maxd0sig / ( sqrt( double(2) ) *  resolutionparameters[thecoord][0] ) );
+	prob = erfc( parameter * f.GaussianScale ) - f.GaussianAtMaximum;
 	
 	// part 2 is the added exponential tails
-      
-      prob += resolutionparameters[thecoord][1]* ( exp(- resolutionparameters[thecoord][2] * parameter )
-						   -exp(- resolutionparameters[thecoord][2] * maxd0sig ) )
-	+resolutionparameters[thecoord][3]* ( exp(- resolutionparameters[thecoord][4] * parameter )
-					      -exp(- resolutionparameters[thecoord][4] * maxd0sig ) );
-      
-      
+	prob += f.TailFraction[0] * ( exp(- f.TailSlope[0] * parameter ) - f.TailAtMaximum[0] )
+	  + f.TailFraction[1] * ( exp(- f.TailSlope[1] * parameter ) - f.TailAtMaximum[1] );
       }
     else
       {
 	
 	//in this view the gaussian part is just squared. 
-	
-	prob = exp(- ( parameter * parameter ) /  ( resolutionparameters[thecoord][0] * resolutionparameters[thecoord][0] * double ( 2 ) ) ) 
-	  -exp(- ( maxd0sig * maxd0sig )  /  ( resolutionparameters[thecoord][0] * resolutionparameters[thecoord][0] * double ( 2 ) ) );
+	prob = exp(- ( parameter * parameter ) * f.GaussianScale ) - f.GaussianAtMaximum;
 
-	prob +=  resolutionparameters[thecoord][1]* ( ( 1 + resolutionparameters[thecoord][2] * parameter )
-						      *exp ( - resolutionparameters[thecoord][2] * parameter )
-						      - ( 1 + resolutionparameters[thecoord][2] * maxd0sig )
-						      *exp ( - resolutionparameters[thecoord][2] * maxd0sig ))
-	  +resolutionparameters[thecoord][3]* ( ( 1 + resolutionparameters[thecoord][4] * parameter )
-						*exp ( - resolutionparameters[thecoord][4] * parameter )
-						- ( 1 + resolutionparameters[thecoord][4] * maxd0sig )
-						*exp ( - resolutionparameters[thecoord][4] * maxd0sig ));
+	prob += f.TailFraction[0] * ( ( 1 + f.TailSlope[0] * parameter ) * exp ( - f.TailSlope[0] * parameter ) - f.TailAtMaximum[0] )
+	  + f.TailFraction[1] * ( ( 1 + f.TailSlope[1] * parameter ) * exp ( - f.TailSlope[1] * parameter ) - f.TailAtMaximum[1] );
 	
       }
 
@@ -11,6 +11,7 @@
 #include <inc/trackstate.h>
 #include <inc/track.h>
 #include <util/inc/memorymanager.h>
+#include <algorithm>
 
 
 // author Erik Devetak
@@ -100,33 +101,36 @@ namespace vertex_lcfi
     dummy.clear();
     double closeapproach;
     double LoD;
-    int numberoftracks = 0;
-    int  vertexcounter = 0;
     int tempvertex =0;
     DecayChain* DecaywithAtTracks = new DecayChain(*MyDecayChain);
     MemoryManager<DecayChain> ::Event()->registerObject(DecaywithAtTracks);
-    std::vector<vertex_lcfi::Track > AttachedTracks;
-    std::vector<Track*> Innertracks;
-    
-    for (std::vector<Vertex*>::const_iterator iVertex = (MyDecayChain->vertices().begin()); iVertex != MyDecayChain->vertices().end() ;++iVertex)
-      {
-
-	numberoftracks = (*iVertex)->tracks( ).size();
-
-	if ( numberoftracks > 1 || vertexcounter > 0 )
-	  {
-	    tempvertex = vertexcounter;
-	  }
-	vertexcounter++;
-      }
-    
-    tempvertex = (MyDecayChain->vertices().size()-1);
+    const std::vector<Track*> & JetTracks = MyDecayChain->jet()->tracks();
     
     if (MyDecayChain->vertices().empty())
 	    std::cerr << "Empty Decay Chain - trackattach.cpp:119" << std::endl;
 
+    //the seed is the last vertex of the chain
+    tempvertex = (MyDecayChain->vertices().size()-1);
+    
+    //Sorted lists of the tracks in the decay chain and of those in its secondary vertices, so the
+    //membership tests below are binary searches rather than searches through every vertex
+    std::vector<Track*> ChainTracks;
+    std::vector<Track*> Innertracks;
+    ChainTracks.reserve(JetTracks.size());
+    for (std::vector<Vertex*>::const_iterator iVertex = (MyDecayChain->vertices().begin()); iVertex != MyDecayChain->vertices().end() ;++iVertex)
+      {
+	const std::vector<Track*> & VertexTracks = (*iVertex)->tracks();
+	ChainTracks.insert(ChainTracks.end(), VertexTracks.begin(), VertexTracks.end());
+	if (_AddAllTracksFromSecondary == true && iVertex != MyDecayChain->vertices().begin())
+	  Innertracks.insert(Innertracks.end(), VertexTracks.begin(), VertexTracks.end());
+      }
+    ChainTracks.insert(ChainTracks.end(), MyDecayChain->attachedTracks().begin(), MyDecayChain->attachedTracks().end());
+    std::sort(ChainTracks.begin(), ChainTracks.end());
+    ChainTracks.erase(std::unique(ChainTracks.begin(), ChainTracks.end()), ChainTracks.end());
+    std::sort(Innertracks.begin(), Innertracks.end());
 
-    VertexPos = (MyDecayChain->vertices()[tempvertex]->position()).subtract( (MyDecayChain->vertices()[0])->position() );
+    const Vector3 & IPPos = MyDecayChain->vertices()[0]->position();
+    VertexPos = (MyDecayChain->vertices()[tempvertex]->position()).subtract( IPPos );
 
     distance =  VertexPos.mag();
 
@@ -155,76 +159,52 @@ namespace vertex_lcfi
 	Track LinearTrack(0,LinearHelix,mom,0.0,dummy,std::vector<int>());	
 	
 	TrackState* TSLin = LinearTrack.makeState();
-	TrackState* TSHel;
+	const Vector3 & SeedPos = MyDecayChain->vertices()[tempvertex]->position();
 
 
-	for (std::vector<Track*>::const_iterator iTrack = (MyDecayChain->jet()->tracks().begin()); iTrack != MyDecayChain->jet()->tracks().end() ;++iTrack)
+	for (std::vector<Track*>::const_iterator iTrack = JetTracks.begin(); iTrack != JetTracks.end() ;++iTrack)
 	  {
-
-
-	    //new addition to find tracks not from primary but associated with a vertex
-
-	    if (_AddAllTracksFromSecondary == true )
-	      {
-		for (std::vector<Vertex*>::const_iterator iVertex = (++MyDecayChain->vertices().begin()); iVertex != MyDecayChain->vertices().end() ;++iVertex)
-		  {	
-		    
-		    if((*iVertex)->hasTrack(*iTrack))
-		      {
-
-			Innertracks.push_back(*iTrack);
-		      }
-		  }
-	      }
-
-	    TSHel = (**iTrack).makeState();  
+	    TrackState TSHel((*iTrack)->helixRep(), (*iTrack)->charge(), (*iTrack)->covarianceMatrix(), *iTrack);
 
 	    //this is a smart way of solving many problems
 	    // we swim near to the vertex since the cut is then perfomed at the vertex.
 	    //so if we have too many iterations we can cut the track
+	    //(for a charged track the line is reset to its reference point by the line-helix swim anyway,
+	    //so this only matters for neutral ones)
 
-	    TSLin->swimToStateNearest( MyDecayChain->vertices()[tempvertex]->position() );
+	    if (TSHel.isNeutral())
+	      TSLin->swimToStateNearest( SeedPos );
 
-       	    TSLin->swimToStateNearest( TSHel );
-	    TSHel->swimToStateNearest( TSLin );
+       	    TSLin->swimToStateNearest( &TSHel );
+	    TSHel.swimToStateNearest( TSLin );
 
-	    closeapproach = ((*TSHel).position().subtract((*TSLin).position())).mag();
+	    closeapproach = (TSHel.position().subtract((*TSLin).position())).mag();
 
-	    LoD = (TSLin->position().subtract((MyDecayChain->vertices()[0])->position())).mag();
+	    Vector3 FromIP = TSLin->position().subtract(IPPos);
+	    LoD = FromIP.mag();
 	    
-	    if( 0 > TSLin->position().subtract(MyDecayChain->vertices()[0]->position()).dot( VertexPos ) )
+	    if( 0 > FromIP.dot( VertexPos ) )
 	    {
 	      LoD = LoD * (-1);
 	    }
 
+	    bool InChain = std::binary_search(ChainTracks.begin(), ChainTracks.end(), *iTrack);
 	    if ( (LoD/distance)> _LoDCutmin && (LoD/distance)< _LoDCutmax && (closeapproach < _CloseapproachCut) )
 	      {
 
-		if(  DecaywithAtTracks->hasTrack(*iTrack) == 0 )
+		if( !InChain )
 		  {
 		    
 		    DecaywithAtTracks->addTrack(*iTrack);
+		    ChainTracks.insert(std::lower_bound(ChainTracks.begin(), ChainTracks.end(), *iTrack), *iTrack);
 		  }
 	      }
-	    else
+	    else if ( InChain )
 	      {
-		if (_AddAllTracksFromSecondary == true )
+		if (_AddAllTracksFromSecondary == false || !std::binary_search(Innertracks.begin(), Innertracks.end(), *iTrack))
 		  {
-		    std::vector<Track*>::const_iterator Inner = find(Innertracks.begin(),Innertracks.end(),*iTrack );
-		    if(Inner == Innertracks.end())
-		      {
-			if(DecaywithAtTracks->hasTrack(*iTrack) == 1)
-			  {
-			    DecaywithAtTracks->removeTrack(*iTrack);
-			  }
-		      }
-		  }
-		else
-		  {
-		    if(DecaywithAtTracks->hasTrack(*iTrack) == 1)
-		      {
-			DecaywithAtTracks->removeTrack(*iTrack);
-		      }
+		    DecaywithAtTracks->removeTrack(*iTrack);
+		    ChainTracks.erase(std::lower_bound(ChainTracks.begin(), ChainTracks.end(), *iTrack));
 		  }
 	      }
 	   
@@ -232,20 +212,17 @@ namespace vertex_lcfi
       }
     else
       {
-	for (std::vector<Track*>::const_iterator iTrack = (MyDecayChain->jet()->tracks().begin()); iTrack != MyDecayChain->jet()->tracks().end() ;++iTrack)
+	for (std::vector<Track*>::const_iterator iTrack = JetTracks.begin(); iTrack != JetTracks.end() ;++iTrack)
 	  {
-	    if(DecaywithAtTracks->hasTrack(*iTrack) == 1)
+	    if(std::binary_search(ChainTracks.begin(), ChainTracks.end(), *iTrack))
 	      {
 		DecaywithAtTracks->removeTrack(*iTrack);
 	      }
 	  }
       }
     
-    //    std::cout<<"I AM FINISHED"<<std::endl;    
     return DecaywithAtTracks;
     
   }
-  
-
       
 }
@@ -30,6 +30,7 @@ namespace vertex_lcfi
 	  _ParameterNames.push_back("Chi2Cut");
 	  _ParameterNames.push_back("RPhiCut");
 	  _ParameterNames.push_back("SignificanceCut");
+	  resetPairCounters();
 
 	}
 
@@ -100,6 +101,25 @@ namespace vertex_lcfi
 	this->badParameter(Parameter);
 	}
 	
+	void TwoTrackPid::resetPairCounters()
+	{
+	  _PairCounters.Pairs = 0;
+	  _PairCounters.FailedSignificance = 0;
+	  _PairCounters.FailedCharge = 0;
+	  _PairCounters.FailedMass = 0;
+	  _PairCounters.FailedVertex = 0;
+	  _PairCounters.Gamma = 0;
+	  _PairCounters.KShort = 0;
+	}
+
+	void TwoTrackPid::printPairCounters(std::ostream & os) const
+	{
+	  os << "TwoTrackPid: " << _PairCounters.Pairs << " track pairs, rejected by significance " << _PairCounters.FailedSignificance
+	     << ", charge " << _PairCounters.FailedCharge << ", mass " << _PairCounters.FailedMass
+	     << ", vertex " << _PairCounters.FailedVertex << "; accepted as gamma " << _PairCounters.Gamma
+	     << ", as Ks " << _PairCounters.KShort << std::endl;
+	}
+
         std::map< PidCutType,std::vector<Track*> > TwoTrackPid::calculateFor(Jet* MyJet) const
 	{
 	  
@@ -110,7 +130,6 @@ namespace vertex_lcfi
 	  double RPhiProjection;
 	  InteractionPoint* IP = 0;
 	  double momentummagnitude;
-	  std::vector< TrackState* > AllTrackStates;
 	  VertexFitterLSM Fitter;
 	  double eeCalculatedM = 0;
 	  double pipiCalculatedM = 0;
@@ -131,117 +150,124 @@ namespace vertex_lcfi
 	  ResultMap[Gamma] = Dummy;
 	  ResultMap[KShort] = Dummy;
 
-	  //nested loop running over pairs of tracks. 
+	  const std::vector<Track*> & Tracks = MyJet->tracks();
+	  const int NumTracks = Tracks.size();
+	  if (NumTracks < 2) return ResultMap;
 
+	  //Everything that only depends on one track is worked out once per track rather than once per pair:
+	  //whether it passes the significance cut, its energy under the electron and pion hypotheses,
+	  //and a TrackState to vertex it with (reset to the reference point before each fit, so the fit
+	  //starts from the same state as a newly made one)
+	  std::vector<bool> Significant(NumTracks);
+	  std::vector<double> eeEnergy(NumTracks);
+	  std::vector<double> pipiEnergy(NumTracks);
+	  std::vector<TrackState> States;
+	  States.reserve(NumTracks);
+	  for (int i=0; i<NumTracks; ++i)
+	    {
+	      Significant[i] = Tracks[i]->significance(RPhi) > significancecut;
+	      double p2 = Tracks[i]->momentum().mag2();
+	      eeEnergy[i] = sqrt(p2+electronmass2);
+	      pipiEnergy[i] = sqrt(p2+pionmass2);
+	      States.push_back(TrackState(Tracks[i]));
+	    }
+	  std::vector<TrackState*> PairStates(2);
 
-	  if( MyJet->tracks().size()>0)
+	  //nested loop running over pairs of tracks. The cuts are applied cheapest first, so the vertex
+	  //fit is only done for pairs that would be accepted on charge and mass.
+	  for (int i=0; i<NumTracks-1; ++i)
 	    {
-	      for(std::vector<Track*>::const_iterator iTrack= (MyJet->tracks().begin()); iTrack != --(MyJet->tracks().end()) ;++iTrack)
+	      for (int j=i+1; j<NumTracks; ++j)
 		{
-		  
-		  for(std::vector<Track*>::const_iterator iTrack2 =  iTrack+1 ; iTrack2 != (MyJet->tracks().end()) ;++iTrack2)
+		  ++_PairCounters.Pairs;
+
+		  //check both tracks d0 significance
+		  if (!Significant[i] || !Significant[j])
+		    {
+		      ++_PairCounters.FailedSignificance;
+		      continue;
+		    }
+
+		  //check that the charge of the tracks is opposite
+		  if ((Tracks[i]->charge() + Tracks[j]->charge()) != 0)
+		    {
+		      ++_PairCounters.FailedCharge;
+		      continue;
+		    }
+
+		  Vector3 Totalmomentum;
+		  Totalmomentum = Totalmomentum.add(Tracks[j]->momentum());
+		  Totalmomentum = Totalmomentum.add(Tracks[i]->momentum());
+		  momentummagnitude = Totalmomentum.mag2();
+
+		  //here we are just using the standard e^2 =m^2 +p^2s
+		  //first with the electron mass
+		  eeCalculatedM = pow(eeEnergy[j]+eeEnergy[i],2)-  momentummagnitude;
+		  if (eeCalculatedM >0)
+		    {
+		      eeCalculatedM = sqrt(eeCalculatedM);
+		    }
+		  else
+		    {
+		      eeCalculatedM = 0;
+		    }
+
+		  //then assume pion mass
+		  pipiCalculatedM = pow(pipiEnergy[j]+pipiEnergy[i],2)-  momentummagnitude;
+		  if (pipiCalculatedM >0)
+		    {
+		      pipiCalculatedM = sqrt(pipiCalculatedM);
+		    }
+		  else
+		    {
+		      pipiCalculatedM = 0;
+		    }
+
+		  //here we assume that a track will never end up in both
+		  //given the different mass I think it is a fair assumption
+		  //NB the Ks window has always been applied as the chained comparison
+		  //(MinKsMass < pipiCalculatedM) < MaxKsMass, kept as it is so the output doesn't change
+		  PidCutType Type;
+		  if (eeCalculatedM < MaxGammaMass)
+		    Type = Gamma;
+		  else if ((MinKsMass < pipiCalculatedM) < MaxKsMass)
+		    Type = KShort;
+		  else
+		    {
+		      ++_PairCounters.FailedMass;
+		      continue;
+		    }
+
+		  //vertex the tracks and see what happens.
+		  States[i].resetToRef();
+		  States[j].resetToRef();
+		  PairStates[0] = &States[i];
+		  PairStates[1] = &States[j];
+		  Fitter.fitVertex( PairStates, IP,  Position, chi2  );
+
+		  //the rphi projection
+		  RPhiProjection = Position.mag(RPhi);
+
+		  //cuts on position of the vertecs and its significance.
+		  if (!(RPhiProjection < RPhiCut && chi2< Chi2Cut))
+		    {
+		      ++_PairCounters.FailedVertex;
+		      continue;
+		    }
+
+		  if (Type == Gamma) ++_PairCounters.Gamma;
+		  else ++_PairCounters.KShort;
+
+		  //these algorithms basically put the tracks into the map in the case that they are not there already!
+		  std::vector<Track*> & Result = ResultMap[Type];
+		  if (find(Result.begin(),Result.end(),Tracks[i]) == Result.end())
+		    {
+		      Result.push_back(Tracks[i]);
+		    }
+		  if (find(Result.begin(),Result.end(),Tracks[j]) == Result.end())
 		    {
-		      //check first track d0 significance
-
-		      if( (*iTrack)->significance(RPhi) > significancecut  )
-			{
-			  
-			  AllTrackStates.push_back( (**iTrack).makeState() );
-			  
-			  //check second track d0 significance
-			  if( (*iTrack2)->significance(RPhi) > significancecut  )      
-			    {
-			      
-			      //chack that the charge of the tracks is opposite)
-			   if (((*iTrack)->charge() + (*iTrack2)->charge()) == 0)
-			     {
-			       //vertex the tracks and see what happens. 
-			       AllTrackStates.push_back( (**iTrack2).makeState() );
-			       
-			       Fitter.fitVertex( AllTrackStates, IP,  Position, chi2  );
-			       
-			       //the rphi projection
-			       RPhiProjection = Position.mag(RPhi);
-			       
-			       //cuts on position of the vertecs and its significance. 
-			       if( RPhiProjection < RPhiCut && chi2< Chi2Cut  )
-				 {
-				   Vector3 Totalmomentum;
-				   Totalmomentum = Totalmomentum.add((**iTrack2).momentum());
-				   Totalmomentum = Totalmomentum.add((**iTrack).momentum());
-				   momentummagnitude = Totalmomentum.mag2();
-				   
-				   //here we are just using the standard e^2 =m^2 +p^2s
-				   //first with the electron mass
-
-				   eeCalculatedM = pow(sqrt((**iTrack2).momentum().mag2()+electronmass2)+
-						       sqrt((**iTrack).momentum().mag2()+electronmass2),2)-  momentummagnitude;
-				   if (eeCalculatedM >0)
-				     {
-				       eeCalculatedM = sqrt(eeCalculatedM);
-				       
-				     }
-				   else
-				     {
-				       eeCalculatedM = 0;
-				     }
-
-				  //then assume pion mass
-				   
-				   pipiCalculatedM = pow(sqrt((**iTrack2).momentum().mag2()+pionmass2)+
-							 sqrt((**iTrack).momentum().mag2()+pionmass2),2)-  momentummagnitude;
-				   if (pipiCalculatedM >0)
-				     {
-				       pipiCalculatedM = sqrt(pipiCalculatedM);
-				     }
-				   else
-				     {
-				       pipiCalculatedM = 0;
-				     }
-				   
-
-				   //here we assume that a track will never end up in both
-				   //given the different mass I think it is a fair assumption
-				   if(eeCalculatedM < MaxGammaMass)
-				     {
-
-				       //these algorithms basically put the tracks into the map in the case that they are not there already!
-				       std::vector<Track*>::const_iterator iTrack3 = find(ResultMap[Gamma].begin(),ResultMap[Gamma].end(), (*iTrack));
-				       if(iTrack3 == ResultMap[Gamma].end() )
-					 {
-					   ResultMap[Gamma].push_back(*iTrack);
-					 }
-				       
-				       
-				       std::vector<Track*>::const_iterator iTrack4 = find(ResultMap[Gamma].begin(),ResultMap[Gamma].end(), (*iTrack2)); 
-				       if(iTrack4 == ResultMap[Gamma].end() )
-					 {
-					   ResultMap[Gamma].push_back(*iTrack2);
-					 }
-				     }
-				   else if( MinKsMass < pipiCalculatedM <MaxKsMass )
-				     { 
-				       std::vector<Track*>::const_iterator iTrack3 = find(ResultMap[KShort].begin(),ResultMap[KShort].end(), (*iTrack));
-				       if(iTrack3 == ResultMap[KShort].end() )
-					 {
-					   ResultMap[KShort].push_back(*iTrack);
-
-					 }
-				       std::vector<Track*>::const_iterator iTrack4 = find(ResultMap[KShort].begin(),ResultMap[KShort].end(), (*iTrack2));
-				       if(iTrack4 == ResultMap[KShort].end() )
-					 {
-					   ResultMap[KShort].push_back(*iTrack2);
-
-					 }
-				     }
-				 }
-			       
-			     }
-			    }
-			}
-		      
-		      AllTrackStates.clear();
-		    } 
+		      Result.push_back(Tracks[j]);
+		    }
 		}
 	    }
 	  return ResultMap;
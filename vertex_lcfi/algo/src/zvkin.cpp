@@ -211,6 +211,7 @@ namespace vertex_lcfi
 						MyVertex = new Vertex(MyJet->event(), Tracks, (*iCV)->interactionPoint()->position(), (*iCV)->interactionPoint()->errorMatrix(), (bool)(*iCV)->interactionPoint(),0,0);
 				}
 				MemoryManager<Vertex>::Event()->registerObject(MyVertex);
+				MyVertex->vertexFuncMaxValue() = (*iCV)->vertexFuncMaxValue();
 				//Remove the ghost!
 				MyVertex->removeTrack(GhostTrack);
 				VResult.push_back(MyVertex);
@@ -12,6 +12,12 @@
 #include <inc/jet.h>
 #include <inc/event.h>
 #include <inc/vertex.h>
+#include <inc/decaychain.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
 
 using namespace lcio;
 using namespace vertex_lcfi;
@@ -25,6 +31,122 @@ DecayChain* decayChainFromLCIORP(Jet* MyJet, ReconstructedParticle* DecayChainRP
 lcio::Vertex* vertexFromLCFIVertex(vertex_lcfi::Vertex* MyLCFIVertex);
 vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEvent);
 
+//!Per event cache of the objects converted from LCIO
+/*!
+Several processors in a chain convert the same LCIO jets, tracks and decay chains for the same event.
+The cache lets the later processors reuse the objects made by the first one, so the conversion (and
+anything the objects cache themselves, such as the track significances) is done once per event.
+<br>Every processor calls forEvent() at the start of processEvent, before it makes any event lifetime
+objects of its own, whether or not it uses the cache. When the LCIO event is not the one the cache was
+made for, all event lifetime objects are deleted first with MetaMemoryManager::Event()->delAllObjects(),
+so this is the only place they are deleted during the job and processors must not call that
+themselves. clear() deletes everything, for use at the end of the job.
+<br>The event a cache was made for is marked with a transient collection (MarkerCollectionName) holding
+an id no other cache in the process has. The pointer, run and event number are not enough, as an
+event can be allocated where the last one was freed and the numbers repeat between input files.
+<br>Events are identified by a key (normally the name of the jet or track collection they are made
+from) together with the IP, so processors that use different collections or a different IP get
+their own vertex_lcfi::Event, exactly as if they had converted it themselves. Jets, tracks and decay
+chains are identified by their Event or Jet and the LCIO ReconstructedParticle they come from.
+Processors must treat cached objects as read only.
+*/
+class LCIOConversionCache
+{
+	public:
+	//! Cache for an LCIO event
+	/*!
+	\param LCIOEvent the event being processed
+	\return the cache, emptied if LCIOEvent is a new event
+	*/
+	static LCIOConversionCache* forEvent(LCEvent* LCIOEvent);
+	
+	//! Delete the cache and all event lifetime objects
+	static void clear();
+	
+	//! Name of the collection that marks the event with the id of its cache
+	static const char* const MarkerCollectionName;
+	
+	~LCIOConversionCache();
+	
+	//! Event for a key and IP
+	/*!
+	\param Key name of the collection the event is made from
+	\param IPPos position of the IP
+	\param IPErr error matrix of the IP
+	\return the cached Event, or a new empty one
+	*/
+	vertex_lcfi::Event* event(const std::string & Key, const Vector3 & IPPos, const SymMatrix3x3 & IPErr);
+	
+	//! Track from an LCIO ReconstructedParticle, as trackFromLCIORP
+	/*!
+	A newly converted track is also added to MyEvent.
+	*/
+	vertex_lcfi::Track* track(Event* MyEvent, lcio::ReconstructedParticle* RP);
+	
+	//! Jet from an LCIO ReconstructedParticle, as jetFromLCIORP
+	/*!
+	A newly converted jet is added to MyEvent, its tracks are taken from track().
+	*/
+	vertex_lcfi::Jet* jet(Event* MyEvent, lcio::ReconstructedParticle* RP);
+	
+	//! DecayChain from an LCIO ReconstructedParticle, as decayChainFromLCIORP
+	DecayChain* decayChain(Jet* MyJet, lcio::ReconstructedParticle* DecayChainRP);
+	
+	private:
+	LCIOConversionCache(LCEvent* LCIOEvent);
+	
+	static int idOf(LCEvent* LCIOEvent);
+	
+	static LCIOConversionCache* _Current;
+	static int _LastId;
+	
+	int _Id;
+	std::vector<std::pair<std::string, vertex_lcfi::Event*> > _Events;
+	std::map<std::pair<vertex_lcfi::Event*, lcio::ReconstructedParticle*>, vertex_lcfi::Track*> _Tracks;
+	std::map<std::pair<vertex_lcfi::Event*, lcio::ReconstructedParticle*>, vertex_lcfi::Jet*> _Jets;
+	std::map<std::pair<vertex_lcfi::Jet*, lcio::ReconstructedParticle*>, DecayChain*> _DecayChains;
+};
+
+//!Writes the decay chains of the jets of an event into LCIO collections
+/*!
+Does the same as addDecayChainToLCIOEvent, but for all the jets of an event. The output collections
+are found (or made) once when the writer is made, and the primary vertex once it has been found or
+made for the first decay chain, so neither the collection names nor the vertex collection are
+searched again for every jet. reserve() makes room in the output collections for a set of decay
+chains in one go, so a processor that runs over all its jets first only grows them once.
+<br>The writer only lives as long as the LCIO event it writes to.
+*/
+class LCIODecayChainWriter
+{
+	public:
+	//! Writer for an LCIO event
+	/*!
+	\param MyLCIOEvent the event to write to
+	\param VertexCollectionName vertex collection, made if not in the event
+	\param TrackRPCollectionName collection for the track and decayed particle RPs, made if not in the event
+	\param StoreTrackChiSquareds if true the chi squared of each track is stored in TrackRPCollectionName+"TrackChiSquareds"
+	*/
+	LCIODecayChainWriter(LCEvent* MyLCIOEvent, const std::string & VertexCollectionName, const std::string & TrackRPCollectionName, bool StoreTrackChiSquareds=false);
+	
+	//! Make room in the output collections for these decay chains
+	void reserve(const std::vector<DecayChain*> & DecayChains);
+	
+	//! Write one decay chain, as addDecayChainToLCIOEvent
+	/*!
+	\return the RP holding all the tracks and decayed particles of the chain, 0 if it has no vertices
+	*/
+	ReconstructedParticle* add(DecayChain* MyDecayChain);
+	
+	private:
+	lcio::Vertex* _primaryVertex(DecayChain* MyDecayChain);
+	
+	LCCollection* _VertexCollection;
+	LCCollection* _TrackRPCollection;
+	LCCollection* _ChiSquaredCollection;
+	lcio::Vertex* _PrimaryVertex;
+	int _VerticesSearched;
+};
+
 class ReconstructedParticleLCFI : private IMPL::ReconstructedParticleImpl 
 {
 	public:
@@ -92,6 +92,16 @@ namespace vertex_lcfi
 		\return double of the significance of the track
 		*/
 		double signedSignificance(Projection Proj, Jet *MyJet) const;		
+		
+		//! Impact parameter of the track
+		/*!
+		Distance from the event IP to the point of closest approach, taken in the XY plane
+		for RPhi and Z (the z component for Z) and in 3D for ThreeD.
+		\param Proj Projection to take the impact parameter in
+		\return double of the unsigned impact parameter
+		*/
+		double impactParameter(Projection Proj) const;
+		
 		//! Number of hits in each sub detector
 		/*!
 		\return vector of ints
@@ -99,6 +109,20 @@ namespace vertex_lcfi
 		inline const std::vector<int> & hitsInSubDetectors() const
 		{return _NumHitsSubDetector;}
 		
+		//! Number of hits in one sub detector
+		/*!
+		\param SubDetector Index of the sub detector, as in hitsInSubDetectors()
+		\return int number of hits, 0 if there is no such sub detector
+		*/
+		inline int hitsInSubDetector(unsigned int SubDetector) const
+		{return SubDetector<_NumHitsSubDetector.size() ? _NumHitsSubDetector[SubDetector] : 0;}
+		
+		//! Total number of hits
+		/*!
+		\return int sum of the hits over all the sub detectors
+		*/
+		int numberOfHits() const;
+		
 		
 		//! Tracking Number
 		/*!
@@ -115,6 +139,21 @@ namespace vertex_lcfi
 		SymMatrix5x5		_CovarianceMatrix;
 		std::vector<int>	_NumHitsSubDetector;
 		void*			_TrackingNum;
+		
+		//Impact parameters and significances, worked out when first asked for and indexed by Projection.
+		//They are thrown away if the helix is changed or the IP moves.
+		mutable bool		_IPValid[3];
+		mutable double		_IP[3];
+		mutable double		_IPSignificance[3];
+		mutable bool		_POCAVectorXYValid;
+		mutable Vector3		_POCAVectorXY;
+		mutable HelixRep	_IPCacheHelix;
+		mutable Vector3		_IPCachePosition;
+		mutable SymMatrix3x3	_IPCacheError;
+		void _invalidateIPCache() const;
+		void _checkIPCache() const;
+		const Vector3 & _pocaVectorXY() const;
+		void _calculateSignificance(Projection Proj) const;
 	};
 	
 	template <class charT, class traits> inline
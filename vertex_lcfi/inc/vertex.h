@@ -30,7 +30,7 @@ namespace vertex_lcfi
 	public:
 		
 		//! Default Constuctor
-		Vertex() {}
+		Vertex() : _VertexFuncMaxValue(0),_SortedTracksValid(0) {}
 		
 		//! Full Constructor
 		/*!
@@ -86,7 +86,7 @@ namespace vertex_lcfi
 		Add a track to the vertex. Does not affect fit. Will not be added if duplicate
 		\param AddTrack Pointer to track to add to vertex
 		*/
-		inline void addTrack(Track* AddTrack) {_Tracks.push_back(AddTrack);}
+		inline void addTrack(Track* AddTrack) {_Tracks.push_back(AddTrack);_SortedTracksValid=0;}
 		
 		//! Remove Track
 		/*!
@@ -98,6 +98,7 @@ namespace vertex_lcfi
 		
 		//! Does vertex contain this Track?
 		/*!
+		Binary search of a sorted copy of the track list, which is made on the first call after the tracks change
 		\param HTrack Pointer to track to check vertex for
 		\return 1 if Track found 0 if not
 		*/
@@ -141,7 +142,7 @@ namespace vertex_lcfi
 		/*!
 		\return map of doubles with Track* key of each tracks chi^2 contribution
 		*/
-		inline std::map<Track*,double> chi2OfTracks() const {return _ChiSquaredOfTrack;}
+		inline const std::map<Track*,double> & chi2OfTracks() const {return _ChiSquaredOfTrack;}
 		
 		//! Probability
 		/*!
@@ -149,6 +150,17 @@ namespace vertex_lcfi
 		*/
 		inline double probability() const {return _Probability;}
 		
+		//! Vertex function maximum
+		/*!
+		\return Value of the ZVTOP vertex function V(r) at the maximum the vertex was found at, 0 if not set (only ZVRES and ZVKIN set it)
+		*/
+		inline double vertexFuncMaxValue() const {return _VertexFuncMaxValue;}
+		//! Vertex function maximum
+		/*!
+		\return Reference to the value of V(r) at the maximum the vertex was found at
+		*/
+		inline double & vertexFuncMaxValue() {return _VertexFuncMaxValue;}
+		
 		//! Radius
 		/*!
 		Distance from the vertex postion to the event's interaction point
@@ -193,6 +205,11 @@ namespace vertex_lcfi
 		double _Chi2;
 		double _Probability;
 		std::map<Track*,double> _ChiSquaredOfTrack;
+		double _VertexFuncMaxValue;
+		
+		//Caching Variables
+		mutable bool _SortedTracksValid;
+		mutable std::vector<vertex_lcfi::Track*> _SortedTracks;
 	};
 
 	}
@@ -47,6 +47,12 @@ public:
 	void setEpochsBeforeGradientReset(const int numberOfEpochs) {_epochsBeforeGradientReset = numberOfEpochs;}
 	void setProgressPrintoutFrequency(const int frequency) {_progressPrintoutFrequency = frequency;}
 	std::vector<double> getTrainingErrorValuesPerEpoch() const {return _savedEpochErrorValues;}
+	// Number of threads used to evaluate the error function and its gradient over the data set,
+	// 0 means one per processor. With more than one thread (or 0) the data set is summed in fixed
+	// blocks that are added up in order, so the result doesn't depend on the number of threads,
+	// but is not bitwise the same as the default single threaded sum.
+	void setNumberOfThreads(const int n) {_numberOfThreads = n;}
+	int numberOfThreads() const {return _numberOfThreads;}
 
 protected:
     double trainWithDataSet(const int numberOfEpochs);
@@ -59,6 +65,7 @@ protected:
 	double error();
 	double newEpoch(bool &success,double &gradient);
 	double processDataSet();
+	double processDataSetInParallel();
     double beta(const std::vector<double> &gk,const std::vector<double> &gkplus1,const std::vector<double> &dk);
 	double betaFR(const std::vector<double> &gk,const std::vector<double> &gkplus1);
 	double betaPR(const std::vector<double> &gk,const std::vector<double> &gkplus1);
@@ -96,6 +103,9 @@ private:
 	double _linearSearchAbsGradientCutoff;
     double _previousEpochStepLength;
     std::vector<double> _previousEpochDeltaWeights;
+	int _numberOfThreads;
+	std::vector<double> _packedInputs;
+	std::vector<double> _packedTargets;
 };
 
 }//namespace nnet
@@ -0,0 +1,127 @@
+#ifndef COMPILEDNEURALNET_H
+#define COMPILEDNEURALNET_H
+
+#include "NeuralNetConfig.h"
+
+#include <vector>
+
+#ifdef __CINT__
+#include "NeuralNet.h"
+#include "Neuron.h"
+#include "InputNormaliser.h"
+#else
+namespace nnet
+{
+class NeuralNet;
+class Neuron;
+class InputNormaliser;
+}
+#endif
+
+// A flattened, evaluation only copy of a NeuralNet.
+// The weights of each layer are held in one contiguous block (in the same
+// order as NeuralNet::weights()) and the standard neuron types are evaluated
+// inline rather than through a virtual call per neuron. The summation order
+// is the same as in Neuron, so the outputs are identical to NeuralNet::output.
+// Evaluation is const and uses no shared scratch space, so one instance can
+// be used from several threads at once. Changing the weights is not thread safe,
+// hence the training algorithms give each worker thread its own copy.
+// For inference the layers can optionally be evaluated in single precision, or
+// with the weights quantised to 8 bit integers with one scale factor per layer
+// (see setPrecision). Input normalisation and the target scaling are always done
+// in double precision, and forward() used for training always uses the full weights.
+// When the input normalisers are all affine (Gaussian, range mapping or passthrough)
+// they can be folded into the weights and biases of the first layer (see
+// setFoldedNormalisation), which removes the per item normalisation altogether.
+// The folded weights round differently, so the outputs then agree with NeuralNet::output
+// to within rounding rather than exactly.
+
+namespace nnet
+{
+
+class
+#ifndef __CINT__
+NEURALNETDLL
+#endif
+CompiledNeuralNet
+{
+public:
+	typedef enum {DoublePrecision,SinglePrecision,QuantisedInt8} Precision;
+
+public:
+	CompiledNeuralNet(const NeuralNet &theNetwork,const Precision precision=DoublePrecision);
+	~CompiledNeuralNet();
+	int numberOfInputs() const {return _numberOfInputs;}
+	int numberOfOutputs() const {return _numberOfOutputs;}
+	int numberOfWeights() const {return _numberOfWeights;}
+	void setWeights(const std::vector<double> &newWeights);
+	void setPrecision(const Precision precision);
+	Precision precision() const {return _precision;}
+	// Returns false, and keeps the explicit normalisation, if the normalisation can't be folded.
+	// forward() always normalises explicitly.
+	bool setFoldedNormalisation(const bool fold);
+	bool foldedNormalisation() const {return _normalisationFolded;}
+	std::vector<double> output(const std::vector<double> &inputValues) const;
+	// Evaluate numberOfItems input vectors stored one after the other in inputs
+	// (numberOfInputs() values each), writing numberOfOutputs() values per item to outputs.
+	void batchOutput(const double *inputs,const int numberOfItems,double *outputs) const;
+
+	// Layer structure, for the training algorithms that work on the flat weight vector
+	int numberOfLayers() const {return (int)_theLayers.size();}
+	int numberOfLayerInputs(const int layer) const {return _theLayers[layer].numberOfInputs;}
+	int numberOfNeurons(const int layer) const {return _theLayers[layer].numberOfNeurons;}
+	double bias(const int layer,const int neuron) const {return _theLayers[layer].bias[neuron];}
+	// Forward pass keeping the intermediate results. values[0] are the normalised inputs and
+	// values[l+1] the outputs of layer l (before the target scaling), derivatives[l] is the derivative
+	// of each neuron of layer l with respect to its activation. Both are resized as needed.
+	void forward(const double *inputs,std::vector<std::vector<double> > &values,std::vector<std::vector<double> > &derivatives) const;
+
+private:
+	typedef enum {Sigmoid,TanSigmoid,Linear,Other} ActivationType;
+
+	struct Layer
+	{
+		int numberOfInputs;
+		int numberOfNeurons;
+		std::vector<double> weights;
+		std::vector<double> bias;
+		std::vector<int> activation;
+		std::vector<double> parameter;
+		std::vector<Neuron *> otherNeurons;
+		// Reduced precision copies, only filled when that precision is selected
+		std::vector<float> singleWeights;
+		std::vector<float> singleBias;
+		std::vector<float> singleParameter;
+		std::vector<signed char> quantisedWeights;
+		float quantisationScale;
+	};
+
+	void evaluate(const double *inputs,double *outputs,std::vector<double> &scratch1,std::vector<double> &scratch2) const;
+	double activation(const Layer &layer,const int neuron,const double *inputs) const;
+	double threshold(const Layer &layer,const int neuron,const double activation,const double *inputs) const;
+	void evaluate(const double *inputs,double *outputs,std::vector<float> &scratch1,std::vector<float> &scratch2) const;
+	float threshold(const Layer &layer,const int neuron,const float activation,const float *inputs) const;
+	void buildReducedPrecisionWeights(Layer &layer) const;
+	void buildFoldedFirstLayer();
+	const Layer &evaluationLayer(const int layer) const
+	{ return ((layer == 0)&&_normalisationFolded) ? _foldedFirstLayer : _theLayers[layer];}
+
+	int _numberOfInputs;
+	int _numberOfOutputs;
+	int _numberOfWeights;
+	int _maximumLayerWidth;
+	Precision _precision;
+	bool _normalisationFolded;
+	std::vector<Layer> _theLayers;
+	Layer _foldedFirstLayer; // First layer with the input normalisation folded in
+	std::vector<InputNormaliser *> _inputNormalisers;
+	std::vector<double> _targetNormalisationOffsets;
+	std::vector<double> _targetNormalisationRanges;
+
+	CompiledNeuralNet(const CompiledNeuralNet &other); // Declared but not defined
+	CompiledNeuralNet &operator=(const CompiledNeuralNet &other); // Declared but not defined
+};
+
+}//namespace nnet
+
+#endif
@@ -40,6 +40,12 @@ public:
 	void newGeneration();
 	void evaluatePopulationFitness(const std::vector<double> &inputValues,
 		const std::vector<double> &desiredOutput);
+	// Same as calling the above for every item of the data set in turn, but the
+	// genomes are shared out between setNumberOfThreads() worker threads.
+	void evaluatePopulationFitness(const NeuralNetDataSet &dataSet);
+	// Number of threads used to evaluate the population, 0 means one per processor
+	void setNumberOfThreads(const int n) {_numberOfThreads = n;}
+	int numberOfThreads() const {return _numberOfThreads;}
 	void batchTrain(const int numberOfEpochs,const NeuralNetDataSet &dataSet,
         const NeuralNet::InputNormalisationSelect normaliseTrainingData=NeuralNet::PassthroughNormalised);
     void batchTrain(const int numberOfEpochs,const NeuralNetDataSet &dataSet,const std::vector<InputNormaliser *> &inputNormalisers);
@@ -57,7 +63,7 @@ protected:
 	virtual double calculateGenomeFitness(const double error);
 	void processDataSet(const NeuralNetDataSet &dataSet);
 	double error(const NeuralNetDataSet &dataSet) const;
-
+	void evaluatePopulationFitness(const std::vector<double> &inputs,const std::vector<double> &targets,const int numberOfItems);
 
 private:
 	NeuralNet &_theNetwork;
@@ -76,6 +82,7 @@ private:
 	int _progressPrintoutFrequency;
     double _maxGenomeFitness;
     std::vector<double> _savedEpochErrorValues;
+	int _numberOfThreads;
 };
 
 }//namespace nnet
@@ -34,6 +34,9 @@ public:
     virtual std::string name() const = 0;
     virtual void serialise(std::ostream &os) const = 0;
     virtual InputNormaliser *clone(const NeuralNet *newNetwork) const = 0;
+    // If the normalisation is of the form scale*input+offset, sets scale and offset and returns true.
+    // Used by CompiledNeuralNet to fold the normalisation into the first layer.
+    virtual bool affineParameters(double &scale,double &offset) const {return false;}
 
 protected:
     const NeuralNet *_parentNetwork;
@@ -0,0 +1,122 @@
+#ifndef MINIBATCHTRAININGALGORITHM_H
+#define MINIBATCHTRAININGALGORITHM_H
+
+#include "NeuralNetConfig.h"
+
+#include "NeuralNet.h"
+#include "NeuralNetDataSet.h"
+
+#include <vector>
+
+#ifdef __CINT__
+#include "InputNormaliser.h"
+#include "CompiledNeuralNet.h"
+#else
+namespace nnet
+{
+class InputNormaliser;
+class CompiledNeuralNet;
+}
+#endif
+
+// Stochastic gradient descent over shuffled mini-batches of the data set, with
+// either classical momentum or Adam updates. A fraction of the data set can be
+// held back for validation, in which case training stops once the validation
+// error hasn't improved for a number of epochs and the network is left with the
+// weights from the best validation epoch.
+// The learning rate can be reduced in steps every so many epochs, and/or whenever
+// the validation error reaches a plateau.
+// The shuffling uses its own random number sequence (see setRandomSeed) so that
+// training is reproducible and doesn't disturb the sequence from NeuralNetRandom.
+
+namespace nnet
+{
+
+class
+#ifndef __CINT__
+NEURALNETDLL
+#endif
+MiniBatchTrainingAlgorithm
+{
+public:
+	typedef enum {Momentum,Adam} UpdateRule;
+
+public:
+	MiniBatchTrainingAlgorithm(NeuralNet &theNetwork,const UpdateRule rule=Adam,const double learningRate=0.001,const int batchSize=64);
+	~MiniBatchTrainingAlgorithm(void);
+	void setUpdateRule(const UpdateRule rule) {_updateRule = rule;}
+	void setLearningRate(const double newLearningRate) {_learningRate = newLearningRate;}
+	void setBatchSize(const int batchSize) {_batchSize = batchSize>0 ? batchSize : 1;}
+	void setMomentumConstant(const double newMomentumConstant) {_momentumConstant = newMomentumConstant;}
+	void setAdamParameters(const double beta1,const double beta2,const double epsilon)
+	{ _beta1 = beta1; _beta2 = beta2; _epsilon = epsilon;}
+	// Fraction of the data set held back for validation (default 0.1), 0 uses everything for training
+	void setValidationFraction(const double fraction) {_validationFraction = fraction;}
+	// Stop after this many epochs without a better validation error (default 10), 0 never stops early
+	void setEarlyStoppingPatience(const int epochs) {_earlyStoppingPatience = epochs;}
+	// Multiply the learning rate by factor every numberOfEpochs epochs
+	void setLearningRateDecay(const double factor,const int numberOfEpochs)
+	{ _decayFactor = factor; _decayPeriod = numberOfEpochs;}
+	// Multiply the learning rate by factor after numberOfEpochs epochs without a better validation error
+	void setLearningRatePlateauReduction(const double factor,const int numberOfEpochs)
+	{ _plateauFactor = factor; _plateauPatience = numberOfEpochs;}
+	void setRandomSeed(const unsigned long seed) {_randomSeed = seed;}
+	double train(const int numberOfEpochs,const NeuralNetDataSet &dataSet,
+		const NeuralNet::InputNormalisationSelect normaliseTrainingData=NeuralNet::PassthroughNormalised);
+	double train(const int numberOfEpochs,const NeuralNetDataSet &dataSet,const std::vector<InputNormaliser *> &inputNormalisers);
+	void setProgressPrintoutFrequency(const int frequency) {_progressPrintoutFrequency = frequency;}
+	std::vector<double> getTrainingErrorValuesPerEpoch() const {return _savedEpochErrorValues;}
+	std::vector<double> getValidationErrorValuesPerEpoch() const {return _savedValidationErrorValues;}
+	// Epoch whose weights the network was left with
+	int bestEpoch() const {return _bestEpoch;}
+
+protected:
+	void setTargetNormalisation(const NeuralNetDataSet &dataSet);
+	double trainWithDataSet(const int numberOfEpochs,const NeuralNetDataSet &dataSet);
+	double processBatch(CompiledNeuralNet &theNet,const std::vector<int> &order,const int begin,const int end);
+	double error(const CompiledNeuralNet &theNet,const std::vector<int> &order,const int begin,const int end) const;
+	void updateWeights(const int numberOfItems,const double learningRate);
+	unsigned long nextRandom();
+
+private:
+	NeuralNet &_theNetwork;
+	UpdateRule _updateRule;
+	double _learningRate;
+	int _batchSize;
+	double _momentumConstant;
+	double _beta1;
+	double _beta2;
+	double _epsilon;
+	double _validationFraction;
+	int _earlyStoppingPatience;
+	double _decayFactor;
+	int _decayPeriod;
+	double _plateauFactor;
+	int _plateauPatience;
+	unsigned long _randomSeed;
+	unsigned long _randomState;
+	int _progressPrintoutFrequency;
+	int _bestEpoch;
+
+	std::vector<double> _inputs;
+	std::vector<double> _targets;
+	int _numberOfInputs;
+	int _numberOfTargets;
+	std::vector<double> _targetOffsets;
+	std::vector<double> _targetRanges;
+	std::vector<int> _layerWeightOffsets;
+	std::vector<double> _weights;
+	std::vector<double> _gradient;
+	std::vector<double> _firstMoment;
+	std::vector<double> _secondMoment;
+	int _numberOfUpdates;
+	std::vector<std::vector<double> > _values;
+	std::vector<std::vector<double> > _derivatives;
+	std::vector<std::vector<double> > _errorSignals;
+	std::vector<double> _savedEpochErrorValues;
+	std::vector<double> _savedValidationErrorValues;
+};
+
+}//namespace nnet
+
+#endif
@@ -37,6 +37,10 @@ public:
         std::vector<double> &inputNormalisationDataRanges) const;
 	void getDataItem(const int item,std::vector<double> &inputData,std::vector<double> &targetData) const;
 	int numberOfDataItems() const { return (int)_theData.size(); }
+	int inputDataSize() const { return (int)_inputDataSize; }
+	int targetDataSize() const { return (int)_targetDataSize; }
+	// Copy the whole data set into two contiguous arrays, item after item
+	void packedData(std::vector<double> &inputData,std::vector<double> &targetData) const;
 	void setSerialisationPrecision(const int precision) {_outputPrecision = precision;}
 
 protected:
@@ -0,0 +1,65 @@
+#ifndef NEURALNETPRECISIONVALIDATOR_H
+#define NEURALNETPRECISIONVALIDATOR_H
+
+#include "NeuralNetConfig.h"
+
+#include "CompiledNeuralNet.h"
+
+#include <vector>
+#include <iostream>
+
+#ifdef __CINT__
+#include "NeuralNet.h"
+#include "NeuralNetDataSet.h"
+#else
+namespace nnet
+{
+class NeuralNet;
+class NeuralNetDataSet;
+}
+#endif
+
+// Checks what a reduced precision CompiledNeuralNet does to a tagging network.
+// Every item of the reference sample is evaluated in double precision and at the
+// requested precision; items with a target above 0.5 (for the output being checked)
+// count as signal, the others as background. The report gives the largest difference
+// in output, and the signal efficiency at a fixed purity for both evaluations.
+
+namespace nnet
+{
+
+class
+#ifndef __CINT__
+NEURALNETDLL
+#endif
+NeuralNetPrecisionValidator
+{
+public:
+	NeuralNetPrecisionValidator(const NeuralNet &theNetwork,const NeuralNetDataSet &referenceSample,const int output=0);
+	void validate(const CompiledNeuralNet::Precision precision,const double purity);
+	int numberOfItems() const {return (int)_referenceOutput.size();}
+	double maximumDeviation() const {return _maximumDeviation;}
+	double purity() const {return _purity;}
+	double referenceEfficiency() const {return _referenceEfficiency;}
+	double efficiency() const {return _efficiency;}
+	void print(std::ostream &os) const;
+
+	// Highest signal efficiency of a cut on output which gives at least the required purity
+	static double efficiencyAtPurity(const std::vector<double> &output,const std::vector<bool> &isSignal,const double purity);
+
+private:
+	const NeuralNet &_theNetwork;
+	int _output;
+	std::vector<double> _inputs;
+	std::vector<bool> _isSignal;
+	std::vector<double> _referenceOutput;
+	CompiledNeuralNet::Precision _precision;
+	double _maximumDeviation;
+	double _purity;
+	double _referenceEfficiency;
+	double _efficiency;
+};
+
+}//namespace nnet
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef NEURALNETTHREADS_H
+#define NEURALNETTHREADS_H
+
+#include "NeuralNetConfig.h"
+
+// Minimal thread support for the training algorithms.
+// Work is described by a NeuralNetParallelTask, and ParallelFor splits
+// a range of items into contiguous chunks, one per worker thread.
+// The chunk boundaries only depend on the number of items and threads,
+// so any task that writes its results per item (or per fixed block of
+// items) and is reduced afterwards in item order gives identical results
+// however the threads are scheduled.
+// On platforms without POSIX threads everything runs on the calling thread.
+
+namespace nnet
+{
+
+class
+#ifndef __CINT__
+NEURALNETDLL
+#endif
+NeuralNetParallelTask
+{
+public:
+	virtual ~NeuralNetParallelTask() {}
+	// Process items [begin,end). thread is the index of the worker in [0,numberOfThreads)
+	// and can be used to select per-thread scratch space.
+	virtual void process(const int thread,const int begin,const int end) = 0;
+};
+
+namespace NeuralNetThreads {
+
+// Number of processors currently online, or 1 if this can't be determined.
+NEURALNETDLL int NumberOfProcessors();
+
+// Number of workers that ParallelFor will actually use for this many items.
+// A request for 0 (or fewer) threads means one thread per processor.
+NEURALNETDLL int NumberOfWorkers(const int numberOfItems,const int numberOfThreads);
+
+// Run task over [0,numberOfItems) split between numberOfThreads workers.
+// The calling thread processes the first chunk itself and returns once
+// all chunks are finished.
+NEURALNETDLL void ParallelFor(NeuralNetParallelTask &task,const int numberOfItems,const int numberOfThreads);
+
+}
+
+}//namespace nnet
+
+#endif
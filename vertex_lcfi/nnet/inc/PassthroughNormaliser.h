@@ -25,6 +25,7 @@ public:
     std::string name() const {return "PassthroughNormaliser";}
     void serialise(std::ostream &os) const;
     InputNormaliser *clone(const NeuralNet *newNetwork) const;
+    bool affineParameters(double &scale,double &offset) const;
 };
 
 }//namespace nnet
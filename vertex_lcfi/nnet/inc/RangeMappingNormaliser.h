@@ -24,6 +24,7 @@ public:
     std::string name() const {return "RangeMappingNormaliser";}
     void serialise(std::ostream &os) const;
     InputNormaliser *clone(const NeuralNet *newNetwork) const;
+    bool affineParameters(double &scale,double &offset) const;
 
 private:
     double _inputMin;
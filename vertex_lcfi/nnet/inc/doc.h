@@ -163,6 +163,7 @@ nnet::BackPropagationAlgorithm
 nnet::BackPropagationCGAlgorithm
 nnet::BatchBackPropagationAlgorithm
 nnet::GeneticAlgorithm
+nnet::MiniBatchTrainingAlgorithm
 \endcode
 
 \subsubsection TrainingWithBackPropagationAlgorithm Training with BackPropagationAlgorithm
@@ -216,6 +217,20 @@ myTrainer.setBetaFunction( nnet::BackPropagationCGAlgorithm::PolakRibiere );
 double finalError=myTrainer.train( 500, animalSample );
 \endcode
 
+\subsubsection TrainingWithMiniBatchTrainingAlgorithm Training with MiniBatchTrainingAlgorithm
+This algorithm updates the weights after every small batch of data items (64 by default) rather than once per pass over the whole sample, using either the Adam method (the default) or gradient descent with momentum.  The sample is shuffled before each epoch.  By default 10% of the sample is held back to measure the validation error, and training stops once this hasn't improved for 10 epochs (<tt>setEarlyStoppingPatience</tt>).  The network is then left with the weights of the epoch with the lowest validation error.  The learning rate can be reduced by a fixed factor every few epochs with <tt>setLearningRateDecay</tt>, or whenever the validation error stops improving with <tt>setLearningRatePlateauReduction</tt>.
+
+\code
+//Adam with a learning rate of 0.01 and batches of 32 items
+nnet::MiniBatchTrainingAlgorithm myTrainer( myPreviouslyCreatedNetwork, nnet::MiniBatchTrainingAlgorithm::Adam, 0.01, 32 );
+
+//halve the learning rate after 3 epochs without improvement
+myTrainer.setLearningRatePlateauReduction( 0.5, 3 );
+
+//train for at most 100 epochs
+double finalError=myTrainer.train( 100, animalSample );
+\endcode
+
 \section ObtainingResults Obtaining results
 To get results from the neural network, the output method takes the inputs as an STL vector of doubles, and provides the results as an STL vector of doubles.  So to determine if some animal is a donkey using a network trained from data of form of the data set in the previous example:
 
@@ -6,6 +6,7 @@
 #include "Neuron.h"
 #include "InputNormaliserBuilder.h"
 #include "InputNormaliserBuilderCatalogue.h"
+#include "NeuralNetThreads.h"
 
 #include <cmath>
 #include <algorithm>
@@ -52,6 +53,123 @@ public:
         return elem/_factor;
     }
 };
+
+// Number of data items summed into one partial result
+const int BackPropCGBlockSize = 256;
+
+// Error function and gradient over the data set, for use from several threads at once.
+// Each item is done with the same arithmetic as calculateRunningDeDw() and error(), the
+// network is only read. The sums are kept per block of items and added up in block order
+// by sum(), so the result is the same whichever thread did which block.
+class BackPropCGGradientTask : public NeuralNetParallelTask
+{
+public:
+	BackPropCGGradientTask(NeuralNet &theNetwork,const std::vector<double> &inputs,const std::vector<double> &targets,
+		const int numberOfItems)
+		: _theNetwork(theNetwork),_inputs(inputs),_targets(targets),_numberOfItems(numberOfItems),
+		  _numberOfBlocks((numberOfItems+BackPropCGBlockSize-1)/BackPropCGBlockSize),
+		  _blockErrors(_numberOfBlocks),_blockGradients(_numberOfBlocks)
+	{
+		// The weights are fixed for the lifetime of the task, take a copy of them up front
+		for (int layer=0;layer<theNetwork.numberOfLayers();++layer)
+		{
+			NeuronLayer *theLayer = theNetwork.layer(layer);
+			_weights.push_back(std::vector<std::vector<double> >());
+			_biases.push_back(std::vector<double>());
+			for (int node=0;node<theLayer->numberOfNeurons();++node)
+			{
+				_weights[layer].push_back(theLayer->neuron(node)->weights());
+				_biases[layer].push_back(theLayer->neuron(node)->bias());
+			}
+		}
+	}
+	int numberOfBlocks() const {return _numberOfBlocks;}
+	void process(const int /*thread*/,const int begin,const int end)
+	{
+		const int numberOfWeights = _theNetwork.numberOfWeights();
+		for (int block=begin;block<end;++block)
+		{
+			_blockErrors[block] = 0.0;
+			_blockGradients[block].assign(numberOfWeights,0.0);
+			const int last = std::min(_numberOfItems,(block+1)*BackPropCGBlockSize);
+			for (int item=block*BackPropCGBlockSize;item<last;++item)
+				accumulate(item,_blockErrors[block],_blockGradients[block]);
+		}
+	}
+	void sum(double &error,std::vector<double> &gradient) const
+	{
+		for (int block=0;block<_numberOfBlocks;++block)
+		{
+			error += _blockErrors[block];
+			std::transform(gradient.begin(),gradient.end(),_blockGradients[block].begin(),gradient.begin(),std::plus<double>());
+		}
+	}
+
+private:
+	void accumulate(const int item,double &error,std::vector<double> &gradient) const
+	{
+		const int numberOfInputs = _theNetwork.numberOfInputs();
+		const int lastLayer = _theNetwork.numberOfLayers()-1;
+		const std::vector<double> inputs(_inputs.begin()+item*numberOfInputs,_inputs.begin()+(item+1)*numberOfInputs);
+		std::vector<double> netOutput = _theNetwork.output(inputs);
+		const double *target = &_targets[item*netOutput.size()];
+
+		// Layer outputs and derivatives, starting from the inputs as calculateLayerOutputs() does
+		std::vector<std::vector<double> > outputs(lastLayer+1),derivatives(lastLayer+1),errorSignals(lastLayer+1);
+		const std::vector<double> *previous = &inputs;
+		for (int layer=0;layer<=lastLayer;++layer)
+		{
+			outputs[layer] = _theNetwork.layer(layer)->output(*previous);
+			derivatives[layer] = _theNetwork.layer(layer)->derivativeOutput(*previous);
+			previous = &outputs[layer];
+		}
+
+		errorSignals[lastLayer].resize(netOutput.size());
+		for (int i=0;i<(int)netOutput.size();++i)
+			errorSignals[lastLayer][i] = netOutput[i]-target[i];
+		for (int layer=lastLayer-1;layer>=0;--layer)
+		{
+			errorSignals[layer].resize(outputs[layer].size());
+			for (int node=0;node<(int)outputs[layer].size();++node)
+			{
+				double errorSignal = 0.0;
+				for (int nextlayernode=0;nextlayernode<(int)outputs[layer+1].size();++nextlayernode)
+					errorSignal += errorSignals[layer+1][nextlayernode]*derivatives[layer+1][nextlayernode]*_weights[layer+1][nextlayernode][node];
+				errorSignals[layer][node] = errorSignal;
+			}
+		}
+
+		std::vector<double>::iterator dEdw = gradient.begin();
+		previous = &inputs;
+		for (int layer=0;layer<=lastLayer;++layer)
+		{
+			if (layer>0) previous = &outputs[layer-1];
+			for (int node=0;node<(int)outputs[layer].size();++node)
+			{
+				const double signal = errorSignals[layer][node];
+				const double derivative = derivatives[layer][node];
+				for (int i=0;i<(int)previous->size();++i)
+					*dEdw++ += signal*derivative*((*previous)[i]);
+				*dEdw++ += signal*derivative*_biases[layer][node];
+			}
+		}
+
+		double totalMeanSqError = 0.0;
+		for (int i=0;i<(int)netOutput.size();++i)
+			totalMeanSqError = totalMeanSqError + BackPropCGDiff(netOutput[i],target[i]);
+		error += totalMeanSqError/2.0;
+	}
+
+	NeuralNet &_theNetwork;
+	const std::vector<double> &_inputs;
+	const std::vector<double> &_targets;
+	const int _numberOfItems;
+	const int _numberOfBlocks;
+	std::vector<double> _blockErrors;
+	std::vector<std::vector<double> > _blockGradients;
+	std::vector<std::vector<std::vector<double> > > _weights;
+	std::vector<std::vector<double> > _biases;
+};
 }
 
 BackPropagationCGAlgorithm::BackPropagationCGAlgorithm(NeuralNet &theNetwork)
@@ -63,7 +181,7 @@ BackPropagationCGAlgorithm::BackPropagationCGAlgorithm(NeuralNet &theNetwork)
   _numberOfEpochs(0),_linearSearchGamma(0.05),
   _linearSearchTolerance(0.002),_progressPrintoutFrequency(100),
   _linearSearchAbsGradientCutoff(1.0E-9),
-  _previousEpochStepLength(0.0)
+  _previousEpochStepLength(0.0),_numberOfThreads(1)
 {
     int numberOfNeurons = 0;
 	for (int i=0;i<_theNetwork.numberOfLayers();++i)
@@ -579,6 +697,10 @@ double BackPropagationCGAlgorithm::trainWithDataSet(const int numberOfEpochs)
 
 	_savedEpochErrorValues.clear();
     _currentSearchDirection.clear();
+	_packedInputs.clear();
+	_packedTargets.clear();
+	if (_numberOfThreads != 1)
+		_currentDataSet->packedData(_packedInputs,_packedTargets);
 
 	for (int epoch=0;epoch<numberOfEpochs;++epoch)
 	{
@@ -639,6 +761,9 @@ void BackPropagationCGAlgorithm::calculateRunningDeDw()
 
 double BackPropagationCGAlgorithm::processDataSet()
 {
+	if (_numberOfThreads != 1)
+		return processDataSetInParallel();
+
 	std::vector<double> inputs;
 	std::vector<double> targets;
 	double runningErrorBeforeThisIteration = _runningEpochErrorTotal;
@@ -657,6 +782,23 @@ double BackPropagationCGAlgorithm::processDataSet()
 	return _runningEpochErrorTotal-runningErrorBeforeThisIteration;
 }
 
+double BackPropagationCGAlgorithm::processDataSetInParallel()
+{
+	const int numberOfItems = _currentDataSet->numberOfDataItems();
+	NeuralNetUtils::BackPropCGGradientTask task(_theNetwork,_packedInputs,_packedTargets,numberOfItems);
+	NeuralNetThreads::ParallelFor(task,task.numberOfBlocks(),_numberOfThreads);
+
+	double error = 0.0;
+	std::vector<double> gradient(_runningDeDwSum.size(),0.0);
+	task.sum(error,gradient);
+	std::transform(_runningDeDwSum.begin(),_runningDeDwSum.end(),gradient.begin(),_runningDeDwSum.begin(),std::plus<double>());
+	_runningEpochErrorTotal += error;
+	_numberOfTrainingEvents += numberOfItems;
+    std::transform(_runningDeDwSum.begin(),_runningDeDwSum.end(),_runningDeDwSum.begin(),
+                    NeuralNetUtils::DivValue<double>((double)_numberOfTrainingEvents));
+	return error;
+}
+
 
 double BackPropagationCGAlgorithm::newEpoch(bool &success,double &gradient)
 {
@@ -0,0 +1,416 @@
+#include "CompiledNeuralNet.h"
+#include "NeuralNet.h"
+#include "NeuronLayer.h"
+#include "Neuron.h"
+#include "SigmoidNeuron.h"
+#include "TanSigmoidNeuron.h"
+#include "LinearNeuron.h"
+#include "InputNormaliser.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace nnet;
+
+CompiledNeuralNet::CompiledNeuralNet(const NeuralNet &theNetwork,const Precision precision)
+: _numberOfInputs(theNetwork.numberOfInputs()),_numberOfOutputs(0),_numberOfWeights(0),_maximumLayerWidth(theNetwork.numberOfInputs()),
+  _precision(DoublePrecision),_normalisationFolded(false)
+{
+	NeuralNet &theNet = const_cast<NeuralNet &>(theNetwork);
+	int layerInputs = _numberOfInputs;
+	for (int l=0;l<theNet.numberOfLayers();++l)
+	{
+		NeuronLayer *theLayer = theNet.layer(l);
+		Layer compiled;
+		compiled.numberOfInputs = layerInputs;
+		compiled.numberOfNeurons = theLayer->numberOfNeurons();
+		compiled.quantisationScale = 0.0f;
+		compiled.weights.reserve(compiled.numberOfNeurons*(layerInputs+1));
+		for (int n=0;n<compiled.numberOfNeurons;++n)
+		{
+			Neuron *theNeuron = theLayer->neuron(n);
+			std::vector<double> neuronWeights = theNeuron->weights();
+			neuronWeights.resize(layerInputs+1,0.0);
+			compiled.weights.insert(compiled.weights.end(),neuronWeights.begin(),neuronWeights.end());
+			compiled.bias.push_back(theNeuron->bias());
+
+			Neuron *other = 0;
+			if (SigmoidNeuron *sigmoid = dynamic_cast<SigmoidNeuron *>(theNeuron))
+			{
+				compiled.activation.push_back(Sigmoid);
+				compiled.parameter.push_back(sigmoid->response());
+			}
+			else if (TanSigmoidNeuron *tansigmoid = dynamic_cast<TanSigmoidNeuron *>(theNeuron))
+			{
+				compiled.activation.push_back(TanSigmoid);
+				compiled.parameter.push_back(tansigmoid->scale());
+			}
+			else if (LinearNeuron *linear = dynamic_cast<LinearNeuron *>(theNeuron))
+			{
+				compiled.activation.push_back(Linear);
+				compiled.parameter.push_back(linear->slopeEnd());
+			}
+			else
+			{
+				// Unknown neuron type, keep a private copy and let it do the evaluation
+				compiled.activation.push_back(Other);
+				compiled.parameter.push_back(0.0);
+				other = theNeuron->clone(0);
+			}
+			compiled.otherNeurons.push_back(other);
+		}
+		_numberOfWeights += (int)compiled.weights.size();
+		_maximumLayerWidth = std::max(_maximumLayerWidth,compiled.numberOfNeurons);
+		layerInputs = compiled.numberOfNeurons;
+		_theLayers.push_back(compiled);
+	}
+	_numberOfOutputs = layerInputs;
+
+	std::vector<InputNormaliser *> theNormalisers = theNetwork.inputNormalisers();
+	for (int i=0;i<(int)theNormalisers.size();++i)
+		_inputNormalisers.push_back(theNormalisers[i]->clone(0));
+	if ((int)_inputNormalisers.size() < _numberOfInputs)
+		std::cerr << "CompiledNeuralNet:: Network has fewer input normalisers than inputs." << std::endl;
+
+	_targetNormalisationOffsets = theNetwork.targetNormalisationOffsets();
+	_targetNormalisationRanges = theNetwork.targetNormalisationRanges();
+
+	setPrecision(precision);
+}
+
+CompiledNeuralNet::~CompiledNeuralNet()
+{
+	for (std::vector<Layer>::iterator iter=_theLayers.begin();iter!=_theLayers.end();++iter)
+		for (std::vector<Neuron *>::iterator neuron=iter->otherNeurons.begin();neuron!=iter->otherNeurons.end();++neuron)
+			if (*neuron) (*neuron)->destroy();
+	for (std::vector<InputNormaliser *>::iterator iter=_inputNormalisers.begin();iter!=_inputNormalisers.end();++iter)
+		delete *iter;
+}
+
+void CompiledNeuralNet::setWeights(const std::vector<double> &newWeights)
+{
+	if ((int)newWeights.size()<_numberOfWeights)
+	{
+		std::cerr << "CompiledNeuralNet:: Too few weights supplied to initialize network." << std::endl;
+		return;
+	}
+	std::vector<double>::const_iterator iter = newWeights.begin();
+	for (std::vector<Layer>::iterator layer=_theLayers.begin();layer!=_theLayers.end();++layer)
+	{
+		std::copy(iter,iter+layer->weights.size(),layer->weights.begin());
+		const int weightsPerNeuron = layer->numberOfInputs+1;
+		for (int n=0;n<layer->numberOfNeurons;++n)
+			if (layer->otherNeurons[n])
+				layer->otherNeurons[n]->setWeights(std::vector<double>(iter+n*weightsPerNeuron,iter+(n+1)*weightsPerNeuron));
+		iter += layer->weights.size();
+		if (_precision != DoublePrecision)
+			buildReducedPrecisionWeights(*layer);
+	}
+	if (_normalisationFolded)
+		buildFoldedFirstLayer();
+}
+
+void CompiledNeuralNet::setPrecision(const Precision precision)
+{
+	_precision = precision;
+	for (std::vector<Layer>::iterator layer=_theLayers.begin();layer!=_theLayers.end();++layer)
+		buildReducedPrecisionWeights(*layer);
+	if (_normalisationFolded)
+		buildReducedPrecisionWeights(_foldedFirstLayer);
+}
+
+bool CompiledNeuralNet::setFoldedNormalisation(const bool fold)
+{
+	_normalisationFolded = false;
+	if (!fold) return true;
+	if (_theLayers.empty()||((int)_inputNormalisers.size() < _numberOfInputs)) return false;
+
+	double scale,offset;
+	for (int i=0;i<_numberOfInputs;++i)
+		if (!_inputNormalisers[i]->affineParameters(scale,offset)) return false;
+	// Neurons of unknown type keep their own weights, which can't be changed here
+	for (int n=0;n<_theLayers[0].numberOfNeurons;++n)
+		if (_theLayers[0].activation[n] == Other) return false;
+
+	_normalisationFolded = true;
+	buildFoldedFirstLayer();
+	return true;
+}
+
+void CompiledNeuralNet::buildFoldedFirstLayer()
+{
+	// sum_i w_i*(scale_i*x_i+offset_i) + bias*w_b = sum_i (w_i*scale_i)*x_i + (bias*w_b + sum_i w_i*offset_i),
+	// the constant term becomes the bias weight of a neuron with bias 1
+	_foldedFirstLayer = _theLayers[0];
+	const int nInputs = _foldedFirstLayer.numberOfInputs;
+	std::vector<double> scales(nInputs),offsets(nInputs);
+	for (int i=0;i<nInputs;++i)
+		_inputNormalisers[i]->affineParameters(scales[i],offsets[i]);
+	for (int n=0;n<_foldedFirstLayer.numberOfNeurons;++n)
+	{
+		double *w = &_foldedFirstLayer.weights[n*(nInputs+1)];
+		double constant = _foldedFirstLayer.bias[n]*w[nInputs];
+		for (int i=0;i<nInputs;++i)
+		{
+			constant += w[i]*offsets[i];
+			w[i] *= scales[i];
+		}
+		w[nInputs] = constant;
+		_foldedFirstLayer.bias[n] = 1.0;
+	}
+	buildReducedPrecisionWeights(_foldedFirstLayer);
+}
+
+void CompiledNeuralNet::buildReducedPrecisionWeights(Layer &layer) const
+{
+	layer.singleWeights.clear();
+	layer.quantisedWeights.clear();
+	layer.quantisationScale = 0.0f;
+	if (_precision == DoublePrecision)
+	{
+		layer.singleBias.clear();
+		layer.singleParameter.clear();
+		return;
+	}
+
+	layer.singleBias.assign(layer.bias.begin(),layer.bias.end());
+	layer.singleParameter.assign(layer.parameter.begin(),layer.parameter.end());
+	if (_precision == SinglePrecision)
+	{
+		layer.singleWeights.assign(layer.weights.begin(),layer.weights.end());
+	}
+	else
+	{
+		// Symmetric quantisation, the largest weight of the layer maps to +-127
+		double largest = 0.0;
+		for (std::vector<double>::const_iterator iter=layer.weights.begin();iter!=layer.weights.end();++iter)
+			largest = std::max(largest,std::fabs(*iter));
+		const double scale = largest>0.0 ? largest/127.0 : 1.0;
+		layer.quantisationScale = (float)scale;
+		layer.quantisedWeights.resize(layer.weights.size());
+		for (int i=0;i<(int)layer.weights.size();++i)
+		{
+			double q = layer.weights[i]/scale;
+			q = q<0.0 ? std::ceil(q-0.5) : std::floor(q+0.5);
+			layer.quantisedWeights[i] = (signed char)std::max(-127.0,std::min(127.0,q));
+		}
+	}
+}
+
+std::vector<double> CompiledNeuralNet::output(const std::vector<double> &inputValues) const
+{
+	if ((int)inputValues.size() < _numberOfInputs)
+	{
+		std::cerr << "CompiledNeuralNet:: Too few input values to evaluate result." << std::endl;
+		return std::vector<double>();
+	}
+	std::vector<double> result(_numberOfOutputs);
+	batchOutput(&inputValues[0],1,&result[0]);
+	return result;
+}
+
+void CompiledNeuralNet::batchOutput(const double *inputs,const int numberOfItems,double *outputs) const
+{
+	if (_precision == DoublePrecision)
+	{
+		std::vector<double> scratch1(_maximumLayerWidth);
+		std::vector<double> scratch2(_maximumLayerWidth);
+		for (int i=0;i<numberOfItems;++i)
+			evaluate(inputs+i*_numberOfInputs,outputs+i*_numberOfOutputs,scratch1,scratch2);
+	}
+	else
+	{
+		std::vector<float> scratch1(_maximumLayerWidth);
+		std::vector<float> scratch2(_maximumLayerWidth);
+		for (int i=0;i<numberOfItems;++i)
+			evaluate(inputs+i*_numberOfInputs,outputs+i*_numberOfOutputs,scratch1,scratch2);
+	}
+}
+
+void CompiledNeuralNet::evaluate(const double *inputs,double *outputs,std::vector<double> &scratch1,std::vector<double> &scratch2) const
+{
+	double *buffers[2] = {&scratch1[0],&scratch2[0]};
+	const double *in = inputs;
+
+	// normalise inputs, unless that is folded into the first layer
+	if (!_normalisationFolded)
+	{
+		for (int i=0;i<_numberOfInputs;++i)
+			buffers[1][i] = _inputNormalisers[i]->normalisedValue(inputs[i]);
+		in = buffers[1];
+	}
+
+	for (int l=0;l<(int)_theLayers.size();++l)
+	{
+		const Layer &layer = evaluationLayer(l);
+		double *out = buffers[l%2];
+		for (int n=0;n<layer.numberOfNeurons;++n)
+			out[n] = threshold(layer,n,activation(layer,n,in),in);
+		in = out;
+	}
+
+	// Scale outputs
+	for (int i=0;i<_numberOfOutputs;++i)
+		outputs[i] = (in[i]*_targetNormalisationRanges[i])+_targetNormalisationOffsets[i];
+}
+
+void CompiledNeuralNet::evaluate(const double *inputs,double *outputs,std::vector<float> &scratch1,std::vector<float> &scratch2) const
+{
+	float *in = &scratch1[0];
+	float *out = &scratch2[0];
+
+	for (int i=0;i<_numberOfInputs;++i)
+		in[i] = (float)(_normalisationFolded ? inputs[i] : _inputNormalisers[i]->normalisedValue(inputs[i]));
+
+	for (int l=0;l<(int)_theLayers.size();++l)
+	{
+		const Layer &layer = evaluationLayer(l);
+		const int nInputs = layer.numberOfInputs;
+		for (int n=0;n<layer.numberOfNeurons;++n)
+		{
+			float activation = 0.0f;
+			if (_precision == QuantisedInt8)
+			{
+				const signed char *w = &layer.quantisedWeights[n*(nInputs+1)];
+				for (int i=0;i<nInputs;++i)
+					activation += in[i]*(float)w[i];
+				activation += layer.singleBias[n]*(float)w[nInputs];
+				activation *= layer.quantisationScale;
+			}
+			else
+			{
+				const float *w = &layer.singleWeights[n*(nInputs+1)];
+				for (int i=0;i<nInputs;++i)
+					activation += in[i]*w[i];
+				activation += layer.singleBias[n]*w[nInputs];
+			}
+			out[n] = threshold(layer,n,activation,in);
+		}
+		std::swap(in,out);
+	}
+
+	for (int i=0;i<_numberOfOutputs;++i)
+		outputs[i] = ((double)in[i]*_targetNormalisationRanges[i])+_targetNormalisationOffsets[i];
+}
+
+void CompiledNeuralNet::forward(const double *inputs,std::vector<std::vector<double> > &values,std::vector<std::vector<double> > &derivatives) const
+{
+	values.resize(_theLayers.size()+1);
+	derivatives.resize(_theLayers.size());
+
+	values[0].resize(_numberOfInputs);
+	for (int i=0;i<_numberOfInputs;++i)
+		values[0][i] = _inputNormalisers[i]->normalisedValue(inputs[i]);
+
+	for (int l=0;l<(int)_theLayers.size();++l)
+	{
+		const Layer &layer = _theLayers[l];
+		const double *in = &values[l][0];
+		std::vector<double> &out = values[l+1];
+		std::vector<double> &derivative = derivatives[l];
+		out.resize(layer.numberOfNeurons);
+		derivative.resize(layer.numberOfNeurons);
+		for (int n=0;n<layer.numberOfNeurons;++n)
+		{
+			const double a = activation(layer,n,in);
+			const double y = threshold(layer,n,a,in);
+			const double p = layer.parameter[n];
+			out[n] = y;
+			switch (layer.activation[n])
+			{
+			case Sigmoid:
+				derivative[n] = (p != 0.0) ? (1.0/p)*y*(1.0-y) : 0.0;
+				break;
+			case TanSigmoid:
+				derivative[n] = p*(1.0-y*y);
+				break;
+			case Linear:
+				derivative[n] = ((p != 0.0)&&(a> -p)&&(a<p)) ? 1.0/p : 0.0;
+				break;
+			default:
+				derivative[n] = layer.otherNeurons[n]->derivativeOutput(std::vector<double>(in,in+layer.numberOfInputs));
+				break;
+			}
+		}
+	}
+}
+
+double CompiledNeuralNet::activation(const Layer &layer,const int neuron,const double *inputs) const
+{
+	// Same order of summation as Neuron::activation
+	const int nInputs = layer.numberOfInputs;
+	const double *w = &layer.weights[neuron*(nInputs+1)];
+	double result = 0.0;
+	for (int i=0;i<nInputs;++i)
+		result = result + inputs[i]*w[i];
+	result += layer.bias[neuron]*w[nInputs];
+	return result;
+}
+
+double CompiledNeuralNet::threshold(const Layer &layer,const int neuron,const double activation,const double *inputs) const
+{
+	const double p = layer.parameter[neuron];
+	switch (layer.activation[neuron])
+	{
+	case Sigmoid:
+		if (p != 0.0)
+			return 1.0/(1.0+exp(-activation/p));
+		else if (activation != 0.0)
+			return activation<0.0 ? 0.0 : 1.0;
+		else
+			return 0.5;
+	case TanSigmoid:
+		return std::tanh(p*activation);
+	case Linear:
+		if (p != 0.0)
+		{
+			if (activation<= -p)
+				return -1.0;
+			else if (activation>=p)
+				return 1.0;
+			else
+				return activation/p;
+		}
+		else if (activation != 0.0)
+			return activation<0.0 ? -1.0 : 1.0;
+		else
+			return 0.0;
+	default:
+		return layer.otherNeurons[neuron]->output(std::vector<double>(inputs,inputs+layer.numberOfInputs));
+	}
+}
+
+float CompiledNeuralNet::threshold(const Layer &layer,const int neuron,const float activation,const float *inputs) const
+{
+	const float p = layer.singleParameter[neuron];
+	switch (layer.activation[neuron])
+	{
+	case Sigmoid:
+		if (p != 0.0f)
+			return 1.0f/(1.0f+std::exp(-activation/p));
+		else if (activation != 0.0f)
+			return activation<0.0f ? 0.0f : 1.0f;
+		else
+			return 0.5f;
+	case TanSigmoid:
+		return std::tanh(p*activation);
+	case Linear:
+		if (p != 0.0f)
+		{
+			if (activation<= -p)
+				return -1.0f;
+			else if (activation>=p)
+				return 1.0f;
+			else
+				return activation/p;
+		}
+		else if (activation != 0.0f)
+			return activation<0.0f ? -1.0f : 1.0f;
+		else
+			return 0.0f;
+	default:
+		// Unknown neuron types only have a double precision interface
+		return (float)layer.otherNeurons[neuron]->output(std::vector<double>(inputs,inputs+layer.numberOfInputs));
+	}
+}
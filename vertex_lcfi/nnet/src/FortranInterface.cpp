@@ -136,6 +136,8 @@ void NNFInterfaceManager<T>::remove(const int ID)
 #define CREATEGENETICALG creategeneticalg_
 #define TRAINWITHBACKPROP trainwithbackprop_
 #define EVALPOPULATIONFITNESS evalpopulationfitness_
+#define EVALPOPULATIONFITNESSDATASET evalpopulationfitnessdataset_
+#define SETGENALGNUMBEROFTHREADS setgenalgnumberofthreads_
 #define BATCHTRAIN batchtrain_
 #define NEWGENERATION newgeneration_
 #define DELETEGENALG deletegenalg_
@@ -314,6 +316,21 @@ NEURALNETDLL void EVALPOPULATIONFITNESS(const int *iga,const int *ninputs,const
 	}
 }
 
+NEURALNETDLL void EVALPOPULATIONFITNESSDATASET(const int *iga,const int *iset)
+{
+	GeneticAlgorithm *thega = NNFInterfaceManager<GeneticAlgorithm>::instance()->item(*iga);
+	NeuralNetDataSet *ds = NNFInterfaceManager<NeuralNetDataSet>::instance()->item(*iset);
+	if ((thega != (GeneticAlgorithm *)0)&&(ds != (NeuralNetDataSet *)0))
+		thega->evaluatePopulationFitness(*ds);
+}
+
+NEURALNETDLL void SETGENALGNUMBEROFTHREADS(const int *iga,const int *nthreads)
+{
+	GeneticAlgorithm *thega = NNFInterfaceManager<GeneticAlgorithm>::instance()->item(*iga);
+	if (thega != (GeneticAlgorithm *)0)
+		thega->setNumberOfThreads(*nthreads);
+}
+
 NEURALNETDLL void NEWGENERATION(const int *iga)
 {
 	GeneticAlgorithm *thega = NNFInterfaceManager<GeneticAlgorithm>::instance()->item(*iga);
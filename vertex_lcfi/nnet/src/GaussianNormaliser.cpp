@@ -19,6 +19,21 @@ double GaussianNormaliser::normalisedValue(const double input) const
         return input;
 }
 
+bool GaussianNormaliser::affineParameters(double &scale,double &offset) const
+{
+    if (_variance > 0.0)
+    {
+        scale = 1.0/sqrt(_variance);
+        offset = -_mean*scale;
+    }
+    else
+    {
+        scale = 1.0;
+        offset = 0.0;
+    }
+    return true;
+}
+
 void GaussianNormaliser::serialise(std::ostream &os) const
 {
     if (_parentNetwork != (NeuralNet *)0)
@@ -3,6 +3,8 @@
 #endif
 #include "GeneticAlgorithm.h"
 #include "Genome.h"
+#include "CompiledNeuralNet.h"
+#include "NeuralNetThreads.h"
 #include "RandomNumberUtils.h"
 #include "InputNormaliserBuilder.h"
 #include "InputNormaliserBuilderCatalogue.h"
@@ -25,6 +27,100 @@ double GenAlgDiff(double ele1,double ele2)
 {
 	return ((ele1-ele2)*(ele1-ele2));
 }
+
+// Sum of the squared differences, added up in the same order as the std::accumulate above
+double GenAlgSumSqrDiff(const double *output,const double *target,const int n)
+{
+	double msd = 0.0;
+	for (int i=0;i<n;++i)
+		msd = msd + GenAlgDiff(output[i],target[i]);
+	return msd;
+}
+
+// Number of data items pushed through a network in one go
+const int GenAlgBlockSize = 256;
+
+// Evaluates the fitness of a range of genomes over the whole data set.
+// Each worker thread has its own copy of the network so the weights can be changed independently.
+class GenAlgFitnessTask : public NeuralNetParallelTask
+{
+public:
+	GenAlgFitnessTask(std::vector<Genome *> &population,const NeuralNet &theNetwork,const int numberOfThreads,
+		const std::vector<double> &inputs,const std::vector<double> &targets,const int numberOfItems,const bool accumulate)
+		: _population(population),_inputs(inputs),_targets(targets),_numberOfItems(numberOfItems),_accumulate(accumulate)
+	{
+		for (int i=0;i<numberOfThreads;++i)
+			_networks.push_back(new CompiledNeuralNet(theNetwork));
+	}
+	~GenAlgFitnessTask()
+	{
+		for (std::vector<CompiledNeuralNet *>::iterator iter=_networks.begin();iter!=_networks.end();++iter)
+			delete *iter;
+	}
+	void process(const int thread,const int begin,const int end)
+	{
+		CompiledNeuralNet &net = *_networks[thread];
+		const int nInputs = net.numberOfInputs();
+		const int nOutputs = net.numberOfOutputs();
+		std::vector<double> outputs(GenAlgBlockSize*nOutputs);
+		for (int g=begin;g<end;++g)
+		{
+			net.setWeights(_population[g]->chromosome());
+			double fitness = _accumulate ? _population[g]->fitness() : 0.0;
+			for (int item=0;item<_numberOfItems;item+=GenAlgBlockSize)
+			{
+				const int n = std::min(GenAlgBlockSize,_numberOfItems-item);
+				net.batchOutput(&_inputs[item*nInputs],n,&outputs[0]);
+				for (int i=0;i<n;++i)
+				{
+					double msd = GenAlgSumSqrDiff(&outputs[i*nOutputs],&_targets[(item+i)*nOutputs],nOutputs);
+					// The very first evaluation replaces the fitness rather than adding to it
+					if ((item+i == 0)&&(!_accumulate))
+						fitness = msd;
+					else
+						fitness += msd;
+				}
+			}
+			_population[g]->setFitness(fitness);
+		}
+	}
+
+private:
+	std::vector<Genome *> &_population;
+	std::vector<CompiledNeuralNet *> _networks;
+	const std::vector<double> &_inputs;
+	const std::vector<double> &_targets;
+	const int _numberOfItems;
+	const bool _accumulate;
+};
+
+// Squared error of each data item for a single network, written per item so that
+// the total can be summed up in item order afterwards.
+class GenAlgErrorTask : public NeuralNetParallelTask
+{
+public:
+	GenAlgErrorTask(const CompiledNeuralNet &net,const std::vector<double> &inputs,const std::vector<double> &targets,std::vector<double> &errors)
+		: _net(net),_inputs(inputs),_targets(targets),_errors(errors) {}
+	void process(const int /*thread*/,const int begin,const int end)
+	{
+		const int nInputs = _net.numberOfInputs();
+		const int nOutputs = _net.numberOfOutputs();
+		std::vector<double> outputs(GenAlgBlockSize*nOutputs);
+		for (int item=begin;item<end;item+=GenAlgBlockSize)
+		{
+			const int n = std::min(GenAlgBlockSize,end-item);
+			_net.batchOutput(&_inputs[item*nInputs],n,&outputs[0]);
+			for (int i=0;i<n;++i)
+				_errors[item+i] = GenAlgSumSqrDiff(&outputs[i*nOutputs],&_targets[(item+i)*nOutputs],nOutputs);
+		}
+	}
+
+private:
+	const CompiledNeuralNet &_net;
+	const std::vector<double> &_inputs;
+	const std::vector<double> &_targets;
+	std::vector<double> &_errors;
+};
 }
 
 GeneticAlgorithm::GeneticAlgorithm(NeuralNet &theNetwork,const int populationSize,const double mutationRate,
@@ -32,7 +128,7 @@ GeneticAlgorithm::GeneticAlgorithm(NeuralNet &theNetwork,const int populationSiz
 								   : _theNetwork(theNetwork),_populationSize(populationSize),
 								     _numberOfEliteCrossGenerationGenomes(4),_numberOfCopiesOfEliteGenomes(1),
 									 _numberOfEvaluations(0),_progressPrintoutFrequency(100),
-                                     _maxGenomeFitness(1.0E11)
+                                     _maxGenomeFitness(1.0E11),_numberOfThreads(1)
 {
 	Genome::MutationRate = mutationRate;
 	Genome::CrossoverRate = crossoverRate;
@@ -128,6 +224,29 @@ void GeneticAlgorithm::evaluatePopulationFitness(const std::vector<double> &inpu
 	}
 }
 
+void GeneticAlgorithm::evaluatePopulationFitness(const NeuralNetDataSet &dataSet)
+{
+	std::vector<double> inputs;
+	std::vector<double> targets;
+	dataSet.packedData(inputs,targets);
+	evaluatePopulationFitness(inputs,targets,dataSet.numberOfDataItems());
+}
+
+void GeneticAlgorithm::evaluatePopulationFitness(const std::vector<double> &inputs,const std::vector<double> &targets,const int numberOfItems)
+{
+	if (numberOfItems <= 0) return;
+	if (numberOfItems*_theNetwork.numberOfInputs() != (int)inputs.size())
+	{
+		std::cerr << "GeneticAlgorithm:: Data set input size does not match the network." << std::endl;
+		return;
+	}
+
+	const int nThreads = NeuralNetThreads::NumberOfWorkers(_populationSize,_numberOfThreads);
+	NeuralNetUtils::GenAlgFitnessTask task(_thePopulation,_theNetwork,nThreads,inputs,targets,numberOfItems,_numberOfEvaluations>0);
+	NeuralNetThreads::ParallelFor(task,_populationSize,nThreads);
+	_numberOfEvaluations += numberOfItems;
+}
+
 void GeneticAlgorithm::pickBest()
 {
 	std::sort(_thePopulation.begin(),_thePopulation.end(),NeuralNetUtils::GenAlgSortGenomePointers);
@@ -231,32 +350,25 @@ void GeneticAlgorithm::trainWithDataSet(const int numberOfEpochs,const NeuralNet
 
 void GeneticAlgorithm::processDataSet(const NeuralNetDataSet &dataSet)
 {
-	std::vector<double> inputs;
-	std::vector<double> target;
-	for (int i=0;i<dataSet.numberOfDataItems();++i)
-	{
-		dataSet.getDataItem(i,inputs,target);
-		evaluatePopulationFitness(inputs,target);
-	}
+	evaluatePopulationFitness(dataSet);
 }
 
 double GeneticAlgorithm::error(const NeuralNetDataSet &dataSet) const
 {
 	std::vector<double> inputs;
-	std::vector<double> target;
-	std::vector<double> output;
+	std::vector<double> targets;
+	dataSet.packedData(inputs,targets);
+	const int numberOfItems = dataSet.numberOfDataItems();
+
+	CompiledNeuralNet theNet(_theNetwork);
+	std::vector<double> errors(numberOfItems,0.0);
+	NeuralNetUtils::GenAlgErrorTask task(theNet,inputs,targets,errors);
+	NeuralNetThreads::ParallelFor(task,numberOfItems,_numberOfThreads);
+
 	double error = 0.0;
-	for (int i=0;i<dataSet.numberOfDataItems();++i)
-	{
-		dataSet.getDataItem(i,inputs,target);
-		std::vector<double> output = _theNetwork.output(inputs);
-		std::vector<double> differences(output.size());
-		std::transform(output.begin(),output.end(),target.begin(),differences.begin(),
-			NeuralNetUtils::GenAlgDiff);
-		double totalSqError = std::accumulate(differences.begin(),differences.end(),0.0);
-		error+=totalSqError;
-	}
-	return error/(2.0*(double)dataSet.numberOfDataItems());
+	for (int i=0;i<numberOfItems;++i)
+		error+=errors[i];
+	return error/(2.0*(double)numberOfItems);
 }
 
 void GeneticAlgorithm::exterminate()
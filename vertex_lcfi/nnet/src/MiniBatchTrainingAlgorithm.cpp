@@ -0,0 +1,311 @@
+#include "MiniBatchTrainingAlgorithm.h"
+
+#include "CompiledNeuralNet.h"
+#include "InputNormaliserBuilder.h"
+#include "InputNormaliserBuilderCatalogue.h"
+
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+using namespace nnet;
+
+MiniBatchTrainingAlgorithm::MiniBatchTrainingAlgorithm(NeuralNet &theNetwork,const UpdateRule rule,const double learningRate,const int batchSize)
+: _theNetwork(theNetwork),_updateRule(rule),_learningRate(learningRate),_batchSize(batchSize>0 ? batchSize : 1),
+  _momentumConstant(0.9),_beta1(0.9),_beta2(0.999),_epsilon(1.0E-8),_validationFraction(0.1),_earlyStoppingPatience(10),
+  _decayFactor(1.0),_decayPeriod(0),_plateauFactor(1.0),_plateauPatience(0),_randomSeed(1),_randomState(1),
+  _progressPrintoutFrequency(100),_bestEpoch(-1),_numberOfInputs(0),_numberOfTargets(0),_numberOfUpdates(0)
+{
+}
+
+MiniBatchTrainingAlgorithm::~MiniBatchTrainingAlgorithm(void)
+{
+}
+
+double MiniBatchTrainingAlgorithm::train(const int numberOfEpochs,const NeuralNetDataSet &dataSet,
+										 const NeuralNet::InputNormalisationSelect normaliseTrainingData)
+{
+	if (normaliseTrainingData==NeuralNet::GaussianNormalised)
+	{
+		std::vector<double> inputmean;
+		std::vector<double> targetoffset;
+		std::vector<double> inputvariance;
+		std::vector<double> targetrange;
+		std::vector<double> inputoffset;
+		std::vector<double> inputrange;
+		dataSet.getNormalisationData(inputmean,targetoffset,inputvariance,targetrange,inputoffset,inputrange);
+
+		if (((int)inputmean.size() != _theNetwork.numberOfInputs())||((int)inputvariance.size() != _theNetwork.numberOfInputs()))
+			std::cerr << "Normalisation error: input size mismatch" << std::endl;
+
+		InputNormaliserBuilder *theBuilder = InputNormaliserBuilderCatalogue::instance(&_theNetwork)->builderOf("GaussianNormaliser");
+		std::vector<InputNormaliser *> theNormalisers;
+		for (int i=0;i<_theNetwork.numberOfInputs();++i)
+		{
+			std::vector<double> constructionData;
+			constructionData.push_back(inputmean[i]);
+			constructionData.push_back(inputvariance[i]);
+			theNormalisers.push_back(theBuilder->buildNormaliser(constructionData));
+		}
+		_theNetwork.setInputNormalisers(theNormalisers);
+	}
+
+	setTargetNormalisation(dataSet);
+	return trainWithDataSet(numberOfEpochs,dataSet);
+}
+
+double MiniBatchTrainingAlgorithm::train(const int numberOfEpochs,const NeuralNetDataSet &dataSet,
+										 const std::vector<InputNormaliser *> &inputNormalisers)
+{
+	_theNetwork.setInputNormalisers(inputNormalisers);
+	setTargetNormalisation(dataSet);
+	return trainWithDataSet(numberOfEpochs,dataSet);
+}
+
+void MiniBatchTrainingAlgorithm::setTargetNormalisation(const NeuralNetDataSet &dataSet)
+{
+	std::vector<double> inputmean;
+	std::vector<double> targetoffset;
+	std::vector<double> inputvariance;
+	std::vector<double> targetrange;
+	std::vector<double> inputoffset;
+	std::vector<double> inputrange;
+	dataSet.getNormalisationData(inputmean,targetoffset,inputvariance,targetrange,inputoffset,inputrange);
+
+	std::vector<std::pair<double,double> > netoutranges = _theNetwork.networkOutputRange();
+	std::vector<double> netoffsets;
+	std::vector<double> netranges;
+	for (int i=0;i<(int)targetoffset.size();++i)
+	{
+		double targetRange = netoutranges[i].second-netoutranges[i].first;
+		netoffsets.push_back( -((targetrange[i]/targetRange)*netoutranges[i].first+targetoffset[i]));
+		netranges.push_back( targetrange[i]/targetRange );
+	}
+	_theNetwork.setTargetNormalisationOffsets(netoffsets);
+	_theNetwork.setTargetNormalisationRanges(netranges);
+}
+
+double MiniBatchTrainingAlgorithm::trainWithDataSet(const int numberOfEpochs,const NeuralNetDataSet &dataSet)
+{
+	_savedEpochErrorValues.clear();
+	_savedValidationErrorValues.clear();
+	_bestEpoch = -1;
+
+	const int numberOfItems = dataSet.numberOfDataItems();
+	if (numberOfItems == 0)
+	{
+		std::cerr << "MiniBatchTrainingAlgorithm:: Empty data set." << std::endl;
+		return 0.0;
+	}
+	dataSet.packedData(_inputs,_targets);
+	_numberOfInputs = dataSet.inputDataSize();
+	_numberOfTargets = dataSet.targetDataSize();
+	_targetOffsets = _theNetwork.targetNormalisationOffsets();
+	_targetRanges = _theNetwork.targetNormalisationRanges();
+
+	CompiledNeuralNet theNet(_theNetwork);
+	if ((_numberOfInputs != theNet.numberOfInputs())||(_numberOfTargets != theNet.numberOfOutputs()))
+	{
+		std::cerr << "MiniBatchTrainingAlgorithm:: Data set does not match the network." << std::endl;
+		return 0.0;
+	}
+
+	_layerWeightOffsets.clear();
+	int offset = 0;
+	for (int l=0;l<theNet.numberOfLayers();++l)
+	{
+		_layerWeightOffsets.push_back(offset);
+		offset += theNet.numberOfNeurons(l)*(theNet.numberOfLayerInputs(l)+1);
+	}
+	_weights = _theNetwork.weights();
+	_gradient.assign(_weights.size(),0.0);
+	_firstMoment.assign(_weights.size(),0.0);
+	_secondMoment.assign(_weights.size(),0.0);
+	_numberOfUpdates = 0;
+
+	// Split off the validation sample once, the training part is reshuffled every epoch
+	_randomState = _randomSeed;
+	std::vector<int> order(numberOfItems);
+	for (int i=0;i<numberOfItems;++i) order[i] = i;
+	for (int i=numberOfItems-1;i>0;--i)
+		std::swap(order[i],order[nextRandom()%(i+1)]);
+	int numberOfValidationItems = (int)(_validationFraction*numberOfItems);
+	if (numberOfValidationItems >= numberOfItems) numberOfValidationItems = numberOfItems-1;
+	if (numberOfValidationItems < 0) numberOfValidationItems = 0;
+	const int numberOfTrainingItems = numberOfItems-numberOfValidationItems;
+
+	std::vector<double> bestWeights = _weights;
+	double bestError = 0.0;
+	int epochsSinceBest = 0;
+	double plateauScale = 1.0;
+	double finalError = 0.0;
+
+	for (int epoch=0;epoch<numberOfEpochs;++epoch)
+	{
+		double learningRate = _learningRate*plateauScale;
+		if ((_decayPeriod > 0)&&(_decayFactor != 1.0))
+			learningRate *= std::pow(_decayFactor,(double)(epoch/_decayPeriod));
+
+		for (int i=numberOfTrainingItems-1;i>0;--i)
+			std::swap(order[i],order[nextRandom()%(i+1)]);
+
+		double epochError = 0.0;
+		for (int begin=0;begin<numberOfTrainingItems;begin+=_batchSize)
+		{
+			const int end = std::min(begin+_batchSize,numberOfTrainingItems);
+			theNet.setWeights(_weights);
+			epochError += processBatch(theNet,order,begin,end);
+			updateWeights(end-begin,learningRate);
+		}
+		epochError /= (double)numberOfTrainingItems;
+		_savedEpochErrorValues.push_back(epochError);
+
+		theNet.setWeights(_weights);
+		double validationError = epochError;
+		if (numberOfValidationItems > 0)
+		{
+			validationError = error(theNet,order,numberOfTrainingItems,numberOfItems);
+			_savedValidationErrorValues.push_back(validationError);
+		}
+
+		if ((_bestEpoch < 0)||(validationError < bestError))
+		{
+			bestError = validationError;
+			bestWeights = _weights;
+			_bestEpoch = epoch;
+			epochsSinceBest = 0;
+		}
+		else
+		{
+			++epochsSinceBest;
+			if ((_plateauPatience > 0)&&(epochsSinceBest%_plateauPatience == 0))
+				plateauScale *= _plateauFactor;
+		}
+		finalError = bestError;
+
+		if (_progressPrintoutFrequency > 0)
+		{
+			if (epoch%_progressPrintoutFrequency == 0)
+			{
+				std::cout << "Epoch " << epoch << "/" << numberOfEpochs << " : Error function " << epochError;
+				if (numberOfValidationItems > 0)
+					std::cout << " validation " << validationError;
+				std::cout << std::endl;
+			}
+		}
+
+		if ((numberOfValidationItems > 0)&&(_earlyStoppingPatience > 0)&&(epochsSinceBest >= _earlyStoppingPatience))
+		{
+			std::cout << "No improvement in validation error for " << epochsSinceBest << " epochs, stopping at epoch " << epoch << std::endl;
+			break;
+		}
+	}
+
+	_theNetwork.setWeights(bestWeights);
+	std::cout << "Final error at end of training cycle : " << finalError << " (epoch " << _bestEpoch << ")" << std::endl;
+	return finalError;
+}
+
+double MiniBatchTrainingAlgorithm::processBatch(CompiledNeuralNet &theNet,const std::vector<int> &order,const int begin,const int end)
+{
+	const int numberOfLayers = theNet.numberOfLayers();
+	const int lastLayer = numberOfLayers-1;
+	_errorSignals.resize(numberOfLayers);
+	_gradient.assign(_gradient.size(),0.0);
+
+	double batchError = 0.0;
+	for (int item=begin;item<end;++item)
+	{
+		const double *inputs = &_inputs[order[item]*_numberOfInputs];
+		const double *targets = &_targets[order[item]*_numberOfTargets];
+		theNet.forward(inputs,_values,_derivatives);
+
+		// Output layer, including the scaling from the network output range to the targets
+		_errorSignals[lastLayer].resize(_numberOfTargets);
+		for (int k=0;k<_numberOfTargets;++k)
+		{
+			const double output = _values[numberOfLayers][k]*_targetRanges[k]+_targetOffsets[k];
+			const double difference = targets[k]-output;
+			batchError += difference*difference/2.0;
+			_errorSignals[lastLayer][k] = -difference*_targetRanges[k]*_derivatives[lastLayer][k];
+		}
+
+		// Back propagate through the hidden layers
+		for (int l=lastLayer-1;l>=0;--l)
+		{
+			const int nextInputs = theNet.numberOfLayerInputs(l+1);
+			const double *nextWeights = &_weights[_layerWeightOffsets[l+1]];
+			_errorSignals[l].resize(theNet.numberOfNeurons(l));
+			for (int j=0;j<theNet.numberOfNeurons(l);++j)
+			{
+				double sum = 0.0;
+				for (int k=0;k<theNet.numberOfNeurons(l+1);++k)
+					sum += _errorSignals[l+1][k]*nextWeights[k*(nextInputs+1)+j];
+				_errorSignals[l][j] = sum*_derivatives[l][j];
+			}
+		}
+
+		// Accumulate dE/dw in the same order as the weights
+		for (int l=0;l<numberOfLayers;++l)
+		{
+			const int nInputs = theNet.numberOfLayerInputs(l);
+			const std::vector<double> &layerInputs = _values[l];
+			double *gradient = &_gradient[_layerWeightOffsets[l]];
+			for (int n=0;n<theNet.numberOfNeurons(l);++n,gradient+=nInputs+1)
+			{
+				const double signal = _errorSignals[l][n];
+				for (int i=0;i<nInputs;++i)
+					gradient[i] += signal*layerInputs[i];
+				gradient[nInputs] += signal*theNet.bias(l,n);
+			}
+		}
+	}
+	return batchError;
+}
+
+double MiniBatchTrainingAlgorithm::error(const CompiledNeuralNet &theNet,const std::vector<int> &order,const int begin,const int end) const
+{
+	std::vector<double> output(_numberOfTargets);
+	double totalError = 0.0;
+	for (int item=begin;item<end;++item)
+	{
+		theNet.batchOutput(&_inputs[order[item]*_numberOfInputs],1,&output[0]);
+		const double *targets = &_targets[order[item]*_numberOfTargets];
+		for (int k=0;k<_numberOfTargets;++k)
+			totalError += (targets[k]-output[k])*(targets[k]-output[k])/2.0;
+	}
+	return end>begin ? totalError/(double)(end-begin) : 0.0;
+}
+
+void MiniBatchTrainingAlgorithm::updateWeights(const int numberOfItems,const double learningRate)
+{
+	++_numberOfUpdates;
+	const double norm = 1.0/(double)numberOfItems;
+	if (_updateRule == Adam)
+	{
+		const double correction1 = 1.0-std::pow(_beta1,(double)_numberOfUpdates);
+		const double correction2 = 1.0-std::pow(_beta2,(double)_numberOfUpdates);
+		for (int i=0;i<(int)_weights.size();++i)
+		{
+			const double g = _gradient[i]*norm;
+			_firstMoment[i] = _beta1*_firstMoment[i]+(1.0-_beta1)*g;
+			_secondMoment[i] = _beta2*_secondMoment[i]+(1.0-_beta2)*g*g;
+			_weights[i] -= learningRate*(_firstMoment[i]/correction1)/(std::sqrt(_secondMoment[i]/correction2)+_epsilon);
+		}
+	}
+	else
+	{
+		for (int i=0;i<(int)_weights.size();++i)
+		{
+			_firstMoment[i] = _momentumConstant*_firstMoment[i]-learningRate*_gradient[i]*norm;
+			_weights[i] += _firstMoment[i];
+		}
+	}
+}
+
+unsigned long MiniBatchTrainingAlgorithm::nextRandom()
+{
+	// 32 bit linear congruential generator (Numerical Recipes constants), upper bits only
+	_randomState = (1664525UL*_randomState+1013904223UL)&0xffffffffUL;
+	return _randomState>>8;
+}
@@ -166,6 +166,19 @@ void NeuralNetDataSet::getDataItem(const int item,std::vector<double> &inputData
 	}
 }
 
+void NeuralNetDataSet::packedData(std::vector<double> &inputData,std::vector<double> &targetData) const
+{
+	inputData.clear();
+	targetData.clear();
+	inputData.reserve(_theData.size()*_inputDataSize);
+	targetData.reserve(_theData.size()*_targetDataSize);
+	for (std::vector<DataSetItem>::const_iterator iter=_theData.begin();iter!=_theData.end();++iter)
+	{
+		inputData.insert(inputData.end(),iter->first.begin(),iter->first.end());
+		targetData.insert(targetData.end(),iter->second.begin(),iter->second.end());
+	}
+}
+
 NEURALNETDLL std::ostream &nnet::operator<<(std::ostream &os,const NeuralNetDataSet &ds)
 {
 	std::streamsize oldPrec = os.precision();
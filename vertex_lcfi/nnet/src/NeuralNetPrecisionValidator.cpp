@@ -0,0 +1,93 @@
+#include "NeuralNetPrecisionValidator.h"
+
+#include "NeuralNet.h"
+#include "NeuralNetDataSet.h"
+
+#include <cmath>
+#include <algorithm>
+#include <utility>
+
+using namespace nnet;
+
+NeuralNetPrecisionValidator::NeuralNetPrecisionValidator(const NeuralNet &theNetwork,const NeuralNetDataSet &referenceSample,const int output)
+: _theNetwork(theNetwork),_output(output),_precision(CompiledNeuralNet::DoublePrecision),
+  _maximumDeviation(0.0),_purity(0.0),_referenceEfficiency(0.0),_efficiency(0.0)
+{
+	std::vector<double> targets;
+	referenceSample.packedData(_inputs,targets);
+	const int numberOfItems = referenceSample.numberOfDataItems();
+	const int numberOfTargets = referenceSample.targetDataSize();
+	if ((referenceSample.inputDataSize() != theNetwork.numberOfInputs())||(output >= numberOfTargets))
+	{
+		std::cerr << "NeuralNetPrecisionValidator:: Reference sample does not match the network." << std::endl;
+		_inputs.clear();
+		return;
+	}
+
+	for (int i=0;i<numberOfItems;++i)
+		_isSignal.push_back(targets[i*numberOfTargets+output] > 0.5);
+
+	CompiledNeuralNet reference(theNetwork);
+	std::vector<double> outputs(numberOfItems*reference.numberOfOutputs());
+	if (numberOfItems > 0)
+		reference.batchOutput(&_inputs[0],numberOfItems,&outputs[0]);
+	for (int i=0;i<numberOfItems;++i)
+		_referenceOutput.push_back(outputs[i*reference.numberOfOutputs()+output]);
+}
+
+void NeuralNetPrecisionValidator::validate(const CompiledNeuralNet::Precision precision,const double purity)
+{
+	_precision = precision;
+	_purity = purity;
+	_maximumDeviation = 0.0;
+	const int numberOfItems = (int)_referenceOutput.size();
+	if (numberOfItems == 0) return;
+
+	CompiledNeuralNet reduced(_theNetwork,precision);
+	std::vector<double> outputs(numberOfItems*reduced.numberOfOutputs());
+	reduced.batchOutput(&_inputs[0],numberOfItems,&outputs[0]);
+
+	std::vector<double> reducedOutput;
+	for (int i=0;i<numberOfItems;++i)
+	{
+		reducedOutput.push_back(outputs[i*reduced.numberOfOutputs()+_output]);
+		_maximumDeviation = std::max(_maximumDeviation,std::fabs(reducedOutput.back()-_referenceOutput[i]));
+	}
+	_referenceEfficiency = efficiencyAtPurity(_referenceOutput,_isSignal,purity);
+	_efficiency = efficiencyAtPurity(reducedOutput,_isSignal,purity);
+}
+
+void NeuralNetPrecisionValidator::print(std::ostream &os) const
+{
+	const char *names[] = {"double","single","int8"};
+	os << "Precision " << names[_precision] << " over " << numberOfItems() << " items: maximum output deviation " << _maximumDeviation
+		<< ", efficiency at purity " << _purity << " " << _efficiency << " (double " << _referenceEfficiency
+		<< ", change " << _efficiency-_referenceEfficiency << ")" << std::endl;
+}
+
+double NeuralNetPrecisionValidator::efficiencyAtPurity(const std::vector<double> &output,const std::vector<bool> &isSignal,const double purity)
+{
+	std::vector<std::pair<double,bool> > sorted;
+	int totalSignal = 0;
+	for (int i=0;i<(int)output.size();++i)
+	{
+		sorted.push_back(std::make_pair(output[i],(bool)isSignal[i]));
+		if (isSignal[i]) ++totalSignal;
+	}
+	if (totalSignal == 0) return 0.0;
+	std::sort(sorted.begin(),sorted.end());
+
+	// Lower the cut from the top one distinct value at a time
+	double bestEfficiency = 0.0;
+	int signal = 0;
+	int background = 0;
+	for (int i=(int)sorted.size()-1;i>=0;--i)
+	{
+		if (sorted[i].second) ++signal;
+		else ++background;
+		if ((i > 0)&&(sorted[i-1].first == sorted[i].first)) continue;
+		if ((double)signal/(double)(signal+background) >= purity)
+			bestEfficiency = std::max(bestEfficiency,(double)signal/(double)totalSignal);
+	}
+	return bestEfficiency;
+}
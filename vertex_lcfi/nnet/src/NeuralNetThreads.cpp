@@ -0,0 +1,81 @@
+#include "NeuralNetThreads.h"
+
+#include <vector>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace nnet;
+
+namespace
+{
+struct NeuralNetThreadArguments
+{
+	NeuralNetParallelTask *task;
+	int thread;
+	int begin;
+	int end;
+};
+
+void *NeuralNetThreadEntry(void *arguments)
+{
+	NeuralNetThreadArguments *args = static_cast<NeuralNetThreadArguments *>(arguments);
+	args->task->process(args->thread,args->begin,args->end);
+	return 0;
+}
+}
+
+NEURALNETDLL int NeuralNetThreads::NumberOfProcessors()
+{
+#ifndef _WIN32
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if (n > 0) return (int)n;
+#endif
+	return 1;
+}
+
+NEURALNETDLL int NeuralNetThreads::NumberOfWorkers(const int numberOfItems,const int numberOfThreads)
+{
+	int workers = numberOfThreads;
+	if (workers <= 0) workers = NumberOfProcessors();
+	if (workers > numberOfItems) workers = numberOfItems;
+	if (workers < 1) workers = 1;
+	return workers;
+}
+
+NEURALNETDLL void NeuralNetThreads::ParallelFor(NeuralNetParallelTask &task,const int numberOfItems,const int numberOfThreads)
+{
+	if (numberOfItems <= 0) return;
+	const int workers = NumberOfWorkers(numberOfItems,numberOfThreads);
+
+	std::vector<NeuralNetThreadArguments> args(workers);
+	for (int i=0;i<workers;++i)
+	{
+		args[i].task = &task;
+		args[i].thread = i;
+		args[i].begin = (int)(((long)numberOfItems*i)/workers);
+		args[i].end = (int)(((long)numberOfItems*(i+1))/workers);
+	}
+
+#ifndef _WIN32
+	std::vector<pthread_t> threads(workers);
+	std::vector<bool> started(workers,false);
+	for (int i=1;i<workers;++i)
+		started[i] = (pthread_create(&threads[i],0,NeuralNetThreadEntry,&args[i]) == 0);
+
+	// The calling thread does the first chunk, plus any chunk that couldn't get a thread of its own
+	NeuralNetThreadEntry(&args[0]);
+	for (int i=1;i<workers;++i)
+	{
+		if (started[i])
+			pthread_join(threads[i],0);
+		else
+			NeuralNetThreadEntry(&args[i]);
+	}
+#else
+	for (int i=0;i<workers;++i)
+		NeuralNetThreadEntry(&args[i]);
+#endif
+}
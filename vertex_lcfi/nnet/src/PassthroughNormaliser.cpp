@@ -18,6 +18,13 @@ double PassthroughNormaliser::normalisedValue(const double input) const
     return input;
 }
 
+bool PassthroughNormaliser::affineParameters(double &scale,double &offset) const
+{
+    scale = 1.0;
+    offset = 0.0;
+    return true;
+}
+
 void PassthroughNormaliser::serialise(std::ostream &os) const
 {
     if (_parentNetwork != (NeuralNet *)0)
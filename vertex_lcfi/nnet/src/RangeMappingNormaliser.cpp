@@ -49,6 +49,13 @@ double RangeMappingNormaliser::normalisedValue(const double input) const
     return (((input-_inputMin)/_inputRange)*_outputRange)+_outputMin;
 }
 
+bool RangeMappingNormaliser::affineParameters(double &scale,double &offset) const
+{
+    scale = _outputRange/_inputRange;
+    offset = _outputMin-_inputMin*scale;
+    return true;
+}
+
 void RangeMappingNormaliser::serialise(std::ostream &os) const
 {
     if (_parentNetwork != (NeuralNet *)0)
@@ -208,63 +208,71 @@ vertex_lcfi::Vertex* vertexFromLCIOVertex(lcio::Vertex* LCIOVertex, Event* MyEve
 //TODO NB - Does nto support a deacy chain that has tracks not in the jet
 DecayChain* decayChainFromLCIORP(Jet* LCFIJet, ReconstructedParticle* DecayChainRP)
 {
-	//First make a map associating LCFI tracks to LCIO Reconstructed particles
-	map<ReconstructedParticle*,Track*> LCFITrack;
-	vector<Track*> LCFITracks = LCFIJet->tracks();
+	//First make a table associating LCFI tracks to LCIO Reconstructed particles, sorted by RP so it can be searched
+	const vector<Track*> & LCFITracks = LCFIJet->tracks();
+	vector<std::pair<ReconstructedParticle*,Track*> > LCFITrack;
+	LCFITrack.reserve(LCFITracks.size());
 	for (vector<Track*>::const_iterator iTrack = LCFITracks.begin();iTrack < LCFITracks.end();++iTrack)
 	{
 		//std::cout << "Adding " << (ReconstructedParticle*)(*iTrack)->trackingNum() << " =L " << *iTrack << std::endl;
-		LCFITrack[(ReconstructedParticle*)(*iTrack)->trackingNum()] = *iTrack;
+		LCFITrack.push_back(std::make_pair((ReconstructedParticle*)(*iTrack)->trackingNum(),*iTrack));
 	}
+	std::sort(LCFITrack.begin(),LCFITrack.end());
 	
-	vector<lcio::Vertex*> LCIOVertices;
-	//Add the primary first
-	LCIOVertices.push_back(DecayChainRP->getStartVertex());
-	
-	//Loop over RPs to find all the vertices
-	vector<ReconstructedParticle*> RPs = DecayChainRP->getParticles();
+	//Find all the vertices, in the order they are first met: the primary first, then the start vertices of the RPs.
+	//The (vertex, position met) pairs are sorted so that each vertex is one run, with the place it was first met at the front
+	const vector<ReconstructedParticle*> & RPs = DecayChainRP->getParticles();
+	vector<std::pair<lcio::Vertex*,int> > VertexMetAt;
+	VertexMetAt.reserve(RPs.size()+1);
+	VertexMetAt.push_back(std::make_pair(DecayChainRP->getStartVertex(),-1));
+	for (unsigned int i = 0;i < RPs.size();++i)
+	{
+		 lcio::Vertex* MyVertex = RPs[i]->getStartVertex();
+		 if(MyVertex) VertexMetAt.push_back(std::make_pair(MyVertex,int(i)));
+	}
+	std::sort(VertexMetAt.begin(),VertexMetAt.end());
 	
-	for (vector<ReconstructedParticle*>::const_iterator iRP = RPs.begin();iRP < RPs.end();++iRP)
+	//Number the runs, and put them back in the order they were met
+	vector<int> RunOfRP(RPs.size(),-1);
+	vector<std::pair<int,int> > FirstMetAtOfRun;//(position first met, run)
+	for (unsigned int i = 0;i < VertexMetAt.size();++i)
 	{
-		 lcio::Vertex* MyVertex = (*iRP)->getStartVertex();
-		 if(MyVertex)
-		 {
-			 vector<lcio::Vertex*>::const_iterator it = find(LCIOVertices.begin(),LCIOVertices.end(),MyVertex);
-			 if (it == LCIOVertices.end())
-			 {
-				 LCIOVertices.push_back(MyVertex);
-			 }
-		 }
+		if (i == 0 || VertexMetAt[i].first != VertexMetAt[i-1].first)
+			FirstMetAtOfRun.push_back(std::make_pair(VertexMetAt[i].second,int(FirstMetAtOfRun.size())));
+		if (VertexMetAt[i].second >= 0) RunOfRP[VertexMetAt[i].second] = FirstMetAtOfRun.back().second;
 	}
+	std::sort(FirstMetAtOfRun.begin(),FirstMetAtOfRun.end());
 
 	DecayChain* NewDecayChain = new DecayChain(LCFIJet,vector<Track*>(),vector<vertex_lcfi::Vertex*>());
 	MemoryManager<vertex_lcfi::DecayChain>::Event()->registerObject(NewDecayChain);
 	
-	vector<vertex_lcfi::Vertex*> LCFIVertices;
-	map<lcio::Vertex*,vertex_lcfi::Vertex*> LCFIVertex;
-	for (vector<lcio::Vertex*>::const_iterator iVertex = LCIOVertices.begin();iVertex < LCIOVertices.end();++iVertex)
+	//The LCFI vertex of each run
+	vector<vertex_lcfi::Vertex*> LCFIVertexOfRun(FirstMetAtOfRun.size());
+	for (vector<std::pair<int,int> >::const_iterator iRun = FirstMetAtOfRun.begin();iRun < FirstMetAtOfRun.end();++iRun)
 	{
-		vertex_lcfi::Vertex* NewVertex = vertexFromLCIOVertex((*iVertex), LCFIJet->event());
-		LCFIVertices.push_back(NewVertex);
-		LCFIVertex[(*iVertex)] = NewVertex;
+		lcio::Vertex* LCIOVertex = (iRun->first < 0) ? DecayChainRP->getStartVertex() : RPs[iRun->first]->getStartVertex();
+		vertex_lcfi::Vertex* NewVertex = vertexFromLCIOVertex(LCIOVertex, LCFIJet->event());
+		LCFIVertexOfRun[iRun->second] = NewVertex;
 		NewDecayChain->addVertex(NewVertex);
 	}
 	
-	for (vector<ReconstructedParticle*>::const_iterator iRP = RPs.begin();iRP < RPs.end();++iRP)
+	for (unsigned int i = 0;i < RPs.size();++i)
 	{
-		if (!(*iRP)->getParticles().empty())
+		if (!RPs[i]->getParticles().empty())
 		{
 			//Only add if there is a corresponding LCFI track
-			map<ReconstructedParticle*,Track*>::const_iterator iLCFITrack= LCFITrack.find((*iRP)->getParticles()[0]);
-			if (iLCFITrack != LCFITrack.end())
+			ReconstructedParticle* TrackRP = RPs[i]->getParticles()[0];
+			vector<std::pair<ReconstructedParticle*,Track*> >::const_iterator iLCFITrack
+				= std::lower_bound(LCFITrack.begin(),LCFITrack.end(),std::make_pair(TrackRP,(Track*)0));
+			if (iLCFITrack != LCFITrack.end() && iLCFITrack->first == TrackRP)
 			{
-				if ((*iRP)->getStartVertex())
+				if (RunOfRP[i] >= 0)
 				{
-					LCFIVertex[(*iRP)->getStartVertex()]->addTrack(LCFITrack[(*iRP)->getParticles()[0]]);
+					LCFIVertexOfRun[RunOfRP[i]]->addTrack(iLCFITrack->second);
 				}
 				else
 				{
-					NewDecayChain->addTrack(LCFITrack[(*iRP)->getParticles()[0]]);
+					NewDecayChain->addTrack(iLCFITrack->second);
 				}
 			}
 		}
@@ -275,25 +283,86 @@ DecayChain* decayChainFromLCIORP(Jet* LCFIJet, ReconstructedParticle* DecayChain
 
 ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain* MyDecayChain, std::string VertexCollectionName, std::string TrackRPCollectionName, bool StoreTrackChiSquareds)
 {
-	//Check for cols and add if needed
-	vector<std::string>::const_iterator it = find(MyLCIOEvent->getCollectionNames()->begin(),MyLCIOEvent->getCollectionNames()->end(),VertexCollectionName);
-	if (it == MyLCIOEvent->getCollectionNames()->end())
+	LCIODecayChainWriter Writer(MyLCIOEvent,VertexCollectionName,TrackRPCollectionName,StoreTrackChiSquareds);
+	return Writer.add(MyDecayChain);
+}
+
+//Find a collection in the event, adding an empty one of the given type if it's not there
+static LCCollection* collectionOrNew(LCEvent* MyLCIOEvent, const std::string & CollectionName, const std::string & TypeName)
+{
+	const std::vector<std::string>* Names = MyLCIOEvent->getCollectionNames();
+	if (find(Names->begin(),Names->end(),CollectionName) == Names->end())
 	{
 		//Not found do add - TODO do these need memory managment?
-		LCCollection* MyCollection = new LCCollectionVec("Vertex");
-		MyLCIOEvent->addCollection(MyCollection,VertexCollectionName);
+		LCCollection* MyCollection = new LCCollectionVec(TypeName);
+		MyLCIOEvent->addCollection(MyCollection,CollectionName);
+		return MyCollection;
 	}
-	it = find(MyLCIOEvent->getCollectionNames()->begin(),MyLCIOEvent->getCollectionNames()->end(),TrackRPCollectionName);
-	if (it == MyLCIOEvent->getCollectionNames()->end())
+	return MyLCIOEvent->getCollection(CollectionName);
+}
+
+LCIODecayChainWriter::LCIODecayChainWriter(LCEvent* MyLCIOEvent, const std::string & VertexCollectionName, const std::string & TrackRPCollectionName, bool StoreTrackChiSquareds)
+: _ChiSquaredCollection(0),_PrimaryVertex(0),_VerticesSearched(0)
+{
+	//Check for cols and add if needed
+	_VertexCollection = collectionOrNew(MyLCIOEvent,VertexCollectionName,"Vertex");
+	_TrackRPCollection = collectionOrNew(MyLCIOEvent,TrackRPCollectionName,"ReconstructedParticle");
+	//The chi squareds are stored in the same order as TrackRPCollection
+	if (StoreTrackChiSquareds)
+		_ChiSquaredCollection = collectionOrNew(MyLCIOEvent,TrackRPCollectionName+"TrackChiSquareds","LCFloatVec");
+}
+
+void LCIODecayChainWriter::reserve(const std::vector<DecayChain*> & DecayChains)
+{
+	//Count what add() will put in each collection
+	int NumVertices = 1; //Allow for the primary
+	int NumTrackRPs = 0;
+	int NumTracks = 0;
+	for (vector<DecayChain*>::const_iterator iChain = DecayChains.begin();iChain != DecayChains.end();++iChain)
 	{
-		//Not found do add
-		LCCollection* MyCollection = new LCCollectionVec("ReconstructedParticle");
-		MyLCIOEvent->addCollection(MyCollection,TrackRPCollectionName);
+		if ((*iChain)->vertices().empty()) continue;
+		int NumDecays = (*iChain)->vertices().size()-1;
+		NumVertices += NumDecays;
+		NumTrackRPs += (*iChain)->allTracks().size() + NumDecays;
+		NumTracks += (*iChain)->allTracks().size();
 	}
-	//Get the collections
-	LCCollection* VertexCollection = MyLCIOEvent->getCollection(VertexCollectionName);
-	LCCollection* TrackRPCollection = MyLCIOEvent->getCollection(TrackRPCollectionName);
 	
+	//The collections are normally LCCollectionVecs, which are std::vectors of the elements
+	LCCollectionVec* Vertices = dynamic_cast<LCCollectionVec*>(_VertexCollection);
+	if (Vertices) Vertices->reserve(Vertices->size()+NumVertices);
+	LCCollectionVec* TrackRPs = dynamic_cast<LCCollectionVec*>(_TrackRPCollection);
+	if (TrackRPs) TrackRPs->reserve(TrackRPs->size()+NumTrackRPs);
+	LCCollectionVec* ChiSquareds = dynamic_cast<LCCollectionVec*>(_ChiSquaredCollection);
+	if (ChiSquareds) ChiSquareds->reserve(ChiSquareds->size()+NumTracks);
+}
+
+lcio::Vertex* LCIODecayChainWriter::_primaryVertex(DecayChain* MyDecayChain)
+{
+	//The first vertex is always assumed to be the IP
+	//We need to check to see if the primary vertex is already in the LCIO record.
+	//The vertices already looked at don't need looking at again, only the ones added since
+	if (!_PrimaryVertex)
+	{
+		int nVerts = _VertexCollection->getNumberOfElements()  ;
+		for(; _VerticesSearched < nVerts && !_PrimaryVertex ; _VerticesSearched++)
+		{
+			lcio::Vertex* iVertex = static_cast<lcio::Vertex*>(_VertexCollection->getElementAt(_VerticesSearched));
+			if(iVertex->isPrimary())
+				_PrimaryVertex = iVertex;
+		}
+	}
+	if (_PrimaryVertex) return _PrimaryVertex;
+	
+	//If no primary found make one and add it to the vertex collection
+	//Take the first vertex and convert it
+	lcio::Vertex* PrimaryVertex = vertexFromLCFIVertex(*(MyDecayChain->vertices().begin()));
+	//Add to the vertex collection
+	_VertexCollection->addElement(PrimaryVertex);
+	return PrimaryVertex;
+}
+
+ReconstructedParticle* LCIODecayChainWriter::add(DecayChain* MyDecayChain)
+{
 	//Check that the decay chain has vertices
 	if (MyDecayChain->vertices().empty())
 	{
@@ -308,33 +377,13 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 	//	//Throw something
 	//}
 	
-	//The first vertex is always assumed to be the IP
-	//We need to check to see if the primary vertex is already in the LCIO record
-	lcio::Vertex* PrimaryVertex = 0;
-	int nVerts = VertexCollection->getNumberOfElements()  ;
-	for(int i=0; i< nVerts && !PrimaryVertex ; i++)
-	{
-		if(dynamic_cast<lcio::Vertex*>(VertexCollection->getElementAt(i))->isPrimary())
-			PrimaryVertex = dynamic_cast<lcio::Vertex*>(VertexCollection->getElementAt(i));
-	}
-	
-	//If no primary found make one and add it to the vertex collection
-	if (!PrimaryVertex)
-	{
-		//Take the first vertex and convert it
-		PrimaryVertex = vertexFromLCFIVertex(*(MyDecayChain->vertices().begin()));
-		//Add to the vertex collection
-		VertexCollection->addElement(PrimaryVertex);
-	}
+	lcio::Vertex* PrimaryVertex = _primaryVertex(MyDecayChain);
 	
-	//If we are storing chi squareds add a collection for them and make a map of tracks and their chi squareds
+	//If we are storing chi squareds make a map of tracks and their chi squareds
 	//Note we only currently cope with a track being in one vertex (ie external legs)
 	map<Track*,double> ChiSquaredOf;
-	if (StoreTrackChiSquareds)
+	if (_ChiSquaredCollection)
 	{
-		LCCollection* MyCollection = new LCCollectionVec("LCFloatVec");
-		MyLCIOEvent->addCollection(MyCollection,TrackRPCollectionName+"TrackChiSquareds");
-		
 		//Loop over vertices adding chi squareds of each track to the map
 		for (vector<vertex_lcfi::Vertex*>::const_iterator iVertex = MyDecayChain->vertices().begin();iVertex < MyDecayChain->vertices().end();++iVertex)
 		{
@@ -346,7 +395,7 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 	//We keep track of correspondance between old and new with this map
 	map<ReconstructedParticle*,ReconstructedParticleImpl*> NewTrackRP;
 	
-	vector<Track*> AllTracks = MyDecayChain->allTracks();
+	const vector<Track*> & AllTracks = MyDecayChain->allTracks();
 	for (vector<Track*>::const_iterator iTrack = AllTracks.begin();iTrack < AllTracks.end();++iTrack)
 	{
 		//Make an RP 
@@ -356,7 +405,7 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 		//Link the RP to the orginal RP
 		NewRP->addParticle(OriginalRP);
 		NewTrackRP[OriginalRP] = NewRP;
-		TrackRPCollection->addElement(NewRP);
+		_TrackRPCollection->addElement(NewRP);
 
 		//We now optionally store the chi squareds of this track in each vertex it is found in
 		//These are stored as a colletion of LCFloatVecs in the same order as TrackRPCollection
@@ -364,33 +413,39 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 		//Eventually the second will be the chi squared in the second vertex (if any) but
 		//as this code does not yet cope with seen decaying particles that will be a future
 		//upgrade
-		if (StoreTrackChiSquareds)
+		if (_ChiSquaredCollection)
 		{
 			LCFloatVec* ChiSquared = new LCFloatVec();
-			if(ChiSquaredOf.find(*iTrack) == ChiSquaredOf.end())
+			map<Track*,double>::const_iterator iChiSquared = ChiSquaredOf.find(*iTrack);
+			if(iChiSquared == ChiSquaredOf.end())
 			{
 				//Not found in any vertex - shouldn't happen store -1
 				ChiSquared->push_back(-1);
 			}
 			else
 			{
-				ChiSquared->push_back(ChiSquaredOf[*iTrack]);
+				ChiSquared->push_back(iChiSquared->second);
 			}
 			
-			MyLCIOEvent->getCollection(TrackRPCollectionName+"TrackChiSquareds")->addElement(ChiSquared);
+			_ChiSquaredCollection->addElement(ChiSquared);
 		}
 	}
 	//We now associate tracks to the primary vertex
 	//We assume that the tracking pointer points to the ReconstructedParticle that the track was
 	//formed of, in future we may want to make tracks that don't have RP's already
-	vector<Track*> PrimaryTracks = (*MyDecayChain->vertices().begin())->tracks();
+	const vector<Track*> & PrimaryTracks = (*MyDecayChain->vertices().begin())->tracks();
 	for (vector<Track*>::const_iterator iTrack = PrimaryTracks.begin();iTrack < PrimaryTracks.end();++iTrack)
 	{
 		NewTrackRP[(ReconstructedParticle*)(*iTrack)->trackingNum()]->setStartVertex(PrimaryVertex);
 	}
 	
-	//Remember the RPs we make
-	vector<ReconstructedParticle*> CreatedRPs;
+	//Then make a a big RP of all tracks in the decay chain, the decayed particles are added as they are made
+	ReconstructedParticleImpl* DecayChainRP = new ReconstructedParticleImpl();
+	//MemoryManager<ReconstructedParticleImpl>::Event()->registerObject(DecayChainRP);
+	for (vector<Track*>::const_iterator iTrack = AllTracks.begin();iTrack < AllTracks.end();++iTrack)
+	{
+		DecayChainRP->addParticle(NewTrackRP[(ReconstructedParticle*)(*iTrack)->trackingNum()]);
+	}
 	
 	//Keep track of the last vertex so we can link them
 	lcio::Vertex* PreviousVertex = PrimaryVertex;
@@ -403,7 +458,7 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 		//Make the RP that represents the decayed particle
 		ReconstructedParticleImpl* NewRP = new ReconstructedParticleImpl();
 		//MemoryManager<ReconstructedParticleImpl>::Event()->registerObject(NewRP);
-		CreatedRPs.push_back(NewRP);
+		DecayChainRP->addParticle(NewRP);
 		//Set the parameters of this particle
 		double mom[3];
 		mom[0] = (*iVertex)->momentum().x();
@@ -426,26 +481,120 @@ ReconstructedParticle* addDecayChainToLCIOEvent(LCEvent* MyLCIOEvent, DecayChain
 		
 		PreviousVertex = NewVertex;
 		//Store them in the LCIO collections
-		VertexCollection->addElement(NewVertex);
-		TrackRPCollection->addElement(NewRP);
+		_VertexCollection->addElement(NewVertex);
+		_TrackRPCollection->addElement(NewRP);
 	}
 	
-	//Then make a a big RP of all tracks in the decay chain and set the start vertex
-	ReconstructedParticleImpl* DecayChainRP = new ReconstructedParticleImpl();
-	//MemoryManager<ReconstructedParticleImpl>::Event()->registerObject(DecayChainRP);
-	for (vector<Track*>::const_iterator iTrack = MyDecayChain->allTracks().begin();iTrack < MyDecayChain->allTracks().end();++iTrack)
+	DecayChainRP->setStartVertex(PrimaryVertex);
+	
+	return DecayChainRP;	
+}
+
+LCIOConversionCache* LCIOConversionCache::_Current = 0;
+int LCIOConversionCache::_LastId = 0;
+const char* const LCIOConversionCache::MarkerCollectionName = "LCFIConversionCacheMarker";
+
+LCIOConversionCache::LCIOConversionCache(LCEvent* LCIOEvent)
+: _Id(++_LastId)
+{
+	//Mark the event, the marker is only there for the cache so it is never written out
+	const std::vector<std::string>* Names = LCIOEvent->getCollectionNames();
+	if (std::find(Names->begin(),Names->end(),MarkerCollectionName) == Names->end())
 	{
-		DecayChainRP->addParticle(NewTrackRP[(ReconstructedParticle*)(*iTrack)->trackingNum()]);
+		LCCollectionVec* Marker = new LCCollectionVec(LCIO::LCGENERICOBJECT);
+		Marker->setTransient(true);
+		LCIOEvent->addCollection(Marker,MarkerCollectionName);
 	}
+	LCIOEvent->getCollection(MarkerCollectionName)->parameters().setValue("CacheId",_Id);
+}
+
+LCIOConversionCache::~LCIOConversionCache()
+{
+	//The objects are deleted by the MemoryManagers that own them
+	if (_Current == this) _Current = 0;
+}
+
+int LCIOConversionCache::idOf(LCEvent* LCIOEvent)
+{
+	//0 for an event no cache was made for, ids start at 1
+	const std::vector<std::string>* Names = LCIOEvent->getCollectionNames();
+	if (std::find(Names->begin(),Names->end(),MarkerCollectionName) == Names->end()) return 0;
+	return LCIOEvent->getCollection(MarkerCollectionName)->getParameters().getIntVal("CacheId");
+}
+
+LCIOConversionCache* LCIOConversionCache::forEvent(LCEvent* LCIOEvent)
+{
+	if (_Current && _Current->_Id == idOf(LCIOEvent))
+		return _Current;
 	
-	//Add the RPs we created as decayed Particles
-	for (vector<ReconstructedParticle*>::const_iterator iRP = CreatedRPs.begin();iRP < CreatedRPs.end();++iRP)
+	//New event, so everything from the last one goes (including the old cache)
+	MetaMemoryManager::Event()->delAllObjects();
+	_Current = new LCIOConversionCache(LCIOEvent);
+	MemoryManager<LCIOConversionCache>::Event()->registerObject(_Current);
+	return _Current;
+}
+
+void LCIOConversionCache::clear()
+{
+	MetaMemoryManager::Event()->delAllObjects();
+}
+
+vertex_lcfi::Event* LCIOConversionCache::event(const std::string & Key, const Vector3 & IPPos, const SymMatrix3x3 & IPErr)
+{
+	for (vector<std::pair<std::string, vertex_lcfi::Event*> >::const_iterator iEvent = _Events.begin();iEvent != _Events.end();++iEvent)
 	{
-		DecayChainRP->addParticle(*iRP);
+		if (iEvent->first != Key) continue;
+		const Vector3 & Pos = iEvent->second->interactionPoint();
+		const SymMatrix3x3 & Err = iEvent->second->interactionPointError();
+		bool Same = Pos.x() == IPPos.x() && Pos.y() == IPPos.y() && Pos.z() == IPPos.z();
+		for (int i=0;i<3 && Same;++i)
+			for (int j=0;j<=i && Same;++j)
+				Same = Err(i,j) == IPErr(i,j);
+		if (Same) return iEvent->second;
 	}
-	DecayChainRP->setStartVertex(PrimaryVertex);
 	
-	return DecayChainRP;	
+	vertex_lcfi::Event* MyEvent = new vertex_lcfi::Event(IPPos,IPErr);
+	MemoryManager<vertex_lcfi::Event>::Event()->registerObject(MyEvent);
+	_Events.push_back(std::make_pair(Key,MyEvent));
+	return MyEvent;
+}
+
+vertex_lcfi::Track* LCIOConversionCache::track(Event* MyEvent, lcio::ReconstructedParticle* RP)
+{
+	vertex_lcfi::Track* & MyTrack = _Tracks[std::make_pair(MyEvent,RP)];
+	if (!MyTrack)
+	{
+		MyTrack = trackFromLCIORP(MyEvent,RP);
+		MyEvent->addTrack(MyTrack);
+	}
+	return MyTrack;
+}
+
+vertex_lcfi::Jet* LCIOConversionCache::jet(Event* MyEvent, lcio::ReconstructedParticle* RP)
+{
+	vertex_lcfi::Jet* & MyJet = _Jets[std::make_pair(MyEvent,RP)];
+	if (!MyJet)
+	{
+		//As jetFromLCIORP, but with the tracks from the cache
+		MyJet = new Jet(MyEvent, vector<vertex_lcfi::Track*>(),RP->getEnergy(),Vector3(RP->getMomentum()[0],RP->getMomentum()[1],RP->getMomentum()[2]),(void*)RP);
+		MemoryManager<Jet>::Event()->registerObject(MyJet);
+		MyEvent->addJet(MyJet);
+		
+		vector<ReconstructedParticle*> LCIOJetRPs = RP->getParticles();
+		for (vector<ReconstructedParticle*>::const_iterator iRP = LCIOJetRPs.begin();iRP!=LCIOJetRPs.end();++iRP)
+		{
+			MyJet->addTrack(this->track(MyEvent,*iRP));
+		}
+	}
+	return MyJet;
+}
+
+DecayChain* LCIOConversionCache::decayChain(Jet* MyJet, lcio::ReconstructedParticle* DecayChainRP)
+{
+	DecayChain* & MyDecayChain = _DecayChains[std::make_pair(MyJet,DecayChainRP)];
+	if (!MyDecayChain)
+		MyDecayChain = decayChainFromLCIORP(MyJet,DecayChainRP);
+	return MyDecayChain;
 }
 
   void ReconstructedParticleLCFI::removeParticle(EVENT::ReconstructedParticle* particle)
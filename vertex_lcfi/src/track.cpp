@@ -12,11 +12,14 @@ namespace vertex_lcfi
 	using namespace vertex_lcfi::util;
 	
 	Track::Track()
-	{}
+	{
+		_invalidateIPCache();
+	}
 	
 	Track::Track(Event* Event, const HelixRep & H,const Vector3 & Momentum,const double & cha, const SymMatrix5x5 & cov, std::vector<int> hits, void* trackNum)
 	: _Event(Event),_H(H),_PMomentum(Momentum),_Charge(cha),_CovarianceMatrix(cov),_NumHitsSubDetector(hits),_TrackingNum(trackNum)
 	{
+		_invalidateIPCache();
 	}
 
 	Event* Track::event() const
@@ -56,20 +59,83 @@ namespace vertex_lcfi
 		return _CovarianceMatrix;
 	}
 	
+	void Track::_invalidateIPCache() const
+	{
+		_IPValid[ThreeD]=_IPValid[RPhi]=_IPValid[Z]=false;
+		_POCAVectorXYValid=false;
+	}
+	
+	void Track::_checkIPCache() const
+	{
+		const Vector3 & IP = this->event()->interactionPoint();
+		const SymMatrix3x3 & IPErr = this->event()->interactionPointError();
+		const HelixRep & H = _H;
+		const HelixRep & CacheH = _IPCacheHelix;
+		bool same = H.d0()==CacheH.d0() && H.z0()==CacheH.z0() && H.phi()==CacheH.phi()
+			&& H.invR()==CacheH.invR() && H.tanLambda()==CacheH.tanLambda();
+		for (short i=0;i<3 && same;++i)
+		{
+			if (_IPCachePosition(i) != IP(i)) same = false;
+			for (short j=0;j<=i;++j)
+				if (_IPCacheError(i,j) != IPErr(i,j)) same = false;
+		}
+		if (!same)
+		{
+			_invalidateIPCache();
+			_IPCacheHelix = _H;
+			_IPCachePosition = IP;
+			_IPCacheError = IPErr;
+		}
+	}
+	
+	const Vector3 & Track::_pocaVectorXY() const
+	{
+		if (!_POCAVectorXYValid)
+		{
+			//Swim a trackstate to the point of closest approach to the events IP
+			TrackState track(_H,_Charge,_CovarianceMatrix,(Track*)this);
+			track.swimToStateNearestXY(this->event()->interactionPoint());
+			_POCAVectorXY = track.position() - this->event()->interactionPoint();
+			_POCAVectorXYValid = true;
+		}
+		return _POCAVectorXY;
+	}
+	
 	double Track::significance(Projection Proj) const
+	{
+		if (Proj!=ThreeD && Proj!=RPhi && Proj!=Z)
+		{
+			std::cerr << "Unsupported Significance: Track.cpp:117" << std::endl;
+			return 1;
+		}
+		_checkIPCache();
+		if (!_IPValid[Proj]) _calculateSignificance(Proj);
+		return _IPSignificance[Proj];
+	}
+	
+	double Track::impactParameter(Projection Proj) const
+	{
+		if (Proj!=ThreeD && Proj!=RPhi && Proj!=Z)
+		{
+			std::cerr << "Unsupported Impact Parameter: Track.cpp" << std::endl;
+			return 0;
+		}
+		_checkIPCache();
+		if (!_IPValid[Proj]) _calculateSignificance(Proj);
+		return _IP[Proj];
+	}
+	
+	void Track::_calculateSignificance(Projection Proj) const
 	{
 		//define some nice index numbers
 		short x=0;short y=1;//short z=2;
-		//Swim a trackstate to the point of closest approach to the events IP
-		TrackState* track = this->makeState();
 		const SymMatrix3x3 & IPErr =this->event()->interactionPointError();
 		//TODO Cope with case where track is used in IP fit?
 		switch (Proj)
 		{
 		case RPhi:
 		  {
-		    track->swimToStateNearestXY(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
+		    const Vector3 & POCAVector = _pocaVectorXY();
 		    double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2.0*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)) / POCAVector.mag2(RPhi); 
 		    double ErrorTrack = this->covarianceMatrix()(0,0);
 		    if (ErrorIP <= 0.0)
@@ -77,26 +143,29 @@ namespace vertex_lcfi
 		    if (ErrorTrack <= 0.0)
 		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:79" << std::endl;
 		   //std::cout <<  POCAVector.mag(RPhi)*1000.0 << " " << sqrt(ErrorIP)*1000.0 << " " << sqrt(ErrorTrack)*1000.0 << " " << POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack) << " ";
-		   return POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack);
+		    _IP[RPhi] = POCAVector.mag(RPhi);
+		    _IPSignificance[RPhi] = POCAVector.mag(RPhi)/sqrt(ErrorIP+ErrorTrack);
 		    break;
 		  }
 		case Z:
 		  {
-		    track->swimToStateNearestXY(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
+		    const Vector3 & POCAVector = _pocaVectorXY();
 		    double ErrorIP = determinant(IPErr)/(IPErr(x,x)*IPErr(y,y)-IPErr(x,y)*IPErr(x,y));//IPErr(z,z);
 		    double ErrorTrack = this->covarianceMatrix()(3,3);
  		    if (ErrorIP <= 0.0)
 		      std::cerr << "-ve IP Error of " << ErrorIP << ": Track.cpp:91" << std::endl;
 		    if (ErrorTrack <= 0.0)
 		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:93" << std::endl;
-		    return POCAVector.mag(Z)/sqrt(ErrorIP+ErrorTrack);
+		    _IP[Z] = POCAVector.mag(Z);
+		    _IPSignificance[Z] = POCAVector.mag(Z)/sqrt(ErrorIP+ErrorTrack);
 		    break;
 		  }
 		case ThreeD:
 		  {
-		    track->swimToStateNearest(this->event()->interactionPoint());
-		    Vector3 POCAVector = track->position() - this->event()->interactionPoint();
+		    //Swim a trackstate to the point of closest approach to the events IP
+		    TrackState track(_H,_Charge,_CovarianceMatrix,(Track*)this);
+		    track.swimToStateNearest(this->event()->interactionPoint());
+		    Vector3 POCAVector = track.position() - this->event()->interactionPoint();
 		    double ErrorIP = prec_inner_prod(prec_prod(IPErr,POCAVector),POCAVector);
 		    //double ErrorIP = (IPErr(x,x)*pow(POCAVector.x(),2.0) + 2*IPErr(x,y)*POCAVector.x()*POCAVector.y() + IPErr(y,y)*pow(POCAVector.y(),2.0)  + IPErr(z,z)*pow(POCAVector.z(),2.0)+ 2*IPErr(x,z)*POCAVector.x()*POCAVector.z() +2*IPErr(z,y)*POCAVector.z()*POCAVector.y())/ POCAVector.mag2(ThreeD) ; 
 		    //this should probably be only 0,0+3,3 given the definition of the POCAVector in the Rphi case.
@@ -109,24 +178,21 @@ namespace vertex_lcfi
 		    if (ErrorTrack <= 0.0)
 		      std::cerr << "-ve Track Error of " << ErrorTrack << ": Track.cpp:111" << std::endl;
 		    
-		    return POCAVector.mag(ThreeD)/sqrt(ErrorIP+ErrorTrack);
+		    _IP[ThreeD] = POCAVector.mag(ThreeD);
+		    _IPSignificance[ThreeD] = POCAVector.mag(ThreeD)/sqrt(ErrorIP+ErrorTrack);
 		    break;
 		  }
 		}
-		std::cerr << "Unsupported Significance: Track.cpp:117" << std::endl;
-		return 1;
+		_IPValid[Proj] = true;
 	}
   double Track::signedSignificance(Projection Proj, Jet *MyJet) const
   {
-
-    TrackState* track = this->makeState();
-    track->swimToStateNearestXY(this->event()->interactionPoint());
-    Vector3 POCAVector = track->position() - this->event()->interactionPoint();    
     switch (Proj)
       {
 		case RPhi:
 		  {	//Sign the significances relative to the jet so if the track and jet cross in front of IP the significance is positive    
 		    double d0significance =  this->significance(RPhi);
+		    const Vector3 & POCAVector = _pocaVectorXY();
 
 		    if (((POCAVector.x()*MyJet->momentum().x())+(POCAVector.y()*MyJet->momentum().y())) < 0) 
 		      {
@@ -140,6 +206,7 @@ namespace vertex_lcfi
       case Z:
 	{
 		double z0significance =  this->significance(Z);
+		const Vector3 & POCAVector = _pocaVectorXY();
 		double TanlambdaJet =  MyJet->momentum().z()/sqrt(pow(MyJet->momentum().x(),2.0)+pow(MyJet->momentum().y(),2.0));
 
 		if(POCAVector.z()*(TanlambdaJet - this->helixRep().tanLambda()) < 0) 
@@ -160,6 +227,13 @@ namespace vertex_lcfi
     return 1;
   }
 
+  int Track::numberOfHits() const
+  {
+    int hits = 0;
+    for (std::vector<int>::const_iterator iHits = _NumHitsSubDetector.begin();iHits != _NumHitsSubDetector.end();++iHits)
+      hits += *iHits;
+    return hits;
+  }
 
   void* Track::trackingNum() const
   {
@@ -3,21 +3,22 @@
 #include "../inc/event.h"
 #include "../zvtop/include/candidatevertex.h"
 #include "../inc/trackstate.h"
+#include <algorithm>
 
 namespace vertex_lcfi
 {
 using namespace util;
 
 	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability, std::map<Track*,double> ChiTrack)
-	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability),_ChiSquaredOfTrack(ChiTrack)
+	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability),_ChiSquaredOfTrack(ChiTrack),_VertexFuncMaxValue(0),_SortedTracksValid(0)
 	{}
 	
 	Vertex::Vertex(Event* Event, const std::vector<Track*> & Tracks, const Vector3 & Position, const SymMatrix3x3 & PosError,bool IsPrimary, double Chi2, double Probability)
-	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability)
+	:_Event(Event),_Tracks(Tracks),_Position(Position),_PosError(PosError),_IsPrimary(IsPrimary), _Chi2(Chi2), _Probability(Probability),_VertexFuncMaxValue(0),_SortedTracksValid(0)
 	{}
 	
 	Vertex::Vertex(ZVTOP::CandidateVertex* CandidateVertex, Event* Event)
-	:_Event(Event),_Position(CandidateVertex->position()),_PosError(CandidateVertex->positionError())
+	:_Event(Event),_Position(CandidateVertex->position()),_PosError(CandidateVertex->positionError()),_VertexFuncMaxValue(0),_SortedTracksValid(0)
 	{
 		for (std::vector<TrackState*>::const_iterator iTrack = CandidateVertex->trackStateList().begin();
 			iTrack != CandidateVertex->trackStateList().end(); ++iTrack)
@@ -40,6 +41,7 @@ using namespace util;
 		if (position!=_Tracks.end()) //Found
 		{
 			_Tracks.erase(position);
+			_SortedTracksValid=0;
 			return 1;
 		}
 		else
@@ -48,12 +50,14 @@ using namespace util;
 	
 	bool Vertex::hasTrack(Track* HTrack) const
 	{
-		if (find(_Tracks.begin(), _Tracks.end(), HTrack) != _Tracks.end()) //Found
+		//Chached variable check the status of the cache
+		if (!_SortedTracksValid)
 		{
-			return 1;
+			_SortedTracks = _Tracks;
+			std::sort(_SortedTracks.begin(),_SortedTracks.end());
+			_SortedTracksValid=1;
 		}
-		else
-			return 0;
+		return std::binary_search(_SortedTracks.begin(), _SortedTracks.end(), HTrack);
 	}
 	
 	Vector3 Vertex::momentum() const
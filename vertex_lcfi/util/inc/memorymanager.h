@@ -2,9 +2,12 @@
 #define LCFIMEMMANAGE_H
 
 #include <vector>
+#include <map>
 
 namespace vertex_lcfi
 {
+	class EventMemoryScope;
+	
 	//! Base class for all MemoryManagers
 	class MemoryManagerType
 	{
@@ -25,6 +28,9 @@ namespace vertex_lcfi
 	{
 	public:
 		//! Returns the Event duration singleton instance of the controller
+		/*!
+		If the calling thread has made an EventMemoryScope current this is the controller of that scope
+		*/
 		static MetaMemoryManager* Event();
 		//! Returns the Run duration singleton instance of the controller
 		static MetaMemoryManager* Run();
@@ -42,6 +48,7 @@ namespace vertex_lcfi
 		MetaMemoryManager& operator= (const MetaMemoryManager&);
 	private:
 		std::vector<MemoryManagerType*> _Types;
+		friend class EventMemoryScope;
 	};
 
 	//!Memory management
@@ -53,6 +60,8 @@ namespace vertex_lcfi
 	<br>At the end of the event to free all objects of all types made using the above call:
 	<br><pre>MetaMemoryManager::Event()->delAllObjects();</pre>
 	<br>Similarly for run lifetime objects, replacing %Event with Run.
+	<br>To process several events at once in different threads each event needs its own
+	event memory, see EventMemoryScope.
 	*/
 	template <class T>
 	class MemoryManager :
@@ -69,6 +78,12 @@ namespace vertex_lcfi
 		void registerObject(T* pointer);
 		//! Delete all objects held by this MemoryManager
 		void delAll();
+		//! Identifies the type T, for EventMemoryScope
+		static const void* typeKey()
+		{
+			static char Key;
+			return &Key;
+		}
 	//Protect the constructor, copy and assignment to prevent usage.		
 	protected:
 		//! Do not use
@@ -79,7 +94,52 @@ namespace vertex_lcfi
 		MemoryManager<T>& operator= (const MemoryManager<T>&) {return MemoryManager<T>();}
 	private:
 		std::vector<T*> _Objects;
+		friend class EventMemoryScope;
+	};
+	
+	//! Event memory for processing several events at once
+	/*!
+	Normally all event lifetime objects of all types go to the one set of singletons returned by
+	MetaMemoryManager::Event() and MemoryManager<T>::Event(), so only one event can be processed at a time.
+	An EventMemoryScope holds its own MetaMemoryManager and MemoryManager for each type. While it is current
+	in a thread (see makeCurrent) the Event() calls made from that thread return those instead, so objects
+	made for the event are kept together. A scope can be made current in one thread to read an event and
+	then in another to process it, but it must only be current in one thread at a time.
+	Deleting the scope deletes all its objects. Run lifetime memory is shared by all threads as before.
+	*/
+	class EventMemoryScope
+	{
+	public:
+		EventMemoryScope();
+		//! Deletes all the objects registered with this scope
+		~EventMemoryScope();
+		
+		//! Make this the event memory of the calling thread
+		void makeCurrent();
+		//! Return the calling thread to the global event memory
+		static void release();
+		//! The scope current in the calling thread, 0 if it uses the global event memory
+		static EventMemoryScope* current();
+		
+		//! The controller of this scope
+		MetaMemoryManager* controller() {return &_Controller;}
+		//! The MemoryManager of type T for this scope, made on first use
+		template <class T> MemoryManager<T>* manager();
+		//! One default constructed object of type T for this scope, made on first use
+		/*!
+		For helper objects that are normally shared but keep state while they are being used
+		*/
+		template <class T> T* instance();
 		
+	private:
+		MetaMemoryManager _Controller;
+		std::map<const void*,MemoryManagerType*> _Managers;
+		std::map<const void*,void*> _Instances;
+		
+		//! Do not use
+		EventMemoryScope(const EventMemoryScope&);
+		//! Do not use
+		EventMemoryScope& operator= (const EventMemoryScope&);
 	};
 	
 	template <class T>
@@ -92,8 +152,14 @@ namespace vertex_lcfi
 	template <class T>
 	MemoryManager<T>* MemoryManager<T>::Event()
 	{
+		//A thread processing one of several events at once has its own event memory
+		EventMemoryScope* Scope = EventMemoryScope::current();
+		if (Scope) return Scope->manager<T>();
+		
 		static MemoryManager<T> eventInstance;
-		MetaMemoryManager::Event()->registerType(&eventInstance);
+		//Register with the controller only once
+		static bool registered = (MetaMemoryManager::Event()->registerType(&eventInstance), true);
+		(void)registered;
 		return &eventInstance;
 	}
 	
@@ -101,7 +167,8 @@ namespace vertex_lcfi
 	MemoryManager<T>* MemoryManager<T>::Run()
 	{
 		static MemoryManager<T> runInstance;
-		MetaMemoryManager::Run()->registerType(&runInstance);
+		static bool registered = (MetaMemoryManager::Run()->registerType(&runInstance), true);
+		(void)registered;
 		return &runInstance;
 	}
 
@@ -121,6 +188,31 @@ namespace vertex_lcfi
 		}
 		_Objects.clear();
 	}
+	
+	template <class T>
+	MemoryManager<T>* EventMemoryScope::manager()
+	{
+		MemoryManagerType* & Manager = _Managers[MemoryManager<T>::typeKey()];
+		if (!Manager)
+		{
+			Manager = new MemoryManager<T>();
+			_Controller.registerType(Manager);
+		}
+		return static_cast<MemoryManager<T>*>(Manager);
+	}
+	
+	template <class T>
+	T* EventMemoryScope::instance()
+	{
+		void* & Instance = _Instances[MemoryManager<T>::typeKey()];
+		if (!Instance)
+		{
+			T* NewInstance = new T();
+			this->manager<T>()->registerObject(NewInstance);
+			Instance = NewInstance;
+		}
+		return static_cast<T*>(Instance);
+	}
 
 
 }
@@ -4,6 +4,9 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <iomanip>
+#include <string>
+#include <cmath>
 
 using std::vector;
 
@@ -90,6 +93,68 @@ namespace util{
 		histogram_data<T> _background;
 	};
 
+	// The same as histogram_data, but instead of keeping every value it only counts them in a fixed
+	// number of fine bins between two limits (plus an underflow and an overflow count). The memory used
+	// does not depend on the number of entries, and two of them with the same binning can be merged,
+	// so the results of many jobs can be added together (see write and read).
+	// The binned queries count whole fine bins, so they give the same as histogram_data when the edges
+	// asked for are also fine bin edges, and are otherwise out by at most the entries of one fine bin.
+	// Entries below the lowest bin asked for are counted in it, as histogram_data does.
+	template<class T>
+	class binned_histogram_data
+	{
+	public:
+		binned_histogram_data( int numberOfFineBins=1000, T lowLimit=0, T highLimit=1 );
+		void add( T data );
+		void merge( const binned_histogram_data<T>& other );
+		int number_of_entries(){return (int)_entries;}
+		std::vector< bin<T> > binned_data( int numberOfBins, T minimum, T maximum );
+		std::vector< bin<T> > binned_data( int numberOfBins );
+		std::vector< bin<T> > binned_cumulative_data( int numberOfBins, T minimum, T maximum );
+		std::vector< bin<T> > binned_cumulative_data( int numberOfBins );
+		std::vector< bin<T> > binned_reversecumulative_data( int numberOfBins, T minimum, T maximum );
+		std::vector< bin<T> > binned_reversecumulative_data( int numberOfBins );
+		double number_below( T value );	// the number of entries in the fine bins (and underflow) below value
+		T minimum(){return _minimum;}	// the exact smallest and largest values added
+		T maximum(){return _maximum;}
+		int size(){return (int)_entries;}
+		void write( std::ostream& output ) const;	// writes everything as one line of text
+		bool read( std::istream& input );	// reads what write wrote, false if it can't
+	protected:
+		std::vector< bin<T> > _binData( int numberOfBins, T minimum, T maximum, bool cumulate, bool reverseCumulate=false );
+		T _lowLimit;
+		T _highLimit;
+		std::vector<double> _counts;
+		double _underflow;
+		double _overflow;
+		double _entries;
+		T _minimum;
+		T _maximum;
+		bool _cumulativeIsValid;
+		std::vector<double> _cumulative;	// _cumulative[i] is the number of entries below fine bin i
+	};
+
+	// The same as efficiency_purity, but with the signal and background held in binned_histogram_data.
+	// The default 1010 fine bins between 0 and 1 make eff_pur exact for 100 points (and any other
+	// number of points that divides 1010 when one is added).
+	template<class T>
+	class binned_efficiency_purity
+	{
+	public:
+		binned_efficiency_purity( int numberOfFineBins=1010 ) : _signal( numberOfFineBins, 0, 1 ), _background( numberOfFineBins, 0, 1 ) {}
+		void add_signal( T data ) {_signal.add( data );}
+		void add_background( T data ) {_background.add( data );}
+		int number_of_signal(){return _signal.size();}
+		int number_of_background(){return _background.size();}
+		std::vector< std::pair<double,double> > eff_pur( int numberOfPoints );
+		void merge( const binned_efficiency_purity<T>& other ) {_signal.merge( other._signal );_background.merge( other._background );}
+		void write( std::ostream& output ) const {_signal.write( output );_background.write( output );}
+		bool read( std::istream& input ) {return _signal.read( input ) && _background.read( input );}
+	protected:
+		binned_histogram_data<T> _signal;
+		binned_histogram_data<T> _background;
+	};
+
 	template<class T>
 	void histogram_data<T>::add( T data )
 	{
@@ -273,5 +338,199 @@ namespace util{
 	
 		return returnVal;
 	}
+
+	template<class T>
+	binned_histogram_data<T>::binned_histogram_data( int numberOfFineBins, T lowLimit, T highLimit )
+		: _lowLimit(lowLimit), _highLimit(highLimit), _counts(numberOfFineBins,0), _underflow(0), _overflow(0), _entries(0),
+		_minimum(0), _maximum(0), _cumulativeIsValid(false)
+	{
+	}
+	
+	template<class T>
+	void binned_histogram_data<T>::add( T data )
+	{
+		if( _entries==0 || data<_minimum ) _minimum=data;
+		if( _entries==0 || data>_maximum ) _maximum=data;
+		++_entries;
+		_cumulativeIsValid=false;
+	
+		if( data<_lowLimit ) ++_underflow;
+		else if( data>=_highLimit ) ++_overflow;
+		else
+		{
+			int fineBin=(int)( (data-_lowLimit)/(_highLimit-_lowLimit)*_counts.size() );
+			if( fineBin>=(int)_counts.size() ) fineBin=_counts.size()-1; //rounding, just under the high limit
+			++_counts[fineBin];
+		}
+	}
+	
+	template<class T>
+	void binned_histogram_data<T>::merge( const binned_histogram_data<T>& other )
+	{
+		if( other._counts.size()!=_counts.size() || other._lowLimit!=_lowLimit || other._highLimit!=_highLimit )
+		{
+			std::cerr << "binned_histogram_data::merge - The binning is different.";
+			throw "binned_histogram_data::merge - The binning is different.";
+		}
+		if( other._entries==0 ) return;
+		if( _entries==0 || other._minimum<_minimum ) _minimum=other._minimum;
+		if( _entries==0 || other._maximum>_maximum ) _maximum=other._maximum;
+		for( size_t i=0; i<_counts.size(); ++i ) _counts[i]+=other._counts[i];
+		_underflow+=other._underflow;
+		_overflow+=other._overflow;
+		_entries+=other._entries;
+		_cumulativeIsValid=false;
+	}
+	
+	template<class T>
+	double binned_histogram_data<T>::number_below( T value )
+	{
+		if( !_cumulativeIsValid )
+		{
+			_cumulative.resize( _counts.size()+1 );
+			_cumulative[0]=_underflow;
+			for( size_t i=0; i<_counts.size(); ++i ) _cumulative[i+1]=_cumulative[i]+_counts[i];
+			_cumulativeIsValid=true;
+		}
+	
+		if( _entries==0 || value<=_minimum ) return 0;
+		if( value>_maximum ) return _entries;
+		if( value<=_lowLimit ) return _underflow;
+		if( value>=_highLimit ) return _entries-_overflow;
+	
+		//The number of whole fine bins below value. An edge asked for is usually worked out with some rounding
+		//error, so treat anything that close to a fine bin edge as being on it.
+		double position=(value-_lowLimit)/(_highLimit-_lowLimit)*_counts.size();
+		double nearestEdge=std::floor( position+0.5 );
+		int fineBins=( std::fabs( position-nearestEdge )<1e-6 ) ? (int)nearestEdge : (int)std::floor( position );
+		return _cumulative[fineBins];
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_data( int numberOfBins, T minimum, T maximum )
+	{
+		return _binData( numberOfBins, minimum, maximum, false );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_data( int numberOfBins )
+	{
+		return _binData( numberOfBins, _minimum, _maximum, false );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_cumulative_data( int numberOfBins, T minimum, T maximum )
+	{
+		return _binData( numberOfBins, minimum, maximum, true );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_cumulative_data( int numberOfBins )
+	{
+		return _binData( numberOfBins, _minimum, _maximum, true );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_reversecumulative_data( int numberOfBins, T minimum, T maximum )
+	{
+		return _binData( numberOfBins, minimum, maximum, true, true );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::binned_reversecumulative_data( int numberOfBins )
+	{
+		return _binData( numberOfBins, _minimum, _maximum, true, true );
+	}
+	
+	template<class T>
+	std::vector< bin<T> > binned_histogram_data<T>::_binData( int numberOfBins, T minimum, T maximum, bool cumulate, bool reverseCumulate )
+	{
+		std::vector< bin<T> > binned_data;
+	
+		//work out the difference between bins, the same way as histogram_data so that the edges are the same
+		T binDifference=(maximum-minimum)/((T)numberOfBins);
+		T currentLow=minimum;
+		double previousBelow=0;
+	
+		for( int a=0; a<numberOfBins; ++a )
+		{
+			bin<T> currentBin;
+			currentBin.region_low()=currentLow;
+			currentBin.region_high()=currentLow+binDifference;
+	
+			double below=number_below( currentBin.region_high() );
+			if( !cumulate ) currentBin.contents()=below-previousBelow;
+			else if( reverseCumulate ) currentBin.contents()=_entries-below;
+			else currentBin.contents()=below;
+			previousBelow=below;
+	
+			binned_data.push_back( currentBin );
+			currentLow+=binDifference;
+		}
+	
+		return binned_data;
+	}
+	
+	template<class T>
+	void binned_histogram_data<T>::write( std::ostream& output ) const
+	{
+		std::streamsize oldPrecision=output.precision( 17 );
+		output << "binned_histogram_data " << _counts.size() << " " << _lowLimit << " " << _highLimit << " " << _entries << " "
+			<< _minimum << " " << _maximum << " " << _underflow << " " << _overflow;
+		for( size_t i=0; i<_counts.size(); ++i ) output << " " << _counts[i];
+		output << std::endl;
+		output.precision( oldPrecision );
+	}
+	
+	template<class T>
+	bool binned_histogram_data<T>::read( std::istream& input )
+	{
+		std::string name;
+		int numberOfFineBins;
+		input >> name >> numberOfFineBins;
+		if( !input || name!="binned_histogram_data" || numberOfFineBins<=0 ) return false;
+	
+		_counts.resize( numberOfFineBins );
+		input >> _lowLimit >> _highLimit >> _entries >> _minimum >> _maximum >> _underflow >> _overflow;
+		for( int i=0; i<numberOfFineBins; ++i ) input >> _counts[i];
+		_cumulativeIsValid=false;
+		return !input.fail();
+	}
+	
+	template<class T>
+	std::vector< std::pair<double,double> > binned_efficiency_purity<T>::eff_pur( int numberOfPoints )
+	{
+		if( _signal.size()==0 && _background.size()==0 )
+		{
+			std::cerr << "binned_efficiency_purity::eff_pur(int) - There is no signal or background data.";
+			throw "binned_efficiency_purity::eff_pur(int) - There is no signal or background data.";
+		}
+		if( _signal.size()==0 )
+		{
+			std::cerr << "binned_efficiency_purity::eff_pur(int) - There is no signal data.";
+			throw "binned_efficiency_purity::eff_pur(int) - There is no signal data.";
+		}
+		if( _background.size()==0 )
+		{
+			std::cerr << "binned_efficiency_purity::eff_pur(int) - There is no background data.";
+			throw "binned_efficiency_purity::eff_pur(int) - There is no background data.";
+		}
+	
+		std::vector< std::pair<double,double> > returnVal;
+	
+		// As efficiency_purity, there is a +1 here because the last bin is dropped
+		std::vector< bin<T> > binnedSignal=_signal.binned_reversecumulative_data( numberOfPoints+1,0,1);
+		std::vector< bin<T> > binnedBackground=_background.binned_reversecumulative_data( numberOfPoints+1,0,1);
+	
+		std::pair<double,double> temp;
+		for( int a=0; a<numberOfPoints; ++a )
+		{
+			temp.first=binnedSignal[a].contents()/_signal.number_of_entries();
+			temp.second=binnedSignal[a].contents()/(binnedSignal[a].contents()+binnedBackground[a].contents());
+			returnVal.push_back( temp );
+		}
+	
+		return returnVal;
+	}
 }}
 #endif
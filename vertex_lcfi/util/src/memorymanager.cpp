@@ -1,13 +1,58 @@
 #include <util/inc/memorymanager.h>
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
 namespace vertex_lcfi
 {
 	
+namespace
+{
+#ifndef _WIN32
+	pthread_key_t CurrentScopeKey;
+	pthread_once_t CurrentScopeKeyOnce = PTHREAD_ONCE_INIT;
+	
+	void makeCurrentScopeKey()
+	{
+		pthread_key_create(&CurrentScopeKey, 0);
+	}
+	
+	EventMemoryScope* currentScope()
+	{
+		pthread_once(&CurrentScopeKeyOnce, makeCurrentScopeKey);
+		return static_cast<EventMemoryScope*>(pthread_getspecific(CurrentScopeKey));
+	}
+	
+	void setCurrentScope(EventMemoryScope* Scope)
+	{
+		pthread_once(&CurrentScopeKeyOnce, makeCurrentScopeKey);
+		pthread_setspecific(CurrentScopeKey, Scope);
+	}
+#else
+	//No threads, so one current scope
+	EventMemoryScope* CurrentScope = 0;
+	
+	EventMemoryScope* currentScope()
+	{
+		return CurrentScope;
+	}
+	
+	void setCurrentScope(EventMemoryScope* Scope)
+	{
+		CurrentScope = Scope;
+	}
+#endif
+}
+	
 	MetaMemoryManager::MetaMemoryManager()
 	{}
 	
 	MetaMemoryManager* MetaMemoryManager::Event() 
 	{
+		EventMemoryScope* Scope = currentScope();
+		if (Scope) return Scope->controller();
+		
 		static MetaMemoryManager eventInstance;
 		return &eventInstance;
 	}
@@ -29,6 +74,30 @@ namespace vertex_lcfi
 		_Types.push_back(Type);
 	}
 	
+	EventMemoryScope::EventMemoryScope()
+	{}
+	
+	EventMemoryScope::~EventMemoryScope()
+	{
+		if (currentScope() == this) setCurrentScope(0);
+		_Controller.delAllObjects();
+		for(std::vector<MemoryManagerType*>::iterator iMem = _Controller._Types.begin();iMem != _Controller._Types.end();++iMem)
+			delete (*iMem);
+	}
+	
+	void EventMemoryScope::makeCurrent()
+	{
+		setCurrentScope(this);
+	}
+	
+	void EventMemoryScope::release()
+	{
+		setCurrentScope(0);
+	}
+	
+	EventMemoryScope* EventMemoryScope::current()
+	{
+		return currentScope();
+	}
+	
 }
-
-
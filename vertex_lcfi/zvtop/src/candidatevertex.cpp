@@ -463,6 +463,10 @@ double CandidateVertex::maxChiSquaredOfTrackIP() const
 
 VertexFitter* CandidateVertex::_getFallbackFitter()
 {
+    //Events processed in parallel each have their own, as the fallbacks keep state while in use
+    if (EventMemoryScope::current())
+        return EventMemoryScope::current()->instance<FallbackVertexFitter>();
+
     if (!_FallbackFitter)
         {
         	_FallbackFitter = new FallbackVertexFitter();
@@ -474,6 +478,9 @@ VertexFitter* CandidateVertex::_getFallbackFitter()
 
 VertexResolver* CandidateVertex::_getFallbackResolver()
 {
+    if (EventMemoryScope::current())
+        return EventMemoryScope::current()->instance<FallbackVertexResolver>();
+
     if (!_FallbackResolver)
     {
     	_FallbackResolver = new FallbackVertexResolver();
@@ -484,6 +491,9 @@ VertexResolver* CandidateVertex::_getFallbackResolver()
 
 VertexFuncMaxFinder* CandidateVertex::_getFallbackMaxFinder()
 {
+    if (EventMemoryScope::current())
+        return EventMemoryScope::current()->instance<FallbackVertexFuncMaxFinder>();
+
     if (!_FallbackMaxFinder)
     {
         _FallbackMaxFinder = new FallbackVertexFuncMaxFinder();